@@ -16,12 +16,18 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
 
 #include "src/carnot/carnot.h"
 #include "src/carnot/engine_state.h"
 #include "src/carnot/exec/exec_graph.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/funcs/builtins/builtins.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/plan.h"
@@ -32,6 +38,15 @@
 #include "src/shared/types/type_utils.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int64(carnot_result_cache_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_RESULT_CACHE_BYTES", 64 * 1024 * 1024),
+             "The memory budget of the cache of plan fragment results, which lets identical "
+             "queries over unchanged data skip the recomputation. 0 disables the cache.");
+DEFINE_int32(carnot_result_cache_ttl_ms,
+             gflags::Int32FromEnv("PL_CARNOT_RESULT_CACHE_TTL_MS", 5000),
+             "How long a cached plan fragment result can be served for, to bound how stale the "
+             "metadata it was computed with can be.");
+
 namespace px {
 namespace carnot {
 
@@ -99,6 +114,8 @@ class CarnotImpl final : public Carnot {
   std::unique_ptr<grpc::Server> grpc_server_;
   std::unique_ptr<exec::GRPCRouter> grpc_router_;
   int grpc_server_port_;
+  // Null if the result cache is disabled.
+  std::unique_ptr<exec::ResultCache> result_cache_;
 
   // The id of the agent that owns this Carnot instance.
   sole::uuid agent_id_;
@@ -114,6 +131,11 @@ Status CarnotImpl::Init(const sole::uuid& agent_id, std::unique_ptr<udf::Registr
   grpc_server_creds_ = grpc_server_creds;
   grpc_server_port_ = grpc_server_port;
   grpc_router_ = std::make_unique<exec::GRPCRouter>();
+  if (FLAGS_carnot_result_cache_bytes > 0) {
+    result_cache_ = std::make_unique<exec::ResultCache>(
+        FLAGS_carnot_result_cache_bytes,
+        std::chrono::milliseconds(FLAGS_carnot_result_cache_ttl_ms));
+  }
   if (grpc_server_port_ > 0) {
     grpc_server_thread_ = std::make_unique<std::thread>(&CarnotImpl::GRPCServerFunc, this);
   }
@@ -172,6 +194,7 @@ Status CarnotImpl::RegisterUDFsInPlanFragment(exec::ExecState* exec_state, plan:
         return WalkExpression(exec_state, *filter.expression());
       })
       .OnLimit(no_op)
+      .OnSort(no_op)
       .OnMemorySink(no_op)
       .OnMemorySource(no_op)
       .OnUnion(no_op)
@@ -303,12 +326,22 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   // Unclear how we'll use plan fragments in the future (they're currently unused). For now, we will
   // share the schema between plan fragments.
   auto schema = std::make_unique<table_store::schema::Schema>();
+  // Analyzed queries are always executed, so that they report the real execution stats.
+  absl::flat_hash_map<int64_t, std::string> fragment_keys;
+  if (result_cache_ != nullptr && !analyze) {
+    for (const auto& fragment : logical_plan.nodes()) {
+      fragment_keys[fragment.id()] = exec::ResultCache::FragmentKey(fragment);
+    }
+  }
   auto s =
       plan::PlanWalker()
           .OnPlanFragment([&](auto* pf) {
             auto exec_graph = exec::ExecutionGraph();
             PL_RETURN_IF_ERROR(exec_graph.Init(schema.get(), plan_state.get(), exec_state.get(), pf,
                                                /* collect_exec_node_stats */ analyze));
+            if (auto it = fragment_keys.find(pf->id()); it != fragment_keys.end()) {
+              exec_graph.set_result_cache(result_cache_.get(), it->second);
+            }
             PL_RETURN_IF_ERROR(exec_graph.Execute());
             std::vector<std::string> frag_sinks = exec_graph.OutputTables();
             output_table_strs.insert(output_table_strs.end(), frag_sinks.begin(), frag_sinks.end());
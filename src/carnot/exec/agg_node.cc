@@ -20,9 +20,16 @@
 
 #include <arrow/array.h>
 #include <arrow/array/builder_base.h>
+#include <arrow/array/builder_primitive.h>
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include <absl/strings/substitute.h>
 
 #include <magic_enum.hpp>
 
@@ -78,6 +85,22 @@ void ExtractToColumnWrapper(const std::vector<GroupArgs>& group_args,
   }
 }
 
+// Appends the values of each group's rows to that group's column wrapper, one contiguous run of
+// rows per group.
+template <types::DataType DT>
+void ExtractRunsToColumnWrapper(const std::vector<AggHashValue*>& group_values,
+                                const std::vector<int64_t>& groups,
+                                const std::vector<int64_t>& group_offsets,
+                                const std::vector<int64_t>& rows_by_group, arrow::Array* arr,
+                                size_t col_idx) {
+  for (size_t i = 0; i < groups.size(); ++i) {
+    auto col_wrapper = group_values[groups[i]]->agg_cols[col_idx].get();
+    for (int64_t j = group_offsets[i]; j < group_offsets[i + 1]; ++j) {
+      types::ExtractValueToColumnWrapper<DT>(col_wrapper, arr, rows_by_group[j]);
+    }
+  }
+}
+
 }  // namespace
 
 std::string AggNode::DebugStringImpl() {
@@ -111,6 +134,15 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     return error::InvalidArgument("Output size mismatch in aggregate");
   }
 
+  auto groups_size = plan_node_->groups().size();
+  if (plan_node_->has_time_window()) {
+    int64_t group_index = plan_node_->time_window().group_index();
+    if (group_index < 0 || group_index >= static_cast<int64_t>(groups_size)) {
+      return error::InvalidArgument("Time window group index $0 is out of range for $1 groups",
+                                    group_index, groups_size);
+    }
+  }
+
   if (HasNoGroups()) {
     return Status::OK();
   }
@@ -121,7 +153,6 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
 
   // Compute the group and value data types.
   // The case of GroupByNone, there will be no groups.
-  auto groups_size = plan_node_->groups().size();
   group_data_types_.reserve(groups_size);
   for (const auto& group : plan_node_->groups()) {
     DCHECK(group.idx < input_descriptor_->size());
@@ -135,6 +166,16 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     value_data_types_.emplace_back(output_descriptor_->type(values_idx));
   }
 
+  use_group_key_table_ = GroupKeyHashTable::SupportsKeyTypes(group_data_types_);
+
+  if (plan_node_->has_time_window()) {
+    auto dt = group_data_types_[plan_node_->time_window().group_index()];
+    if (dt != types::TIME64NS) {
+      return error::InvalidArgument("Time window group must be TIME64NS, got $0",
+                                    magic_enum::enum_name(dt));
+    }
+  }
+
   return CreateColumnMapping();
 }
 
@@ -146,6 +187,9 @@ Status AggNode::PrepareImpl(ExecState* exec_state) {
 Status AggNode::OpenImpl(ExecState* exec_state) {
   if (HasNoGroups()) {
     PL_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
+  } else if (!plan_node_->has_time_window()) {
+    global_partition_ = CreatePartition();
+    partition_ = global_partition_.get();
   }
   return Status::OK();
 }
@@ -154,6 +198,9 @@ Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
   if (HasNoGroups()) {
     return AggregateGroupByNone(exec_state, rb);
   }
+  if (plan_node_->has_time_window()) {
+    return AggregateTimeWindows(exec_state, rb);
+  }
   return AggregateGroupByClause(exec_state, rb);
 }
 
@@ -161,24 +208,54 @@ Status AggNode::CloseImpl(ExecState*) {
   udas_no_groups_.clear();
   group_args_chunk_.clear();
   group_args_pool_.Clear();
-  udas_pool_.Clear();
+  partition_ = nullptr;
+  global_partition_.reset();
+  window_partitions_.clear();
+  window_start_col_.reset();
+  if (num_late_rows_ > 0) {
+    VLOG(1) << absl::Substitute("Dropped $0 rows that arrived after their time window closed",
+                                num_late_rows_);
+  }
 
   return Status::OK();
 }
 
 bool AggNode::ReadyToEmitBatches(const RowBatch& rb) const {
+  if (plan_node_->has_time_window()) {
+    // Time windowed aggregates emit each window once the watermark passes it instead.
+    return false;
+  }
   return rb.eos() || (rb.eow() && plan_node_->windowed());
 }
 
 Status AggNode::ClearAggState(ExecState* exec_state) {
   if (HasNoGroups()) {
     udas_no_groups_.clear();
-    PL_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
+    return CreateUDAInfoValues(&udas_no_groups_, exec_state);
   }
-  agg_hash_map_.clear();
+  // Replace the partition rather than clearing it, so that the memory of its groups is freed.
+  global_partition_ = CreatePartition();
+  partition_ = global_partition_.get();
+  group_batch_idx_.clear();
   return Status::OK();
 }
 
+std::unique_ptr<AggPartition> AggNode::CreatePartition() const {
+  auto partition = std::make_unique<AggPartition>();
+  if (use_group_key_table_) {
+    partition->group_key_table = std::make_unique<GroupKeyHashTable>(group_data_types_);
+  }
+  return partition;
+}
+
+arrow::Array* AggNode::GroupColumn(const RowBatch& rb, size_t group_idx) const {
+  if (window_start_col_ != nullptr &&
+      static_cast<int64_t>(group_idx) == plan_node_->time_window().group_index()) {
+    return window_start_col_.get();
+  }
+  return rb.ColumnAt(plan_node_->groups()[group_idx].idx).get();
+}
+
 Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb) {
   auto values = plan_node_->values();
   for (size_t i = 0; i < values.size(); ++i) {
@@ -219,11 +296,10 @@ Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
 
   // Scan through all the group args in column order and extract the entire column.
   for (size_t idx = 0; idx < plan_node_->groups().size(); idx++) {
-    auto grp = plan_node_->groups()[idx];
-    DCHECK(grp.idx < input_descriptor_->size());
+    DCHECK(plan_node_->groups()[idx].idx < input_descriptor_->size());
     DCHECK(idx < group_data_types_.size());
     auto dt = group_data_types_[idx];
-    auto col = rb.ColumnAt(grp.idx).get();
+    auto col = GroupColumn(rb, idx);
 
 #define TYPE_CASE(_dt_) ExtractIntoGroupArgs<_dt_>(&group_args_chunk_, col, idx);
     PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
@@ -241,14 +317,17 @@ Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
     AggHashValue* val = nullptr;
     // Check to see if in hash
     // TODO(zasgar): Change this to upsert.
-    auto it = agg_hash_map_.find(ga.rt);
+    auto it = partition_->agg_hash_map.find(ga.rt);
     // If not in hash then insert
-    if (it == agg_hash_map_.end()) {
+    if (it == partition_->agg_hash_map.end()) {
       // Create a val array.
       val = CreateAggHashValue(exec_state);
-      agg_hash_map_[ga.rt] = val;
-      // We have inserted this, so the stored RowTuple is now in the table.
-      ga.rt = nullptr;
+      // Move the key into a RowTuple owned by the partition, so that it is freed with the
+      // partition. This leaves ga.rt with the new tuple's empty values.
+      auto* rt = partition_->pool.Add(new RowTuple(&group_data_types_));
+      std::swap(rt->fixed_values, ga.rt->fixed_values);
+      std::swap(rt->variable_values, ga.rt->variable_values);
+      partition_->agg_hash_map[rt] = val;
     } else {
       val = it->second;
     }
@@ -270,6 +349,70 @@ Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
   return Status::OK();
 }
 
+Status AggNode::AggregateWithGroupKeyTable(ExecState* exec_state, const RowBatch& rb) {
+  std::vector<const arrow::Array*> key_cols;
+  key_cols.reserve(plan_node_->groups().size());
+  for (size_t idx = 0; idx < plan_node_->groups().size(); ++idx) {
+    key_cols.push_back(GroupColumn(rb, idx));
+  }
+  auto& group_values = partition_->group_values;
+  partition_->group_key_table->FindOrInsertBatch(key_cols, &batch_group_ids_);
+  int64_t num_groups = partition_->group_key_table->num_groups();
+  while (static_cast<int64_t>(group_values.size()) < num_groups) {
+    group_values.push_back(CreateAggHashValue(exec_state));
+  }
+  if (plan_node_->values().empty()) {
+    return Status::OK();
+  }
+
+  // Bucket the rows of the batch by group, so that every group gets its values appended (and
+  // later updated) as one contiguous run rather than row by row.
+  group_batch_idx_.resize(num_groups, -1);
+  batch_groups_.clear();
+  batch_group_offsets_.clear();
+  for (int64_t group_id : batch_group_ids_) {
+    if (group_batch_idx_[group_id] == -1) {
+      group_batch_idx_[group_id] = batch_groups_.size();
+      batch_groups_.push_back(group_id);
+      batch_group_offsets_.push_back(0);
+    }
+    ++batch_group_offsets_[group_batch_idx_[group_id]];
+  }
+  // Turn the counts into start offsets, with a trailing end offset.
+  int64_t offset = 0;
+  for (auto& group_offset : batch_group_offsets_) {
+    int64_t count = group_offset;
+    group_offset = offset;
+    offset += count;
+  }
+  batch_group_offsets_.push_back(offset);
+  batch_rows_by_group_.resize(batch_group_ids_.size());
+  std::vector<int64_t> next_pos(batch_group_offsets_.begin(), batch_group_offsets_.end() - 1);
+  for (size_t row_idx = 0; row_idx < batch_group_ids_.size(); ++row_idx) {
+    batch_rows_by_group_[next_pos[group_batch_idx_[batch_group_ids_[row_idx]]]++] = row_idx;
+  }
+
+  for (size_t i = 0; i < stored_cols_data_types_.size(); ++i) {
+    const auto& rb_col_idx = stored_cols_to_plan_idx_[i];
+    const auto& dt = input_descriptor_->type(rb_col_idx);
+    auto arr = rb.ColumnAt(rb_col_idx).get();
+#define TYPE_CASE(_dt_)                                                              \
+  ExtractRunsToColumnWrapper<_dt_>(group_values, batch_groups_, batch_group_offsets_, \
+                                   batch_rows_by_group_, arr, i);
+    PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+  }
+
+  for (int64_t group_id : batch_groups_) {
+    group_batch_idx_[group_id] = -1;
+    auto* val = group_values[group_id];
+    if (val->agg_cols[0]->Size() > kAggCompactionThreshold) {
+      PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
+    }
+  }
+  return Status::OK();
+}
+
 Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, size_t num_records) {
   PL_UNUSED(exec_state);
   // TODO(zasgar): This only needs to run for unique groups. We should find
@@ -286,44 +429,22 @@ Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, size_t num_reco
 }
 
 Status AggNode::ResetGroupArgs() {
-  // Reset the group args. If the row tuple is null it has been consumed, so
-  // we can replace it with a new RowTuple. We also reset the
-  // agg hash value to nullptr.
+  // Reset the group args, and the agg hash value to nullptr.
   for (size_t i = 0; i < group_args_chunk_.size(); ++i) {
     group_args_chunk_[i].av = nullptr;
-    if (group_args_chunk_[i].rt == nullptr) {
-      group_args_chunk_[i].rt = CreateGroupArgsRowTuple();
-    } else {
-      group_args_chunk_[i].rt->Reset();
-    }
+    group_args_chunk_[i].rt->Reset();
   }
   return Status::OK();
 }
 
 Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
-  PL_UNUSED(exec_state);
   DCHECK(output_rb != nullptr);
-  std::vector<std::unique_ptr<arrow::ArrayBuilder>> group_builders;
-  for (const auto& group_dt : group_data_types_) {
-    group_builders.push_back(types::MakeArrowBuilder(group_dt, exec_state->exec_mem_pool()));
-  }
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> value_builders;
   for (const auto& value_data_type : value_data_types_) {
     value_builders.push_back(types::MakeArrowBuilder(value_data_type, exec_state->exec_mem_pool()));
   }
 
-  // Agg into agg values and emit!
-  for (const auto& kv : agg_hash_map_) {
-    auto* groups_rt = kv.first;
-    auto* val = kv.second;
-
-    for (size_t i = 0; i < group_data_types_.size(); ++i) {
-      DCHECK(i < group_builders.size());
-
-#define TYPE_CASE(_dt_) AppendToBuilder<_dt_>(group_builders[i].get(), groups_rt, i);
-      PL_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
-#undef TYPE_CASE
-    }
+  auto finalize_values = [&](AggHashValue* val) -> Status {
     // Actually Finalize the UDA based on the column wrapper chunks.
     PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
     for (size_t i = 0; i < val->udas.size(); ++i) {
@@ -331,12 +452,47 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
       PL_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
                                                      value_builders[i].get()));
     }
+    return Status::OK();
+  };
+
+  std::vector<std::shared_ptr<arrow::Array>> group_cols;
+  if (use_group_key_table_) {
+    // Groups are emitted in group id order, which matches the order of the keys.
+    PL_ASSIGN_OR_RETURN(group_cols,
+                        partition_->group_key_table->KeysToArrow(exec_state->exec_mem_pool()));
+    for (auto* val : partition_->group_values) {
+      PL_RETURN_IF_ERROR(finalize_values(val));
+    }
+  } else {
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> group_builders;
+    for (const auto& group_dt : group_data_types_) {
+      group_builders.push_back(types::MakeArrowBuilder(group_dt, exec_state->exec_mem_pool()));
+    }
+
+    // Agg into agg values and emit!
+    for (const auto& kv : partition_->agg_hash_map) {
+      auto* groups_rt = kv.first;
+      auto* val = kv.second;
+
+      for (size_t i = 0; i < group_data_types_.size(); ++i) {
+        DCHECK(i < group_builders.size());
+
+#define TYPE_CASE(_dt_) AppendToBuilder<_dt_>(group_builders[i].get(), groups_rt, i);
+        PL_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+      }
+      PL_RETURN_IF_ERROR(finalize_values(val));
+    }
+
+    for (const auto& group_builder : group_builders) {
+      std::shared_ptr<arrow::Array> arr;
+      PL_RETURN_IF_ERROR(group_builder->Finish(&arr));
+      group_cols.push_back(arr);
+    }
   }
 
-  for (const auto& group_builder : group_builders) {
-    std::shared_ptr<arrow::Array> arr;
-    PL_RETURN_IF_ERROR(group_builder->Finish(&arr));
-    PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+  for (const auto& group_col : group_cols) {
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(group_col));
   }
 
   for (const auto& value_builder : value_builders) {
@@ -357,23 +513,178 @@ Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb
   // 3. If the agg values are large then run aggregate and compact.
   // 4. Reset state to prepare for next row batch.
   // 5. If it's the last batch then emit the values.
-  PL_RETURN_IF_ERROR(ExtractRowTupleForBatch(rb));
-  PL_RETURN_IF_ERROR(HashRowBatch(exec_state, rb));
-  if (plan_node_->values().size() > 0) {
-    PL_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
+  if (use_group_key_table_) {
+    PL_RETURN_IF_ERROR(AggregateWithGroupKeyTable(exec_state, rb));
+  } else {
+    PL_RETURN_IF_ERROR(ExtractRowTupleForBatch(rb));
+    PL_RETURN_IF_ERROR(HashRowBatch(exec_state, rb));
+    if (plan_node_->values().size() > 0) {
+      PL_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
+    }
+    PL_RETURN_IF_ERROR(ResetGroupArgs());
   }
-  PL_RETURN_IF_ERROR(ResetGroupArgs());
   if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PL_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
-    output_rb.set_eow(rb.eow());
-    output_rb.set_eos(rb.eos());
-    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+    PL_RETURN_IF_ERROR(EmitPartition(exec_state, rb.eow(), rb.eos()));
     PL_RETURN_IF_ERROR(ClearAggState(exec_state));
   }
   return Status::OK();
 }
 
+Status AggNode::EmitPartition(ExecState* exec_state, bool eow, bool eos) {
+  RowBatch output_rb(*output_descriptor_, NumGroups());
+  PL_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
+  output_rb.set_eow(eow);
+  output_rb.set_eos(eos);
+  return SendRowBatchToChildren(exec_state, output_rb);
+}
+
+Status AggNode::AggregateTimeWindows(ExecState* exec_state, const RowBatch& rb) {
+  const auto& window = plan_node_->time_window();
+  const auto& time_group = plan_node_->groups()[window.group_index()];
+  const auto* times = static_cast<const arrow::Int64Array*>(rb.ColumnAt(time_group.idx).get());
+
+  // 1. Bucket the rows by the start of each window that they fall into. Tumbling windows put each
+  // row into one window, sliding windows into about size / slide windows.
+  std::map<int64_t, std::vector<int64_t>> window_rows;
+  int64_t max_time = std::numeric_limits<int64_t>::min();
+  std::vector<int64_t>* last_rows = nullptr;
+  int64_t last_start = 0;
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    int64_t time = times->Value(row_idx);
+    max_time = std::max(max_time, time);
+    // The last window to start at or before the row. Rounds towards negative infinity.
+    int64_t start = time - (time % window.slide_ns() + window.slide_ns()) % window.slide_ns();
+    if (start + window.size_ns() <= watermark_) {
+      // All of the windows that the row falls into have already been emitted.
+      ++num_late_rows_;
+      continue;
+    }
+    for (; start > time - window.size_ns() && start + window.size_ns() > watermark_;
+         start -= window.slide_ns()) {
+      if (last_rows == nullptr || start != last_start) {
+        last_rows = &window_rows[start];
+        last_start = start;
+      }
+      last_rows->push_back(row_idx);
+    }
+  }
+
+  // 2. Aggregate each window's rows into its partition. The window's time group is keyed on the
+  // window start.
+  for (auto& [start, rows] : window_rows) {
+    auto& partition = window_partitions_[start];
+    if (partition == nullptr) {
+      partition = CreatePartition();
+    }
+    partition_ = partition.get();
+
+    RowBatch window_rb(*input_descriptor_, rb.num_rows());
+    for (int64_t col_idx = 0; col_idx < rb.num_columns(); ++col_idx) {
+      PL_RETURN_IF_ERROR(window_rb.AddColumn(rb.ColumnAt(col_idx)));
+    }
+    if (static_cast<int64_t>(rows.size()) != rb.num_rows()) {
+      window_rb.set_selection(std::move(rows));
+    }
+    PL_ASSIGN_OR_RETURN(auto dense_rb, window_rb.MaterializeSelection());
+
+    arrow::Int64Builder start_builder(exec_state->exec_mem_pool());
+    PL_RETURN_IF_ERROR(start_builder.Reserve(dense_rb->num_rows()));
+    for (int64_t i = 0; i < dense_rb->num_rows(); ++i) {
+      start_builder.UnsafeAppend(start);
+    }
+    PL_RETURN_IF_ERROR(start_builder.Finish(&window_start_col_));
+
+    PL_RETURN_IF_ERROR(AggregateGroupByClause(exec_state, *dense_rb));
+  }
+  window_start_col_.reset();
+
+  // 3. Advance the watermark and emit the windows that it closes, freeing their state. Everything
+  // left is emitted at the end of the stream.
+  if (rb.num_rows() > 0 && max_time - window.allowed_lateness_ns() > watermark_) {
+    watermark_ = max_time - window.allowed_lateness_ns();
+  }
+  bool sent_eos = false;
+  for (auto it = window_partitions_.begin(); it != window_partitions_.end();) {
+    if (!rb.eos() && it->first + window.size_ns() > watermark_) {
+      break;
+    }
+    partition_ = it->second.get();
+    sent_eos = rb.eos() && std::next(it) == window_partitions_.end();
+    PL_RETURN_IF_ERROR(EmitPartition(exec_state, /*eow*/ true, /*eos*/ sent_eos));
+    it = window_partitions_.erase(it);
+  }
+  partition_ = nullptr;
+  if (rb.eos() && !sent_eos) {
+    PL_ASSIGN_OR_RETURN(auto eos_rb,
+                        RowBatch::WithZeroRows(*output_descriptor_, /*eow*/ true, /*eos*/ true));
+    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *eos_rb));
+  }
+  return Status::OK();
+}
+
+Status AggNode::MergeUDAs(const std::vector<UDAInfo>& udas,
+                          const std::vector<UDAInfo>& other_udas) {
+  DCHECK_EQ(udas.size(), other_udas.size());
+  for (size_t i = 0; i < udas.size(); ++i) {
+    const auto& uda_info = udas[i];
+    PL_RETURN_IF_ERROR(
+        uda_info.def->Merge(uda_info.uda.get(), other_udas[i].uda.get(), function_ctx_.get()));
+  }
+  return Status::OK();
+}
+
+Status AggNode::MergeFrom(ExecState* exec_state, AggNode* other) {
+  DCHECK(other != nullptr);
+  if (HasNoGroups()) {
+    return MergeUDAs(udas_no_groups_, other->udas_no_groups_);
+  }
+
+  auto* other_partition = other->partition_;
+  if (use_group_key_table_) {
+    // Look up the other node's keys in our table as if they were a batch of input rows.
+    PL_ASSIGN_OR_RETURN(auto other_keys, other_partition->group_key_table->KeysToArrow(
+                                             exec_state->exec_mem_pool()));
+    std::vector<const arrow::Array*> key_cols;
+    for (const auto& key_col : other_keys) {
+      key_cols.push_back(key_col.get());
+    }
+    std::vector<int64_t> group_ids;
+    auto& group_values = partition_->group_values;
+    partition_->group_key_table->FindOrInsertBatch(key_cols, &group_ids);
+    while (static_cast<int64_t>(group_values.size()) < partition_->group_key_table->num_groups()) {
+      group_values.push_back(CreateAggHashValue(exec_state));
+    }
+    for (size_t other_group_id = 0; other_group_id < group_ids.size(); ++other_group_id) {
+      auto* other_val = other_partition->group_values[other_group_id];
+      PL_RETURN_IF_ERROR(other->EvaluateAggHashValue(exec_state, other_val));
+      auto* val = group_values[group_ids[other_group_id]];
+      PL_RETURN_IF_ERROR(MergeUDAs(val->udas, other_val->udas));
+    }
+    return Status::OK();
+  }
+
+  for (const auto& [other_rt, other_val] : other_partition->agg_hash_map) {
+    // The other node may still have values buffered in its column wrappers, so fold those into its
+    // UDAs before merging.
+    PL_RETURN_IF_ERROR(other->EvaluateAggHashValue(exec_state, other_val));
+
+    AggHashValue* val = nullptr;
+    auto it = partition_->agg_hash_map.find(other_rt);
+    if (it == partition_->agg_hash_map.end()) {
+      // The RowTuple is owned by the other node's partition, so we need our own copy of it.
+      auto* rt = partition_->pool.Add(new RowTuple(&group_data_types_));
+      rt->fixed_values = other_rt->fixed_values;
+      rt->variable_values = other_rt->variable_values;
+      val = CreateAggHashValue(exec_state);
+      partition_->agg_hash_map[rt] = val;
+    } else {
+      val = it->second;
+    }
+    PL_RETURN_IF_ERROR(MergeUDAs(val->udas, other_val->udas));
+  }
+  return Status::OK();
+}
+
 StatusOr<types::DataType> AggNode::GetTypeOfDep(const plan::ScalarExpression& expr) const {
   // Agg exprs can only be of type col, or  const.
   switch (expr.ExpressionType()) {
@@ -507,7 +818,7 @@ Status AggNode::CreateColumnMapping() {
 }
 
 AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state) {
-  auto* val = udas_pool_.Add(new AggHashValue);
+  auto* val = partition_->pool.Add(new AggHashValue);
   PL_CHECK_OK(CreateUDAInfoValues(&(val->udas), exec_state));
   for (const auto& dt : stored_cols_data_types_) {
     val->agg_cols.emplace_back(types::ColumnWrapper::Make(dt, 0));
@@ -18,6 +18,7 @@
 
 #pragma once
 #include <cstddef>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
@@ -27,6 +28,7 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/group_key_hash_table.h"
 #include "src/carnot/exec/row_tuple.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/scalar_expression.h"
@@ -57,6 +59,21 @@ struct AggHashValue {
   std::vector<types::SharedColumnWrapper> agg_cols;
 };
 
+/**
+ * The groups and aggregate values of an aggregate, along with the memory that backs them. Time
+ * windowed aggregates keep a partition per open window, so that the state of a window can be freed
+ * as soon as the window is emitted.
+ */
+struct AggPartition {
+  AbslRowTupleHashMap<AggHashValue*> agg_hash_map;
+  // When the group types allow it, groups are tracked in group_key_table instead of agg_hash_map,
+  // and group_values holds the aggregate values indexed by group id.
+  std::unique_ptr<GroupKeyHashTable> group_key_table;
+  std::vector<AggHashValue*> group_values;
+  // Owns the AggHashValues and the RowTuple keys of agg_hash_map.
+  ObjectPool pool;
+};
+
 struct GroupArgs {
   explicit GroupArgs(RowTuple* rt) : rt(rt), av(nullptr) {}
   RowTuple* rt;
@@ -64,15 +81,32 @@ struct GroupArgs {
 };
 
 class AggNode : public ProcessingNode {
-  using AggHashMap = AbslRowTupleHashMap<AggHashValue*>;
-
  public:
   AggNode() = default;
   virtual ~AggNode() = default;
 
+  /**
+   * Whether the state of this node can be built up by multiple workers and merged back together
+   * with MergeFrom. Windowed aggregates emit on every window and need to see their input in order.
+   */
+  bool SupportsMorselMerge() const {
+    return !plan_node_->windowed() && !plan_node_->has_time_window();
+  }
+
+  /**
+   * Merges the aggregate state accumulated by another AggNode with the same plan into this node.
+   * Used to gather the thread-local partial aggregates built by morsel workers. The other node must
+   * not be used afterwards, except to Close it.
+   * @param exec_state The execution state.
+   * @param other The node to merge from.
+   * @return The status of the merge.
+   */
+  Status MergeFrom(ExecState* exec_state, AggNode* other);
+
  protected:
   Status AggregateGroupByNone(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status AggregateGroupByClause(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status AggregateTimeWindows(ExecState* exec_state, const table_store::schema::RowBatch& rb);
 
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -83,14 +117,23 @@ class AggNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
-  AggHashMap agg_hash_map_;
   bool HasNoGroups() const { return plan_node_->groups().empty(); }
+  int64_t NumGroups() const {
+    return use_group_key_table_ ? partition_->group_key_table->num_groups()
+                                : partition_->agg_hash_map.size();
+  }
   // ReadyToEmitBatches returns true when the input stream has reached a point where output batches
   // can be emitted. In the windowed aggregate case, this happens whenever end of window (eow) is
   // reached. In the blocking aggregate case, this happens at eos only.
   bool ReadyToEmitBatches(const table_store::schema::RowBatch& rb) const;
   // When we see a new window, we need to be able to clear the aggregate state.
   Status ClearAggState(ExecState* exec_state);
+  std::unique_ptr<AggPartition> CreatePartition() const;
+  // Emits the groups of partition_ as a row batch.
+  Status EmitPartition(ExecState* exec_state, bool eow, bool eos);
+  // The column that the group at group_idx is keyed on. For time windowed aggregates, the time
+  // column is replaced by the start of the window that the batch is aggregated into.
+  arrow::Array* GroupColumn(const table_store::schema::RowBatch& rb, size_t group_idx) const;
 
   Status EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UDAInfo& uda_info,
                                           plan::AggregateExpression* expr,
@@ -122,7 +165,6 @@ class AggNode : public ProcessingNode {
   std::vector<types::DataType> stored_cols_data_types_;
 
   ObjectPool group_args_pool_{"group_args_pool"};
-  ObjectPool udas_pool_{"udas_pool"};
 
   std::vector<types::DataType> group_data_types_;
   std::vector<types::DataType> value_data_types_;
@@ -131,13 +173,38 @@ class AggNode : public ProcessingNode {
   // This vector holds pointers to the row_tuples which are managed by the group_args_pool_.
 
   std::vector<GroupArgs> group_args_chunk_;
+
+  // The partition that rows are currently aggregated into. Unless the aggregate is time windowed,
+  // this is the only partition and is owned by global_partition_.
+  AggPartition* partition_ = nullptr;
+  std::unique_ptr<AggPartition> global_partition_;
+  bool use_group_key_table_ = false;
+  // Scratch space used to bucket the rows of a batch by group id.
+  std::vector<int64_t> batch_group_ids_;
+  std::vector<int64_t> group_batch_idx_;
+  std::vector<int64_t> batch_groups_;
+  std::vector<int64_t> batch_group_offsets_;
+  std::vector<int64_t> batch_rows_by_group_;
   // END: Variables specific to GroupBy Agg.
 
+  // Variables specific to time windowed Agg.
+  // The open windows, keyed by their start time.
+  std::map<int64_t, std::unique_ptr<AggPartition>> window_partitions_;
+  // Windows which end at or before the watermark are closed: they have been emitted, and rows that
+  // fall into them are dropped.
+  int64_t watermark_ = std::numeric_limits<int64_t>::min();
+  int64_t num_late_rows_ = 0;
+  // The window start column of the batch that is being aggregated into partition_.
+  std::shared_ptr<arrow::Array> window_start_col_;
+  // END: Variables specific to time windowed Agg.
+
   // Creates a mapping between plan cols and stored cols (see above comment).
   Status CreateColumnMapping();
 
   Status ExtractRowTupleForBatch(const table_store::schema::RowBatch& rb);
   Status HashRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status AggregateWithGroupKeyTable(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status MergeUDAs(const std::vector<UDAInfo>& udas, const std::vector<UDAInfo>& other_udas);
   Status EvaluatePartialAggregates(ExecState* exec_state, size_t num_records);
   Status ResetGroupArgs();
   Status ConvertAggHashMapToRowBatch(ExecState* exec_state,
@@ -201,6 +201,79 @@ agg_op {
   value_names: "value1"
 })";
 
+constexpr char kTumblingTimeWindowAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  groups {
+     node: 0
+     index: 1
+  }
+  group_names: "time_"
+  group_names: "g1"
+  value_names: "value1"
+  time_window {
+    group_index: 0
+    size_ns: 10
+    slide_ns: 10
+  }
+})";
+
+constexpr char kSlidingTimeWindowAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  groups {
+     node: 0
+     index: 1
+  }
+  group_names: "time_"
+  group_names: "g1"
+  value_names: "value1"
+  time_window {
+    group_index: 0
+    size_ns: 10
+    slide_ns: 5
+    allowed_lateness_ns: 5
+  }
+})";
+
 constexpr char kSingleGroupNoValues[] = R"(
 op_type: AGGREGATE_OPERATOR
 agg_op {
@@ -610,6 +683,137 @@ TEST_F(AggNodeTest, single_group_blocking_init_args) {
       .Close();
 }
 
+TEST_F(AggNodeTest, tumbling_time_window) {
+  auto plan_node = PlanNodeFromPbtxt(kTumblingTimeWindowAgg);
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                          types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                           types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // The watermark moves to 12, which closes the window [0, 10).
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({1, 5, 12, 3})
+                       .AddColumn<types::Int64Value>({1, 1, 1, 2})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ false)
+                          .AddColumn<types::Time64NSValue>({0, 0})
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::Int64Value>({3, 4})
+                          .get(),
+                      false)
+      // The row at time 8 is dropped because its window has already been emitted.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({8, 15, 25})
+                       .AddColumn<types::Int64Value>({1, 1, 1})
+                       .AddColumn<types::Int64Value>({10, 5, 7})
+                       .get(),
+                   0, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ false)
+                          .AddColumn<types::Time64NSValue>({10})
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({8})
+                          .get(),
+                      false)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
+                          .AddColumn<types::Time64NSValue>({20})
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({7})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, sliding_time_window) {
+  auto plan_node = PlanNodeFromPbtxt(kSlidingTimeWindowAgg);
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::STRING,
+                          types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::STRING,
+                           types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // Each row falls into two windows. The watermark trails the max time by 5, so it moves to 6 and
+  // only closes the window [-5, 5).
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({2, 7, 11})
+                       .AddColumn<types::StringValue>({"a", "a", "b"})
+                       .AddColumn<types::Int64Value>({1, 2, 4})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ false)
+                          .AddColumn<types::Time64NSValue>({-5})
+                          .AddColumn<types::StringValue>({"a"})
+                          .AddColumn<types::Int64Value>({1})
+                          .get(),
+                      false)
+      // The row at time 4 still makes it into the window [0, 10), but not into [-5, 5).
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({4})
+                       .AddColumn<types::StringValue>({"a"})
+                       .AddColumn<types::Int64Value>({8})
+                       .get(),
+                   0, 3)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ false)
+                          .AddColumn<types::Time64NSValue>({0})
+                          .AddColumn<types::StringValue>({"a"})
+                          .AddColumn<types::Int64Value>({11})
+                          .get(),
+                      false)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ false)
+                          .AddColumn<types::Time64NSValue>({5, 5})
+                          .AddColumn<types::StringValue>({"a", "b"})
+                          .AddColumn<types::Int64Value>({2, 4})
+                          .get(),
+                      false)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
+                          .AddColumn<types::Time64NSValue>({10})
+                          .AddColumn<types::StringValue>({"b"})
+                          .AddColumn<types::Int64Value>({4})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, time_window_group_index_out_of_range) {
+  planpb::Operator op_pb;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kTumblingTimeWindowAgg, &op_pb));
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                          types::DataType::INT64});
+
+  // The plan operator rejects these windows too, but the node must not index past its groups
+  // when it's handed one anyway.
+  op_pb.mutable_agg_op()->mutable_time_window()->set_group_index(2);
+  plan::AggregateOperator plan_node(1);
+  EXPECT_NOT_OK(plan_node.Init(op_pb.agg_op()));
+  AggNode node;
+  auto s = node.Init(plan_node,
+                     RowDescriptor({types::DataType::TIME64NS, types::DataType::INT64,
+                                    types::DataType::INT64}),
+                     {input_rd});
+  EXPECT_NOT_OK(s);
+  EXPECT_EQ(s.msg(), "Time window group index 2 is out of range for 2 groups");
+
+  // A time window with no groups doesn't fall back to a global aggregate.
+  op_pb.mutable_agg_op()->mutable_time_window()->set_group_index(0);
+  op_pb.mutable_agg_op()->clear_groups();
+  op_pb.mutable_agg_op()->clear_group_names();
+  plan::AggregateOperator no_groups_plan_node(1);
+  EXPECT_NOT_OK(no_groups_plan_node.Init(op_pb.agg_op()));
+  AggNode no_groups_node;
+  s = no_groups_node.Init(no_groups_plan_node, RowDescriptor({types::DataType::INT64}),
+                          {input_rd});
+  EXPECT_NOT_OK(s);
+  EXPECT_EQ(s.msg(), "Time window group index 0 is out of range for 0 groups");
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -21,6 +21,7 @@
 #include <arrow/array.h>
 #include <arrow/memory_pool.h>
 #include <arrow/status.h>
+#include <string.h>
 #include <algorithm>
 #include <cstdint>
 #include <string>
@@ -42,6 +43,99 @@ namespace exec {
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
+namespace {
+
+// The build side is split into enough partitions that each one holds roughly this many rows, which
+// keeps a partition's slots (2 per row) within the L2 cache.
+constexpr int64_t kJoinPartitionRows = 8 * 1024;
+constexpr int64_t kMaxJoinPartitionBits = 10;
+// How many probe rows ahead to prefetch hash table slots for.
+constexpr int64_t kProbePrefetchDistance = 16;
+
+template <types::DataType DT>
+bool KeyValuesEqual(const arrow::Array* a, int64_t a_idx, const arrow::Array* b, int64_t b_idx) {
+  if constexpr (DT == types::STRING) {
+    int32_t a_len;
+    int32_t b_len;
+    const uint8_t* a_data = static_cast<const arrow::StringArray*>(a)->GetValue(a_idx, &a_len);
+    const uint8_t* b_data = static_cast<const arrow::StringArray*>(b)->GetValue(b_idx, &b_len);
+    return a_len == b_len && memcmp(a_data, b_data, a_len) == 0;
+  } else if constexpr (DT == types::FLOAT64) {
+    // Compare the bit patterns, to be consistent with the hash.
+    auto a_val = types::GetValueFromArrowArray<DT>(a, a_idx);
+    auto b_val = types::GetValueFromArrowArray<DT>(b, b_idx);
+    return memcmp(&a_val, &b_val, sizeof(a_val)) == 0;
+  } else {
+    return types::GetValueFromArrowArray<DT>(a, a_idx) ==
+           types::GetValueFromArrowArray<DT>(b, b_idx);
+  }
+}
+
+// Appends the given rows of the input column to the builder. A row index of -1 appends the
+// default value for the type (used for the missing side of an outer join).
+template <types::DataType DT>
+Status GatherProbeColumn(arrow::ArrayBuilder* output_builder, const arrow::Array* input_col,
+                         const int64_t* rows, int64_t num_rows) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  auto* builder =
+      static_cast<typename types::DataTypeTraits<DT>::arrow_builder_type*>(output_builder);
+  PL_RETURN_IF_ERROR(builder->Reserve(num_rows));
+  if constexpr (DT == types::STRING) {
+    int64_t total_size = 0;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      if (rows[i] >= 0) {
+        total_size += static_cast<const arrow::StringArray*>(input_col)->value_length(rows[i]);
+      }
+    }
+    PL_RETURN_IF_ERROR(builder->ReserveData(total_size));
+  }
+  ValueType zeroval;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    if (rows[i] < 0) {
+      builder->UnsafeAppend(udf::UnWrap(zeroval));
+    } else {
+      builder->UnsafeAppend(types::GetValueFromArrowArray<DT>(input_col, rows[i]));
+    }
+  }
+  return Status::OK();
+}
+
+// Same as GatherProbeColumn, but for rows spread over the buffered build batches.
+template <types::DataType DT, typename TRowRef>
+Status GatherBuildColumn(arrow::ArrayBuilder* output_builder,
+                         const std::vector<std::shared_ptr<arrow::Array>>& input_cols,
+                         const std::vector<TRowRef>& row_refs, const int64_t* rows,
+                         int64_t num_rows) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  auto* builder =
+      static_cast<typename types::DataTypeTraits<DT>::arrow_builder_type*>(output_builder);
+  PL_RETURN_IF_ERROR(builder->Reserve(num_rows));
+  if constexpr (DT == types::STRING) {
+    int64_t total_size = 0;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      if (rows[i] >= 0) {
+        const auto& ref = row_refs[rows[i]];
+        total_size += static_cast<const arrow::StringArray*>(input_cols[ref.batch_idx].get())
+                          ->value_length(ref.row_idx);
+      }
+    }
+    PL_RETURN_IF_ERROR(builder->ReserveData(total_size));
+  }
+  ValueType zeroval;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    if (rows[i] < 0) {
+      builder->UnsafeAppend(udf::UnWrap(zeroval));
+    } else {
+      const auto& ref = row_refs[rows[i]];
+      builder->UnsafeAppend(
+          types::GetValueFromArrowArray<DT>(input_cols[ref.batch_idx].get(), ref.row_idx));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 std::string EquijoinNode::DebugStringImpl() {
   return absl::Substitute("Exec::JoinNode<$0>", absl::StrJoin(plan_node_->column_names(), ","));
 }
@@ -92,7 +186,11 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
     int64_t right_index = eq_condition.right_column_index();
 
     CHECK_EQ(input_descriptors_[0].type(left_index), input_descriptors_[1].type(right_index));
-    key_data_types_.emplace_back(input_descriptors_[0].type(left_index));
+    auto key_type = input_descriptors_[0].type(left_index);
+    key_data_types_.emplace_back(key_type);
+#define TYPE_CASE(_dt_) key_equal_fns_.push_back(&KeyValuesEqual<_dt_>);
+    PL_SWITCH_FOREACH_DATATYPE(key_type, TYPE_CASE);
+#undef TYPE_CASE
 
     build_spec_.key_indices.emplace_back(
         probe_table_ == EquijoinNode::JoinInputTable::kLeftTable ? right_index : left_index);
@@ -134,130 +232,144 @@ Status EquijoinNode::PrepareImpl(ExecState* /*exec_state*/) {
 Status EquijoinNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
 
 Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
-  join_keys_chunk_.clear();
-  build_buffer_.clear();
-  probed_keys_.clear();
-  key_values_pool_.Clear();
+  build_key_cols_.clear();
+  build_output_cols_.clear();
+  num_build_batches_ = 0;
+  build_rows_.clear();
+  build_hashes_.clear();
+  build_next_row_.clear();
+  build_chain_tail_.clear();
+  build_chain_heads_.clear();
+  build_chain_matched_.clear();
+  partition_offsets_.clear();
+  slots_.clear();
   return Status::OK();
 }
 
-template <types::DataType DT>
-void ExtractIntoRowTuples(std::vector<RowTuple*>* row_tuples, arrow::Array* input_col,
-                          int rt_col_idx) {
-  auto num_rows = input_col->length();
-  for (auto row_idx = 0; row_idx < num_rows; ++row_idx) {
-    ExtractIntoRowTuple<DT>((*row_tuples)[row_idx], input_col, rt_col_idx, row_idx);
-  }
-}
-
-Status EquijoinNode::ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb,
-                                             bool is_probe) {
-  // Reset the row tuples
-  for (auto& rt : join_keys_chunk_) {
-    if (rt == nullptr) {
-      rt = key_values_pool_.Add(new RowTuple(&key_data_types_));
-    } else {
-      rt->Reset();
+bool EquijoinNode::KeysEqual(int64_t build_row,
+                             const std::vector<const arrow::Array*>& probe_key_cols,
+                             int64_t probe_row) const {
+  const auto& ref = build_rows_[build_row];
+  for (size_t key_idx = 0; key_idx < key_equal_fns_.size(); ++key_idx) {
+    if (!key_equal_fns_[key_idx](build_key_cols_[key_idx][ref.batch_idx].get(), ref.row_idx,
+                                 probe_key_cols[key_idx], probe_row)) {
+      return false;
     }
   }
-
-  // Grow the join_keys_chunk_ to be the size of the RowBatch.
-  size_t num_rows = rb.num_rows();
-  if (join_keys_chunk_.size() < num_rows) {
-    int prev_size = join_keys_chunk_.size();
-    join_keys_chunk_.reserve(num_rows);
-    for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      auto tuple_ptr = key_values_pool_.Add(new RowTuple(&key_data_types_));
-      join_keys_chunk_.emplace_back(tuple_ptr);
-    }
-  }
-
-  const TableSpec& spec = is_probe ? probe_spec_ : build_spec_;
-
-  // Scan through all the group args in column order and extract the entire column.
-  for (size_t tuple_col_idx = 0; tuple_col_idx < spec.key_indices.size(); ++tuple_col_idx) {
-    auto input_col_idx = spec.key_indices[tuple_col_idx];
-    auto dt = key_data_types_[tuple_col_idx];
-    auto col = rb.ColumnAt(input_col_idx).get();
-
-#define TYPE_CASE(_dt_) ExtractIntoRowTuples<_dt_>(&join_keys_chunk_, col, tuple_col_idx);
-    PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
-  }
-
-  return Status::OK();
+  return true;
 }
 
-std::vector<types::SharedColumnWrapper>* CreateWrapper(ObjectPool* pool,
-                                                       const std::vector<types::DataType>& types) {
-  auto ptr = pool->Add(new std::vector<types::SharedColumnWrapper>(types.size()));
-  for (size_t col_idx = 0; col_idx < types.size(); ++col_idx) {
-    (*ptr)[col_idx] = types::ColumnWrapper::Make(types[col_idx], 0);
+Status EquijoinNode::BufferBuildBatch(const RowBatch& rb) {
+  if (rb.num_rows() == 0) {
+    return Status::OK();
   }
-  return ptr;
-}
-
-Status EquijoinNode::HashRowBatch(const table_store::schema::RowBatch& rb) {
-  if (rb.num_rows() > static_cast<int64_t>(build_wrappers_chunk_.size())) {
-    build_wrappers_chunk_.resize(rb.num_rows());
+  int32_t batch_idx = num_build_batches_++;
+  build_key_cols_.resize(build_spec_.key_indices.size());
+  for (size_t i = 0; i < build_spec_.key_indices.size(); ++i) {
+    build_key_cols_[i].push_back(rb.ColumnAt(build_spec_.key_indices[i]));
   }
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    if (build_wrappers_chunk_[row_idx] == nullptr) {
-      build_wrappers_chunk_[row_idx] =
-          CreateWrapper(&column_values_pool_, build_spec_.input_col_types);
-    }
+  build_output_cols_.resize(build_spec_.input_col_indices.size());
+  for (size_t i = 0; i < build_spec_.input_col_indices.size(); ++i) {
+    build_output_cols_[i].push_back(rb.ColumnAt(build_spec_.input_col_indices[i]));
   }
 
-  // Make sure the map has constructed the necessary column wrappers for all of the tuples.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& rt = join_keys_chunk_[row_idx];
-    auto& current = build_buffer_[rt];
-    auto wrappers_ptr = current != nullptr ? current : build_wrappers_chunk_[row_idx];
-
-    // Now extract the values into the corresponding column wrappers.
-    for (size_t i = 0; i < build_spec_.input_col_indices.size(); ++i) {
-      const auto& rb_col_idx = build_spec_.input_col_indices[i];
-      auto arr = rb.ColumnAt(rb_col_idx).get();
-      const auto& dt = build_spec_.input_col_types[i];
-
-#define TYPE_CASE(_dt_) \
-  types::ExtractValueToColumnWrapper<_dt_>(wrappers_ptr->at(i).get(), arr, row_idx);
-      PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
-    }
-    // Keep track of the number of rows that the build buffer matches for each key.
-    build_buffer_rows_[rt]++;
-
-    if (current == nullptr) {
-      std::swap(build_wrappers_chunk_[row_idx], current);
-      // Reset the new tuples that we added
-      join_keys_chunk_[row_idx] = nullptr;
-    }
+  std::vector<uint64_t> hashes;
+  HashJoinKeys(rb, build_spec_.key_indices, key_data_types_, &hashes);
+  build_hashes_.insert(build_hashes_.end(), hashes.begin(), hashes.end());
+  for (int32_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    build_rows_.push_back({batch_idx, row_idx});
   }
-
   return Status::OK();
 }
 
-template <types::DataType DT>
-Status AppendValuesFromWrapper(arrow::ArrayBuilder* output_builder,
-                               types::SharedColumnWrapper input_wrapper, size_t start_idx,
-                               size_t num_rows) {
-  using ValueType = typename types::DataTypeTraits<DT>::value_type;
-  for (size_t row_idx = start_idx; row_idx < start_idx + num_rows; ++row_idx) {
-    PL_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(
-        output_builder, udf::UnWrap(input_wrapper->Get<ValueType>(row_idx))));
+void EquijoinNode::BuildPartitionedHashTable() {
+  int64_t num_rows = build_rows_.size();
+  partition_bits_ = 0;
+  while (partition_bits_ < kMaxJoinPartitionBits &&
+         (num_rows >> partition_bits_) > kJoinPartitionRows) {
+    ++partition_bits_;
+  }
+  int64_t num_partitions = 1LL << partition_bits_;
+  auto partition_of = [&](uint64_t hash) -> int64_t {
+    return partition_bits_ == 0 ? 0 : static_cast<int64_t>(hash >> (64 - partition_bits_));
+  };
+
+  // Radix partition the build rows, keeping their input order within each partition.
+  std::vector<int64_t> partition_counts(num_partitions, 0);
+  for (int64_t row = 0; row < num_rows; ++row) {
+    ++partition_counts[partition_of(build_hashes_[row])];
+  }
+  std::vector<int64_t> partition_row_offsets(num_partitions + 1, 0);
+  partition_offsets_.assign(num_partitions + 1, 0);
+  for (int64_t p = 0; p < num_partitions; ++p) {
+    partition_row_offsets[p + 1] = partition_row_offsets[p] + partition_counts[p];
+    // Keep the load factor at or below 1/2, with a power of two slot count per partition.
+    int64_t num_slots = 8;
+    while (num_slots < 2 * partition_counts[p]) {
+      num_slots *= 2;
+    }
+    partition_offsets_[p + 1] = partition_offsets_[p] + num_slots;
+  }
+  std::vector<int64_t> partitioned_rows(num_rows);
+  std::vector<int64_t> next_pos(partition_row_offsets.begin(), partition_row_offsets.end() - 1);
+  for (int64_t row = 0; row < num_rows; ++row) {
+    partitioned_rows[next_pos[partition_of(build_hashes_[row])]++] = row;
+  }
+
+  slots_.assign(partition_offsets_[num_partitions], -1);
+  build_next_row_.assign(num_rows, -1);
+  build_chain_tail_.assign(num_rows, -1);
+  build_chain_heads_.clear();
+  std::vector<const arrow::Array*> row_key_cols(build_key_cols_.size());
+  // Build one partition at a time, so the slots being written stay in cache.
+  for (int64_t p = 0; p < num_partitions; ++p) {
+    int64_t base = partition_offsets_[p];
+    uint64_t mask = partition_offsets_[p + 1] - base - 1;
+    for (int64_t i = partition_row_offsets[p]; i < partition_row_offsets[p + 1]; ++i) {
+      int64_t row = partitioned_rows[i];
+      uint64_t hash = build_hashes_[row];
+      const auto& ref = build_rows_[row];
+      for (size_t k = 0; k < build_key_cols_.size(); ++k) {
+        row_key_cols[k] = build_key_cols_[k][ref.batch_idx].get();
+      }
+      uint64_t pos = hash & mask;
+      while (true) {
+        int64_t head = slots_[base + pos];
+        if (head == -1) {
+          slots_[base + pos] = row;
+          build_chain_tail_[row] = row;
+          build_chain_heads_.push_back(row);
+          break;
+        }
+        if (build_hashes_[head] == hash && KeysEqual(head, row_key_cols, ref.row_idx)) {
+          build_next_row_[build_chain_tail_[head]] = row;
+          build_chain_tail_[head] = row;
+          break;
+        }
+        pos = (pos + 1) & mask;
+      }
+    }
   }
-  return Status::OK();
+  build_chain_matched_.assign(num_rows, false);
 }
 
-template <types::DataType DT>
-Status AppendColumnDefaultValue(arrow::ArrayBuilder* output_builder, size_t num_times) {
-  using ValueType = typename types::DataTypeTraits<DT>::value_type;
-  ValueType zeroval;
-  for (size_t i = 0; i < num_times; ++i) {
-    PL_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(output_builder, udf::UnWrap(zeroval)));
+int64_t EquijoinNode::FindBuildRow(uint64_t hash,
+                                   const std::vector<const arrow::Array*>& probe_key_cols,
+                                   int64_t probe_row) const {
+  int64_t p = partition_bits_ == 0 ? 0 : static_cast<int64_t>(hash >> (64 - partition_bits_));
+  int64_t base = partition_offsets_[p];
+  uint64_t mask = partition_offsets_[p + 1] - base - 1;
+  uint64_t pos = hash & mask;
+  while (true) {
+    int64_t head = slots_[base + pos];
+    if (head == -1) {
+      return -1;
+    }
+    if (build_hashes_[head] == hash && KeysEqual(head, probe_key_cols, probe_row)) {
+      return head;
+    }
+    pos = (pos + 1) & mask;
   }
-  return Status::OK();
 }
 
 // Create a new output row batch from the column builders, and flush the pending row batch.
@@ -275,74 +387,49 @@ Status EquijoinNode::NextOutputBatch(ExecState* exec_state) {
   return InitializeColumnBuilders();
 }
 
-Status EquijoinNode::FlushChunkedRows(ExecState* exec_state) {
+Status EquijoinNode::GatherOutputRows(const RowBatch* probe_rb, const int64_t* probe_rows,
+                                      const int64_t* build_rows, int64_t num_rows) {
   for (size_t col = 0; col < build_spec_.output_col_indices.size(); ++col) {
-    for (const auto& chunk : chunks_) {
-      auto output_idx = build_spec_.output_col_indices[col];
-      auto builder = column_builders_.at(output_idx).get();
-
-      if (chunk.wrappers_ptr == nullptr) {
-#define TYPE_CASE(_dt_) PL_RETURN_IF_ERROR(AppendColumnDefaultValue<_dt_>(builder, chunk.num_rows))
-        PL_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
+    auto output_idx = build_spec_.output_col_indices[col];
+    auto builder = column_builders_[output_idx].get();
+#define TYPE_CASE(_dt_)                                                                   \
+  PL_RETURN_IF_ERROR(GatherBuildColumn<_dt_>(builder, build_output_cols_[col], build_rows_, \
+                                             build_rows, num_rows))
+    PL_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
 #undef TYPE_CASE
-      } else {
-#define TYPE_CASE(_dt_)                                                                  \
-  PL_RETURN_IF_ERROR(AppendValuesFromWrapper<_dt_>(builder, chunk.wrappers_ptr->at(col), \
-                                                   chunk.bb_row_idx, chunk.num_rows))
-        PL_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
-#undef TYPE_CASE
-      }
-    }
   }
 
   for (size_t col = 0; col < probe_spec_.output_col_indices.size(); ++col) {
-    for (const auto& chunk : chunks_) {
-      auto output_idx = probe_spec_.output_col_indices[col];
-      auto builder = column_builders_.at(output_idx).get();
-
-      if (chunk.rb == nullptr) {
-#define TYPE_CASE(_dt_) PL_RETURN_IF_ERROR(AppendColumnDefaultValue<_dt_>(builder, chunk.num_rows))
-        PL_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
-#undef TYPE_CASE
-      } else {
-        auto src_idx = probe_spec_.input_col_indices[col];
-        auto builder = column_builders_[output_idx].get();
-        auto input_col = chunk.rb->ColumnAt(src_idx).get();
-
-#define TYPE_CASE(_dt_)                                                             \
-  PL_RETURN_IF_ERROR(table_store::schema::CopyValueRepeated<_dt_>(                  \
-      builder, types::GetValueFromArrowArray<_dt_>(input_col, chunk.probe_row_idx), \
-      chunk.num_rows))
-        PL_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
-#undef TYPE_CASE
-      }
+    auto output_idx = probe_spec_.output_col_indices[col];
+    auto builder = column_builders_[output_idx].get();
+    const arrow::Array* input_col = nullptr;
+    if (probe_rb != nullptr) {
+      input_col = probe_rb->ColumnAt(probe_spec_.input_col_indices[col]).get();
     }
+#define TYPE_CASE(_dt_) \
+  PL_RETURN_IF_ERROR(GatherProbeColumn<_dt_>(builder, input_col, probe_rows, num_rows))
+    PL_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
+#undef TYPE_CASE
   }
-  std::vector<EquijoinNode::OutputChunk> new_chunks(0);
-  std::swap(chunks_, new_chunks);
-  queued_rows_ = 0;
-  return NextOutputBatch(exec_state);
+  return Status::OK();
 }
 
-Status EquijoinNode::MatchBuildValuesAndFlush(ExecState* exec_state,
-                                              std::vector<types::SharedColumnWrapper>* wrapper,
-                                              std::shared_ptr<RowBatch> probe_rb,
-                                              int64_t probe_rb_row, int64_t matching_bb_rows) {
-  int64_t bb_rows_left = matching_bb_rows;
-
-  while (bb_rows_left > 0) {
-    auto available = output_rows_per_batch_ - (column_builders_[0]->length() + queued_rows_);
-    auto chunk_rows = std::min(bb_rows_left, available);
-    OutputChunk c{probe_rb, wrapper, chunk_rows, matching_bb_rows - bb_rows_left, probe_rb_row};
-    chunks_.emplace_back(c);
-    queued_rows_ += chunk_rows;
-    bb_rows_left -= chunk_rows;
-
-    if (queued_rows_ == output_rows_per_batch_) {
-      PL_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
+Status EquijoinNode::EmitJoinedRows(ExecState* exec_state, const RowBatch* probe_rb,
+                                    const std::vector<int64_t>& probe_rows,
+                                    const std::vector<int64_t>& build_rows) {
+  DCHECK_EQ(probe_rows.size(), build_rows.size());
+  int64_t total_rows = probe_rows.size();
+  int64_t emitted_rows = 0;
+  while (emitted_rows < total_rows) {
+    int64_t available = output_rows_per_batch_ - column_builders_[0]->length();
+    int64_t num_rows = std::min(available, total_rows - emitted_rows);
+    PL_RETURN_IF_ERROR(GatherOutputRows(probe_rb, probe_rows.data() + emitted_rows,
+                                        build_rows.data() + emitted_rows, num_rows));
+    emitted_rows += num_rows;
+    if (column_builders_[0]->length() == output_rows_per_batch_) {
+      PL_RETURN_IF_ERROR(NextOutputBatch(exec_state));
     }
   }
-
   return Status::OK();
 }
 
@@ -351,61 +438,83 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
     probe_eos_ = true;
   }
 
-  PL_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, true));
-
-  if (rb.num_rows() > static_cast<int64_t>(probe_wrappers_chunk_.size())) {
-    probe_wrappers_chunk_.resize(rb.num_rows());
+  int64_t num_rows = rb.num_rows();
+  HashJoinKeys(rb, probe_spec_.key_indices, key_data_types_, &probe_hashes_);
+  std::vector<const arrow::Array*> probe_key_cols;
+  for (auto key_idx : probe_spec_.key_indices) {
+    probe_key_cols.push_back(rb.ColumnAt(key_idx).get());
   }
 
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto it = build_buffer_.find(join_keys_chunk_[row_idx]);
-    if (it != build_buffer_.end()) {
-      probe_wrappers_chunk_[row_idx] = it->second;
-      probed_keys_.insert(it->first);
-    } else {
-      probe_wrappers_chunk_[row_idx] = nullptr;
-    }
+  // Compute the first slot of every row up front, so they can be prefetched ahead of the lookups.
+  std::vector<int64_t> first_slots(num_rows);
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    uint64_t hash = probe_hashes_[row_idx];
+    int64_t p = partition_bits_ == 0 ? 0 : static_cast<int64_t>(hash >> (64 - partition_bits_));
+    int64_t base = partition_offsets_[p];
+    first_slots[row_idx] = base + (hash & (partition_offsets_[p + 1] - base - 1));
   }
 
-  auto rb_ptr = std::make_shared<RowBatch>(rb);
-
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    if (queued_rows_ >= output_rows_per_batch_ - column_builders_[0]->length()) {
-      PL_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
+  probe_out_rows_.clear();
+  build_out_rows_.clear();
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    if (row_idx + kProbePrefetchDistance < num_rows) {
+      __builtin_prefetch(&slots_[first_slots[row_idx + kProbePrefetchDistance]]);
     }
-
-    if (probe_wrappers_chunk_[row_idx] == nullptr) {
+    int64_t head = FindBuildRow(probe_hashes_[row_idx], probe_key_cols, row_idx);
+    if (head == -1) {
       if (probe_spec_.emit_unmatched_rows) {
-        OutputChunk c{rb_ptr, nullptr, 1, 0, row_idx};
-        chunks_.emplace_back(c);
-        queued_rows_ += 1;
+        probe_out_rows_.push_back(row_idx);
+        build_out_rows_.push_back(-1);
       }
       continue;
     }
-
-    PL_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, probe_wrappers_chunk_[row_idx], rb_ptr,
-                                                row_idx,
-                                                build_buffer_rows_[join_keys_chunk_[row_idx]]));
+    build_chain_matched_[head] = true;
+    for (int64_t build_row = head; build_row != -1; build_row = build_next_row_[build_row]) {
+      probe_out_rows_.push_back(row_idx);
+      build_out_rows_.push_back(build_row);
+    }
   }
 
-  if (probe_eos_ && queued_rows_ > 0) {
-    PL_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
+  PL_RETURN_IF_ERROR(EmitJoinedRows(exec_state, &rb, probe_out_rows_, build_out_rows_));
+
+  if (probe_eos_ && column_builders_[0]->length() > 0) {
+    PL_RETURN_IF_ERROR(NextOutputBatch(exec_state));
   }
 
   return Status::OK();
 }
 
 Status EquijoinNode::EmitUnmatchedBuildRows(ExecState* exec_state) {
-  for (auto it = build_buffer_.begin(); it != build_buffer_.end(); ++it) {
-    if (probed_keys_.find(it->first) != probed_keys_.end()) {
+  probe_out_rows_.clear();
+  build_out_rows_.clear();
+  for (int64_t head : build_chain_heads_) {
+    if (build_chain_matched_[head]) {
       continue;
     }
-    PL_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, it->second, nullptr, 0,
-                                                build_buffer_rows_[it->first]));
+    for (int64_t build_row = head; build_row != -1; build_row = build_next_row_[build_row]) {
+      probe_out_rows_.push_back(-1);
+      build_out_rows_.push_back(build_row);
+    }
+  }
+  PL_RETURN_IF_ERROR(EmitJoinedRows(exec_state, nullptr, probe_out_rows_, build_out_rows_));
+
+  if (column_builders_[0]->length() > 0) {
+    PL_RETURN_IF_ERROR(NextOutputBatch(exec_state));
   }
+  return Status::OK();
+}
 
-  if (queued_rows_ > 0) {
-    PL_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
+Status EquijoinNode::PublishRuntimeFilter(ExecState* exec_state) {
+  if (runtime_filter_sources_.empty()) {
+    return Status::OK();
+  }
+  PL_ASSIGN_OR_RETURN(std::shared_ptr<RuntimeJoinFilter> filter,
+                      RuntimeJoinFilter::Create(key_data_types_, build_hashes_.size()));
+  for (uint64_t hash : build_hashes_) {
+    filter->Insert(hash);
+  }
+  for (const auto& [source_id, key_indices] : runtime_filter_sources_) {
+    exec_state->AddRuntimeJoinFilter(source_id, {key_indices, filter});
   }
   return Status::OK();
 }
@@ -416,10 +525,11 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
     build_eos_ = true;
   }
 
-  PL_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
-  PL_RETURN_IF_ERROR(HashRowBatch(rb));
+  PL_RETURN_IF_ERROR(BufferBuildBatch(rb));
 
   if (build_eos_) {
+    BuildPartitionedHashTable();
+    PL_RETURN_IF_ERROR(PublishRuntimeFilter(exec_state));
     while (probe_batches_.size()) {
       PL_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
       probe_batches_.pop();
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <arrow/array.h>
 #include <arrow/array/builder_base.h>
 #include <cstddef>
 #include <memory>
@@ -26,15 +27,12 @@
 #include <utility>
 #include <vector>
 
-#include <absl/container/flat_hash_map.h>
-
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
-#include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/runtime_join_filter.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
-#include "src/common/memory/memory.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/table_store.h"
@@ -64,6 +62,26 @@ class EquijoinNode : public ProcessingNode {
   EquijoinNode() = default;
   virtual ~EquijoinNode() = default;
 
+  /**
+   * Whether the join drops probe rows that have no match on the build side, in which case a filter
+   * of the build keys can be applied to the probe input before it reaches the join.
+   */
+  bool SupportsRuntimeFilter() const { return !probe_spec_.emit_unmatched_rows; }
+  size_t probe_parent_index() const {
+    return probe_table_ == JoinInputTable::kLeftTable ? 0 : 1;
+  }
+  const std::vector<int64_t>& probe_key_indices() const { return probe_spec_.key_indices; }
+
+  /**
+   * Registers a source that feeds the probe side of this join. Once the build side is complete, a
+   * RuntimeJoinFilter of the build keys is published for the source.
+   * @param source_id The id of the source.
+   * @param key_indices The columns of the source's output that hold the probe keys.
+   */
+  void AddRuntimeFilterSource(int64_t source_id, std::vector<int64_t> key_indices) {
+    runtime_filter_sources_.push_back({source_id, std::move(key_indices)});
+  }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -74,17 +92,29 @@ class EquijoinNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
+  // A reference to a row of one of the buffered build batches.
+  struct BuildRowRef {
+    int32_t batch_idx;
+    int32_t row_idx;
+  };
+  using KeyEqualFn = bool (*)(const arrow::Array*, int64_t, const arrow::Array*, int64_t);
+
   Status InitializeColumnBuilders();
   bool IsProbeTable(size_t parent_index);
-  Status FlushChunkedRows(ExecState* exec_state);
-  Status ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb, bool is_probe);
-  Status HashRowBatch(const table_store::schema::RowBatch& rb);
+  bool KeysEqual(int64_t build_row, const std::vector<const arrow::Array*>& probe_key_cols,
+                 int64_t probe_row) const;
+  Status BufferBuildBatch(const table_store::schema::RowBatch& rb);
+  void BuildPartitionedHashTable();
+  Status PublishRuntimeFilter(ExecState* exec_state);
+  int64_t FindBuildRow(uint64_t hash, const std::vector<const arrow::Array*>& probe_key_cols,
+                       int64_t probe_row) const;
 
   Status DoProbe(ExecState* exec_state, const table_store::schema::RowBatch& rb);
-  Status MatchBuildValuesAndFlush(ExecState* exec_state,
-                                  std::vector<types::SharedColumnWrapper>* wrapper,
-                                  std::shared_ptr<table_store::schema::RowBatch> probe_rb,
-                                  int64_t probe_rb_row_idx, int64_t matching_bb_rows);
+  Status EmitJoinedRows(ExecState* exec_state, const table_store::schema::RowBatch* probe_rb,
+                        const std::vector<int64_t>& probe_rows,
+                        const std::vector<int64_t>& build_rows);
+  Status GatherOutputRows(const table_store::schema::RowBatch* probe_rb, const int64_t* probe_rows,
+                          const int64_t* build_rows, int64_t num_rows);
   Status EmitUnmatchedBuildRows(ExecState* exec_state);
   Status NextOutputBatch(ExecState* exec_state);
   Status ConsumeBuildBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
@@ -103,6 +133,7 @@ class EquijoinNode : public ProcessingNode {
   TableSpec probe_spec_;
 
   std::vector<types::DataType> key_data_types_;
+  std::vector<KeyEqualFn> key_equal_fns_;
 
   // Example of the above specs:
   // For input table A (build) which has [key_A_1, output_col_0, key_A_0/output_col_2]
@@ -111,45 +142,42 @@ class EquijoinNode : public ProcessingNode {
   // probe_spec_: {key_indices: [0, 2], input_col_indices: [1, 2], output_col_indices: [3, 1]}
   // produces table [output_col_0, output_col_1(key_B_1), output_col_2(key_A_0), output_col_3]
 
-  // This struct represents a chunk of output rows that are queued to be written
-  // to the column builders.
-  struct OutputChunk {
-    std::shared_ptr<table_store::schema::RowBatch> rb;
-    std::vector<types::SharedColumnWrapper>* wrappers_ptr;
-    int64_t num_rows;
-    int64_t bb_row_idx;
-    int64_t probe_row_idx;
-  };
-
-  int64_t queued_rows_ = 0;
-  std::vector<OutputChunk> chunks_;
-
   // Memory/column building members
   // If the build stage isn't complete, we need to buffer the probe batches.
   std::queue<table_store::schema::RowBatch> probe_batches_;
   // Column builders will flush a batch once they hit output_rows_per_batch_ rows.
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
-  // Manages the RowTuples containing the keys for the join.
-  ObjectPool key_values_pool_{"equijoin_kv_pool"};
-  ObjectPool column_values_pool_{"equijoin_col_vals_pool"};
-
-  // Chunk of data to use when extracting join keys.
-  std::vector<RowTuple*> join_keys_chunk_;
-  // Chunk of data to use when performing the build stage of the join.
-  std::vector<std::vector<types::SharedColumnWrapper>*> build_wrappers_chunk_;
-
-  // Chunk of data to use when performing the probe stage of the join.
-  // This will store build table data from `build_buffer_`.
-  std::vector<std::vector<types::SharedColumnWrapper>*> probe_wrappers_chunk_;
-  AbslRowTupleHashMap<std::vector<types::SharedColumnWrapper>*> build_buffer_;
-  // Store the number of rows that match a given set of keys for the build buffer.
-  // This is necessary to store in addition to the values in `build_buffer_` in
-  // the event that no columns from the build side are emitted.
-  AbslRowTupleHashMap<int64_t> build_buffer_rows_;
-
-  // For joins where the build_buffer_ needs to emit any non-probed rows at the end of the join,
-  // keep track of which ones they were.
-  AbslRowTupleHashSet probed_keys_;
+
+  // Build side. The build batches are not copied, we hold on to their key and output columns
+  // (indexed by [column][batch]) and refer to the rows by BuildRowRef.
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> build_key_cols_;
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> build_output_cols_;
+  int32_t num_build_batches_ = 0;
+  std::vector<BuildRowRef> build_rows_;
+  std::vector<uint64_t> build_hashes_;
+  // Build rows with the same key are chained together in input order. Only the first row of each
+  // chain (the head) is stored in the hash table.
+  std::vector<int64_t> build_next_row_;
+  std::vector<int64_t> build_chain_tail_;
+  std::vector<int64_t> build_chain_heads_;
+  // For joins where the build side needs to emit any non-probed rows at the end of the join,
+  // keep track of which chains were matched (indexed by head row).
+  std::vector<bool> build_chain_matched_;
+
+  // The build side hash table is radix partitioned on the top bits of the hash, so that each
+  // partition's slots stay cache resident while it is built. The slots of partition i are
+  // slots_[partition_offsets_[i], partition_offsets_[i+1]) and hold chain heads (or -1).
+  int64_t partition_bits_ = 0;
+  std::vector<int64_t> partition_offsets_;
+  std::vector<int64_t> slots_;
+
+  // The sources to publish a filter of the build keys to, with their probe key columns.
+  std::vector<std::pair<int64_t, std::vector<int64_t>>> runtime_filter_sources_;
+
+  // Scratch space for the probe stage.
+  std::vector<uint64_t> probe_hashes_;
+  std::vector<int64_t> probe_out_rows_;
+  std::vector<int64_t> build_out_rows_;
 
   // Handle on the most recent RowBatch (in case it's the final one).
   std::unique_ptr<table_store::schema::RowBatch> pending_output_batch_;
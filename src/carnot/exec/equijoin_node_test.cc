@@ -685,6 +685,129 @@ TEST_F(JoinNodeTest, unordered_many_matches) {
       .Close();
 }
 
+TEST_F(JoinNodeTest, partitioned_build_side) {
+  // Enough build rows to spread the build side over several hash table partitions.
+  // Left table input: [left_0:Int64, left_1:Int64]
+  // Right table input: [right_0:Int64, right_1:String]
+  // Output table: [left_1:Int64, right_1:String]
+  // Inner join on left_0=right_0
+  const char* proto = R"(
+  type: INNER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 1
+  }
+  column_names: "left_1"
+  column_names: "right_1"
+  rows_per_batch: 1024
+)";
+
+  RowDescriptor input_rd_0({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor input_rd_1({types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::STRING});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+
+  constexpr int64_t kNumBatches = 8;
+  constexpr int64_t kRowsPerBatch = 5000;
+  for (int64_t batch = 0; batch < kNumBatches; ++batch) {
+    std::vector<types::Int64Value> keys;
+    std::vector<types::Int64Value> values;
+    for (int64_t i = 0; i < kRowsPerBatch; ++i) {
+      int64_t key = batch * kRowsPerBatch + i;
+      keys.emplace_back(key);
+      values.emplace_back(2 * key);
+    }
+    bool last = batch == kNumBatches - 1;
+    tester.ConsumeNext(RowBatchBuilder(input_rd_0, kRowsPerBatch, last, last)
+                           .AddColumn<types::Int64Value>(keys)
+                           .AddColumn<types::Int64Value>(values)
+                           .get(),
+                       0, 0);
+  }
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 4, true, true)
+                       .AddColumn<types::Int64Value>({5, 12345, 39999, 50000})
+                       .AddColumn<types::StringValue>({"a", "b", "c", "d"})
+                       .get(),
+                   1, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Int64Value>({10, 24690, 79998})
+                          .AddColumn<types::StringValue>({"a", "b", "c"})
+                          .get(),
+                      true)
+      .Close();
+}
+
+TEST_F(JoinNodeTest, publishes_runtime_filter) {
+  // Left table input: [left_0:Int64, left_1:Int64]
+  // Right table input: [right_0:Int64, right_1:String]
+  // Output table: [left_1:Int64, right_1:String]
+  // Inner join on left_0=right_0
+  const char* proto = R"(
+  type: INNER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 1
+  }
+  column_names: "left_1"
+  column_names: "right_1"
+  rows_per_batch: 1024
+)";
+
+  RowDescriptor input_rd_0({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor input_rd_1({types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::STRING});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+  ASSERT_TRUE(tester.node()->SupportsRuntimeFilter());
+  EXPECT_EQ(1UL, tester.node()->probe_parent_index());
+  // The tester runs everything as source 1, which feeds the probe side here.
+  tester.node()->AddRuntimeFilterSource(1, {0});
+
+  tester.ConsumeNext(RowBatchBuilder(input_rd_0, 3, true, true)
+                         .AddColumn<types::Int64Value>({1, 2, 2})
+                         .AddColumn<types::Int64Value>({10, 20, 21})
+                         .get(),
+                     0, 0);
+  const auto& filters = exec_state_->CurrentSourceJoinFilters();
+  ASSERT_EQ(1UL, filters.size());
+
+  RowBatchBuilder probe_rb(input_rd_1, 3, true, true);
+  probe_rb.AddColumn<types::Int64Value>({2, 7, 1}).AddColumn<types::StringValue>({"a", "b", "c"});
+  filters[0].filter->Apply(filters[0].key_indices, &probe_rb.get());
+  EXPECT_EQ(std::vector<int64_t>({0, 2}), probe_rb.get().selection());
+
+  tester.ConsumeNext(probe_rb.get(), 1, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Int64Value>({20, 21, 10})
+                          .AddColumn<types::StringValue>({"a", "a", "c"})
+                          .get(),
+                      true)
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -19,8 +19,10 @@
 #include "src/carnot/exec/exec_graph.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <set>
+#include <thread>
 #include <unordered_map>
 
 #include "src/carnot/exec/agg_node.h"
@@ -35,6 +37,7 @@
 #include "src/carnot/exec/map_node.h"
 #include "src/carnot/exec/memory_sink_node.h"
 #include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/sort_node.h"
 #include "src/carnot/exec/udtf_source_node.h"
 #include "src/carnot/exec/union_node.h"
 #include "src/carnot/plan/operators.h"
@@ -42,6 +45,11 @@
 #include "src/common/perf/perf.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int32(carnot_morsel_parallelism,
+             gflags::Int32FromEnv("PL_CARNOT_MORSEL_PARALLELISM", 1),
+             "The number of worker threads used to scan a memory source and run its Map/Filter "
+             "pipeline up to a blocking aggregate. Values <= 1 disable parallel execution.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -61,7 +69,7 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
 
   std::unordered_map<int64_t, ExecNode*> nodes;
   std::unordered_map<int64_t, RowDescriptor> descriptors;
-  return plan::PlanFragmentWalker()
+  auto walk_status = plan::PlanFragmentWalker()
       .OnMap([&](auto& node) {
         return OnOperatorImpl<plan::MapOperator, MapNode>(node, &descriptors);
       })
@@ -81,6 +89,9 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
       .OnLimit([&](auto& node) {
         return OnOperatorImpl<plan::LimitOperator, LimitNode>(node, &descriptors);
       })
+      .OnSort([&](auto& node) {
+        return OnOperatorImpl<plan::SortOperator, SortNode>(node, &descriptors);
+      })
       .OnUnion([&](auto& node) {
         return OnOperatorImpl<plan::UnionOperator, UnionNode>(node, &descriptors);
       })
@@ -106,6 +117,84 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         return OnOperatorImpl<plan::EmptySourceOperator, EmptySourceNode>(node, &descriptors);
       })
       .Walk(pf_);
+  PL_RETURN_IF_ERROR(walk_status);
+
+  SetUpRuntimeJoinFilters();
+  SetUpSourcePredicates();
+  return Status::OK();
+}
+
+void ExecutionGraph::SetUpSourcePredicates() {
+  for (const auto& [filter_id, op_type] : node_op_types_) {
+    if (op_type != planpb::FILTER_OPERATOR) {
+      continue;
+    }
+    auto parents = pf_->dag().ParentsOf(filter_id);
+    if (parents.size() != 1 || node_op_types_.at(parents[0]) != planpb::MEMORY_SOURCE_OPERATOR ||
+        pf_->dag().DependenciesOf(parents[0]).size() != 1) {
+      continue;
+    }
+    const auto* source_op =
+        static_cast<const plan::MemorySourceOperator*>(pf_->nodes().at(parents[0]).get());
+    const auto* filter_op =
+        static_cast<const plan::FilterOperator*>(pf_->nodes().at(filter_id).get());
+    if (source_op->predicate() == nullptr ||
+        source_op->predicate()->DebugString() != filter_op->expression()->DebugString()) {
+      continue;
+    }
+    static_cast<FilterNode*>(nodes_.at(filter_id))->set_predicate_applied_by_source();
+    source_applied_filters_.insert(filter_id);
+  }
+}
+
+void ExecutionGraph::SetUpRuntimeJoinFilters() {
+  for (const auto& [join_id, op_type] : node_op_types_) {
+    if (op_type != planpb::JOIN_OPERATOR) {
+      continue;
+    }
+    auto join = static_cast<EquijoinNode*>(nodes_.at(join_id));
+    if (!join->SupportsRuntimeFilter()) {
+      continue;
+    }
+    auto parents = pf_->dag().ParentsOf(join_id);
+    int64_t cur_id = parents[join->probe_parent_index()];
+    // The columns of cur_id's output that hold the probe keys.
+    std::vector<int64_t> key_indices = join->probe_key_indices();
+    while (true) {
+      // Dropping rows is only safe if the join is the only consumer of them.
+      if (pf_->dag().DependenciesOf(cur_id).size() != 1) {
+        break;
+      }
+      auto cur_type = node_op_types_.at(cur_id);
+      if (cur_type == planpb::MEMORY_SOURCE_OPERATOR || cur_type == planpb::GRPC_SOURCE_OPERATOR) {
+        join->AddRuntimeFilterSource(cur_id, key_indices);
+        break;
+      }
+      plan::Operator* op = pf_->nodes().at(cur_id).get();
+      if (cur_type == planpb::FILTER_OPERATOR) {
+        auto selected_cols = static_cast<plan::FilterOperator*>(op)->selected_cols();
+        for (auto& key_idx : key_indices) {
+          key_idx = selected_cols[key_idx];
+        }
+      } else if (cur_type == planpb::MAP_OPERATOR) {
+        const auto& exprs = static_cast<plan::MapOperator*>(op)->expressions();
+        bool all_columns = true;
+        for (auto& key_idx : key_indices) {
+          if (exprs[key_idx]->ExpressionType() != plan::Expression::kColumn) {
+            all_columns = false;
+            break;
+          }
+          key_idx = static_cast<const plan::Column*>(exprs[key_idx].get())->Index();
+        }
+        if (!all_columns) {
+          break;
+        }
+      } else {
+        break;
+      }
+      cur_id = pf_->dag().ParentsOf(cur_id)[0];
+    }
+  }
 }
 
 bool ExecutionGraph::YieldWithTimeout() {
@@ -285,11 +374,239 @@ Status ExecutionGraph::ExecuteSources() {
   return Status::OK();
 }
 
+std::vector<MorselPipeline> ExecutionGraph::FindMorselPipelines() const {
+  std::vector<MorselPipeline> pipelines;
+  for (int64_t source_id : sources_) {
+    if (node_op_types_.at(source_id) != planpb::MEMORY_SOURCE_OPERATOR) {
+      continue;
+    }
+    auto source = static_cast<MemorySourceNode*>(nodes_.at(source_id));
+    if (!source->SupportsMorsels()) {
+      continue;
+    }
+    MorselPipeline pipeline{source_id, {}, -1};
+    int64_t cur_id = source_id;
+    while (pipeline.breaker_id == -1) {
+      // Every node in the pipeline must feed exactly one node, which has no other inputs.
+      auto children = pf_->dag().DependenciesOf(cur_id);
+      if (children.size() != 1 || pf_->dag().ParentsOf(children[0]).size() != 1) {
+        break;
+      }
+      int64_t child_id = children[0];
+      auto op_type = node_op_types_.at(child_id);
+      if (op_type == planpb::MAP_OPERATOR || op_type == planpb::FILTER_OPERATOR) {
+        pipeline.chain_ids.push_back(child_id);
+        cur_id = child_id;
+        continue;
+      }
+      if (op_type == planpb::AGGREGATE_OPERATOR &&
+          static_cast<AggNode*>(nodes_.at(child_id))->SupportsMorselMerge()) {
+        pipeline.breaker_id = child_id;
+      }
+      break;
+    }
+    if (pipeline.breaker_id != -1) {
+      pipelines.push_back(pipeline);
+    }
+  }
+  return pipelines;
+}
+
+Status ExecutionGraph::ExecuteMorselPipeline(const MorselPipeline& pipeline) {
+  auto source = static_cast<MemorySourceNode*>(nodes_.at(pipeline.source_id));
+  auto breaker = static_cast<AggNode*>(nodes_.at(pipeline.breaker_id));
+
+  // Give each worker its own copy of the chain and of the aggregate, so no node is shared between
+  // threads.
+  std::vector<ExecNode*> worker_heads;
+  std::vector<AggNode*> worker_aggs;
+  std::vector<ExecNode*> worker_nodes;
+  for (int32_t i = 0; i < morsel_parallelism_; ++i) {
+    ExecNode* prev = nullptr;
+    ExecNode* head = nullptr;
+    std::vector<int64_t> ids = pipeline.chain_ids;
+    ids.push_back(pipeline.breaker_id);
+    for (int64_t id : ids) {
+      PL_ASSIGN_OR_RETURN(auto clone, node_clone_fns_.at(id)());
+      if (source_applied_filters_.contains(id)) {
+        static_cast<FilterNode*>(clone)->set_predicate_applied_by_source();
+      }
+      PL_RETURN_IF_ERROR(clone->Prepare(exec_state_));
+      PL_RETURN_IF_ERROR(clone->Open(exec_state_));
+      worker_nodes.push_back(clone);
+      if (prev == nullptr) {
+        head = clone;
+      } else {
+        prev->AddChild(clone, 0);
+      }
+      prev = clone;
+    }
+    worker_heads.push_back(head);
+    worker_aggs.push_back(static_cast<AggNode*>(prev));
+  }
+
+  exec_state_->SetCurrentSource(pipeline.source_id);
+  std::atomic<bool> failed{false};
+  std::vector<Status> worker_status(morsel_parallelism_);
+  std::vector<std::thread> workers;
+  for (int32_t i = 0; i < morsel_parallelism_; ++i) {
+    workers.emplace_back([&, i] {
+      while (!failed) {
+        auto morsel_or_s = source->NextMorsel(exec_state_);
+        if (!morsel_or_s.ok()) {
+          worker_status[i] = morsel_or_s.status();
+          break;
+        }
+        auto morsel = morsel_or_s.ConsumeValueOrDie();
+        if (morsel == nullptr) {
+          break;
+        }
+        worker_status[i] = worker_heads[i]->ConsumeNext(exec_state_, *morsel, 0);
+        if (!worker_status[i].ok()) {
+          break;
+        }
+      }
+      if (!worker_status[i].ok()) {
+        failed = true;
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  Status s;
+  for (const auto& worker_s : worker_status) {
+    if (!worker_s.ok()) {
+      s = worker_s;
+      break;
+    }
+  }
+  // Gather the thread-local aggregates into the original aggregate, which then emits the results
+  // when the end of stream flows through the original pipeline.
+  if (s.ok()) {
+    for (AggNode* worker_agg : worker_aggs) {
+      s = breaker->MergeFrom(exec_state_, worker_agg);
+      if (!s.ok()) {
+        break;
+      }
+    }
+  }
+  for (ExecNode* node : worker_nodes) {
+    auto close_s = node->Close(exec_state_);
+    if (!close_s.ok()) {
+      LOG(ERROR) << absl::Substitute("Error closing morsel worker node for query $0: $1",
+                                     exec_state_->query_id().str(), close_s.msg());
+    }
+  }
+  PL_RETURN_IF_ERROR(s);
+  return source->SendEndOfStream(exec_state_);
+}
+
+Status ExecutionGraph::ExecuteMorselPipelines() {
+  if (morsel_parallelism_ <= 1) {
+    return Status::OK();
+  }
+  for (const auto& pipeline : FindMorselPipelines()) {
+    PL_RETURN_IF_ERROR(ExecuteMorselPipeline(pipeline));
+  }
+  return Status::OK();
+}
+
 /**
  * Execute the graph starting at all of the sources.
  * @return a status of whether execution succeeded.
  */
 Status ExecutionGraph::Execute() {
+  PL_RETURN_IF_ERROR(Open());
+
+  std::vector<ResultCache::ScanRange> scan_ranges;
+  std::shared_ptr<const ResultCache::Entry> cached_entry;
+  std::shared_ptr<ResultCache::Entry> new_entry;
+  if (result_cache_ != nullptr && GetCacheableScanRanges(&scan_ranges)) {
+    cached_entry = result_cache_->Lookup(fragment_key_, scan_ranges);
+    if (cached_entry == nullptr) {
+      new_entry = std::make_shared<ResultCache::Entry>();
+      new_entry->scan_ranges = std::move(scan_ranges);
+      RecordSinkBatches(new_entry.get());
+    }
+  }
+
+  // We don't PL_RETURN_IF_ERROR here because we want to make sure we close all of our
+  // nodes, even if there was an error during execution. Morsel pipelines run to completion first,
+  // after which their sources have sent eos and are skipped by ExecuteSources.
+  Status source_status;
+  if (cached_entry != nullptr) {
+    source_status = ReplaySinkBatches(*cached_entry);
+  } else {
+    source_status = ExecuteMorselPipelines();
+    if (source_status.ok()) {
+      source_status = ExecuteSources();
+    }
+  }
+  if (new_entry != nullptr && source_status.ok()) {
+    for (int64_t sink_id : AllSinks()) {
+      nodes_.at(sink_id)->set_consume_observer(nullptr);
+    }
+    result_cache_->Insert(fragment_key_, std::move(new_entry));
+  }
+  Status close_status = Close();
+
+  if (!source_status.ok()) {
+    return source_status;
+  }
+  return close_status;
+}
+
+bool ExecutionGraph::GetCacheableScanRanges(std::vector<ResultCache::ScanRange>* scan_ranges) {
+  if (sources_.empty()) {
+    return false;
+  }
+  for (int64_t source_id : sources_) {
+    if (node_op_types_.at(source_id) != planpb::MEMORY_SOURCE_OPERATOR) {
+      return false;
+    }
+    auto* source = static_cast<MemorySourceNode*>(nodes_.at(source_id));
+    // Only bounded sources can be split into morsels, streams can't be cached.
+    if (!source->SupportsMorsels()) {
+      return false;
+    }
+    scan_ranges->push_back(source->ScanRange());
+  }
+  return true;
+}
+
+std::vector<int64_t> ExecutionGraph::AllSinks() const {
+  std::vector<int64_t> sink_ids = sinks_;
+  sink_ids.insert(sink_ids.end(), grpc_sinks_.begin(), grpc_sinks_.end());
+  return sink_ids;
+}
+
+void ExecutionGraph::RecordSinkBatches(ResultCache::Entry* entry) {
+  for (int64_t sink_id : AllSinks()) {
+    nodes_.at(sink_id)->set_consume_observer(
+        [this, entry, sink_id](const RowBatch& rb, size_t parent_index) {
+          if (entry->num_bytes > result_cache_->max_entry_bytes()) {
+            // Too big to be cached, Insert will drop it.
+            return;
+          }
+          entry->num_bytes += rb.NumBytes();
+          entry->sink_batches.push_back(ResultCache::SinkBatch{sink_id, parent_index, rb});
+        });
+  }
+}
+
+Status ExecutionGraph::ReplaySinkBatches(const ResultCache::Entry& entry) {
+  // The sinks are this query's own nodes, so the replayed batches, including the end of stream,
+  // go to this query's destinations, tagged with its query ID.
+  for (const auto& sink_batch : entry.sink_batches) {
+    auto* sink = nodes_.at(sink_batch.sink_id);
+    PL_RETURN_IF_ERROR(sink->ConsumeNext(exec_state_, sink_batch.rb, sink_batch.parent_index));
+  }
+  return Status::OK();
+}
+
+Status ExecutionGraph::Open() {
   query_start_time_ = std::chrono::system_clock::now();
 
   // Get vector of nodes.
@@ -303,14 +620,13 @@ Status ExecutionGraph::Execute() {
   for (auto node : nodes) {
     PL_RETURN_IF_ERROR(node->Open(exec_state_));
   }
+  return Status::OK();
+}
 
-  // We don't PL_RETURN_IF_ERROR here because we want to make sure we close all of our
-  // nodes, even if there was an error during execution.
-  Status source_status = ExecuteSources();
+Status ExecutionGraph::Close() {
   Status close_status = Status::OK();
-
-  for (auto node : nodes) {
-    auto s = node->Close(exec_state_);
+  for (const auto& kv : nodes_) {
+    auto s = kv.second->Close(exec_state_);
     if (!s.ok()) {
       // Since we only return a single error status if there are multiple errors,
       // make sure to log all of the errors that we receive as we close down the query.
@@ -320,10 +636,6 @@ Status ExecutionGraph::Execute() {
       close_status = s;
     }
   }
-
-  if (!source_status.ok()) {
-    return source_status;
-  }
   return close_status;
 }
 
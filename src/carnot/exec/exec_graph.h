@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <condition_variable>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -32,6 +33,7 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/plan/plan_fragment.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/common/base/base.h"
@@ -39,6 +41,8 @@
 #include "src/shared/types/types.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int32(carnot_morsel_parallelism);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -53,6 +57,20 @@ constexpr std::chrono::milliseconds kDefaultUpstreamResultConnectionTimeout{5000
 constexpr int32_t kDefaultConsecutiveGenerateCallsPerSource = 10;
 using SystemTimePoint = std::chrono::time_point<std::chrono::system_clock>;
 
+/**
+ * A MorselPipeline is a section of the graph that can be executed by several workers at once: a
+ * bounded MemorySource, followed by a chain of Map/Filter nodes, followed by a blocking aggregate
+ * (the pipeline breaker). Each worker runs its own copy of the chain and aggregate over morsels
+ * pulled from the source, and the thread-local aggregates are merged into the original aggregate
+ * once the source is exhausted.
+ */
+struct MorselPipeline {
+  int64_t source_id;
+  // The ids of the Map/Filter nodes between the source and the breaker, in order.
+  std::vector<int64_t> chain_ids;
+  int64_t breaker_id;
+};
+
 /**
  * An Execution Graph defines the structure of execution nodes for a given plan fragment.
  */
@@ -69,7 +87,8 @@ class ExecutionGraph {
   ExecutionGraph(const std::chrono::milliseconds& yield_duration,
                  const std::chrono::milliseconds& upstream_result_connection_timeout)
       : upstream_result_connection_timeout_ms_(upstream_result_connection_timeout),
-        yield_timeout_ms_(yield_duration) {}
+        yield_timeout_ms_(yield_duration),
+        morsel_parallelism_(FLAGS_carnot_morsel_parallelism) {}
 
   ExecutionGraph()
       : ExecutionGraph(kDefaultYieldTimeoutMS, kDefaultUpstreamResultConnectionTimeout) {}
@@ -147,11 +166,32 @@ class ExecutionGraph {
     }
   }
 
+  /**
+   * Lets Execute() serve the output of this graph from the cache, or add it to the cache, when all
+   * of its sources are bounded memory sources. Both memory and GRPC sinks are replayed.
+   * @param result_cache The cache, which must outlive this graph.
+   * @param fragment_key The key of the plan fragment, from ResultCache::FragmentKey.
+   */
+  void set_result_cache(ResultCache* result_cache, std::string fragment_key) {
+    result_cache_ = result_cache;
+    fragment_key_ = std::move(fragment_key);
+  }
+
   /**
    * For unit testing, set exec_state_ in the cases where the normal Init() hasn't been called.
    */
   void testing_set_exec_state(ExecState* exec_state) { exec_state_ = exec_state; }
 
+  /**
+   * For unit testing, override the number of morsel workers set by --carnot_morsel_parallelism.
+   */
+  void testing_set_morsel_parallelism(int32_t parallelism) { morsel_parallelism_ = parallelism; }
+
+  /**
+   * @return the pipelines of this graph that can be executed morsel-at-a-time by multiple workers.
+   */
+  std::vector<MorselPipeline> FindMorselPipelines() const;
+
   // Check the upstream connection health for a given GRPC source.
   // If it is not healthy, then we will just omit this particular source from the query,
   // since an input agent may have just been deleted or some other legitimate reason.
@@ -161,6 +201,25 @@ class ExecutionGraph {
   Status CheckDownstreamGRPCConnectionsHealth();
 
  private:
+  // Prepares and opens all of the nodes of the graph.
+  Status Open();
+  // Closes all of the nodes of the graph. All of the nodes are closed even if some fail, and the
+  // last error is returned.
+  Status Close();
+
+  /**
+   * Finds the source feeding the probe side of each EquijoinNode through a chain of Filter and
+   * column-projecting Map nodes, and registers it with the join so that a filter of the build keys
+   * can be pushed down to it at runtime.
+   */
+  void SetUpRuntimeJoinFilters();
+
+  /**
+   * Finds the FilterNodes whose predicate is already applied by the MemorySourceNode feeding them,
+   * and turns them into column projections so that the predicate isn't evaluated twice.
+   */
+  void SetUpSourcePredicates();
+
   /**
    * For the given operator type, creates the corresponding execution node and updates the structure
    * of the execution graph.
@@ -195,6 +254,14 @@ class ExecutionGraph {
     auto s = execNode->Init(node, output_descriptor, input_descriptors, collect_exec_node_stats_);
 
     AddNode(node.id(), execNode);
+    node_op_types_[node.id()] = node.op_type();
+    node_clone_fns_[node.id()] = [this, node, output_descriptor,
+                                  input_descriptors]() -> StatusOr<ExecNode*> {
+      auto clone = pool_.Add(new TNode());
+      PL_RETURN_IF_ERROR(clone->Init(node, output_descriptor, input_descriptors,
+                                     /* collect_exec_stats */ false));
+      return clone;
+    };
 
     // Update parents' children.
     for (size_t i = 0; i < parents.size(); ++i) {
@@ -209,6 +276,17 @@ class ExecutionGraph {
   }
 
   Status ExecuteSources();
+  // Fills scan_ranges with the ranges read by the sources, if the output of the graph only depends
+  // on those ranges. Returns false if it doesn't, eg. because a source is a stream.
+  bool GetCacheableScanRanges(std::vector<ResultCache::ScanRange>* scan_ranges);
+  // The ids of the memory and GRPC sinks.
+  std::vector<int64_t> AllSinks() const;
+  // Records the batches consumed by the sinks into entry, until they outgrow the cache.
+  void RecordSinkBatches(ResultCache::Entry* entry);
+  // Feeds the cached batches to the sinks, in place of running the sources.
+  Status ReplaySinkBatches(const ResultCache::Entry& entry);
+  Status ExecuteMorselPipelines();
+  Status ExecuteMorselPipeline(const MorselPipeline& pipeline);
 
   ExecState* exec_state_;
   ObjectPool pool_{"exec_graph_pool"};
@@ -220,6 +298,15 @@ class ExecutionGraph {
   absl::flat_hash_set<int64_t> grpc_sources_;
   absl::flat_hash_set<int64_t> grpc_sinks_;
   std::unordered_map<int64_t, ExecNode*> nodes_;
+  std::unordered_map<int64_t, planpb::OperatorType> node_op_types_;
+  // Creates a fresh, initialized copy of the node with the given id, which is not connected to the
+  // rest of the graph. Used to give each morsel worker its own copy of a pipeline.
+  std::unordered_map<int64_t, std::function<StatusOr<ExecNode*>()>> node_clone_fns_;
+  // The ids of the filters whose predicate is applied by their source.
+  absl::flat_hash_set<int64_t> source_applied_filters_;
+
+  ResultCache* result_cache_ = nullptr;
+  std::string fragment_key_;
 
   SystemTimePoint query_start_time_;
 
@@ -236,6 +323,10 @@ class ExecutionGraph {
   // (Doesn't apply if there is only one active source.)
   int32_t consecutive_generate_calls_per_source_ = kDefaultConsecutiveGenerateCallsPerSource;
 
+  // The number of workers used to execute each MorselPipeline. Values <= 1 disable morsel-driven
+  // execution, in which case every source is run on the calling thread.
+  int32_t morsel_parallelism_;
+
   // Whether or not the graph should continue executing or wait for more work to do.
   bool continue_ = false;
   std::mutex execution_mutex_;
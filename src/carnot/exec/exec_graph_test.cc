@@ -26,10 +26,12 @@
 #include <vector>
 
 #include <google/protobuf/text_format.h>
+#include <grpcpp/test/mock_stream.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
 
 #include "src/carnot/exec/grpc_source_node.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/exec/test_utils.h"
 #include "src/carnot/plan/plan_fragment.h"
 #include "src/carnot/plan/plan_state.h"
@@ -39,6 +41,7 @@
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/udf.h"
 #include "src/common/base/test_utils.h"
+#include "src/common/uuid/uuid_utils.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/table_store.h"
@@ -556,6 +559,326 @@ TEST_F(ExecGraphTest, execute_with_two_limits) {
                   ->Equals(types::ToArrow(out_in1, arrow::default_memory_pool())));
 }
 
+class SumUDA : public udf::UDA {
+ public:
+  void Update(udf::FunctionContext*, types::Float64Value arg) { sum_ = sum_.val + arg.val; }
+  void Merge(udf::FunctionContext*, const SumUDA& other) { sum_ = sum_.val + other.sum_.val; }
+  types::Float64Value Finalize(udf::FunctionContext*) { return sum_; }
+
+ protected:
+  types::Float64Value sum_ = 0;
+};
+
+constexpr char kMapAggPlanFragment[] = R"(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 2
+    }
+    nodes {
+      id: 2
+      sorted_children: 3
+      sorted_parents: 1
+    }
+    nodes {
+      id: 3
+      sorted_children: 4
+      sorted_parents: 2
+    }
+    nodes {
+      id: 4
+      sorted_parents: 3
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "numbers"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "a"
+        column_idxs: 1
+        column_types: BOOLEAN
+        column_names: "b"
+        column_idxs: 2
+        column_types: FLOAT64
+        column_names: "c"
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: MAP_OPERATOR
+      map_op {
+        expressions {
+          func {
+            name: "add"
+            id: 0
+            args {
+              column {
+                node: 1
+                index: 0
+              }
+            }
+            args {
+              column {
+                node: 1
+                index: 2
+              }
+            }
+            args_data_types: INT64
+            args_data_types: FLOAT64
+          }
+        }
+        expressions {
+          column {
+            node: 1
+            index: 1
+          }
+        }
+        column_names: "summed"
+        column_names: "b"
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: AGGREGATE_OPERATOR
+      agg_op {
+        windowed: false
+        values {
+          name: "sum"
+          id: 0
+          args {
+            column {
+              node: 2
+              index: 0
+            }
+          }
+          args_data_types: FLOAT64
+        }
+        groups {
+          node: 2
+          index: 1
+        }
+        group_names: "b"
+        value_names: "total"
+      }
+    }
+  }
+  nodes {
+    id: 4
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "output"
+        column_types: BOOLEAN
+        column_types: FLOAT64
+        column_names: "b"
+        column_names: "total"
+      }
+    }
+  }
+)";
+
+class MorselExecGraphTest : public BaseExecGraphTest,
+                            public ::testing::WithParamInterface<int32_t> {
+ protected:
+  void SetUp() override {
+    SetUpExecState();
+    func_registry_->RegisterOrDie<SumUDA>("sum");
+  }
+};
+
+TEST_P(MorselExecGraphTest, parallel_agg_matches_serial) {
+  int32_t parallelism = GetParam();
+
+  planpb::PlanFragment pf_pb;
+  ASSERT_TRUE(TextFormat::MergeFromString(kMapAggPlanFragment, &pf_pb));
+  ASSERT_OK(plan_fragment_->Init(pf_pb));
+
+  auto plan_state = std::make_unique<plan::PlanState>(func_registry_.get());
+  auto schema = std::make_shared<table_store::schema::Schema>();
+  schema->AddRelation(
+      1, table_store::schema::Relation(
+             std::vector<types::DataType>(
+                 {types::DataType::INT64, types::DataType::BOOLEAN, types::DataType::FLOAT64}),
+             std::vector<std::string>({"a", "b", "c"})));
+
+  table_store::schema::Relation rel(
+      {types::DataType::INT64, types::DataType::BOOLEAN, types::DataType::FLOAT64},
+      {"col1", "col2", "col3"});
+  auto table = Table::Create("test", rel);
+
+  double expected_true = 0;
+  double expected_false = 0;
+  for (int64_t batch = 0; batch < 64; ++batch) {
+    auto rb = RowBatch(RowDescriptor(rel.col_types()), 4);
+    std::vector<types::Int64Value> col1;
+    std::vector<types::BoolValue> col2;
+    std::vector<types::Float64Value> col3;
+    for (int64_t i = 0; i < 4; ++i) {
+      int64_t a = batch * 4 + i;
+      bool b = (a % 3) == 0;
+      double c = 0.5 * i;
+      col1.emplace_back(a);
+      col2.emplace_back(b);
+      col3.emplace_back(c);
+      (b ? expected_true : expected_false) += a + c;
+    }
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col2, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col3, arrow::default_memory_pool())));
+    EXPECT_OK(table->WriteRowBatch(rb));
+  }
+
+  auto table_store = std::make_shared<table_store::TableStore>();
+  table_store->AddTable("numbers", table);
+  auto exec_state = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                                MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+  EXPECT_OK(exec_state->AddScalarUDF(
+      0, "add", std::vector<types::DataType>({types::DataType::INT64, types::DataType::FLOAT64})));
+  EXPECT_OK(exec_state->AddUDA(0, "sum", std::vector<types::DataType>({types::DataType::FLOAT64})));
+
+  ExecutionGraph e;
+  e.testing_set_morsel_parallelism(parallelism);
+  ASSERT_OK(e.Init(schema.get(), plan_state.get(), exec_state.get(), plan_fragment_.get(),
+                   /* collect_exec_node_stats */ false));
+  EXPECT_EQ(1, e.FindMorselPipelines().size());
+  EXPECT_OK(e.Execute());
+  EXPECT_EQ(256, e.GetStats().rows_processed);
+
+  auto output_table = exec_state->table_store()->GetTable("output");
+  auto rb = output_table
+                ->GetRowBatchSlice(output_table->FirstBatch(), std::vector<int64_t>({0, 1}),
+                                   arrow::default_memory_pool())
+                .ConsumeValueOrDie();
+  ASSERT_EQ(2, rb->num_rows());
+  for (int64_t i = 0; i < rb->num_rows(); ++i) {
+    auto group = types::GetValueFromArrowArray<types::BOOLEAN>(rb->ColumnAt(0).get(), i);
+    auto total = types::GetValueFromArrowArray<types::FLOAT64>(rb->ColumnAt(1).get(), i);
+    EXPECT_DOUBLE_EQ(group ? expected_true : expected_false, total);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(MorselExecGraphTestSuite, MorselExecGraphTest,
+                         ::testing::Values(1, 2, 4, 8));
+
+constexpr char kMemorySourceGRPCSinkPlanFragment[] = R"(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 2
+    }
+    nodes {
+      id: 2
+      sorted_parents: 1
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "numbers"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "a"
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: GRPC_SINK_OPERATOR
+      grpc_sink_op {
+        address: "$0"
+        grpc_source_id: $1
+      }
+    }
+  }
+)";
+
+TEST_F(BaseExecGraphTest, result_cache_replays_grpc_sinks) {
+  func_registry_ = std::make_unique<udf::Registry>("test_registry");
+  auto plan_state = std::make_unique<plan::PlanState>(func_registry_.get());
+  auto schema = std::make_shared<table_store::schema::Schema>();
+  schema->AddRelation(1, table_store::schema::Relation(
+                             std::vector<types::DataType>({types::DataType::INT64}),
+                             std::vector<std::string>({"a"})));
+
+  table_store::schema::Relation rel({types::DataType::INT64}, {"col1"});
+  auto table = Table::Create("test", rel);
+  for (int64_t batch = 0; batch < 4; ++batch) {
+    auto rb = RowBatch(RowDescriptor(rel.col_types()), 3);
+    std::vector<types::Int64Value> col1{batch, batch, batch};
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table->WriteRowBatch(rb));
+  }
+  auto table_store = std::make_shared<table_store::TableStore>();
+  table_store->AddTable("numbers", table);
+
+  ResultCache cache(1024 * 1024, std::chrono::milliseconds(60000));
+
+  // Run the same fragment for two queries that send their results to different destinations. The
+  // second query is served from the cache, but its downstream Carnot still needs to receive all of
+  // the rows and the end of stream on its own connection, for its own query.
+  for (int run = 0; run < 2; ++run) {
+    std::string address = absl::Substitute("localhost:123$0", run);
+    planpb::PlanFragment pf_pb;
+    ASSERT_TRUE(TextFormat::MergeFromString(
+        absl::Substitute(kMemorySourceGRPCSinkPlanFragment, address, run), &pf_pb));
+    auto plan_fragment = std::make_shared<plan::PlanFragment>(1);
+    ASSERT_OK(plan_fragment->Init(pf_pb));
+    auto query_id = sole::uuid4();
+
+    int64_t rows_sent = 0;
+    bool sent_eos = false;
+    auto writer = new grpc::testing::MockClientWriter<carnotpb::TransferResultChunkRequest>();
+    EXPECT_CALL(*writer, Write(::testing::_, ::testing::_))
+        .WillRepeatedly(::testing::Invoke(
+            [&](const carnotpb::TransferResultChunkRequest& req, grpc::WriteOptions) {
+              EXPECT_EQ(address, req.address());
+              EXPECT_EQ(query_id, ParseUUID(req.query_id()).ConsumeValueOrDie());
+              if (req.query_result().has_row_batch()) {
+                EXPECT_EQ(run, req.query_result().grpc_source_id());
+                rows_sent += req.query_result().row_batch().num_rows();
+                sent_eos |= req.query_result().row_batch().eos();
+              }
+              return true;
+            }));
+    EXPECT_CALL(*writer, WritesDone());
+    EXPECT_CALL(*writer, Finish()).WillOnce(::testing::Return(grpc::Status::OK));
+    auto stub = std::make_unique<carnotpb::MockResultSinkServiceStub>();
+    EXPECT_CALL(*stub, TransferResultChunkRaw(::testing::_, ::testing::_))
+        .WillOnce(::testing::Return(writer));
+
+    auto exec_state = std::make_unique<ExecState>(
+        func_registry_.get(), table_store,
+        [&stub](const std::string&, const std::string&)
+            -> std::unique_ptr<carnotpb::ResultSinkService::StubInterface> {
+          return std::move(stub);
+        },
+        query_id, nullptr);
+
+    ExecutionGraph e;
+    ASSERT_OK(e.Init(schema.get(), plan_state.get(), exec_state.get(), plan_fragment.get(),
+                     /* collect_exec_node_stats */ false));
+    e.set_result_cache(&cache, ResultCache::FragmentKey(pf_pb));
+    EXPECT_OK(e.Execute());
+    // Only the first query scans the table, the second one replays the cached batches.
+    EXPECT_EQ(run == 0 ? 12 : 0, e.GetStats().rows_processed);
+    EXPECT_EQ(12, rows_sent);
+    EXPECT_TRUE(sent_eos);
+  }
+}
+
 class YieldingExecGraphTest : public BaseExecGraphTest {
  protected:
   void SetUp() { SetUpExecState(); }
@@ -18,8 +18,10 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/exec/exec_state.h"
@@ -46,7 +48,7 @@ struct ExecNodeStats {
     }
     ++batches_output;
     bytes_output += rb.NumBytes();
-    rows_output += rb.num_rows();
+    rows_output += rb.num_selected_rows();
   }
 
   void AddInputStats(const table_store::schema::RowBatch& rb) {
@@ -55,7 +57,7 @@ struct ExecNodeStats {
     }
     ++batches_input;
     bytes_input += rb.NumBytes();
-    rows_input += rb.num_rows();
+    rows_input += rb.num_selected_rows();
   }
 
   void ResumeChildTimer() {
@@ -218,6 +220,14 @@ class ExecNode {
       return error::Internal(
           "ConsumeNext received row batch with end of stream set but not end of window.");
     }
+    if (rb.has_selection() && !AcceptsSelectionVector()) {
+      // Copy out the selected rows once, for nodes that only understand dense batches.
+      PL_ASSIGN_OR_RETURN(auto dense_rb, rb.MaterializeSelection());
+      return ConsumeNext(exec_state, *dense_rb, parent_index);
+    }
+    if (consume_observer_) {
+      consume_observer_(rb, parent_index);
+    }
     stats_->AddInputStats(rb);
     stats_->ResumeTotalTimer();
     PL_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
@@ -275,6 +285,14 @@ class ExecNode {
 
   ExecNodeStats* stats() const { return stats_.get(); }
 
+  using ConsumeObserver =
+      std::function<void(const table_store::schema::RowBatch& rb, size_t parent_index)>;
+  /**
+   * Sets a function that is called with every (dense) row batch this node consumes, before the
+   * node consumes it. Used to record the input of sinks for the result cache.
+   */
+  void set_consume_observer(ConsumeObserver observer) { consume_observer_ = std::move(observer); }
+
  protected:
   /**
    * Send data to children row batches.
@@ -313,6 +331,13 @@ class ExecNode {
   virtual Status ConsumeNextImpl(ExecState*, const table_store::schema::RowBatch&, size_t) {
     return error::Unimplemented("Implement in derived class (if sink or processing)");
   }
+
+  /**
+   * Whether ConsumeNextImpl can handle row batches that carry a selection vector. Nodes that
+   * return false receive a materialized copy of the selected rows instead.
+   */
+  virtual bool AcceptsSelectionVector() const { return false; }
+
   bool is_closed() { return is_closed_; }
 
   std::unique_ptr<table_store::schema::RowDescriptor> output_descriptor_;
@@ -334,6 +359,7 @@ class ExecNode {
   ExecNodeType type_;
   // Whether this node has been initialized.
   bool is_initialized_ = false;
+  ConsumeObserver consume_observer_;
 };
 
 /**
@@ -368,6 +394,16 @@ class SourceNode : public ExecNode {
   }
 
  protected:
+  /**
+   * Applies any join filters published for the current source to rb (see
+   * ExecState::AddRuntimeJoinFilter), narrowing its selection to the rows that may be joined.
+   */
+  void ApplyRuntimeJoinFilters(ExecState* exec_state, table_store::schema::RowBatch* rb) {
+    for (const auto& join_filter : exec_state->CurrentSourceJoinFilters()) {
+      join_filter.filter->Apply(join_filter.key_indices, rb);
+    }
+  }
+
   int64_t rows_processed_ = 0;
   int64_t bytes_processed_ = 0;
 };
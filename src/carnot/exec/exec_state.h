@@ -31,6 +31,7 @@
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/exec/grpc_router.h"
 #include "src/carnot/exec/ml/model_pool.h"
+#include "src/carnot/exec/runtime_join_filter.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
 #include "src/shared/metadata/metadata_state.h"
@@ -147,6 +148,22 @@ class ExecState {
     }
   }
 
+  // An EquijoinNode calls this method once its build side is complete, so that the source feeding
+  // its probe side can drop rows that have no match on the build side.
+  void AddRuntimeJoinFilter(int64_t src_id, SourceJoinFilter filter) {
+    source_id_to_join_filters_map_[src_id].push_back(std::move(filter));
+  }
+
+  // Returns the join filters that have been published for the current source.
+  const std::vector<SourceJoinFilter>& CurrentSourceJoinFilters() {
+    static const std::vector<SourceJoinFilter> kNoFilters;
+    if (!current_source_set_) {
+      return kNoFilters;
+    }
+    auto it = source_id_to_join_filters_map_.find(current_source_);
+    return it == source_id_to_join_filters_map_.end() ? kNoFilters : it->second;
+  }
+
   void set_metadata_state(std::shared_ptr<const md::AgentMetadataState> metadata_state) {
     metadata_state_ = metadata_state;
   }
@@ -178,6 +195,7 @@ class ExecState {
   int64_t current_source_ = 0;
   bool current_source_set_ = false;
   std::map<int64_t, bool> source_id_to_keep_running_map_;
+  std::map<int64_t, std::vector<SourceJoinFilter>> source_id_to_join_filters_map_;
 
   std::vector<std::unique_ptr<carnotpb::ResultSinkService::StubInterface>> result_sink_stubs_pool_;
   // Mapping of remote address to stub that serves that address.
@@ -37,6 +37,11 @@
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 
+DEFINE_bool(carnot_fuse_expressions,
+            gflags::BoolFromEnv("PL_CARNOT_FUSE_EXPRESSIONS", true),
+            "Evaluate trees of the builtin arithmetic, comparison and boolean functions a block at "
+            "a time without calling the UDFs (see FusedScalarExpression).");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -138,7 +143,23 @@ Status ScalarExpressionEvaluator::Evaluate(ExecState* exec_state, const RowBatch
   CHECK(output != nullptr);
   CHECK_EQ(static_cast<size_t>(output->num_columns()), expressions_.size());
 
-  for (const auto& expression : expressions_) {
+  if (!fused_expressions_compiled_) {
+    if (FLAGS_carnot_fuse_expressions) {
+      for (const auto& expression : expressions_) {
+        fused_expressions_.push_back(
+            FusedScalarExpression::Compile(exec_state, *expression, input.desc()));
+      }
+    }
+    fused_expressions_compiled_ = true;
+  }
+
+  for (const auto& [idx, expression] : Enumerate(expressions_)) {
+    if (idx < fused_expressions_.size() && fused_expressions_[idx] != nullptr) {
+      PL_ASSIGN_OR_RETURN(auto result, fused_expressions_[idx]->Evaluate(
+                                           input, exec_state->exec_mem_pool()));
+      PL_RETURN_IF_ERROR(output->AddColumn(result));
+      continue;
+    }
     PL_RETURN_IF_ERROR(EvaluateSingleExpression(exec_state, input, *expression, output));
   }
   return Status::OK();
@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/fused_expression.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
 #include "src/carnot/udf/udf.h"
@@ -34,6 +35,8 @@
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_bool(carnot_fuse_expressions);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -126,6 +129,12 @@ class ScalarExpressionEvaluator : public ExpressionEvaluator {
   plan::ConstScalarExpressionVector expressions_;
   udf::FunctionContext* function_ctx_ = nullptr;
   std::map<int64_t, std::unique_ptr<udf::ScalarUDF>> id_to_udf_map_;
+
+ private:
+  // Compiled on the first batch, since that's where the input types come from. An expression that
+  // can't be fused has a nullptr, and is evaluated by EvaluateSingleExpression.
+  bool fused_expressions_compiled_ = false;
+  std::vector<std::unique_ptr<FusedScalarExpression>> fused_expressions_;
 };
 
 /**
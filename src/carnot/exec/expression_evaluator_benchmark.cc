@@ -65,11 +65,14 @@ using px::types::ToArrow;
 class AddUDF : public ScalarUDF {
  public:
   Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
+  static constexpr px::carnot::udf::FusedOp Fused() { return px::carnot::udf::FusedOp::kAdd; }
 };
 
 // NOLINTNEXTLINE : runtime/references.
 void BM_ScalarExpressionTwoCols(benchmark::State& state,
-                                const ScalarExpressionEvaluatorType& eval_type, const char* pbtxt) {
+                                const ScalarExpressionEvaluatorType& eval_type, const char* pbtxt,
+                                bool fuse) {
+  FLAGS_carnot_fuse_expressions = fuse;
   px::carnot::planpb::ScalarExpression se_pb;
   size_t data_size = state.range(0);
 
@@ -83,6 +86,7 @@ void BM_ScalarExpressionTwoCols(benchmark::State& state,
   PL_CHECK_OK(func_registry->Register<AddUDF>("add"));
   auto exec_state = std::make_unique<ExecState>(
       func_registry.get(), table_store, MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+  PL_CHECK_OK(exec_state->AddScalarUDF(0, "add", {DataType::INT64, DataType::INT64}));
 
   auto in1 = px::datagen::CreateLargeData<Int64Value>(data_size);
   auto in2 = px::datagen::CreateLargeData<Int64Value>(data_size);
@@ -109,37 +113,46 @@ void BM_ScalarExpressionTwoCols(benchmark::State& state,
 }
 
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, eval_col_arrow,
-                  ScalarExpressionEvaluatorType::kArrowNative, kColumnReferencePbtxt)
+                  ScalarExpressionEvaluatorType::kArrowNative, kColumnReferencePbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, eval_col_native,
-                  ScalarExpressionEvaluatorType::kVectorNative, kColumnReferencePbtxt)
+                  ScalarExpressionEvaluatorType::kVectorNative, kColumnReferencePbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, eval_const_arrow,
-                  ScalarExpressionEvaluatorType::kArrowNative, kScalarInt64ValuePbtxt)
+                  ScalarExpressionEvaluatorType::kArrowNative, kScalarInt64ValuePbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, eval_const_native,
-                  ScalarExpressionEvaluatorType::kVectorNative, kScalarInt64ValuePbtxt)
+                  ScalarExpressionEvaluatorType::kVectorNative, kScalarInt64ValuePbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_arrow,
-                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt)
+                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_native,
-                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt)
+                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_arrow,
-                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt)
+                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_vector,
-                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt)
+                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt, false)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_fused_arrow,
+                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt, true)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_fused_native,
+                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt, true)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
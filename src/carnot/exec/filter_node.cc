@@ -67,6 +67,13 @@ Status FilterNode::PrepareImpl(ExecState* exec_state) {
 
 Status FilterNode::OpenImpl(ExecState* exec_state) {
   PL_RETURN_IF_ERROR(evaluator_->Open(exec_state));
+  if (FLAGS_carnot_fuse_expressions && !predicate_applied_by_source_) {
+    fused_predicate_ = FusedScalarExpression::Compile(exec_state, *plan_node_->expression(),
+                                                      input_descriptors_[0]);
+    if (fused_predicate_ != nullptr && fused_predicate_->output_type() != types::BOOLEAN) {
+      fused_predicate_.reset();
+    }
+  }
   return Status::OK();
 }
 
@@ -75,93 +82,67 @@ Status FilterNode::CloseImpl(ExecState* exec_state) {
   return Status::OK();
 }
 
-template <types::DataType T>
-Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arrow::Array* input_col,
-                           RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  auto output_col_builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
-  auto* output_col_builder = static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(
-      output_col_builder_generic.get());
-  PL_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      output_col_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, idx));
+Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (predicate_applied_by_source_) {
+    RowBatch output_rb(*output_descriptor_, rb.num_rows());
+    for (int64_t input_col_idx : plan_node_->selected_cols()) {
+      PL_RETURN_IF_ERROR(output_rb.AddColumn(rb.ColumnAt(input_col_idx)));
     }
-  }
-  std::shared_ptr<arrow::Array> output_array;
-  PL_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
-  PL_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
-  return Status::OK();
-}
-
-template <>
-Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& pred,
-                                          const arrow::Array* input_col, RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  size_t reserved =
-      100;  // This can be an arbritrary number, since we do exponential doubling below.
-  size_t total_size = 0;
-
-  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, arrow::default_memory_pool());
-  auto* output_col_builder = static_cast<types::DataTypeTraits<types::STRING>::arrow_builder_type*>(
-      output_col_builder_generic.get());
-
-  PL_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  PL_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      auto res = types::GetValueFromArrowArray<types::STRING>(input_col, idx);
-      total_size += res.size();
-      while (total_size >= reserved) {
-        reserved *= 2;
-      }
-      PL_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-      output_col_builder->UnsafeAppend(std::move(res));
+    if (rb.has_selection()) {
+      output_rb.set_selection(rb.selection());
     }
+    output_rb.set_eow(rb.eow());
+    output_rb.set_eos(rb.eos());
+    return SendRowBatchToChildren(exec_state, output_rb);
   }
-  std::shared_ptr<arrow::Array> output_array;
-  PL_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
-  PL_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
-  return Status::OK();
-}
 
-Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
-  // Current implementation does not merge across row batches, we should
-  // consider this for cases where the filter has really low selectivity.
-  PL_ASSIGN_OR_RETURN(auto pred_col, evaluator_->EvaluateSingleExpression(
-                                         exec_state, rb, *plan_node_->expression()));
-
-  // Verify that the type of the column is boolean.
-  DCHECK_EQ(pred_col->data_type(), types::BOOLEAN) << "Predicate expression must be a boolean";
-
-  const types::BoolValueColumnWrapper& pred_col_wrapper =
-      *static_cast<types::BoolValueColumnWrapper*>(pred_col.get());
-  size_t num_pred = pred_col_wrapper.Size();
-
-  DCHECK_EQ(static_cast<size_t>(rb.num_rows()), num_pred);
-
-  // Find out how many of them returned true;
-  size_t num_output_records = 0;
-  for (size_t i = 0; i < num_pred; ++i) {
-    if (pred_col_wrapper[i].val) {
-      ++num_output_records;
+  // Narrow the incoming selection (or the whole batch) down to the rows that pass the predicate.
+  // The column data is never copied here: it is shared with the input batch and only gets
+  // materialized by the first downstream node that doesn't accept selection vectors.
+  std::vector<int64_t> selection;
+  if (fused_predicate_ != nullptr) {
+    selection.reserve(rb.num_selected_rows());
+    fused_predicate_->Select(rb, &selection);
+  } else {
+    // Current implementation does not merge across row batches, we should
+    // consider this for cases where the filter has really low selectivity.
+    PL_ASSIGN_OR_RETURN(auto pred_col, evaluator_->EvaluateSingleExpression(
+                                           exec_state, rb, *plan_node_->expression()));
+
+    // Verify that the type of the column is boolean.
+    DCHECK_EQ(pred_col->data_type(), types::BOOLEAN) << "Predicate expression must be a boolean";
+
+    const types::BoolValueColumnWrapper& pred_col_wrapper =
+        *static_cast<types::BoolValueColumnWrapper*>(pred_col.get());
+    size_t num_pred = pred_col_wrapper.Size();
+
+    DCHECK_EQ(static_cast<size_t>(rb.num_rows()), num_pred);
+
+    if (rb.has_selection()) {
+      selection.reserve(rb.selection().size());
+      for (int64_t idx : rb.selection()) {
+        if (pred_col_wrapper[idx].val) {
+          selection.push_back(idx);
+        }
+      }
+    } else {
+      selection.reserve(num_pred);
+      for (size_t i = 0; i < num_pred; ++i) {
+        if (pred_col_wrapper[i].val) {
+          selection.push_back(i);
+        }
+      }
     }
   }
 
-  RowBatch output_rb(*output_descriptor_, num_output_records);
+  RowBatch output_rb(*output_descriptor_, rb.num_rows());
   DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
-
-  for (const auto& [output_col_idx, input_col_idx] : Enumerate(plan_node_->selected_cols())) {
-    auto input_col = rb.ColumnAt(input_col_idx);
-    auto col_type = output_descriptor_->type(output_col_idx);
-#define TYPE_CASE(_dt_) \
-  PL_RETURN_IF_ERROR(PredicateCopyValues<_dt_>(pred_col_wrapper, input_col.get(), &output_rb));
-    PL_SWITCH_FOREACH_DATATYPE(col_type, TYPE_CASE);
-#undef TYPE_CASE
+  for (int64_t input_col_idx : plan_node_->selected_cols()) {
+    PL_RETURN_IF_ERROR(output_rb.AddColumn(rb.ColumnAt(input_col_idx)));
+  }
+  // Every row passed, so there's no need for a selection.
+  if (static_cast<int64_t>(selection.size()) != rb.num_rows()) {
+    output_rb.set_selection(std::move(selection));
   }
 
   output_rb.set_eow(rb.eow());
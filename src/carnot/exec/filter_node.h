@@ -26,6 +26,7 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/fused_expression.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/udf/base.h"
 #include "src/common/base/base.h"
@@ -41,6 +42,12 @@ class FilterNode : public ProcessingNode {
   FilterNode() = default;
   virtual ~FilterNode() = default;
 
+  /**
+   * Marks the filter's predicate as already applied by the MemorySource feeding it (see
+   * MemorySourceOperator::predicate), so the node only selects its output columns.
+   */
+  void set_predicate_applied_by_source() { predicate_applied_by_source_ = true; }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -49,11 +56,17 @@ class FilterNode : public ProcessingNode {
   Status CloseImpl(ExecState* exec_state) override;
   Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                          size_t parent_index) override;
+  // Filters stack selection vectors instead of copying their input.
+  bool AcceptsSelectionVector() const override { return true; }
 
  private:
   std::unique_ptr<VectorNativeScalarExpressionEvaluator> evaluator_;
+  // Set when the predicate can be fused (see FusedScalarExpression), in which case it's used
+  // instead of evaluator_ to select the rows.
+  std::unique_ptr<FusedScalarExpression> fused_predicate_;
   std::unique_ptr<plan::FilterOperator> plan_node_;
   std::unique_ptr<udf::FunctionContext> function_ctx_;
+  bool predicate_applied_by_source_ = false;
 };
 
 }  // namespace exec
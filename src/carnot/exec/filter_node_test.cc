@@ -110,6 +110,29 @@ TEST_F(FilterNodeTest, basic) {
       .Close();
 }
 
+TEST_F(FilterNodeTest, predicate_applied_by_source) {
+  auto op_proto = planpb::testutils::CreateTestFilterTwoColsColumnSelection();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester.node()->set_predicate_applied_by_source();
+  // The rows are passed through as is, and only the selected columns are kept.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .AddColumn<types::Int64Value>({1, 4, 6})
+                       .AddColumn<types::StringValue>({"Hello", "world", "now"})
+                       .get(),
+                   0)
+      .ExpectRowBatch(
+          RowBatchBuilder(output_rd, 3, true, true).AddColumn<types::Int64Value>({1, 4, 6}).get())
+      .Close();
+}
+
 TEST_F(FilterNodeTest, column_selection) {
   auto op_proto = planpb::testutils::CreateTestFilterTwoColsColumnSelection();
   plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
@@ -139,6 +162,32 @@ TEST_F(FilterNodeTest, column_selection) {
       .Close();
 }
 
+TEST_F(FilterNodeTest, input_selection) {
+  auto op_proto = planpb::testutils::CreateTestFilterTwoCols();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  // Simulate the output of an upstream filter which dropped the first row.
+  RowBatchBuilder input_builder(input_rd, 4, /*eow*/ true, /*eos*/ true);
+  input_builder.AddColumn<types::Int64Value>({1, 1, 3, 1})
+      .AddColumn<types::Int64Value>({1, 3, 6, 9})
+      .AddColumn<types::StringValue>({"ABC", "DEF", "HELLO", "WORLD"});
+  input_builder.get().set_selection({1, 2, 3});
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester.ConsumeNext(input_builder.get(), 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::Int64Value>({1, 1})
+                          .AddColumn<types::Int64Value>({3, 9})
+                          .AddColumn<types::StringValue>({"DEF", "WORLD"})
+                          .get())
+      .Close();
+}
+
 TEST_F(FilterNodeTest, zero_row_row_batch) {
   auto op_proto = planpb::testutils::CreateTestFilterTwoCols();
   plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
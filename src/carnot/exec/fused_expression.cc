@@ -0,0 +1,505 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fused_expression.h"
+
+#include <arrow/builder.h>
+
+#include <algorithm>
+#include <functional>
+
+#include "src/carnot/udf/udf_definition.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+namespace {
+
+template <typename TIn, typename TOut, typename TFn>
+void UnaryLoop(const TIn* a, TOut* out, int64_t num_rows, TFn fn) {
+  for (int64_t i = 0; i < num_rows; ++i) {
+    out[i] = fn(a[i]);
+  }
+}
+
+template <typename TIn, typename TOut, typename TFn>
+void BinaryLoop(const TIn* a, const TIn* b, TOut* out, int64_t num_rows, TFn fn) {
+  for (int64_t i = 0; i < num_rows; ++i) {
+    out[i] = fn(a[i], b[i]);
+  }
+}
+
+template <typename T>
+void RunArithmetic(udf::FusedOp op, const T* a, const T* b, T* out, int64_t num_rows) {
+  switch (op) {
+    case udf::FusedOp::kAdd:
+      return BinaryLoop(a, b, out, num_rows, std::plus<T>());
+    case udf::FusedOp::kSubtract:
+      return BinaryLoop(a, b, out, num_rows, std::minus<T>());
+    case udf::FusedOp::kMultiply:
+      return BinaryLoop(a, b, out, num_rows, std::multiplies<T>());
+    case udf::FusedOp::kDivide:
+      return BinaryLoop(a, b, out, num_rows, std::divides<T>());
+    case udf::FusedOp::kNegate:
+      return UnaryLoop(a, out, num_rows, std::negate<T>());
+    default:
+      LOG(DFATAL) << "Not an arithmetic op: " << static_cast<int>(op);
+  }
+}
+
+template <typename T>
+void RunCompare(udf::FusedOp op, const T* a, const T* b, int64_t* out, int64_t num_rows) {
+  switch (op) {
+    case udf::FusedOp::kEqual:
+      return BinaryLoop(a, b, out, num_rows, [](T x, T y) -> int64_t { return x == y; });
+    case udf::FusedOp::kNotEqual:
+      return BinaryLoop(a, b, out, num_rows, [](T x, T y) -> int64_t { return x != y; });
+    case udf::FusedOp::kLessThan:
+      return BinaryLoop(a, b, out, num_rows, [](T x, T y) -> int64_t { return x < y; });
+    case udf::FusedOp::kLessThanEqual:
+      return BinaryLoop(a, b, out, num_rows, [](T x, T y) -> int64_t { return x <= y; });
+    case udf::FusedOp::kGreaterThan:
+      return BinaryLoop(a, b, out, num_rows, [](T x, T y) -> int64_t { return x > y; });
+    case udf::FusedOp::kGreaterThanEqual:
+      return BinaryLoop(a, b, out, num_rows, [](T x, T y) -> int64_t { return x >= y; });
+    default:
+      LOG(DFATAL) << "Not a comparison op: " << static_cast<int>(op);
+  }
+}
+
+void RunLogical(udf::FusedOp op, const int64_t* a, const int64_t* b, int64_t* out,
+                int64_t num_rows) {
+  switch (op) {
+    case udf::FusedOp::kLogicalAnd:
+      return BinaryLoop(a, b, out, num_rows,
+                        [](int64_t x, int64_t y) -> int64_t { return (x != 0) & (y != 0); });
+    case udf::FusedOp::kLogicalOr:
+      return BinaryLoop(a, b, out, num_rows,
+                        [](int64_t x, int64_t y) -> int64_t { return (x != 0) | (y != 0); });
+    case udf::FusedOp::kLogicalNot:
+      return UnaryLoop(a, out, num_rows, [](int64_t x) -> int64_t { return x == 0; });
+    default:
+      LOG(DFATAL) << "Not a logical op: " << static_cast<int>(op);
+  }
+}
+
+bool IsFusableType(types::DataType data_type) {
+  switch (data_type) {
+    case types::BOOLEAN:
+    case types::INT64:
+    case types::TIME64NS:
+    case types::FLOAT64:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsComparison(udf::FusedOp op) {
+  switch (op) {
+    case udf::FusedOp::kEqual:
+    case udf::FusedOp::kNotEqual:
+    case udf::FusedOp::kLessThan:
+    case udf::FusedOp::kLessThanEqual:
+    case udf::FusedOp::kGreaterThan:
+    case udf::FusedOp::kGreaterThanEqual:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+/**
+ * The per call state of the program: the block sized registers, and the data of the input columns.
+ * Keeping it out of the expression lets a single compiled expression be evaluated concurrently.
+ */
+struct FusedScalarExpression::Registers {
+  Registers(const FusedScalarExpression& expr, const RowBatch& rb)
+      : int64_values(expr.num_int64_registers_ * kBlockSize),
+        float64_values(expr.num_float64_registers_ * kBlockSize),
+        int64_columns(rb.num_columns(), nullptr),
+        float64_columns(rb.num_columns(), nullptr),
+        bool_columns(rb.num_columns(), nullptr) {
+    for (int64_t i = 0; i < rb.num_columns(); ++i) {
+      const arrow::Array* arr = rb.ColumnAt(i).get();
+      switch (rb.desc().type(i)) {
+        case types::INT64:
+        case types::TIME64NS:
+          int64_columns[i] = static_cast<const arrow::Int64Array*>(arr)->raw_values();
+          break;
+        case types::FLOAT64:
+          float64_columns[i] = static_cast<const arrow::DoubleArray*>(arr)->raw_values();
+          break;
+        case types::BOOLEAN:
+          bool_columns[i] = static_cast<const arrow::BooleanArray*>(arr);
+          break;
+        default:
+          break;
+      }
+    }
+    // Constants are never overwritten, so they only need to be filled in once.
+    for (const auto& [reg, value] : expr.int64_constants_) {
+      std::fill_n(int64_register(reg), kBlockSize, value);
+    }
+    for (const auto& [reg, value] : expr.float64_constants_) {
+      std::fill_n(float64_register(reg), kBlockSize, value);
+    }
+  }
+
+  int64_t* int64_register(int64_t idx) { return int64_values.data() + idx * kBlockSize; }
+  double* float64_register(int64_t idx) { return float64_values.data() + idx * kBlockSize; }
+
+  const int64_t* int64_operand(const Operand& operand, int64_t start) {
+    return operand.is_column ? int64_columns[operand.index] + start
+                             : int64_register(operand.index);
+  }
+  const double* float64_operand(const Operand& operand, int64_t start) {
+    return operand.is_column ? float64_columns[operand.index] + start
+                             : float64_register(operand.index);
+  }
+
+  std::vector<int64_t> int64_values;
+  std::vector<double> float64_values;
+  std::vector<const int64_t*> int64_columns;
+  std::vector<const double*> float64_columns;
+  std::vector<const arrow::BooleanArray*> bool_columns;
+};
+
+std::unique_ptr<FusedScalarExpression> FusedScalarExpression::Compile(
+    ExecState* exec_state, const plan::ScalarExpression& expr, const RowDescriptor& input_desc) {
+  // Columns and constants are already cheap to evaluate.
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return nullptr;
+  }
+  std::unique_ptr<FusedScalarExpression> fused(new FusedScalarExpression());
+  auto result_or_s = fused->CompileExpression(exec_state, expr, input_desc);
+  if (!result_or_s.ok()) {
+    VLOG(1) << "Not fusing " << expr.DebugString() << ": " << result_or_s.msg();
+    return nullptr;
+  }
+  fused->result_ = result_or_s.ConsumeValueOrDie();
+  const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+  fused->output_type_ = exec_state->GetScalarUDFDefinition(fn.udf_id())->exec_return_type();
+  return fused;
+}
+
+int64_t FusedScalarExpression::NewRegister(Kind kind) {
+  return kind == Kind::kInt64 ? num_int64_registers_++ : num_float64_registers_++;
+}
+
+FusedScalarExpression::Operand FusedScalarExpression::Convert(Operand operand, Kind kind) {
+  if (operand.kind == kind) {
+    return operand;
+  }
+  Instruction instr;
+  instr.code = kind == Kind::kFloat64 ? OpCode::kToFloat64 : OpCode::kToInt64;
+  instr.kind = operand.kind;
+  instr.args[0] = operand;
+  instr.out = NewRegister(kind);
+  program_.push_back(instr);
+  return Operand{false, instr.out, kind};
+}
+
+StatusOr<FusedScalarExpression::Operand> FusedScalarExpression::CompileExpression(
+    ExecState* exec_state, const plan::ScalarExpression& expr, const RowDescriptor& input_desc) {
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kColumn: {
+      int64_t idx = static_cast<const plan::Column&>(expr).Index();
+      if (idx < 0 || idx >= static_cast<int64_t>(input_desc.size())) {
+        return error::InvalidArgument("Column index $0 is out of range", idx);
+      }
+      switch (input_desc.type(idx)) {
+        case types::INT64:
+        case types::TIME64NS:
+          return Operand{true, idx, Kind::kInt64};
+        case types::FLOAT64:
+          return Operand{true, idx, Kind::kFloat64};
+        case types::BOOLEAN: {
+          // Booleans are bit packed, so they are unpacked into a register.
+          Instruction instr;
+          instr.code = OpCode::kLoadBool;
+          instr.args[0] = Operand{true, idx, Kind::kInt64};
+          instr.out = NewRegister(Kind::kInt64);
+          program_.push_back(instr);
+          return Operand{false, instr.out, Kind::kInt64};
+        }
+        default:
+          return error::Unimplemented("Can't fuse column $0 of type $1", idx,
+                                      types::ToString(input_desc.type(idx)));
+      }
+    }
+    case plan::Expression::kConstant: {
+      const auto& val = static_cast<const plan::ScalarValue&>(expr);
+      switch (val.DataType()) {
+        case types::BOOLEAN:
+        case types::INT64:
+        case types::TIME64NS: {
+          int64_t value = val.DataType() == types::BOOLEAN    ? val.BoolValue()
+                          : val.DataType() == types::INT64 ? val.Int64Value()
+                                                           : val.Time64NSValue();
+          int64_t reg = NewRegister(Kind::kInt64);
+          int64_constants_.emplace_back(reg, value);
+          return Operand{false, reg, Kind::kInt64};
+        }
+        case types::FLOAT64: {
+          int64_t reg = NewRegister(Kind::kFloat64);
+          float64_constants_.emplace_back(reg, val.Float64Value());
+          return Operand{false, reg, Kind::kFloat64};
+        }
+        default:
+          return error::Unimplemented("Can't fuse constants of type $0",
+                                      types::ToString(val.DataType()));
+      }
+    }
+    case plan::Expression::kFunc:
+      return CompileFunc(exec_state, static_cast<const plan::ScalarFunc&>(expr), input_desc);
+    default:
+      return error::Unimplemented("Can't fuse expression $0", expr.DebugString());
+  }
+}
+
+StatusOr<FusedScalarExpression::Operand> FusedScalarExpression::CompileFunc(
+    ExecState* exec_state, const plan::ScalarFunc& fn, const RowDescriptor& input_desc) {
+  auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+  if (def == nullptr) {
+    return error::NotFound("No UDF with id $0", fn.udf_id());
+  }
+  udf::FusedOp op = def->fused_op();
+  if (op == udf::FusedOp::kNone) {
+    return error::Unimplemented("UDF $0 can't be fused", fn.name());
+  }
+  if (!fn.init_arguments().empty()) {
+    return error::Unimplemented("UDF $0 has init arguments", fn.name());
+  }
+  const auto& arg_types = def->exec_arguments();
+  if (arg_types.size() != fn.arg_deps().size()) {
+    return error::InvalidArgument("UDF $0 expects $1 arguments, got $2", fn.name(),
+                                  arg_types.size(), fn.arg_deps().size());
+  }
+  types::DataType return_type = def->exec_return_type();
+  if (!IsFusableType(return_type)) {
+    return error::Unimplemented("UDF $0 returns $1", fn.name(), types::ToString(return_type));
+  }
+  Kind return_kind = return_type == types::FLOAT64 ? Kind::kFloat64 : Kind::kInt64;
+
+  std::vector<Operand> args;
+  bool has_bool_arg = false;
+  for (const auto& [idx, arg] : Enumerate(fn.arg_deps())) {
+    if (!IsFusableType(arg_types[idx])) {
+      return error::Unimplemented("UDF $0 takes $1", fn.name(), types::ToString(arg_types[idx]));
+    }
+    has_bool_arg |= arg_types[idx] == types::BOOLEAN;
+    PL_ASSIGN_OR_RETURN(Operand operand, CompileExpression(exec_state, *arg, input_desc));
+    Kind arg_kind = arg_types[idx] == types::FLOAT64 ? Kind::kFloat64 : Kind::kInt64;
+    if (operand.kind != arg_kind) {
+      return error::InvalidArgument("Argument $0 of UDF $1 has the wrong type", idx, fn.name());
+    }
+    args.push_back(operand);
+  }
+
+  bool unary = op == udf::FusedOp::kNegate || op == udf::FusedOp::kLogicalNot;
+  if (args.size() != (unary ? 1UL : 2UL)) {
+    return error::InvalidArgument("UDF $0 has $1 arguments", fn.name(), args.size());
+  }
+  // Comparisons and arithmetic on mixed arguments are done on doubles, like the UDFs do.
+  Kind kind = args[0].kind;
+  if (!unary && args[1].kind == Kind::kFloat64) {
+    kind = Kind::kFloat64;
+  }
+
+  Instruction instr;
+  instr.op = op;
+  if (op == udf::FusedOp::kLogicalAnd || op == udf::FusedOp::kLogicalOr ||
+      op == udf::FusedOp::kLogicalNot) {
+    if (kind != Kind::kInt64 || return_type != types::BOOLEAN) {
+      return error::Unimplemented("Can't fuse UDF $0 on doubles", fn.name());
+    }
+    instr.code = OpCode::kLogical;
+    kind = Kind::kInt64;
+  } else if (IsComparison(op)) {
+    if (return_type != types::BOOLEAN) {
+      return error::InvalidArgument("Comparison $0 doesn't return a boolean", fn.name());
+    }
+    instr.code = OpCode::kCompare;
+  } else {
+    if (has_bool_arg) {
+      return error::Unimplemented("Can't fuse arithmetic UDF $0 on booleans", fn.name());
+    }
+    // Division is done on the return type, which is always FLOAT64 for the builtins. Integer
+    // division isn't fused, since dividing by zero would trap rather than fail the query.
+    if (op == udf::FusedOp::kDivide) {
+      if (return_kind != Kind::kFloat64) {
+        return error::Unimplemented("Can't fuse integer division $0", fn.name());
+      }
+      kind = Kind::kFloat64;
+    }
+    instr.code = OpCode::kArithmetic;
+  }
+  instr.kind = kind;
+  for (const auto& [idx, arg] : Enumerate(args)) {
+    instr.args[idx] = Convert(arg, kind);
+  }
+
+  Kind out_kind = instr.code == OpCode::kArithmetic ? kind : Kind::kInt64;
+  instr.out = NewRegister(out_kind);
+  program_.push_back(instr);
+  return Convert(Operand{false, instr.out, out_kind}, return_kind);
+}
+
+void FusedScalarExpression::RunBlock(int64_t start, int64_t num_rows,
+                                     Registers* registers) const {
+  for (const auto& instr : program_) {
+    const Operand& a = instr.args[0];
+    const Operand& b = instr.args[1];
+    switch (instr.code) {
+      case OpCode::kLoadBool: {
+        const arrow::BooleanArray* arr = registers->bool_columns[a.index];
+        int64_t* out = registers->int64_register(instr.out);
+        for (int64_t i = 0; i < num_rows; ++i) {
+          out[i] = arr->Value(start + i);
+        }
+        break;
+      }
+      case OpCode::kToFloat64:
+        UnaryLoop(registers->int64_operand(a, start), registers->float64_register(instr.out),
+                  num_rows, [](int64_t x) { return static_cast<double>(x); });
+        break;
+      case OpCode::kToInt64:
+        UnaryLoop(registers->float64_operand(a, start), registers->int64_register(instr.out),
+                  num_rows, [](double x) { return static_cast<int64_t>(x); });
+        break;
+      case OpCode::kArithmetic:
+        if (instr.kind == Kind::kInt64) {
+          RunArithmetic(instr.op, registers->int64_operand(a, start),
+                        registers->int64_operand(b, start), registers->int64_register(instr.out),
+                        num_rows);
+        } else {
+          RunArithmetic(instr.op, registers->float64_operand(a, start),
+                        registers->float64_operand(b, start),
+                        registers->float64_register(instr.out), num_rows);
+        }
+        break;
+      case OpCode::kCompare:
+        if (instr.kind == Kind::kInt64) {
+          RunCompare(instr.op, registers->int64_operand(a, start),
+                     registers->int64_operand(b, start), registers->int64_register(instr.out),
+                     num_rows);
+        } else {
+          RunCompare(instr.op, registers->float64_operand(a, start),
+                     registers->float64_operand(b, start), registers->int64_register(instr.out),
+                     num_rows);
+        }
+        break;
+      case OpCode::kLogical:
+        RunLogical(instr.op, registers->int64_operand(a, start),
+                   registers->int64_operand(b, start), registers->int64_register(instr.out),
+                   num_rows);
+        break;
+    }
+  }
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> FusedScalarExpression::Evaluate(
+    const RowBatch& rb, arrow::MemoryPool* mem_pool) const {
+  Registers registers(*this, rb);
+  int64_t num_rows = rb.num_rows();
+  auto builder = types::MakeArrowBuilder(output_type_, mem_pool);
+  PL_RETURN_IF_ERROR(builder->Reserve(num_rows));
+
+  std::vector<uint8_t> bools;
+  if (output_type_ == types::BOOLEAN) {
+    bools.resize(kBlockSize);
+  }
+  for (int64_t start = 0; start < num_rows; start += kBlockSize) {
+    int64_t block_rows = std::min(kBlockSize, num_rows - start);
+    RunBlock(start, block_rows, &registers);
+    switch (output_type_) {
+      case types::FLOAT64:
+        PL_RETURN_IF_ERROR(static_cast<arrow::DoubleBuilder*>(builder.get())
+                               ->AppendValues(registers.float64_register(result_.index),
+                                              block_rows));
+        break;
+      case types::BOOLEAN: {
+        const int64_t* result = registers.int64_register(result_.index);
+        for (int64_t i = 0; i < block_rows; ++i) {
+          bools[i] = result[i] != 0;
+        }
+        PL_RETURN_IF_ERROR(static_cast<arrow::BooleanBuilder*>(builder.get())
+                               ->AppendValues(bools.data(), block_rows));
+        break;
+      }
+      default:
+        PL_RETURN_IF_ERROR(static_cast<arrow::Int64Builder*>(builder.get())
+                               ->AppendValues(registers.int64_register(result_.index),
+                                              block_rows));
+        break;
+    }
+  }
+
+  std::shared_ptr<arrow::Array> out;
+  PL_RETURN_IF_ERROR(builder->Finish(&out));
+  return out;
+}
+
+void FusedScalarExpression::Select(const RowBatch& rb, std::vector<int64_t>* selection) const {
+  DCHECK_EQ(output_type_, types::BOOLEAN);
+  Registers registers(*this, rb);
+  int64_t num_rows = rb.num_rows();
+  const std::vector<int64_t>& input_selection = rb.selection();
+  size_t next = 0;
+  for (int64_t start = 0; start < num_rows; start += kBlockSize) {
+    int64_t block_rows = std::min(kBlockSize, num_rows - start);
+    int64_t end = start + block_rows;
+    if (rb.has_selection()) {
+      if (next == input_selection.size()) {
+        break;
+      }
+      // Blocks without any selected row don't need to be evaluated.
+      if (input_selection[next] >= end) {
+        continue;
+      }
+    }
+    RunBlock(start, block_rows, &registers);
+    const int64_t* result = registers.int64_register(result_.index);
+    if (rb.has_selection()) {
+      for (; next < input_selection.size() && input_selection[next] < end; ++next) {
+        if (result[input_selection[next] - start]) {
+          selection->push_back(input_selection[next]);
+        }
+      }
+    } else {
+      for (int64_t i = 0; i < block_rows; ++i) {
+        if (result[i]) {
+          selection->push_back(start + i);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/scalar_expression.h"
+#include "src/carnot/udf/udf.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * FusedScalarExpression evaluates an expression tree of the builtin arithmetic, comparison and
+ * boolean UDFs (see udf::FusedOp) over fixed width columns and constants, without calling the
+ * UDFs.
+ *
+ * The tree is compiled into a list of typed instructions, which run over blocks of kBlockSize
+ * rows. Each instruction is a tight loop over a block, and the values of the sub-expressions live
+ * in block sized registers that stay in the L1 cache, rather than in a column per sub-expression.
+ */
+class FusedScalarExpression {
+ public:
+  static constexpr int64_t kBlockSize = 512;
+
+  /**
+   * Compiles the expression for batches with the given descriptor.
+   * @return nullptr if the expression isn't a function, or uses a function or a type that can't
+   * be fused.
+   */
+  static std::unique_ptr<FusedScalarExpression> Compile(
+      ExecState* exec_state, const plan::ScalarExpression& expr,
+      const table_store::schema::RowDescriptor& input_desc);
+
+  types::DataType output_type() const { return output_type_; }
+
+  /**
+   * Evaluates the expression for every row of the batch.
+   */
+  StatusOr<std::shared_ptr<arrow::Array>> Evaluate(const table_store::schema::RowBatch& rb,
+                                                   arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * Appends the rows of the batch (or of its selection) for which the boolean expression is true.
+   */
+  void Select(const table_store::schema::RowBatch& rb, std::vector<int64_t>* selection) const;
+
+ private:
+  // Booleans are kept as 0/1 int64 values, so that they share the instructions of integers.
+  enum class Kind : uint8_t {
+    kInt64,
+    kFloat64,
+  };
+
+  struct Operand {
+    bool is_column = false;
+    // The column index for columns, the register index otherwise.
+    int64_t index = 0;
+    Kind kind = Kind::kInt64;
+  };
+
+  enum class OpCode : uint8_t {
+    kLoadBool,
+    kToFloat64,
+    kToInt64,
+    kArithmetic,
+    kCompare,
+    kLogical,
+  };
+
+  struct Instruction {
+    OpCode code = OpCode::kArithmetic;
+    udf::FusedOp op = udf::FusedOp::kNone;
+    // The kind of the operands, which the result has too for arithmetic.
+    Kind kind = Kind::kInt64;
+    Operand args[2];
+    int64_t out = 0;
+  };
+
+  FusedScalarExpression() = default;
+
+  StatusOr<Operand> CompileExpression(ExecState* exec_state, const plan::ScalarExpression& expr,
+                                      const table_store::schema::RowDescriptor& input_desc);
+  StatusOr<Operand> CompileFunc(ExecState* exec_state, const plan::ScalarFunc& fn,
+                                const table_store::schema::RowDescriptor& input_desc);
+  Operand Convert(Operand operand, Kind kind);
+  int64_t NewRegister(Kind kind);
+
+  struct Registers;
+  void RunBlock(int64_t start, int64_t num_rows, Registers* registers) const;
+
+  std::vector<Instruction> program_;
+  int64_t num_int64_registers_ = 0;
+  int64_t num_float64_registers_ = 0;
+  std::vector<std::pair<int64_t, int64_t>> int64_constants_;
+  std::vector<std::pair<int64_t, double>> float64_constants_;
+  Operand result_;
+  types::DataType output_type_ = types::DATA_TYPE_UNKNOWN;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fused_expression.h"
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/plan/scalar_expression.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/test_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using types::BoolValue;
+using types::Float64Value;
+using types::Int64Value;
+using types::ToArrow;
+using udf::FunctionContext;
+
+class AddUDF : public udf::ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
+  static constexpr udf::FusedOp Fused() { return udf::FusedOp::kAdd; }
+};
+
+class MultiplyUDF : public udf::ScalarUDF {
+ public:
+  Float64Value Exec(FunctionContext*, Float64Value v1, Int64Value v2) { return v1.val * v2.val; }
+  static constexpr udf::FusedOp Fused() { return udf::FusedOp::kMultiply; }
+};
+
+class GreaterThanUDF : public udf::ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1 > v2; }
+  static constexpr udf::FusedOp Fused() { return udf::FusedOp::kGreaterThan; }
+};
+
+class LogicalAndUDF : public udf::ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, BoolValue v1, BoolValue v2) { return v1.val && v2.val; }
+  static constexpr udf::FusedOp Fused() { return udf::FusedOp::kLogicalAnd; }
+};
+
+// Doesn't opt in to fusion.
+class SubtractUDF : public udf::ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val - v2.val; }
+};
+
+// add(col0, add(col1, 1337))
+constexpr char kNestedAddPbtxt[] = R"(
+func {
+  name: "add"
+  id: 0
+  args { column { index: 0 } }
+  args {
+    func {
+      name: "add"
+      id: 0
+      args { column { index: 1 } }
+      args { constant { data_type: INT64 int64_value: 1337 } }
+    }
+  }
+})";
+
+// multiply(col2, col0)
+constexpr char kMultiplyPbtxt[] = R"(
+func {
+  name: "multiply"
+  id: 1
+  args { column { index: 2 } }
+  args { column { index: 0 } }
+})";
+
+// logicalAnd(greaterThan(col0, 500), col3)
+constexpr char kPredicatePbtxt[] = R"(
+func {
+  name: "logicalAnd"
+  id: 3
+  args {
+    func {
+      name: "greaterThan"
+      id: 2
+      args { column { index: 0 } }
+      args { constant { data_type: INT64 int64_value: 500 } }
+    }
+  }
+  args { column { index: 3 } }
+})";
+
+// add(col0, subtract(col1, col0))
+constexpr char kUnfusableArgPbtxt[] = R"(
+func {
+  name: "add"
+  id: 0
+  args { column { index: 0 } }
+  args {
+    func {
+      name: "subtract"
+      id: 4
+      args { column { index: 1 } }
+      args { column { index: 0 } }
+    }
+  }
+})";
+
+std::shared_ptr<plan::ScalarExpression> ScalarExpressionOf(const std::string& pbtxt) {
+  planpb::ScalarExpression se_pb;
+  EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(pbtxt, &se_pb));
+  auto s_or_se = plan::ScalarExpression::FromProto(se_pb);
+  EXPECT_OK(s_or_se);
+  return s_or_se.ConsumeValueOrDie();
+}
+
+class FusedScalarExpressionTest : public ::testing::Test {
+ protected:
+  // More rows than a block, so that the last block is partial.
+  static constexpr int64_t kNumRows = 2 * FusedScalarExpression::kBlockSize + 100;
+
+  void SetUp() override {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    ASSERT_OK(func_registry_->Register<AddUDF>("add"));
+    ASSERT_OK(func_registry_->Register<MultiplyUDF>("multiply"));
+    ASSERT_OK(func_registry_->Register<GreaterThanUDF>("greaterThan"));
+    ASSERT_OK(func_registry_->Register<LogicalAndUDF>("logicalAnd"));
+    ASSERT_OK(func_registry_->Register<SubtractUDF>("subtract"));
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(),
+                                              std::make_shared<table_store::TableStore>(),
+                                              MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+    ASSERT_OK(exec_state_->AddScalarUDF(0, "add", {types::INT64, types::INT64}));
+    ASSERT_OK(exec_state_->AddScalarUDF(1, "multiply", {types::FLOAT64, types::INT64}));
+    ASSERT_OK(exec_state_->AddScalarUDF(2, "greaterThan", {types::INT64, types::INT64}));
+    ASSERT_OK(exec_state_->AddScalarUDF(3, "logicalAnd", {types::BOOLEAN, types::BOOLEAN}));
+    ASSERT_OK(exec_state_->AddScalarUDF(4, "subtract", {types::INT64, types::INT64}));
+
+    std::vector<Int64Value> col0;
+    std::vector<Int64Value> col1;
+    std::vector<Float64Value> col2;
+    std::vector<BoolValue> col3;
+    for (int64_t i = 0; i < kNumRows; ++i) {
+      col0.push_back(i);
+      col1.push_back(2 * i);
+      col2.push_back(0.5 * i);
+      col3.push_back(i % 3 == 0);
+    }
+    input_rb_ = std::make_unique<RowBatch>(
+        RowDescriptor({types::INT64, types::INT64, types::FLOAT64, types::BOOLEAN}), kNumRows);
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(col0, arrow::default_memory_pool())));
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(col1, arrow::default_memory_pool())));
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(col2, arrow::default_memory_pool())));
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(col3, arrow::default_memory_pool())));
+  }
+
+  std::unique_ptr<FusedScalarExpression> Compile(const std::string& pbtxt) {
+    return FusedScalarExpression::Compile(exec_state_.get(), *ScalarExpressionOf(pbtxt),
+                                          input_rb_->desc());
+  }
+
+  std::unique_ptr<udf::Registry> func_registry_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<RowBatch> input_rb_;
+};
+
+TEST_F(FusedScalarExpressionTest, nested_arithmetic) {
+  auto fused = Compile(kNestedAddPbtxt);
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ(types::INT64, fused->output_type());
+
+  ASSERT_OK_AND_ASSIGN(auto out, fused->Evaluate(*input_rb_, arrow::default_memory_pool()));
+  ASSERT_EQ(kNumRows, out->length());
+  auto values = std::static_pointer_cast<arrow::Int64Array>(out);
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    EXPECT_EQ(3 * i + 1337, values->Value(i));
+  }
+}
+
+TEST_F(FusedScalarExpressionTest, mixed_types) {
+  auto fused = Compile(kMultiplyPbtxt);
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ(types::FLOAT64, fused->output_type());
+
+  ASSERT_OK_AND_ASSIGN(auto out, fused->Evaluate(*input_rb_, arrow::default_memory_pool()));
+  ASSERT_EQ(kNumRows, out->length());
+  auto values = std::static_pointer_cast<arrow::DoubleArray>(out);
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    EXPECT_DOUBLE_EQ(0.5 * i * i, values->Value(i));
+  }
+}
+
+TEST_F(FusedScalarExpressionTest, boolean_predicate) {
+  auto fused = Compile(kPredicatePbtxt);
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ(types::BOOLEAN, fused->output_type());
+
+  ASSERT_OK_AND_ASSIGN(auto out, fused->Evaluate(*input_rb_, arrow::default_memory_pool()));
+  ASSERT_EQ(kNumRows, out->length());
+  auto values = std::static_pointer_cast<arrow::BooleanArray>(out);
+  std::vector<int64_t> expected;
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    bool pass = i > 500 && i % 3 == 0;
+    EXPECT_EQ(pass, values->Value(i));
+    if (pass) {
+      expected.push_back(i);
+    }
+  }
+
+  std::vector<int64_t> selection;
+  fused->Select(*input_rb_, &selection);
+  EXPECT_EQ(expected, selection);
+}
+
+TEST_F(FusedScalarExpressionTest, select_narrows_selection) {
+  auto fused = Compile(kPredicatePbtxt);
+  ASSERT_NE(nullptr, fused);
+
+  // Only the even rows in the last block are selected, so the first blocks are skipped.
+  std::vector<int64_t> input_selection;
+  std::vector<int64_t> expected;
+  for (int64_t i = 2 * FusedScalarExpression::kBlockSize; i < kNumRows; i += 2) {
+    input_selection.push_back(i);
+    if (i % 3 == 0) {
+      expected.push_back(i);
+    }
+  }
+  input_rb_->set_selection(input_selection);
+
+  std::vector<int64_t> selection;
+  fused->Select(*input_rb_, &selection);
+  EXPECT_EQ(expected, selection);
+}
+
+TEST_F(FusedScalarExpressionTest, not_fusable) {
+  // A UDF that doesn't opt in can't be fused, even below one that does.
+  EXPECT_EQ(nullptr, Compile(kUnfusableArgPbtxt));
+  // Nor can columns and constants on their own, which are cheap already.
+  EXPECT_EQ(nullptr, Compile(R"(column { index: 0 })"));
+  EXPECT_EQ(nullptr, Compile(R"(constant { data_type: INT64 int64_value: 1 })"));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,295 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/group_key_hash_table.h"
+
+#include <farmhash.h>
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "src/common/base/hash_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+constexpr uint64_t kHashSeed = 0x5bd1e9955bd1e995ULL;
+constexpr size_t kInitialNumSlots = 1024;
+
+size_t NumWordsForType(types::DataType dt) { return dt == types::UINT128 ? 2 : 1; }
+
+// Encodes a fixed-width key column into one (or two, for UINT128) 64-bit words per row.
+template <types::DataType DT>
+void EncodeFixedColumn(const arrow::Array* col, int64_t num_rows, uint64_t* words0,
+                       uint64_t* words1) {
+  if constexpr (DT == types::STRING) {
+    LOG(DFATAL) << "String keys can't be encoded as fixed-width words";
+  } else {
+    for (int64_t i = 0; i < num_rows; ++i) {
+      auto val = types::GetValueFromArrowArray<DT>(col, i);
+      if constexpr (DT == types::UINT128) {
+        words0[i] = absl::Uint128Low64(val);
+        words1[i] = absl::Uint128High64(val);
+      } else if constexpr (DT == types::FLOAT64) {
+        memcpy(&words0[i], &val, sizeof(uint64_t));
+      } else {
+        words0[i] = static_cast<uint64_t>(val);
+      }
+      PL_UNUSED(words1);
+    }
+  }
+}
+
+// Decodes the stored words of a fixed-width key column back into an arrow array.
+template <types::DataType DT>
+Status DecodeFixedColumn(const std::vector<uint64_t>& words0, const std::vector<uint64_t>* words1,
+                         int64_t num_groups, arrow::ArrayBuilder* builder) {
+  if constexpr (DT == types::STRING) {
+    return error::Internal("String keys can't be decoded from fixed-width words");
+  } else {
+    using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
+    auto* typed_builder = static_cast<ArrowBuilder*>(builder);
+    PL_RETURN_IF_ERROR(typed_builder->Reserve(num_groups));
+    for (int64_t i = 0; i < num_groups; ++i) {
+      if constexpr (DT == types::UINT128) {
+        typed_builder->UnsafeAppend(absl::MakeUint128((*words1)[i], words0[i]));
+      } else if constexpr (DT == types::FLOAT64) {
+        double val;
+        memcpy(&val, &words0[i], sizeof(double));
+        typed_builder->UnsafeAppend(val);
+      } else if constexpr (DT == types::BOOLEAN) {
+        typed_builder->UnsafeAppend(words0[i] != 0);
+      } else {
+        typed_builder->UnsafeAppend(static_cast<int64_t>(words0[i]));
+      }
+    }
+    PL_UNUSED(words1);
+    return Status::OK();
+  }
+}
+
+}  // namespace
+
+bool GroupKeyHashTable::SupportsKeyTypes(const std::vector<types::DataType>& key_types) {
+  if (key_types.empty()) {
+    return false;
+  }
+  if (key_types.size() == 1 && key_types[0] == types::STRING) {
+    return true;
+  }
+  if (key_types.size() > kMaxFixedKeys) {
+    return false;
+  }
+  for (const auto& dt : key_types) {
+    switch (dt) {
+      case types::BOOLEAN:
+      case types::INT64:
+      case types::UINT128:
+      case types::TIME64NS:
+      case types::FLOAT64:
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+GroupKeyHashTable::GroupKeyHashTable(std::vector<types::DataType> key_types)
+    : key_types_(std::move(key_types)) {
+  DCHECK(SupportsKeyTypes(key_types_));
+  if (!is_string_key()) {
+    for (const auto& dt : key_types_) {
+      key_word_offsets_.push_back(num_key_words_);
+      num_key_words_ += NumWordsForType(dt);
+    }
+    key_words_.resize(num_key_words_);
+    batch_words_.resize(num_key_words_);
+  }
+  Clear();
+}
+
+void GroupKeyHashTable::Clear() {
+  for (auto& words : key_words_) {
+    words.clear();
+  }
+  string_arena_.clear();
+  string_offsets_.assign(1, 0);
+  group_hashes_.clear();
+  num_groups_ = 0;
+  slots_.assign(kInitialNumSlots, kEmptySlot);
+  slot_mask_ = kInitialNumSlots - 1;
+}
+
+void GroupKeyHashTable::EncodeAndHashBatch(const std::vector<const arrow::Array*>& key_cols,
+                                           int64_t num_rows) {
+  batch_hashes_.resize(num_rows);
+  if (is_string_key()) {
+    batch_string_col_ = static_cast<const arrow::StringArray*>(key_cols[0]);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      int32_t len;
+      const uint8_t* data = batch_string_col_->GetValue(i, &len);
+      batch_hashes_[i] = ::util::Hash64(reinterpret_cast<const char*>(data), len);
+    }
+    return;
+  }
+
+  for (size_t col_idx = 0; col_idx < key_types_.size(); ++col_idx) {
+    size_t offset = key_word_offsets_[col_idx];
+    batch_words_[offset].resize(num_rows);
+    uint64_t* words1 = nullptr;
+    if (NumWordsForType(key_types_[col_idx]) == 2) {
+      batch_words_[offset + 1].resize(num_rows);
+      words1 = batch_words_[offset + 1].data();
+    }
+    uint64_t* words0 = batch_words_[offset].data();
+    const arrow::Array* col = key_cols[col_idx];
+#define TYPE_CASE(_dt_) EncodeFixedColumn<_dt_>(col, num_rows, words0, words1);
+    PL_SWITCH_FOREACH_DATATYPE(key_types_[col_idx], TYPE_CASE);
+#undef TYPE_CASE
+  }
+
+  // Hash word by word so each pass runs over a contiguous array.
+  std::fill(batch_hashes_.begin(), batch_hashes_.end(), kHashSeed);
+  for (const auto& words : batch_words_) {
+    for (int64_t i = 0; i < num_rows; ++i) {
+      batch_hashes_[i] = ::px::HashCombine(batch_hashes_[i], words[i]);
+    }
+  }
+}
+
+bool GroupKeyHashTable::KeyEquals(int64_t group_id, int64_t row) const {
+  if (is_string_key()) {
+    int32_t len;
+    const uint8_t* data = batch_string_col_->GetValue(row, &len);
+    int64_t start = string_offsets_[group_id];
+    int64_t stored_len = string_offsets_[group_id + 1] - start;
+    return stored_len == len && memcmp(string_arena_.data() + start, data, len) == 0;
+  }
+  for (size_t w = 0; w < num_key_words_; ++w) {
+    if (key_words_[w][group_id] != batch_words_[w][row]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int64_t GroupKeyHashTable::InsertKey(int64_t row, uint64_t hash) {
+  int64_t group_id = num_groups_++;
+  if (is_string_key()) {
+    int32_t len;
+    const uint8_t* data = batch_string_col_->GetValue(row, &len);
+    string_arena_.append(reinterpret_cast<const char*>(data), len);
+    string_offsets_.push_back(string_arena_.size());
+  } else {
+    for (size_t w = 0; w < num_key_words_; ++w) {
+      key_words_[w].push_back(batch_words_[w][row]);
+    }
+  }
+  group_hashes_.push_back(hash);
+  return group_id;
+}
+
+void GroupKeyHashTable::Grow() {
+  size_t new_size = slots_.size() * 2;
+  slots_.assign(new_size, kEmptySlot);
+  slot_mask_ = new_size - 1;
+  for (int64_t group_id = 0; group_id < num_groups_; ++group_id) {
+    uint64_t slot = group_hashes_[group_id] & slot_mask_;
+    while (slots_[slot] != kEmptySlot) {
+      slot = (slot + 1) & slot_mask_;
+    }
+    slots_[slot] = group_id;
+  }
+}
+
+int64_t GroupKeyHashTable::FindOrInsertBatch(const std::vector<const arrow::Array*>& key_cols,
+                                             std::vector<int64_t>* group_ids) {
+  DCHECK_EQ(key_cols.size(), key_types_.size());
+  int64_t num_rows = key_cols.empty() ? 0 : key_cols[0]->length();
+  group_ids->resize(num_rows);
+  EncodeAndHashBatch(key_cols, num_rows);
+
+  int64_t num_inserted = 0;
+  for (int64_t row = 0; row < num_rows; ++row) {
+    // Keep the load factor at or below 1/2.
+    if (static_cast<size_t>(num_groups_ + 1) * 2 > slots_.size()) {
+      Grow();
+    }
+    uint64_t hash = batch_hashes_[row];
+    uint64_t slot = hash & slot_mask_;
+    while (true) {
+      int64_t group_id = slots_[slot];
+      if (group_id == kEmptySlot) {
+        group_id = InsertKey(row, hash);
+        slots_[slot] = group_id;
+        ++num_inserted;
+        (*group_ids)[row] = group_id;
+        break;
+      }
+      if (group_hashes_[group_id] == hash && KeyEquals(group_id, row)) {
+        (*group_ids)[row] = group_id;
+        break;
+      }
+      slot = (slot + 1) & slot_mask_;
+    }
+  }
+  batch_string_col_ = nullptr;
+  return num_inserted;
+}
+
+StatusOr<std::vector<std::shared_ptr<arrow::Array>>> GroupKeyHashTable::KeysToArrow(
+    arrow::MemoryPool* mem_pool) const {
+  std::vector<std::shared_ptr<arrow::Array>> arrays;
+  for (size_t col_idx = 0; col_idx < key_types_.size(); ++col_idx) {
+    auto dt = key_types_[col_idx];
+    auto builder = types::MakeArrowBuilder(dt, mem_pool);
+    if (is_string_key()) {
+      auto* string_builder = static_cast<arrow::StringBuilder*>(builder.get());
+      PL_RETURN_IF_ERROR(string_builder->Reserve(num_groups_));
+      PL_RETURN_IF_ERROR(string_builder->ReserveData(string_arena_.size()));
+      for (int64_t i = 0; i < num_groups_; ++i) {
+        string_builder->UnsafeAppend(string_arena_.data() + string_offsets_[i],
+                                     string_offsets_[i + 1] - string_offsets_[i]);
+      }
+    } else {
+      size_t offset = key_word_offsets_[col_idx];
+      const std::vector<uint64_t>* words1 =
+          NumWordsForType(dt) == 2 ? &key_words_[offset + 1] : nullptr;
+#define TYPE_CASE(_dt_)        \
+  PL_RETURN_IF_ERROR(          \
+      DecodeFixedColumn<_dt_>(key_words_[offset], words1, num_groups_, builder.get()));
+      PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+    }
+    std::shared_ptr<arrow::Array> arr;
+    PL_RETURN_IF_ERROR(builder->Finish(&arr));
+    arrays.push_back(std::move(arr));
+  }
+  return arrays;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
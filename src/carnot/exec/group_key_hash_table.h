@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * GroupKeyHashTable maps group-by keys to dense group ids (0, 1, 2, ... in insertion order).
+ *
+ * It is a specialized alternative to a RowTuple keyed hash map for the common key shapes: up to
+ * kMaxFixedKeys fixed-width columns, or a single string column. Fixed-width keys are encoded into
+ * 64-bit words and stored column-wise, string keys are stored back to back in a single arena, so
+ * there is no per-key allocation. Lookups run a batch at a time: all the keys of the batch are
+ * encoded and hashed in one pass, and then probed against an open-addressing (linear probing)
+ * table of group ids.
+ */
+class GroupKeyHashTable : public NotCopyable {
+ public:
+  static constexpr size_t kMaxFixedKeys = 4;
+
+  /**
+   * Returns true if the given key types can be handled by this hash table.
+   */
+  static bool SupportsKeyTypes(const std::vector<types::DataType>& key_types);
+
+  explicit GroupKeyHashTable(std::vector<types::DataType> key_types);
+
+  /**
+   * Looks up the group id of every row in the key columns, inserting the keys that are not yet
+   * present.
+   * @param key_cols The key columns, one per key type. They must all have the same length.
+   * @param group_ids Output, resized to the number of rows and filled with the group ids.
+   * @return the number of groups inserted by this call.
+   */
+  int64_t FindOrInsertBatch(const std::vector<const arrow::Array*>& key_cols,
+                            std::vector<int64_t>* group_ids);
+
+  /**
+   * Converts the stored keys to arrow arrays, one per key column, ordered by group id.
+   */
+  StatusOr<std::vector<std::shared_ptr<arrow::Array>>> KeysToArrow(
+      arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * @return the number of distinct groups in the table.
+   */
+  int64_t num_groups() const { return num_groups_; }
+
+  /**
+   * Removes all of the groups, while keeping the allocated memory around.
+   */
+  void Clear();
+
+ private:
+  bool is_string_key() const { return key_types_.size() == 1 && key_types_[0] == types::STRING; }
+
+  void EncodeAndHashBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows);
+  bool KeyEquals(int64_t group_id, int64_t row) const;
+  int64_t InsertKey(int64_t row, uint64_t hash);
+  void Grow();
+
+  std::vector<types::DataType> key_types_;
+  // The word offset of each key column in the encoded key (UINT128 keys use two words).
+  std::vector<size_t> key_word_offsets_;
+  size_t num_key_words_ = 0;
+
+  // Stored keys. For fixed keys there is one vector per encoded word, indexed by group id.
+  std::vector<std::vector<uint64_t>> key_words_;
+  // For string keys, the key of group i is string_arena_[string_offsets_[i], string_offsets_[i+1]).
+  std::string string_arena_;
+  std::vector<int64_t> string_offsets_;
+  std::vector<uint64_t> group_hashes_;
+  int64_t num_groups_ = 0;
+
+  // Open-addressing slots holding group ids, or kEmptySlot.
+  static constexpr int64_t kEmptySlot = -1;
+  std::vector<int64_t> slots_;
+  uint64_t slot_mask_ = 0;
+
+  // Scratch space for the batch being processed.
+  std::vector<std::vector<uint64_t>> batch_words_;
+  std::vector<uint64_t> batch_hashes_;
+  const arrow::StringArray* batch_string_col_ = nullptr;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
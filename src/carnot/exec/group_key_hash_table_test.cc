@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/group_key_hash_table.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(GroupKeyHashTableTest, supported_key_types) {
+  EXPECT_TRUE(GroupKeyHashTable::SupportsKeyTypes({types::INT64}));
+  EXPECT_TRUE(GroupKeyHashTable::SupportsKeyTypes({types::STRING}));
+  EXPECT_TRUE(GroupKeyHashTable::SupportsKeyTypes(
+      {types::BOOLEAN, types::UINT128, types::TIME64NS, types::FLOAT64}));
+  EXPECT_FALSE(GroupKeyHashTable::SupportsKeyTypes({}));
+  EXPECT_FALSE(GroupKeyHashTable::SupportsKeyTypes({types::STRING, types::INT64}));
+  EXPECT_FALSE(GroupKeyHashTable::SupportsKeyTypes(
+      {types::INT64, types::INT64, types::INT64, types::INT64, types::INT64}));
+}
+
+TEST(GroupKeyHashTableTest, fixed_keys) {
+  GroupKeyHashTable table({types::INT64, types::BOOLEAN, types::UINT128});
+
+  auto col1 = types::ToArrow(std::vector<types::Int64Value>({1, 2, 1, 1}),
+                             arrow::default_memory_pool());
+  auto col2 = types::ToArrow(std::vector<types::BoolValue>({true, true, true, false}),
+                             arrow::default_memory_pool());
+  auto col3 = types::ToArrow(
+      std::vector<types::UInt128Value>({absl::MakeUint128(1, 2), absl::MakeUint128(1, 2),
+                                        absl::MakeUint128(1, 2), absl::MakeUint128(1, 2)}),
+      arrow::default_memory_pool());
+
+  std::vector<int64_t> group_ids;
+  EXPECT_EQ(3, table.FindOrInsertBatch({col1.get(), col2.get(), col3.get()}, &group_ids));
+  EXPECT_EQ(std::vector<int64_t>({0, 1, 0, 2}), group_ids);
+
+  auto col4 = types::ToArrow(
+      std::vector<types::UInt128Value>({absl::MakeUint128(1, 2), absl::MakeUint128(3, 2),
+                                        absl::MakeUint128(1, 2), absl::MakeUint128(1, 2)}),
+      arrow::default_memory_pool());
+  EXPECT_EQ(1, table.FindOrInsertBatch({col1.get(), col2.get(), col4.get()}, &group_ids));
+  EXPECT_EQ(std::vector<int64_t>({0, 3, 0, 2}), group_ids);
+  EXPECT_EQ(4, table.num_groups());
+
+  ASSERT_OK_AND_ASSIGN(auto keys, table.KeysToArrow(arrow::default_memory_pool()));
+  ASSERT_EQ(3, keys.size());
+  EXPECT_TRUE(keys[0]->Equals(types::ToArrow(std::vector<types::Int64Value>({1, 2, 1, 2}),
+                                             arrow::default_memory_pool())));
+  EXPECT_TRUE(keys[1]->Equals(types::ToArrow(
+      std::vector<types::BoolValue>({true, true, false, true}), arrow::default_memory_pool())));
+  EXPECT_TRUE(keys[2]->Equals(types::ToArrow(
+      std::vector<types::UInt128Value>({absl::MakeUint128(1, 2), absl::MakeUint128(1, 2),
+                                        absl::MakeUint128(1, 2), absl::MakeUint128(3, 2)}),
+      arrow::default_memory_pool())));
+
+  table.Clear();
+  EXPECT_EQ(0, table.num_groups());
+}
+
+TEST(GroupKeyHashTableTest, string_key) {
+  GroupKeyHashTable table({types::STRING});
+
+  auto col = types::ToArrow(std::vector<types::StringValue>({"abc", "", "def", "abc", ""}),
+                            arrow::default_memory_pool());
+  std::vector<int64_t> group_ids;
+  EXPECT_EQ(3, table.FindOrInsertBatch({col.get()}, &group_ids));
+  EXPECT_EQ(std::vector<int64_t>({0, 1, 2, 0, 1}), group_ids);
+
+  ASSERT_OK_AND_ASSIGN(auto keys, table.KeysToArrow(arrow::default_memory_pool()));
+  ASSERT_EQ(1, keys.size());
+  EXPECT_TRUE(keys[0]->Equals(types::ToArrow(std::vector<types::StringValue>({"abc", "", "def"}),
+                                             arrow::default_memory_pool())));
+}
+
+TEST(GroupKeyHashTableTest, grows_past_initial_size) {
+  GroupKeyHashTable table({types::INT64});
+
+  std::vector<types::Int64Value> values;
+  for (int64_t i = 0; i < 10000; ++i) {
+    values.emplace_back(i % 5000);
+  }
+  auto col = types::ToArrow(values, arrow::default_memory_pool());
+  std::vector<int64_t> group_ids;
+  EXPECT_EQ(5000, table.FindOrInsertBatch({col.get()}, &group_ids));
+  for (int64_t i = 0; i < 10000; ++i) {
+    EXPECT_EQ(i % 5000, group_ids[i]);
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -31,10 +31,17 @@
 #include "src/common/base/base.h"
 #include "src/common/uuid/uuid.h"
 
+DEFINE_int64(carnot_grpc_router_query_buffer_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_GRPC_ROUTER_QUERY_BUFFER_BYTES", 256 * 1024 * 1024),
+             "The bytes of received row batches that a query can hold before its result streams "
+             "stop reading and the remote sinks are slowed down. 0 disables the limit.");
+
 namespace px {
 namespace carnot {
 namespace exec {
 
+GRPCRouter::GRPCRouter() : GRPCRouter(FLAGS_carnot_grpc_router_query_buffer_bytes) {}
+
 GRPCRouter::SourceNodeTracker* GRPCRouter::GetSourceNodeTracker(QueryTracker* query_tracker,
                                                                 int64_t source_id) {
   absl::base_internal::SpinLockHolder query_lock(&query_tracker->query_lock);
@@ -43,7 +50,8 @@ GRPCRouter::SourceNodeTracker* GRPCRouter::GetSourceNodeTracker(QueryTracker* qu
 
 Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
                                    std::unique_ptr<carnotpb::TransferResultChunkRequest> req) {
-  if (!req->has_query_result() || !req->query_result().has_row_batch() ||
+  if (!req->has_query_result() ||
+      !(req->query_result().has_row_batch() || req->query_result().has_flat_row_batch()) ||
       req->query_result().destination_case() !=
           carnotpb::TransferResultChunkRequest_SinkResult::DestinationCase::kGrpcSourceId) {
     return error::Internal(
@@ -51,7 +59,17 @@ Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
         "with a GPRC source ID.");
   }
 
-  auto snt = GetSourceNodeTracker(query_tracker, req->query_result().grpc_source_id());
+  int64_t source_id = req->query_result().grpc_source_id();
+  // The source node releases the bytes when it consumes the batch, using the size cached here.
+  int64_t num_bytes = req->ByteSizeLong();
+  {
+    absl::MutexLock lock(&query_tracker->buffer_lock);
+    query_tracker->buffered_bytes += num_bytes;
+    query_tracker->source_buffered_bytes[source_id] += num_bytes;
+  }
+
+  auto snt = GetSourceNodeTracker(query_tracker, source_id);
+  Status s;
   {
     absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
     // It's possible that we see row batches before we have gotten information about the query. To
@@ -60,12 +78,52 @@ Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
       snt->response_backlog.emplace_back(std::move(req));
       return Status::OK();
     }
-    PL_RETURN_IF_ERROR(snt->source_node->EnqueueRowBatch(std::move(req)));
+    s = snt->source_node->EnqueueRowBatch(std::move(req));
+  }
+  if (!s.ok()) {
+    ReleaseBufferedBytes(query_tracker, source_id, num_bytes);
+    return s;
   }
   query_tracker->RestartExecution();
   return Status::OK();
 }
 
+void GRPCRouter::WaitForBufferSpace(QueryTracker* query_tracker, int64_t source_id,
+                                    ::grpc::ServerContext* context) {
+  if (max_query_buffer_bytes_ <= 0) {
+    return;
+  }
+  absl::MutexLock lock(&query_tracker->buffer_lock);
+  auto over_budget = [&]() {
+    if (query_tracker->deleted || query_tracker->buffered_bytes < max_query_buffer_bytes_) {
+      return false;
+    }
+    // A source with nothing buffered can always get a batch in, so that a query that waits on
+    // one of its sources can't deadlock on the batches of the others.
+    auto it = query_tracker->source_buffered_bytes.find(source_id);
+    return it != query_tracker->source_buffered_bytes.end() && it->second > 0;
+  };
+  while (over_budget() && !context->IsCancelled()) {
+    // Cancellation of the stream isn't signaled on the condition variable, so check periodically.
+    query_tracker->buffer_released.WaitWithTimeout(&query_tracker->buffer_lock,
+                                                   absl::Milliseconds(100));
+  }
+}
+
+void GRPCRouter::ReleaseBufferedBytes(QueryTracker* query_tracker, int64_t source_id,
+                                      int64_t num_bytes) {
+  absl::MutexLock lock(&query_tracker->buffer_lock);
+  auto it = query_tracker->source_buffered_bytes.find(source_id);
+  // The source was deleted, and its bytes released already.
+  if (it == query_tracker->source_buffered_bytes.end()) {
+    return;
+  }
+  num_bytes = std::min(num_bytes, it->second);
+  it->second -= num_bytes;
+  query_tracker->buffered_bytes -= num_bytes;
+  query_tracker->buffer_released.SignalAll();
+}
+
 Status GRPCRouter::MarkResultStreamInitiated(QueryTracker* query_tracker, int64_t source_id) {
   auto snt = GetSourceNodeTracker(query_tracker, source_id);
   absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
@@ -169,12 +227,17 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
                            absl::Substitute("Failed to record stats w/ err: $0", s.msg()));
         break;
       }
-    } else if (rb->has_query_result() && rb->query_result().has_row_batch()) {
+    } else if (rb->has_query_result() && (rb->query_result().has_row_batch() ||
+                                          rb->query_result().has_flat_row_batch())) {
+      auto batch_source_id = rb->query_result().grpc_source_id();
       auto s = EnqueueRowBatch(query_tracker.get(), std::move(rb));
       if (!s.ok()) {
         result_status = ::grpc::Status(grpc::StatusCode::INTERNAL, "failed to enqueue batch");
         break;
       }
+      // Stop reading from the stream while the query is over its budget, so that the remote sink
+      // is slowed down by gRPC flow control.
+      WaitForBufferSpace(query_tracker.get(), batch_source_id, context);
     } else if (rb->has_query_result() && rb->query_result().initiate_result_stream()) {
       if (rb->query_result().destination_case() !=
           carnotpb::TransferResultChunkRequest_SinkResult::DestinationCase::kGrpcSourceId) {
@@ -265,6 +328,9 @@ Status GRPCRouter::AddGRPCSourceNode(sole::uuid query_id, int64_t source_id,
     absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
     query_tracker->restart_execution_func_ = std::move(restart_execution);
   }
+  source_node->set_batch_consumed_callback([query_tracker, source_id](int64_t num_bytes) {
+    ReleaseBufferedBytes(query_tracker.get(), source_id, num_bytes);
+  });
   auto snt = GetSourceNodeTracker(query_tracker.get(), source_id);
 
   absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
@@ -320,6 +386,17 @@ Status GRPCRouter::DeleteGRPCSourceNode(sole::uuid query_id, int64_t source_id)
     query_tracker = query_node_map_[query_id];
   }
 
+  {
+    // The batches that the source didn't consume are dropped along with it.
+    absl::MutexLock lock(&query_tracker->buffer_lock);
+    auto it = query_tracker->source_buffered_bytes.find(source_id);
+    if (it != query_tracker->source_buffered_bytes.end()) {
+      query_tracker->buffered_bytes -= it->second;
+      query_tracker->source_buffered_bytes.erase(it);
+      query_tracker->buffer_released.SignalAll();
+    }
+  }
+
   absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
   auto it = query_tracker->source_node_trackers.find(source_id);
   if (it == query_tracker->source_node_trackers.end()) {
@@ -344,6 +421,12 @@ void GRPCRouter::DeleteQuery(sole::uuid query_id) {
     query_tracker = it->second;
     query_node_map_.erase(it);
   }
+  {
+    // Wake up the result streams that are waiting on the query's budget.
+    absl::MutexLock lock(&query_tracker->buffer_lock);
+    query_tracker->deleted = true;
+    query_tracker->buffer_released.SignalAll();
+  }
   absl::base_internal::SpinLockHolder lock(&query_tracker->query_lock);
   query_tracker->ResetRestartExecutionFunc();
   // For any active input streams for this query, mark their context as cancelled.
@@ -357,6 +440,20 @@ size_t GRPCRouter::NumQueriesTracking() const {
   return query_node_map_.size();
 }
 
+int64_t GRPCRouter::QueryBufferedBytes(const sole::uuid& query_id) const {
+  std::shared_ptr<QueryTracker> query_tracker;
+  {
+    absl::base_internal::SpinLockHolder lock(&query_node_map_lock_);
+    auto it = query_node_map_.find(query_id);
+    if (it == query_node_map_.end()) {
+      return 0;
+    }
+    query_tracker = it->second;
+  }
+  absl::MutexLock lock(&query_tracker->buffer_lock);
+  return query_tracker->buffered_bytes;
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
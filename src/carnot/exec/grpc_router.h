@@ -30,6 +30,7 @@
 #include <absl/container/flat_hash_set.h>
 #include <absl/container/node_hash_map.h>
 #include <absl/hash/hash.h>
+#include <absl/synchronization/mutex.h>
 #include <grpcpp/grpcpp.h>
 #include <sole.hpp>
 
@@ -48,9 +49,18 @@ class GRPCSourceNode;
 /**
  * GRPCRouter tracks incoming Kelvin connections and routes them to the appropriate Carnot source
  * node.
+ *
+ * The row batches that a query received but hasn't consumed yet are bounded by a per query budget.
+ * Once a query is over its budget, its result streams stop reading from the network until the
+ * source nodes catch up, which closes the HTTP/2 flow control window of the streams and blocks
+ * the writes of the remote sinks, instead of buffering their results without bound.
  */
 class GRPCRouter final : public carnotpb::ResultSinkService::Service {
  public:
+  GRPCRouter();
+  explicit GRPCRouter(int64_t max_query_buffer_bytes)
+      : max_query_buffer_bytes_(max_query_buffer_bytes) {}
+
   /**
    * TransferResultChunk implements the RPC method.
    */
@@ -104,6 +114,12 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
    */
   size_t NumQueriesTracking() const;
 
+  /**
+   * @return the bytes of row batches that the query received but its source nodes haven't
+   * consumed yet.
+   */
+  int64_t QueryBufferedBytes(const sole::uuid& query_id) const;
+
  private:
   /**
    * SourceNodeTracker is responsible for tracking a single source node and the backlog of messages
@@ -134,6 +150,14 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     std::vector<queryresultspb::AgentExecutionStats> agent_exec_stats GUARDED_BY(query_lock);
     absl::base_internal::SpinLock query_lock;
 
+    // The bytes of row batches received but not consumed yet, in total and per source node.
+    // Guarded by a mutex rather than the spinlocks, since result streams wait on it.
+    absl::Mutex buffer_lock;
+    absl::CondVar buffer_released;
+    int64_t buffered_bytes ABSL_GUARDED_BY(buffer_lock) = 0;
+    absl::flat_hash_map<int64_t, int64_t> source_buffered_bytes ABSL_GUARDED_BY(buffer_lock);
+    bool deleted ABSL_GUARDED_BY(buffer_lock) = false;
+
     void ResetRestartExecutionFunc() ABSL_EXCLUSIVE_LOCKS_REQUIRED(query_lock) {
       restart_execution_func_ = std::function<void()>();
     }
@@ -161,6 +185,14 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
                                          ::grpc::ServerContext* context);
   SourceNodeTracker* GetSourceNodeTracker(QueryTracker* query_tracker, int64_t source_id);
 
+  // Waits until the query is back under its buffer budget, or the source has nothing buffered.
+  void WaitForBufferSpace(QueryTracker* query_tracker, int64_t source_id,
+                          ::grpc::ServerContext* context);
+  static void ReleaseBufferedBytes(QueryTracker* query_tracker, int64_t source_id,
+                                   int64_t num_bytes);
+
+  const int64_t max_query_buffer_bytes_;
+
   absl::node_hash_map<sole::uuid, std::shared_ptr<QueryTracker>> query_node_map_
       GUARDED_BY(query_node_map_lock_);
   mutable absl::base_internal::SpinLock query_node_map_lock_;
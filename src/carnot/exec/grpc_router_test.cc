@@ -799,6 +799,95 @@ TEST_F(GRPCRouterTest, continue_func_segfault) {
   server_->Shutdown();
 }
 
+class GRPCRouterFlowControlTest : public GRPCRouterTest {
+ protected:
+  // Any batch puts the query over budget, so each stream only has one batch in flight.
+  GRPCRouterFlowControlTest() { service_ = std::make_unique<GRPCRouter>(1); }
+};
+
+TEST_F(GRPCRouterFlowControlTest, blocks_streams_over_budget) {
+  uint64_t ab = 0xea8aa095697f49f1, cd = 0xb127d50e5b6e2645;
+  auto query_uuid = sole::rebuild(ab, cd);
+
+  auto func_registry_ = std::make_unique<udf::Registry>("test_registry");
+  auto table_store = std::make_shared<table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry_.get(), table_store, MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+
+  MockExecNode mock_child;
+
+  RowDescriptor input_rd({types::DataType::INT64});
+  auto op_proto = planpb::testutils::CreateTestGRPCSource1PB();
+  std::unique_ptr<px::carnot::plan::Operator> plan_node =
+      plan::GRPCSourceOperator::FromProto(op_proto, 1);
+  auto source_node = GRPCSourceNode();
+  ASSERT_OK(source_node.Init(*plan_node, input_rd, {}));
+  source_node.AddChild(&mock_child, 0);
+  ASSERT_OK(source_node.Open(exec_state.get()));
+  ASSERT_OK(source_node.Prepare(exec_state.get()));
+
+  FakePlanNode fake_plan_node(111);
+  // Silence GMOCK warnings.
+  EXPECT_CALL(mock_child, InitImpl(::testing::_));
+  EXPECT_CALL(mock_child, PrepareImpl(::testing::_));
+  EXPECT_CALL(mock_child, OpenImpl(::testing::_));
+  ASSERT_OK(mock_child.Init(fake_plan_node, RowDescriptor({}), {}));
+  ASSERT_OK(mock_child.Open(exec_state.get()));
+  ASSERT_OK(mock_child.Prepare(exec_state.get()));
+  EXPECT_CALL(mock_child, ConsumeNextImpl(::testing::_, ::testing::_, ::testing::_))
+      .Times(101)
+      .WillRepeatedly(::testing::Return(Status::OK()));
+
+  ASSERT_OK(service_->AddGRPCSourceNode(query_uuid, /* source_id */ 0, &source_node, [] {}));
+
+  std::vector<carnotpb::TransferResultChunkRequest> rb_reqs;
+  for (int idx = 0; idx <= 100; ++idx) {
+    auto rb = RowBatchBuilder(input_rd, /*size*/ 1, /*eow*/ idx == 100, /*eos*/ idx == 100)
+                  .AddColumn<types::Int64Value>({idx})
+                  .get();
+    auto& rb_req = rb_reqs.emplace_back();
+    EXPECT_OK(rb.ToProto(rb_req.mutable_query_result()->mutable_row_batch()));
+    rb_req.mutable_query_result()->set_grpc_source_id(0);
+    rb_req.mutable_query_id()->set_high_bits(ab);
+    rb_req.mutable_query_id()->set_low_bits(cd);
+  }
+  int64_t max_req_bytes = 0;
+  for (const auto& rb_req : rb_reqs) {
+    max_req_bytes = std::max<int64_t>(max_req_bytes, rb_req.ByteSizeLong());
+  }
+
+  px::carnotpb::TransferResultChunkResponse response;
+  grpc::ClientContext context;
+  auto writer = stub_->TransferResultChunk(&context, &response);
+  std::thread write_thread([&] {
+    carnotpb::TransferResultChunkRequest initiate_stream_req0;
+    initiate_stream_req0.mutable_query_id()->set_high_bits(ab);
+    initiate_stream_req0.mutable_query_id()->set_low_bits(cd);
+    initiate_stream_req0.mutable_query_result()->set_grpc_source_id(0);
+    initiate_stream_req0.mutable_query_result()->set_initiate_result_stream(true);
+    writer->Write(initiate_stream_req0);
+    for (const auto& rb_req : rb_reqs) {
+      writer->Write(rb_req);
+    }
+    writer->WritesDone();
+    writer->Finish();
+  });
+
+  while (source_node.HasBatchesRemaining()) {
+    if (!source_node.NextBatchReady()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+    // The router stops reading the stream until the buffered batch is consumed.
+    EXPECT_LE(service_->QueryBufferedBytes(query_uuid), max_req_bytes);
+    ASSERT_OK(source_node.GenerateNext(exec_state.get()));
+  }
+  write_thread.join();
+
+  EXPECT_EQ(0, service_->QueryBufferedBytes(query_uuid));
+  EXPECT_TRUE(response.success());
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -21,6 +21,8 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/substitute.h>
@@ -31,6 +33,15 @@
 #include "src/common/uuid/uuid_utils.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_string(carnot_grpc_sink_compression,
+              gflags::StringFromEnv("PL_CARNOT_GRPC_SINK_COMPRESSION", ""),
+              "The compression of the row batches that GRPC sinks send to the GRPC sources of "
+              "other Carnot instances: gzip, deflate or none.");
+DEFINE_int64(carnot_grpc_sink_coalesce_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_GRPC_SINK_COALESCE_BYTES", 0),
+             "GRPC sinks coalesce the writes of small row batches into fewer HTTP/2 frames until "
+             "this many bytes are pending, or the query yields. 0 disables coalescing.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -38,6 +49,23 @@ namespace exec {
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
+namespace {
+
+StatusOr<grpc_compression_algorithm> ParseCompressionAlgorithm(std::string_view name) {
+  if (name.empty() || name == "none") {
+    return GRPC_COMPRESS_NONE;
+  }
+  if (name == "gzip") {
+    return GRPC_COMPRESS_GZIP;
+  }
+  if (name == "deflate") {
+    return GRPC_COMPRESS_DEFLATE;
+  }
+  return error::InvalidArgument("Unknown gRPC compression algorithm '$0'", name);
+}
+
+}  // namespace
+
 std::string GRPCSinkNode::DebugStringImpl() {
   std::string destination;
   if (plan_node_->has_table_name()) {
@@ -67,10 +95,23 @@ StatusOr<carnotpb::TransferResultChunkRequest> RequestWithMetadata(
   return req;
 }
 
+Status GRPCSinkNode::SerializeRowBatch(const RowBatch& rb,
+                                       carnotpb::TransferResultChunkRequest* req) const {
+  if (plan_node_->flat_row_batches()) {
+    return rb.ToFlatProto(req->mutable_query_result()->mutable_flat_row_batch());
+  }
+  return rb.ToProto(req->mutable_query_result()->mutable_row_batch());
+}
+
 Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
   if (sent_eos_ || cancelled_) {
     return Status::OK();
   }
+  // The query yields between calls, so a request held back for coalescing is sent now rather
+  // than after the next batch, which also shows that the connection is alive.
+  if (pending_req_ != nullptr) {
+    return FlushPendingRequest(exec_state);
+  }
 
   auto time_now = std::chrono::system_clock::now();
   auto since_last_flush =
@@ -83,7 +124,7 @@ Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
   PL_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   PL_ASSIGN_OR_RETURN(auto rb,
                       RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-  PL_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PL_RETURN_IF_ERROR(SerializeRowBatch(*rb, &req));
 
   PL_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
   return Status::OK();
@@ -99,6 +140,8 @@ Status GRPCSinkNode::InitImpl(const plan::Operator& plan_node) {
   input_descriptor_ = std::make_unique<RowDescriptor>(input_descriptors_[0]);
   const auto* sink_plan_node = static_cast<const plan::GRPCSinkOperator*>(&plan_node);
   plan_node_ = std::make_unique<plan::GRPCSinkOperator>(*sink_plan_node);
+  PL_ASSIGN_OR_RETURN(compression_, ParseCompressionAlgorithm(FLAGS_carnot_grpc_sink_compression));
+  coalesce_bytes_ = FLAGS_carnot_grpc_sink_coalesce_bytes;
   return Status::OK();
 }
 
@@ -126,6 +169,9 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, bool send
   if (plan_node_->has_table_name()) {
     // Adding auth to GRPC client.
     exec_state->AddAuthToGRPCClientContext(context_.get());
+  } else {
+    // Only the GRPCRouter of other Carnot instances is known to accept compressed requests.
+    context_->set_compression_algorithm(compression_);
   }
 
   response_.Clear();
@@ -139,7 +185,7 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, bool send
     // initiate_result_stream request.
     PL_ASSIGN_OR_RETURN(
         auto rb, RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-    PL_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+    PL_RETURN_IF_ERROR(SerializeRowBatch(*rb, &req));
   }
 
   if (!writer_->Write(req)) {
@@ -159,8 +205,13 @@ Status GRPCSinkNode::CancelledByServer(ExecState* exec_state) {
 }
 
 Status GRPCSinkNode::TryWriteRequest(ExecState* exec_state,
-                                     const carnotpb::TransferResultChunkRequest& req) {
-  if (writer_->Write(req)) {
+                                     const carnotpb::TransferResultChunkRequest& req,
+                                     bool buffer_hint) {
+  grpc::WriteOptions options;
+  if (buffer_hint) {
+    options.set_buffer_hint();
+  }
+  if (writer_->Write(req, options)) {
     last_send_time_ = std::chrono::system_clock::now();
     return Status::OK();
   }
@@ -181,13 +232,45 @@ Status GRPCSinkNode::TryWriteRequest(ExecState* exec_state,
   PL_RETURN_IF_ERROR(StartConnection(exec_state, /* send_initiate_req */ false));
 
   // Try again to write the request on the new connection.
-  if (!writer_->Write(req)) {
+  if (!writer_->Write(req, options)) {
     return CancelledByServer(exec_state);
   }
   last_send_time_ = std::chrono::system_clock::now();
   return Status::OK();
 }
 
+Status GRPCSinkNode::WriteRowBatchRequest(ExecState* exec_state,
+                                          carnotpb::TransferResultChunkRequest req, bool flush) {
+  if (coalesce_bytes_ <= 0) {
+    return TryWriteRequest(exec_state, req);
+  }
+  if (pending_req_ != nullptr) {
+    // Another request follows the pending one, so it can be written with a buffer hint, unless
+    // enough bytes were already coalesced.
+    coalesced_bytes_ += pending_req_bytes_;
+    bool buffer_hint = coalesced_bytes_ < coalesce_bytes_;
+    PL_RETURN_IF_ERROR(TryWriteRequest(exec_state, *pending_req_, buffer_hint));
+    if (!buffer_hint) {
+      coalesced_bytes_ = 0;
+    }
+  }
+  pending_req_bytes_ = req.ByteSizeLong();
+  pending_req_ = std::make_unique<carnotpb::TransferResultChunkRequest>(std::move(req));
+  if (flush || pending_req_bytes_ >= coalesce_bytes_) {
+    return FlushPendingRequest(exec_state);
+  }
+  return Status::OK();
+}
+
+Status GRPCSinkNode::FlushPendingRequest(ExecState* exec_state) {
+  if (pending_req_ == nullptr) {
+    return Status::OK();
+  }
+  auto req = std::move(pending_req_);
+  coalesced_bytes_ = 0;
+  return TryWriteRequest(exec_state, *req);
+}
+
 Status GRPCSinkNode::OpenImpl(ExecState* exec_state) {
   return StartConnection(exec_state, /* send_initiate_req */ true);
 }
@@ -319,9 +402,10 @@ Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb,
 Status GRPCSinkNode::ConsumeNextImplNoSplit(ExecState* exec_state, const RowBatch& rb, size_t) {
   PL_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   // Serialize the RowBatch.
-  PL_RETURN_IF_ERROR(rb.ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PL_RETURN_IF_ERROR(SerializeRowBatch(rb, &req));
 
-  PL_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
+  PL_RETURN_IF_ERROR(
+      WriteRowBatchRequest(exec_state, std::move(req), /* flush */ rb.eow() || rb.eos()));
 
   if (!rb.eos()) {
     return Status::OK();
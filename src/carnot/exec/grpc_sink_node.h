@@ -35,6 +35,9 @@
 
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 
+DECLARE_string(carnot_grpc_sink_compression);
+DECLARE_int64(carnot_grpc_sink_coalesce_bytes);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -90,7 +93,18 @@ class GRPCSinkNode : public SinkNode {
   Status StartConnectionWithRetries(ExecState* exec_state, bool send_initiate_req,
                                     size_t n_retries);
   Status CancelledByServer(ExecState* exec_state);
-  Status TryWriteRequest(ExecState* exec_state, const carnotpb::TransferResultChunkRequest& req);
+  // A buffer_hint lets gRPC hold the request back and coalesce it with the following writes.
+  Status TryWriteRequest(ExecState* exec_state, const carnotpb::TransferResultChunkRequest& req,
+                         bool buffer_hint = false);
+  // Writes a row batch request. When coalescing is enabled, the last request is held back so that
+  // the ones before it can be written with a buffer hint, until flush is set or enough bytes are
+  // pending.
+  Status WriteRowBatchRequest(ExecState* exec_state, carnotpb::TransferResultChunkRequest req,
+                              bool flush);
+  Status FlushPendingRequest(ExecState* exec_state);
+  // Serializes the row batch into req, in the encoding that the plan asks for.
+  Status SerializeRowBatch(const table_store::schema::RowBatch& rb,
+                           carnotpb::TransferResultChunkRequest* req) const;
 
   bool cancelled_ = false;
 
@@ -108,6 +122,13 @@ class GRPCSinkNode : public SinkNode {
 
   size_t max_batch_size_;
   float batch_size_factor_;
+
+  grpc_compression_algorithm compression_ = GRPC_COMPRESS_NONE;
+  int64_t coalesce_bytes_ = 0;
+  std::unique_ptr<carnotpb::TransferResultChunkRequest> pending_req_;
+  int64_t pending_req_bytes_ = 0;
+  // The bytes written with a buffer hint since the last write without one.
+  int64_t coalesced_bytes_ = 0;
 };
 
 }  // namespace exec
@@ -773,6 +773,60 @@ TEST_F(GRPCSinkNodeTest, check_connection_after_eos) {
   tester.Close();
 }
 
+TEST_F(GRPCSinkNodeTest, coalesce_small_batches) {
+  auto coalesce_bytes = FLAGS_carnot_grpc_sink_coalesce_bytes;
+  FLAGS_carnot_grpc_sink_coalesce_bytes = 1024 * 1024;
+
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor input_rd({types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<int64_t> written_num_rows;
+  std::vector<bool> buffer_hints;
+  auto save_arg = [&](TransferResultChunkRequest req, grpc::WriteOptions options) {
+    written_num_rows.push_back(req.query_result().row_batch().num_rows());
+    buffer_hints.push_back(options.get_buffer_hint());
+  };
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _)).WillRepeatedly(DoAll(Invoke(save_arg), Return(true)));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  // The stream initiation request.
+  EXPECT_EQ(1, written_num_rows.size());
+
+  for (auto i = 1; i <= 3; ++i) {
+    std::vector<types::Int64Value> data(i, i);
+    auto rb = RowBatchBuilder(output_rd, i, /*eow*/ false, /*eos*/ false)
+                  .AddColumn<types::Int64Value>(data)
+                  .get();
+    tester.ConsumeNext(rb, 5, 0);
+  }
+  // The last batch is held back until the query yields.
+  EXPECT_THAT(written_num_rows, ::testing::ElementsAre(0, 1, 2));
+  EXPECT_OK(tester.node()->OptionallyCheckConnection(exec_state_.get()));
+  EXPECT_THAT(written_num_rows, ::testing::ElementsAre(0, 1, 2, 3));
+
+  auto rb = RowBatchBuilder(output_rd, 4, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Int64Value>({4, 4, 4, 4})
+                .get();
+  tester.ConsumeNext(rb, 5, 0);
+  tester.Close();
+
+  EXPECT_THAT(written_num_rows, ::testing::ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_THAT(buffer_hints, ::testing::ElementsAre(false, true, true, false, false));
+  FLAGS_carnot_grpc_sink_coalesce_bytes = coalesce_bytes;
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -51,6 +51,7 @@ Status GRPCSourceNode::CloseImpl(ExecState*) { return Status::OK(); }
 
 Status GRPCSourceNode::GenerateNextImpl(ExecState* exec_state) {
   PL_RETURN_IF_ERROR(PopRowBatch());
+  ApplyRuntimeJoinFilters(exec_state, rb_.get());
   PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *rb_));
   return Status::OK();
 }
@@ -72,6 +73,15 @@ Status GRPCSourceNode::PopRowBatch() {
         "Called GRPCSourceNode::OptionallyPopRowBatch but there was no available row batch in the "
         "queue.");
   }
+  if (batch_consumed_callback_) {
+    // The router computed the size when it received the request, which the proto caches.
+    batch_consumed_callback_(rb_request->GetCachedSize());
+  }
+  if (rb_request->has_query_result() && rb_request->query_result().has_flat_row_batch()) {
+    PL_ASSIGN_OR_RETURN(rb_, RowBatch::FromFlatProto(
+                                 rb_request->mutable_query_result()->mutable_flat_row_batch()));
+    return Status::OK();
+  }
   if (!rb_request->has_query_result() || !rb_request->query_result().has_row_batch()) {
     return error::Internal(
         "GRPCSourceNode::PopRowBatch expected TransferResultChunkRequest to have RowBatch "
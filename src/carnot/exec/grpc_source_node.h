@@ -19,8 +19,10 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/carnotpb/carnot.pb.h"
@@ -56,6 +58,12 @@ class GRPCSourceNode : public SourceNode {
   void set_upstream_closed_connection() { upstream_closed_connection_ = true; }
   bool upstream_closed_connection() const { return upstream_closed_connection_; }
 
+  // Called with the serialized size of each enqueued request once its row batch is consumed, so
+  // that the GRPCRouter can account for the results that the query is holding.
+  void set_batch_consumed_callback(std::function<void(int64_t num_bytes)> callback) {
+    batch_consumed_callback_ = std::move(callback);
+  }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -74,6 +82,7 @@ class GRPCSourceNode : public SourceNode {
   std::unique_ptr<plan::GRPCSourceOperator> plan_node_;
   bool upstream_initiated_connection_ = false;
   bool upstream_closed_connection_ = false;
+  std::function<void(int64_t num_bytes)> batch_consumed_callback_;
 };
 
 }  // namespace exec
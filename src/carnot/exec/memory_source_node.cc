@@ -18,19 +18,145 @@
 
 #include "src/carnot/exec/memory_source_node.h"
 
+#include <algorithm>
 #include <limits>
+#include <optional>
 #include <string>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
 
 namespace px {
 namespace carnot {
 namespace exec {
 
+// The maximum number of rows handed out to a single worker by NextMorsel.
+constexpr int64_t kMaxMorselRows = 16 * 1024;
+
+namespace {
+
+// Returns the zone map op equivalent to the comparison UDF with the given name, with the operands
+// swapped if the constant is on the left.
+std::optional<table_store::ZoneMapOp> ZoneMapOpForFunc(const std::string& name,
+                                                       bool constant_on_left) {
+  using table_store::ZoneMapOp;
+  if (name == "equal") {
+    return ZoneMapOp::kEqual;
+  }
+  if (name == "notEqual") {
+    return ZoneMapOp::kNotEqual;
+  }
+  if (name == "lessThan") {
+    return constant_on_left ? ZoneMapOp::kGreaterThan : ZoneMapOp::kLessThan;
+  }
+  if (name == "lessThanEqual") {
+    return constant_on_left ? ZoneMapOp::kGreaterThanEqual : ZoneMapOp::kLessThanEqual;
+  }
+  if (name == "greaterThan") {
+    return constant_on_left ? ZoneMapOp::kLessThan : ZoneMapOp::kGreaterThan;
+  }
+  if (name == "greaterThanEqual") {
+    return constant_on_left ? ZoneMapOp::kLessThanEqual : ZoneMapOp::kGreaterThanEqual;
+  }
+  return std::nullopt;
+}
+
+// Collects the comparisons between a column and a constant in the conjunction expr. Any other part
+// of the expression is left out, which only means that fewer batches can be skipped.
+void CollectZoneMapPredicates(const plan::ScalarExpression& expr,
+                              const std::vector<int64_t>& table_cols,
+                              const table_store::schema::Relation& table_rel,
+                              std::vector<table_store::ZoneMapPredicate>* predicates) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return;
+  }
+  const auto& func = static_cast<const plan::ScalarFunc&>(expr);
+  const auto& args = func.arg_deps();
+  if (func.name() == "logicalAnd") {
+    for (const auto& arg : args) {
+      CollectZoneMapPredicates(*arg, table_cols, table_rel, predicates);
+    }
+    return;
+  }
+  if (args.size() != 2) {
+    return;
+  }
+  bool constant_on_left = args[0]->ExpressionType() == plan::Expression::kConstant;
+  const auto* col_arg = args[constant_on_left ? 1 : 0].get();
+  const auto* constant_arg = args[constant_on_left ? 0 : 1].get();
+  if (col_arg->ExpressionType() != plan::Expression::kColumn ||
+      constant_arg->ExpressionType() != plan::Expression::kConstant) {
+    return;
+  }
+  auto op = ZoneMapOpForFunc(func.name(), constant_on_left);
+  if (!op.has_value()) {
+    return;
+  }
+  auto col_idx = static_cast<const plan::Column*>(col_arg)->Index();
+  if (col_idx < 0 || col_idx >= static_cast<int64_t>(table_cols.size())) {
+    return;
+  }
+  auto table_col_idx = table_cols[col_idx];
+  const auto& constant = *static_cast<const plan::ScalarValue*>(constant_arg);
+  if (constant.IsNull()) {
+    return;
+  }
+  table_store::ZoneMapPredicate predicate{table_col_idx, op.value(), int64_t{0}};
+  switch (constant.DataType()) {
+    case types::DataType::INT64:
+      predicate.value = constant.Int64Value();
+      break;
+    case types::DataType::TIME64NS:
+      predicate.value = constant.Time64NSValue();
+      break;
+    case types::DataType::BOOLEAN:
+      predicate.value = static_cast<int64_t>(constant.BoolValue());
+      break;
+    case types::DataType::FLOAT64:
+      // Float equality is approximate, so only the range comparisons can be used.
+      if (op == table_store::ZoneMapOp::kEqual || op == table_store::ZoneMapOp::kNotEqual) {
+        return;
+      }
+      predicate.value = constant.Float64Value();
+      break;
+    case types::DataType::STRING:
+      predicate.value = constant.StringValue();
+      break;
+    default:
+      return;
+  }
+  // Comparisons between different types (eg. an INT64 column and a FLOAT64 constant) convert the
+  // values, so they are left out.
+  bool types_match = false;
+  switch (table_rel.GetColumnType(table_col_idx)) {
+    case types::DataType::INT64:
+    case types::DataType::TIME64NS:
+    case types::DataType::BOOLEAN:
+      types_match = std::holds_alternative<int64_t>(predicate.value);
+      break;
+    case types::DataType::FLOAT64:
+      types_match = std::holds_alternative<double>(predicate.value);
+      break;
+    case types::DataType::STRING:
+      types_match = std::holds_alternative<std::string>(predicate.value);
+      break;
+    default:
+      break;
+  }
+  if (!types_match) {
+    return;
+  }
+  predicates->push_back(std::move(predicate));
+}
+
+}  // namespace
+
 std::string MemorySourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::MemorySourceNode: <name: $0, output: $1>", plan_node_->TableName(),
                           output_descriptor_->DebugString());
@@ -45,7 +171,27 @@ Status MemorySourceNode::InitImpl(const plan::Operator& plan_node) {
   return Status::OK();
 }
 
-Status MemorySourceNode::PrepareImpl(ExecState*) { return Status::OK(); }
+Status MemorySourceNode::PrepareImpl(ExecState*) {
+  if (plan_node_->scan_predicate() == nullptr) {
+    return Status::OK();
+  }
+  const auto& cols = plan_node_->Columns();
+  const auto& predicate_cols = plan_node_->predicate_columns();
+  for (const auto& [output_idx, table_col_idx] : Enumerate(cols)) {
+    auto it = std::lower_bound(predicate_cols.begin(), predicate_cols.end(),
+                               static_cast<int64_t>(output_idx));
+    bool in_predicate = it != predicate_cols.end() && *it == static_cast<int64_t>(output_idx);
+    output_col_in_predicate_.push_back(in_predicate);
+    if (in_predicate) {
+      output_col_positions_.push_back(predicate_table_cols_.size());
+      predicate_table_cols_.push_back(table_col_idx);
+    } else {
+      output_col_positions_.push_back(remaining_table_cols_.size());
+      remaining_table_cols_.push_back(table_col_idx);
+    }
+  }
+  return Status::OK();
+}
 
 Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
   table_ = exec_state->table_store()->GetTable(plan_node_->TableName(), plan_node_->Tablet());
@@ -73,14 +219,129 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
   }
   current_batch_ = table_->SliceIfPastStop(current_batch_, stop_);
 
+  if (plan_node_->predicate() != nullptr) {
+    CollectZoneMapPredicates(*plan_node_->predicate(), plan_node_->Columns(), table_->GetRelation(),
+                             &zone_map_predicates_);
+  }
   return Status::OK();
 }
 
-Status MemorySourceNode::CloseImpl(ExecState*) {
+Status MemorySourceNode::CloseImpl(ExecState* exec_state) {
   stats()->AddExtraInfo("infinite_stream", infinite_stream_ ? "true" : "false");
+  stats()->AddExtraInfo("batches_skipped", std::to_string(batches_skipped_));
+  if (plan_node_->scan_predicate() != nullptr) {
+    stats()->AddExtraInfo("batches_filtered", std::to_string(batches_filtered_));
+    stats()->AddExtraInfo("rows_filtered", std::to_string(rows_filtered_));
+  }
+  absl::MutexLock lock(&morsel_lock_);
+  for (const auto& evaluator : idle_evaluators_) {
+    PL_RETURN_IF_ERROR(evaluator->evaluator->Close(exec_state));
+  }
+  idle_evaluators_.clear();
   return Status::OK();
 }
 
+Status MemorySourceNode::EvaluatePredicate(ExecState* exec_state, const RowBatch& rb,
+                                           std::vector<int64_t>* selection) {
+  std::unique_ptr<PredicateEvaluator> evaluator;
+  {
+    absl::MutexLock lock(&morsel_lock_);
+    if (!idle_evaluators_.empty()) {
+      evaluator = std::move(idle_evaluators_.back());
+      idle_evaluators_.pop_back();
+    }
+  }
+  if (evaluator == nullptr) {
+    evaluator = std::make_unique<PredicateEvaluator>();
+    evaluator->function_ctx = exec_state->CreateFunctionContext();
+    evaluator->evaluator = std::make_unique<VectorNativeScalarExpressionEvaluator>(
+        plan::ConstScalarExpressionVector{plan_node_->scan_predicate()},
+        evaluator->function_ctx.get());
+    PL_RETURN_IF_ERROR(evaluator->evaluator->Open(exec_state));
+  }
+  auto pred_col_or_s = evaluator->evaluator->EvaluateSingleExpression(
+      exec_state, rb, *plan_node_->scan_predicate());
+  {
+    absl::MutexLock lock(&morsel_lock_);
+    idle_evaluators_.push_back(std::move(evaluator));
+  }
+  PL_ASSIGN_OR_RETURN(auto pred_col, std::move(pred_col_or_s));
+  DCHECK_EQ(pred_col->data_type(), types::BOOLEAN) << "Predicate expression must be a boolean";
+  const auto& pred_col_wrapper = *static_cast<types::BoolValueColumnWrapper*>(pred_col.get());
+  DCHECK_EQ(static_cast<int64_t>(pred_col_wrapper.Size()), rb.num_rows());
+  for (int64_t i = 0; i < rb.num_rows(); ++i) {
+    if (pred_col_wrapper[i].val) {
+      selection->push_back(i);
+    }
+  }
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::ReadBatchSlice(
+    ExecState* exec_state, const table_store::BatchSlice& slice) {
+  auto mem_pool = exec_state->exec_mem_pool();
+  if (plan_node_->scan_predicate() == nullptr) {
+    PL_ASSIGN_OR_RETURN(auto row_batch,
+                        table_->GetRowBatchSlice(slice, plan_node_->Columns(), mem_pool));
+    absl::MutexLock lock(&morsel_lock_);
+    rows_processed_ += row_batch->num_rows();
+    bytes_processed_ += row_batch->NumBytes();
+    return row_batch;
+  }
+
+  PL_ASSIGN_OR_RETURN(auto predicate_rb,
+                      table_->GetRowBatchSlice(slice, predicate_table_cols_, mem_pool));
+  std::vector<int64_t> selection;
+  PL_RETURN_IF_ERROR(EvaluatePredicate(exec_state, *predicate_rb, &selection));
+  {
+    absl::MutexLock lock(&morsel_lock_);
+    rows_processed_ += predicate_rb->num_rows();
+    bytes_processed_ += predicate_rb->NumBytes();
+    rows_filtered_ += predicate_rb->num_rows() - static_cast<int64_t>(selection.size());
+    if (selection.empty()) {
+      ++batches_filtered_;
+    }
+  }
+  if (selection.empty()) {
+    return std::unique_ptr<RowBatch>(nullptr);
+  }
+
+  // Only the range of rows between the first and the last matching row is read for the remaining
+  // columns, and is the range covered by the output batch.
+  int64_t first_row = selection.front();
+  int64_t num_rows = selection.back() - first_row + 1;
+  std::unique_ptr<RowBatch> remaining_rb;
+  if (!remaining_table_cols_.empty()) {
+    auto narrowed_slice = slice;
+    narrowed_slice.uniq_row_start_idx = slice.uniq_row_start_idx + first_row;
+    narrowed_slice.uniq_row_end_idx = narrowed_slice.uniq_row_start_idx + num_rows - 1;
+    // Force the table to look up the position of the narrowed slice.
+    narrowed_slice.generation = -1;
+    PL_ASSIGN_OR_RETURN(remaining_rb,
+                        table_->GetRowBatchSlice(narrowed_slice, remaining_table_cols_, mem_pool));
+    absl::MutexLock lock(&morsel_lock_);
+    bytes_processed_ += remaining_rb->NumBytes();
+  }
+
+  auto row_batch = std::make_unique<RowBatch>(*output_descriptor_, num_rows);
+  for (size_t output_idx = 0; output_idx < output_col_in_predicate_.size(); ++output_idx) {
+    auto pos = output_col_positions_[output_idx];
+    if (output_col_in_predicate_[output_idx]) {
+      PL_RETURN_IF_ERROR(
+          row_batch->AddColumn(predicate_rb->ColumnAt(pos)->Slice(first_row, num_rows)));
+    } else {
+      PL_RETURN_IF_ERROR(row_batch->AddColumn(remaining_rb->ColumnAt(pos)));
+    }
+  }
+  if (static_cast<int64_t>(selection.size()) != num_rows) {
+    for (auto& row : selection) {
+      row -= first_row;
+    }
+    row_batch->set_selection(std::move(selection));
+  }
+  return row_batch;
+}
+
 StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState* exec_state) {
   DCHECK(table_ != nullptr);
 
@@ -97,22 +358,34 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
     wait_for_valid_next_ = false;
   }
 
-  if (!current_batch_.IsValid()) {
-    return RowBatch::WithZeroRows(*output_descriptor_, /* eow */ !infinite_stream_,
-                                  /* eos */ !infinite_stream_);
-  }
+  std::unique_ptr<RowBatch> row_batch;
+  while (row_batch == nullptr) {
+    // Skip the batches that the table's zone maps show have no rows matching the predicate.
+    while (current_batch_.IsValid() && !table_->MayMatch(current_batch_, zone_map_predicates_)) {
+      ++batches_skipped_;
+      auto next_batch = table_->NextBatch(current_batch_, stop_);
+      if (infinite_stream_ && !next_batch.IsValid()) {
+        wait_for_valid_next_ = true;
+        return RowBatch::WithZeroRows(*output_descriptor_, /* eow */ false, /* eos */ false);
+      }
+      current_batch_ = next_batch;
+    }
 
-  PL_ASSIGN_OR_RETURN(
-      auto row_batch,
-      table_->GetRowBatchSlice(current_batch_, plan_node_->Columns(), exec_state->exec_mem_pool()));
+    if (!current_batch_.IsValid()) {
+      return RowBatch::WithZeroRows(*output_descriptor_, /* eow */ !infinite_stream_,
+                                    /* eos */ !infinite_stream_);
+    }
 
-  rows_processed_ += row_batch->num_rows();
-  bytes_processed_ += row_batch->NumBytes();
-  auto next_batch = table_->NextBatch(current_batch_, stop_);
-  if (infinite_stream_ && !next_batch.IsValid()) {
-    wait_for_valid_next_ = true;
-  } else {
-    current_batch_ = next_batch;
+    PL_ASSIGN_OR_RETURN(row_batch, ReadBatchSlice(exec_state, current_batch_));
+    auto next_batch = table_->NextBatch(current_batch_, stop_);
+    if (infinite_stream_ && !next_batch.IsValid()) {
+      wait_for_valid_next_ = true;
+      if (row_batch == nullptr) {
+        return RowBatch::WithZeroRows(*output_descriptor_, /* eow */ false, /* eos */ false);
+      }
+    } else {
+      current_batch_ = next_batch;
+    }
   }
 
   // If infinite stream is set, we don't send Eow or Eos. Infinite streams therefore never cause
@@ -125,12 +398,49 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
   return row_batch;
 }
 
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::NextMorsel(ExecState* exec_state) {
+  DCHECK(table_ != nullptr);
+  DCHECK(SupportsMorsels());
+  // Keep going until a morsel has a row that satisfies the predicate, or the range is exhausted.
+  std::unique_ptr<RowBatch> row_batch;
+  while (row_batch == nullptr) {
+    table_store::BatchSlice morsel;
+    {
+      absl::MutexLock lock(&morsel_lock_);
+      while (current_batch_.IsValid() && !table_->MayMatch(current_batch_, zone_map_predicates_)) {
+        ++batches_skipped_;
+        current_batch_ = table_->NextBatch(current_batch_, stop_);
+      }
+      if (!current_batch_.IsValid()) {
+        return std::unique_ptr<RowBatch>(nullptr);
+      }
+      // Cap the morsel size so that large cold batches are still split across workers. NextBatch
+      // will return the remainder of a cut short batch.
+      morsel = table_->SliceIfPastStop(current_batch_,
+                                       current_batch_.uniq_row_start_idx + kMaxMorselRows);
+      current_batch_ = table_->NextBatch(morsel, stop_);
+    }
+    PL_ASSIGN_OR_RETURN(row_batch, ReadBatchSlice(exec_state, morsel));
+  }
+  return row_batch;
+}
+
 Status MemorySourceNode::GenerateNextImpl(ExecState* exec_state) {
   PL_ASSIGN_OR_RETURN(auto row_batch, GetNextRowBatch(exec_state));
+  ApplyRuntimeJoinFilters(exec_state, row_batch.get());
   PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *row_batch));
   return Status::OK();
 }
 
+ResultCache::ScanRange MemorySourceNode::ScanRange() const {
+  ResultCache::ScanRange range;
+  range.table_name = plan_node_->TableName();
+  range.tablet = plan_node_->Tablet();
+  range.stop = stop_;
+  range.start = current_batch_.IsValid() ? current_batch_.uniq_row_start_idx : stop_;
+  return range;
+}
+
 bool MemorySourceNode::InfiniteStreamNextBatchReady() {
   if (!wait_for_valid_next_) {
     return current_batch_.IsValid();
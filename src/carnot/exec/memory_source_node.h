@@ -23,9 +23,14 @@
 #include <string>
 #include <vector>
 
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/plan/operators.h"
+#include "src/carnot/udf/base.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
 #include "src/table_store/schema/row_batch.h"
@@ -44,6 +49,28 @@ class MemorySourceNode : public SourceNode {
 
   bool NextBatchReady() override;
 
+  /**
+   * Whether this source can hand out its data as morsels to multiple workers. Only bounded
+   * (non-streaming) sources can be split up this way.
+   */
+  bool SupportsMorsels() const { return !plan_node_->infinite_stream(); }
+
+  /**
+   * Returns the next morsel of the table's BatchSlice range as a RowBatch, or nullptr once the
+   * range is exhausted. Safe to call from multiple threads concurrently, but must not be mixed with
+   * GenerateNext(). Morsels never have eow/eos set; the caller is responsible for sending the end
+   * of stream once all morsels have been processed.
+   * @param exec_state The execution state.
+   * @return the next morsel, or nullptr if there are no more morsels.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> NextMorsel(ExecState* exec_state);
+
+  /**
+   * @return the range of unique row ids of the table that this source scans. Only valid after
+   * Open, and before any batch has been generated.
+   */
+  ResultCache::ScanRange ScanRange() const;
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -53,7 +80,25 @@ class MemorySourceNode : public SourceNode {
   Status GenerateNextImpl(ExecState* exec_state) override;
 
  private:
+  // An evaluator for the plan's scan predicate. Morsel workers evaluate the predicate concurrently,
+  // so each call takes an idle evaluator (or creates a new one) and returns it when done.
+  struct PredicateEvaluator {
+    std::unique_ptr<udf::FunctionContext> function_ctx;
+    std::unique_ptr<VectorNativeScalarExpressionEvaluator> evaluator;
+  };
+
   StatusOr<std::unique_ptr<RowBatch>> GetNextRowBatch(ExecState* exec_state);
+  /**
+   * Reads the output columns of the slice. If the plan has a predicate, the columns it reads are
+   * read and evaluated first, and the remaining columns are only read for the range of rows that
+   * satisfy it. The rows that don't satisfy it are left out of the returned batch's selection.
+   * @return the row batch, or nullptr if no row of the slice satisfies the predicate.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> ReadBatchSlice(ExecState* exec_state,
+                                                     const table_store::BatchSlice& slice);
+  // Sets selection to the indices of the rows of rb that satisfy the scan predicate.
+  Status EvaluatePredicate(ExecState* exec_state, const RowBatch& rb,
+                           std::vector<int64_t>* selection);
   bool InfiniteStreamNextBatchReady();
   // Whether this memory source will stream infinitely. Can be stopped by the
   // exec_state_->keep_running() call in exec_graph.
@@ -63,9 +108,26 @@ class MemorySourceNode : public SourceNode {
   bool wait_for_valid_next_ = false;
   table_store::BatchSlice current_batch_;
   table_store::Table::StopPosition stop_;
+  // The comparisons in the plan's predicate that can be checked against the table's zone maps.
+  std::vector<table_store::ZoneMapPredicate> zone_map_predicates_;
+  int64_t batches_skipped_ = 0;
+  // The table columns that the predicate reads, and the remaining output table columns.
+  std::vector<int64_t> predicate_table_cols_;
+  std::vector<int64_t> remaining_table_cols_;
+  // For each output column, whether it is read with the predicate, and its index in
+  // predicate_table_cols_ or remaining_table_cols_.
+  std::vector<bool> output_col_in_predicate_;
+  std::vector<int64_t> output_col_positions_;
+  std::vector<std::unique_ptr<PredicateEvaluator>> idle_evaluators_;
+  int64_t batches_filtered_ = 0;
+  int64_t rows_filtered_ = 0;
 
   std::unique_ptr<plan::MemorySourceOperator> plan_node_;
   table_store::Table* table_ = nullptr;
+
+  // Protects current_batch_, the idle evaluators and the counters while morsels are handed out to
+  // workers.
+  absl::Mutex morsel_lock_;
 };
 
 }  // namespace exec
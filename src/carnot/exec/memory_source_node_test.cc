@@ -25,6 +25,7 @@
 
 #include <absl/strings/substitute.h>
 #include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
 
@@ -43,14 +44,37 @@ using table_store::Table;
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 using ::testing::_;
+using udf::FunctionContext;
+
+class GreaterThanEqualUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::Time64NSValue v1, types::Time64NSValue v2) {
+    return v1.val >= v2.val;
+  }
+};
+
+class BoolEqualUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::BoolValue v1, types::BoolValue v2) {
+    return v1.val == v2.val;
+  }
+};
 
 class MemorySourceNodeTest : public ::testing::Test {
  protected:
   void SetUp() override {
     func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    EXPECT_OK(func_registry_->Register<GreaterThanEqualUDF>("greaterThanEqual"));
+    EXPECT_OK(func_registry_->Register<BoolEqualUDF>("equal"));
     auto table_store = std::make_shared<table_store::TableStore>();
     exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
                                               MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        0, "greaterThanEqual",
+        std::vector<types::DataType>({types::DataType::TIME64NS, types::DataType::TIME64NS})));
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        1, "equal",
+        std::vector<types::DataType>({types::DataType::BOOLEAN, types::DataType::BOOLEAN})));
 
     table_store::schema::Relation rel({types::DataType::BOOLEAN, types::DataType::TIME64NS},
                                       {"col1", "time_"});
@@ -226,9 +250,17 @@ class MemorySourceNodeTabletTest : public ::testing::Test {
  protected:
   void SetUp() override {
     func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    EXPECT_OK(func_registry_->Register<GreaterThanEqualUDF>("greaterThanEqual"));
+    EXPECT_OK(func_registry_->Register<BoolEqualUDF>("equal"));
     auto table_store = std::make_shared<table_store::TableStore>();
     exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
                                               MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        0, "greaterThanEqual",
+        std::vector<types::DataType>({types::DataType::TIME64NS, types::DataType::TIME64NS})));
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        1, "equal",
+        std::vector<types::DataType>({types::DataType::BOOLEAN, types::DataType::BOOLEAN})));
 
     rel = table_store::schema::Relation({types::DataType::BOOLEAN, types::DataType::TIME64NS},
                                         {"col1", "time_"});
@@ -412,6 +444,104 @@ TEST_F(MemorySourceNodeTest, table_compact_between_open_and_exec) {
   tester.Close();
 }
 
+TEST_F(MemorySourceNodeTest, predicate_skips_cold_batches) {
+  auto op_proto = planpb::testutils::CreateTestSource1PB();
+  constexpr char kTimeGreaterThanEqual5[] = R"(
+func {
+  name: "greaterThanEqual"
+  args {
+    column {
+      node: 0
+      index: 0
+    }
+  }
+  args {
+    constant {
+      data_type: TIME64NS
+      time64_ns_value: 5
+    }
+  }
+  args_data_types: TIME64NS
+  args_data_types: TIME64NS
+})";
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(
+      kTimeGreaterThanEqual5, op_proto.mutable_mem_source_op()->mutable_predicate()));
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  // Each of the two batches is compacted into its own cold batch.
+  EXPECT_OK(cpu_table_->CompactHotToCold(arrow::default_memory_pool()));
+
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  EXPECT_TRUE(tester.node()->HasBatchesRemaining());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({5, 6})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+  EXPECT_EQ(2, tester.node()->RowsProcessed());
+}
+
+TEST_F(MemorySourceNodeTest, predicate_filters_rows) {
+  planpb::Operator op_proto;
+  constexpr char kSourceWithPredicate[] = R"(
+op_type: MEMORY_SOURCE_OPERATOR
+mem_source_op {
+  name: "cpu"
+  column_idxs: 1
+  column_idxs: 0
+  column_types: TIME64NS
+  column_types: BOOLEAN
+  column_names: "time_"
+  column_names: "col1"
+  predicate {
+    func {
+      name: "equal"
+      id: 1
+      args {
+        column {
+          node: 0
+          index: 1
+        }
+      }
+      args {
+        constant {
+          data_type: BOOLEAN
+          bool_value: true
+        }
+      }
+      args_data_types: BOOLEAN
+      args_data_types: BOOLEAN
+    }
+  }
+})";
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kSourceWithPredicate, &op_proto));
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::BOOLEAN});
+
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  EXPECT_TRUE(tester.node()->HasBatchesRemaining());
+  // Only the rows of the first batch that satisfy the predicate are selected.
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+          .AddColumn<types::Time64NSValue>({1, 3})
+          .AddColumn<types::BoolValue>({true, true})
+          .get());
+  // No row of the second batch satisfies the predicate, so only the end of stream is sent.
+  EXPECT_TRUE(tester.node()->HasBatchesRemaining());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 0, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({})
+          .AddColumn<types::BoolValue>({})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+  EXPECT_EQ(5, tester.node()->RowsProcessed());
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
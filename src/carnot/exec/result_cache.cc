@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/carnot/exec/result_cache.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+std::string ResultCache::FragmentKey(const planpb::PlanFragment& fragment) {
+  planpb::PlanFragment canonical = fragment;
+  for (auto& node : *canonical.mutable_nodes()) {
+    auto op_type = node.op().op_type();
+    if (op_type == planpb::MEMORY_SINK_OPERATOR || op_type == planpb::GRPC_SINK_OPERATOR) {
+      // The sinks consume the same batches wherever they send them.
+      node.mutable_op()->clear_op();
+    }
+  }
+  std::string key;
+  {
+    google::protobuf::io::StringOutputStream output(&key);
+    google::protobuf::io::CodedOutputStream coded_output(&output);
+    coded_output.SetSerializationDeterministic(true);
+    canonical.SerializeToCodedStream(&coded_output);
+  }
+  return key;
+}
+
+std::shared_ptr<const ResultCache::Entry> ResultCache::Lookup(
+    const std::string& fragment_key, const std::vector<ScanRange>& scan_ranges) {
+  absl::MutexLock lock(&lock_);
+  auto it = entries_.find(fragment_key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  if (std::chrono::steady_clock::now() - it->second.inserted > ttl_) {
+    EraseLocked(it);
+    return nullptr;
+  }
+  if (it->second.entry->scan_ranges != scan_ranges) {
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+  return it->second.entry;
+}
+
+void ResultCache::Insert(const std::string& fragment_key, std::shared_ptr<const Entry> entry) {
+  if (entry->num_bytes > max_entry_bytes()) {
+    return;
+  }
+  absl::MutexLock lock(&lock_);
+  if (auto it = entries_.find(fragment_key); it != entries_.end()) {
+    EraseLocked(it);
+  }
+  num_bytes_ += entry->num_bytes;
+  lru_.push_front(fragment_key);
+  entries_.emplace(fragment_key,
+                   CachedEntry{std::move(entry), std::chrono::steady_clock::now(), lru_.begin()});
+  while (num_bytes_ > max_bytes_ && !lru_.empty()) {
+    EraseLocked(entries_.find(lru_.back()));
+  }
+}
+
+void ResultCache::EraseLocked(absl::flat_hash_map<std::string, CachedEntry>::iterator it) {
+  num_bytes_ -= it->second.entry->num_bytes;
+  lru_.erase(it->second.lru_it);
+  entries_.erase(it);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
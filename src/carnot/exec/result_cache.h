@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * ResultCache keeps the row batches that the sinks of recently executed plan fragments consumed,
+ * so that when the same fragment is executed again over the same data (eg. many users opening the
+ * same dashboard), the batches can be replayed into its sinks instead of being recomputed.
+ *
+ * Entries are keyed by the fragment with its sink destinations left out, and are only valid for
+ * the exact ranges of rows that the fragment's memory sources scanned. Tables are append only, and
+ * rows keep their unique ids through compaction, so an unchanged range of row ids means unchanged
+ * data. Results can still depend on the agent metadata, so entries also expire after a short TTL.
+ */
+class ResultCache : public NotCopyable {
+ public:
+  // The range of unique row ids that a memory source scans.
+  struct ScanRange {
+    std::string table_name;
+    std::string tablet;
+    int64_t start = 0;
+    int64_t stop = 0;
+
+    bool operator==(const ScanRange& other) const {
+      return table_name == other.table_name && tablet == other.tablet && start == other.start &&
+             stop == other.stop;
+    }
+  };
+
+  struct SinkBatch {
+    int64_t sink_id;
+    size_t parent_index;
+    table_store::schema::RowBatch rb;
+  };
+
+  struct Entry {
+    std::vector<ScanRange> scan_ranges;
+    // The batches consumed by all of the sinks, in the order that they were consumed.
+    std::vector<SinkBatch> sink_batches;
+    int64_t num_bytes = 0;
+  };
+
+  ResultCache(int64_t max_bytes, std::chrono::milliseconds ttl)
+      : max_bytes_(max_bytes), ttl_(ttl) {}
+
+  /**
+   * @return the key of the fragment, which leaves out the destinations of its sinks.
+   */
+  static std::string FragmentKey(const planpb::PlanFragment& fragment);
+
+  /**
+   * @return the entry for the fragment if it was computed over the same scan ranges and hasn't
+   * expired, otherwise nullptr.
+   */
+  std::shared_ptr<const Entry> Lookup(const std::string& fragment_key,
+                                      const std::vector<ScanRange>& scan_ranges);
+
+  /**
+   * Adds the entry for the fragment, replacing any older entry, and evicts the least recently used
+   * entries until the cache fits in max_bytes.
+   */
+  void Insert(const std::string& fragment_key, std::shared_ptr<const Entry> entry);
+
+  // Results that are bigger than this aren't worth keeping, since they would push out many others.
+  int64_t max_entry_bytes() const { return max_bytes_ / 4; }
+
+ private:
+  struct CachedEntry {
+    std::shared_ptr<const Entry> entry;
+    std::chrono::steady_clock::time_point inserted;
+    // The position of the fragment key in lru_.
+    std::list<std::string>::iterator lru_it;
+  };
+
+  void EraseLocked(absl::flat_hash_map<std::string, CachedEntry>::iterator it)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const int64_t max_bytes_;
+  const std::chrono::milliseconds ttl_;
+
+  absl::Mutex lock_;
+  absl::flat_hash_map<std::string, CachedEntry> entries_ ABSL_GUARDED_BY(lock_);
+  // The fragment keys, most recently used first.
+  std::list<std::string> lru_ ABSL_GUARDED_BY(lock_);
+  int64_t num_bytes_ ABSL_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/result_cache.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using ScanRange = ResultCache::ScanRange;
+
+namespace {
+
+std::shared_ptr<const ResultCache::Entry> MakeEntry(std::vector<ScanRange> scan_ranges,
+                                                    int64_t num_bytes) {
+  auto entry = std::make_shared<ResultCache::Entry>();
+  entry->scan_ranges = std::move(scan_ranges);
+  entry->num_bytes = num_bytes;
+  return entry;
+}
+
+planpb::PlanFragment MakeFragment(const std::string& table_name, const std::string& sink_name) {
+  planpb::PlanFragment fragment;
+  fragment.set_id(1);
+  auto* src = fragment.add_nodes();
+  src->set_id(1);
+  src->mutable_op()->set_op_type(planpb::MEMORY_SOURCE_OPERATOR);
+  src->mutable_op()->mutable_mem_source_op()->set_name(table_name);
+  auto* sink = fragment.add_nodes();
+  sink->set_id(2);
+  sink->mutable_op()->set_op_type(planpb::MEMORY_SINK_OPERATOR);
+  sink->mutable_op()->mutable_mem_sink_op()->set_name(sink_name);
+  return fragment;
+}
+
+}  // namespace
+
+TEST(ResultCacheTest, lookup_matches_scan_ranges) {
+  ResultCache cache(1024, std::chrono::milliseconds(60000));
+  std::vector<ScanRange> ranges{{"http_events", "", 0, 100}};
+  auto entry = MakeEntry(ranges, 10);
+  cache.Insert("fragment", entry);
+
+  EXPECT_EQ(entry, cache.Lookup("fragment", ranges));
+  EXPECT_EQ(nullptr, cache.Lookup("other_fragment", ranges));
+  // Rows were appended to the table since the entry was computed.
+  EXPECT_EQ(nullptr, cache.Lookup("fragment", {{"http_events", "", 0, 120}}));
+  EXPECT_EQ(nullptr, cache.Lookup("fragment", {{"http_events", "1", 0, 100}}));
+}
+
+TEST(ResultCacheTest, insert_replaces_entry) {
+  ResultCache cache(1024, std::chrono::milliseconds(60000));
+  cache.Insert("fragment", MakeEntry({{"http_events", "", 0, 100}}, 10));
+  std::vector<ScanRange> ranges{{"http_events", "", 0, 120}};
+  auto entry = MakeEntry(ranges, 10);
+  cache.Insert("fragment", entry);
+
+  EXPECT_EQ(entry, cache.Lookup("fragment", ranges));
+  EXPECT_EQ(nullptr, cache.Lookup("fragment", {{"http_events", "", 0, 100}}));
+}
+
+TEST(ResultCacheTest, entries_expire) {
+  ResultCache cache(1024, std::chrono::milliseconds(1));
+  std::vector<ScanRange> ranges{{"http_events", "", 0, 100}};
+  cache.Insert("fragment", MakeEntry(ranges, 10));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  EXPECT_EQ(nullptr, cache.Lookup("fragment", ranges));
+}
+
+TEST(ResultCacheTest, evicts_least_recently_used) {
+  ResultCache cache(100, std::chrono::milliseconds(60000));
+  std::vector<ScanRange> ranges{{"http_events", "", 0, 100}};
+  cache.Insert("a", MakeEntry(ranges, 20));
+  cache.Insert("b", MakeEntry(ranges, 20));
+  cache.Insert("c", MakeEntry(ranges, 20));
+  cache.Insert("d", MakeEntry(ranges, 20));
+  // Using a makes b the least recently used entry.
+  EXPECT_NE(nullptr, cache.Lookup("a", ranges));
+  cache.Insert("e", MakeEntry(ranges, 25));
+
+  EXPECT_NE(nullptr, cache.Lookup("a", ranges));
+  EXPECT_EQ(nullptr, cache.Lookup("b", ranges));
+  EXPECT_NE(nullptr, cache.Lookup("c", ranges));
+  EXPECT_NE(nullptr, cache.Lookup("d", ranges));
+  EXPECT_NE(nullptr, cache.Lookup("e", ranges));
+}
+
+TEST(ResultCacheTest, skips_large_entries) {
+  ResultCache cache(100, std::chrono::milliseconds(60000));
+  std::vector<ScanRange> ranges{{"http_events", "", 0, 100}};
+  cache.Insert("fragment", MakeEntry(ranges, cache.max_entry_bytes() + 1));
+
+  EXPECT_EQ(nullptr, cache.Lookup("fragment", ranges));
+}
+
+TEST(ResultCacheTest, fragment_key_ignores_sink_destination) {
+  EXPECT_EQ(ResultCache::FragmentKey(MakeFragment("http_events", "out1")),
+            ResultCache::FragmentKey(MakeFragment("http_events", "out2")));
+  EXPECT_NE(ResultCache::FragmentKey(MakeFragment("http_events", "out1")),
+            ResultCache::FragmentKey(MakeFragment("process_stats", "out1")));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/runtime_join_filter.h"
+
+#include <farmhash.h>
+#include <string.h>
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+#include "src/common/base/hash_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+namespace {
+
+constexpr uint64_t kJoinHashSeed = 0x9ae16a3b2f90404fULL;
+
+template <types::DataType DT>
+void HashKeyColumn(const arrow::Array* col, int64_t num_rows, std::vector<uint64_t>* hashes) {
+  for (int64_t i = 0; i < num_rows; ++i) {
+    uint64_t h;
+    if constexpr (DT == types::STRING) {
+      int32_t len;
+      const uint8_t* data = static_cast<const arrow::StringArray*>(col)->GetValue(i, &len);
+      h = ::util::Hash64(reinterpret_cast<const char*>(data), len);
+    } else if constexpr (DT == types::UINT128) {
+      auto val = types::GetValueFromArrowArray<DT>(col, i);
+      h = ::px::HashCombine(absl::Uint128Low64(val), absl::Uint128High64(val));
+    } else if constexpr (DT == types::FLOAT64) {
+      auto val = types::GetValueFromArrowArray<DT>(col, i);
+      memcpy(&h, &val, sizeof(uint64_t));
+    } else {
+      h = static_cast<uint64_t>(types::GetValueFromArrowArray<DT>(col, i));
+    }
+    (*hashes)[i] = ::px::HashCombine((*hashes)[i], h);
+  }
+}
+
+std::string_view HashBytes(const uint64_t& key_hash) {
+  return std::string_view(reinterpret_cast<const char*>(&key_hash), sizeof(key_hash));
+}
+
+}  // namespace
+
+void HashJoinKeys(const RowBatch& rb, const std::vector<int64_t>& key_indices,
+                  const std::vector<types::DataType>& key_types, std::vector<uint64_t>* hashes) {
+  DCHECK_EQ(key_indices.size(), key_types.size());
+  int64_t num_rows = rb.num_rows();
+  hashes->assign(num_rows, kJoinHashSeed);
+  // Hash column by column, so that each pass runs over a single contiguous array.
+  for (size_t key_idx = 0; key_idx < key_indices.size(); ++key_idx) {
+    auto col = rb.ColumnAt(key_indices[key_idx]).get();
+#define TYPE_CASE(_dt_) HashKeyColumn<_dt_>(col, num_rows, hashes);
+    PL_SWITCH_FOREACH_DATATYPE(key_types[key_idx], TYPE_CASE);
+#undef TYPE_CASE
+  }
+}
+
+StatusOr<std::unique_ptr<RuntimeJoinFilter>> RuntimeJoinFilter::Create(
+    std::vector<types::DataType> key_types, int64_t max_entries, double error_rate) {
+  PL_ASSIGN_OR_RETURN(auto bloom_filter, bloomfilter::XXHash64BloomFilter::Create(
+                                             std::max<int64_t>(max_entries, 1), error_rate));
+  return std::unique_ptr<RuntimeJoinFilter>(
+      new RuntimeJoinFilter(std::move(key_types), std::move(bloom_filter)));
+}
+
+void RuntimeJoinFilter::Insert(uint64_t key_hash) { bloom_filter_->Insert(HashBytes(key_hash)); }
+
+bool RuntimeJoinFilter::MayContain(uint64_t key_hash) const {
+  return bloom_filter_->Contains(HashBytes(key_hash));
+}
+
+void RuntimeJoinFilter::Apply(const std::vector<int64_t>& key_indices, RowBatch* rb) const {
+  std::vector<uint64_t> hashes;
+  HashJoinKeys(*rb, key_indices, key_types_, &hashes);
+
+  std::vector<int64_t> selection;
+  if (rb->has_selection()) {
+    selection.reserve(rb->selection().size());
+    for (int64_t row : rb->selection()) {
+      if (MayContain(hashes[row])) {
+        selection.push_back(row);
+      }
+    }
+  } else {
+    for (int64_t row = 0; row < rb->num_rows(); ++row) {
+      if (MayContain(hashes[row])) {
+        selection.push_back(row);
+      }
+    }
+  }
+  if (!rb->has_selection() && static_cast<int64_t>(selection.size()) == rb->num_rows()) {
+    // Every row may match, leave the row batch dense.
+    return;
+  }
+  rb->set_selection(std::move(selection));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * Hashes the given key columns of each row of rb into hashes (one per row of the underlying
+ * columns, ignoring any selection vector). The EquijoinNode build/probe and the RuntimeJoinFilter
+ * must agree on these hashes.
+ */
+void HashJoinKeys(const table_store::schema::RowBatch& rb, const std::vector<int64_t>& key_indices,
+                  const std::vector<types::DataType>& key_types, std::vector<uint64_t>* hashes);
+
+/**
+ * A RuntimeJoinFilter is a bloom filter over the join key hashes of the build side of an
+ * EquijoinNode. Once the build side is complete, it is handed to the source feeding the probe side
+ * so that rows which can't possibly match are dropped before they flow through the rest of the
+ * probe pipeline.
+ *
+ * The filter only applies to sources in the same plan fragment as the join. On Kelvin those are the
+ * GRPC sources that receive the probe side from the PEMs, so the filtered rows have already been
+ * sent over the network: the PEMs don't run a GRPC server, and the result stream from a PEM to
+ * Kelvin has no way to send data back while the query runs.
+ */
+class RuntimeJoinFilter {
+ public:
+  static constexpr double kDefaultErrorRate = 0.01;
+
+  /**
+   * Creates a filter sized for the given number of build keys.
+   */
+  static StatusOr<std::unique_ptr<RuntimeJoinFilter>> Create(
+      std::vector<types::DataType> key_types, int64_t max_entries,
+      double error_rate = kDefaultErrorRate);
+
+  void Insert(uint64_t key_hash);
+  bool MayContain(uint64_t key_hash) const;
+
+  /**
+   * Narrows the selection of rb down to the rows whose keys (in the columns key_indices) may be in
+   * the filter. The columns of rb are not copied.
+   */
+  void Apply(const std::vector<int64_t>& key_indices, table_store::schema::RowBatch* rb) const;
+
+  const std::vector<types::DataType>& key_types() const { return key_types_; }
+
+ private:
+  RuntimeJoinFilter(std::vector<types::DataType> key_types,
+                    std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter)
+      : key_types_(std::move(key_types)), bloom_filter_(std::move(bloom_filter)) {}
+
+  std::vector<types::DataType> key_types_;
+  std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter_;
+};
+
+/**
+ * A RuntimeJoinFilter to apply to the output of a source, along with the columns of the source
+ * that hold the join keys.
+ */
+struct SourceJoinFilter {
+  std::vector<int64_t> key_indices;
+  std::shared_ptr<const RuntimeJoinFilter> filter;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
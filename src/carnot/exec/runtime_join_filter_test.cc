@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/carnot/exec/runtime_join_filter.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+// Keep the false positive rate low enough that the tests are unaffected by it.
+constexpr double kTestErrorRate = 1e-6;
+
+class RuntimeJoinFilterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    RowDescriptor build_rd({types::DataType::INT64, types::DataType::STRING});
+    RowBatchBuilder build_rb(build_rd, 2, /*eow*/ true, /*eos*/ true);
+    build_rb.AddColumn<types::Int64Value>({1, 2}).AddColumn<types::StringValue>({"a", "b"});
+
+    ASSERT_OK_AND_ASSIGN(filter_, RuntimeJoinFilter::Create(key_types_, 2, kTestErrorRate));
+    std::vector<uint64_t> hashes;
+    HashJoinKeys(build_rb.get(), {0, 1}, key_types_, &hashes);
+    for (auto hash : hashes) {
+      filter_->Insert(hash);
+    }
+  }
+
+  std::unique_ptr<RowBatch> ProbeBatch() {
+    // The probe keys are in the opposite column order to the build keys.
+    RowDescriptor probe_rd({types::DataType::STRING, types::DataType::INT64});
+    RowBatchBuilder probe_rb(probe_rd, 4, /*eow*/ false, /*eos*/ false);
+    probe_rb.AddColumn<types::StringValue>({"a", "c", "b", "b"})
+        .AddColumn<types::Int64Value>({1, 3, 2, 1});
+    return std::make_unique<RowBatch>(probe_rb.get());
+  }
+
+  std::vector<types::DataType> key_types_{types::DataType::INT64, types::DataType::STRING};
+  std::unique_ptr<RuntimeJoinFilter> filter_;
+};
+
+TEST_F(RuntimeJoinFilterTest, apply) {
+  auto rb = ProbeBatch();
+  filter_->Apply({1, 0}, rb.get());
+  ASSERT_TRUE(rb->has_selection());
+  EXPECT_EQ(std::vector<int64_t>({0, 2}), rb->selection());
+  // The columns themselves are untouched.
+  EXPECT_EQ(4, rb->num_rows());
+}
+
+TEST_F(RuntimeJoinFilterTest, apply_narrows_selection) {
+  auto rb = ProbeBatch();
+  rb->set_selection({1, 2, 3});
+  filter_->Apply({1, 0}, rb.get());
+  EXPECT_EQ(std::vector<int64_t>({2}), rb->selection());
+}
+
+TEST_F(RuntimeJoinFilterTest, all_rows_match) {
+  RowDescriptor probe_rd({types::DataType::STRING, types::DataType::INT64});
+  RowBatchBuilder probe_rb(probe_rd, 2, /*eow*/ false, /*eos*/ false);
+  probe_rb.AddColumn<types::StringValue>({"b", "a"}).AddColumn<types::Int64Value>({2, 1});
+  filter_->Apply({1, 0}, &probe_rb.get());
+  EXPECT_FALSE(probe_rb.get().has_selection());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/sort_node.h"
+
+#include <arrow/array.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+namespace {
+
+// The buffer of a top-k is compacted back down to the limit once it holds this many times the
+// limit, which amortizes the cost of each compaction over the rows that were added since the last.
+constexpr int64_t kTopKCompactionFactor = 2;
+
+template <types::DataType DT>
+int CompareValues(const arrow::Array* a, int64_t a_idx, const arrow::Array* b, int64_t b_idx) {
+  if constexpr (DT == types::STRING) {
+    int32_t a_len;
+    int32_t b_len;
+    const uint8_t* a_data = static_cast<const arrow::StringArray*>(a)->GetValue(a_idx, &a_len);
+    const uint8_t* b_data = static_cast<const arrow::StringArray*>(b)->GetValue(b_idx, &b_len);
+    int cmp = memcmp(a_data, b_data, std::min(a_len, b_len));
+    if (cmp != 0) {
+      return cmp;
+    }
+    return a_len < b_len ? -1 : (a_len > b_len ? 1 : 0);
+  } else {
+    auto a_val = types::GetValueFromArrowArray<DT>(a, a_idx);
+    auto b_val = types::GetValueFromArrowArray<DT>(b, b_idx);
+    if constexpr (DT == types::FLOAT64) {
+      // NaN is unordered, which would break the strict weak ordering that std::sort and the
+      // top-k compaction rely on. Order it after every other value instead, and equal to itself.
+      bool a_nan = std::isnan(a_val);
+      bool b_nan = std::isnan(b_val);
+      if (a_nan || b_nan) {
+        return static_cast<int>(a_nan) - static_cast<int>(b_nan);
+      }
+    }
+    if (a_val < b_val) {
+      return -1;
+    }
+    return b_val < a_val ? 1 : 0;
+  }
+}
+
+template <types::DataType DT, typename TRowRef>
+Status GatherColumn(const std::vector<std::shared_ptr<arrow::Array>>& input_cols,
+                    const TRowRef* rows, int64_t num_rows, std::shared_ptr<arrow::Array>* output) {
+  auto output_builder = MakeArrowBuilder(DT, arrow::default_memory_pool());
+  auto* builder =
+      static_cast<typename types::DataTypeTraits<DT>::arrow_builder_type*>(output_builder.get());
+  PL_RETURN_IF_ERROR(builder->Reserve(num_rows));
+  if constexpr (DT == types::STRING) {
+    int64_t total_size = 0;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      total_size += static_cast<const arrow::StringArray*>(input_cols[rows[i].batch_idx].get())
+                        ->value_length(rows[i].row_idx);
+    }
+    PL_RETURN_IF_ERROR(builder->ReserveData(total_size));
+  }
+  for (int64_t i = 0; i < num_rows; ++i) {
+    builder->UnsafeAppend(
+        types::GetValueFromArrowArray<DT>(input_cols[rows[i].batch_idx].get(), rows[i].row_idx));
+  }
+  PL_RETURN_IF_ERROR(builder->Finish(output));
+  return Status::OK();
+}
+
+}  // namespace
+
+std::string SortNode::DebugStringImpl() {
+  return absl::Substitute("Exec::SortNode<$0>", plan_node_->DebugString());
+}
+
+Status SortNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::SORT_OPERATOR);
+  const auto* sort_plan_node = static_cast<const plan::SortOperator*>(&plan_node);
+  // copy the plan node to local object;
+  plan_node_ = std::make_unique<plan::SortOperator>(*sort_plan_node);
+
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("Sort operator expects a single input relation, got $0",
+                                  input_descriptors_.size());
+  }
+  const auto& input_desc = input_descriptors_[0];
+
+  buffered_input_cols_ = plan_node_->selected_cols();
+  for (int64_t sort_col : plan_node_->sort_cols()) {
+    auto it = std::find(buffered_input_cols_.begin(), buffered_input_cols_.end(), sort_col);
+    sort_buffer_idx_.push_back(it - buffered_input_cols_.begin());
+    if (it == buffered_input_cols_.end()) {
+      buffered_input_cols_.push_back(sort_col);
+    }
+  }
+  for (int64_t input_col : buffered_input_cols_) {
+    buffered_types_.push_back(input_desc.type(input_col));
+  }
+
+  descending_ = plan_node_->descending();
+  for (int64_t sort_col : plan_node_->sort_cols()) {
+#define TYPE_CASE(_dt_) compare_fns_.push_back(&CompareValues<_dt_>);
+    PL_SWITCH_FOREACH_DATATYPE(input_desc.type(sort_col), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  buffered_cols_.resize(buffered_input_cols_.size());
+  return Status::OK();
+}
+
+Status SortNode::PrepareImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status SortNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status SortNode::CloseImpl(ExecState* /*exec_state*/) {
+  buffered_cols_.clear();
+  batch_num_rows_.clear();
+  num_buffered_rows_ = 0;
+  return Status::OK();
+}
+
+bool SortNode::RowLess(const RowRef& a, const RowRef& b) const {
+  for (size_t i = 0; i < compare_fns_.size(); ++i) {
+    const auto& col = buffered_cols_[sort_buffer_idx_[i]];
+    int cmp = compare_fns_[i](col[a.batch_idx].get(), a.row_idx, col[b.batch_idx].get(), b.row_idx);
+    if (cmp != 0) {
+      return descending_[i] ? cmp > 0 : cmp < 0;
+    }
+  }
+  // Break ties by input order, which makes the sort stable (and the top-k deterministic).
+  if (a.batch_idx != b.batch_idx) {
+    return a.batch_idx < b.batch_idx;
+  }
+  return a.row_idx < b.row_idx;
+}
+
+std::vector<SortNode::RowRef> SortNode::SortedRows() const {
+  std::vector<RowRef> rows;
+  rows.reserve(num_buffered_rows_);
+  for (size_t batch_idx = 0; batch_idx < batch_num_rows_.size(); ++batch_idx) {
+    for (int64_t row_idx = 0; row_idx < batch_num_rows_[batch_idx]; ++row_idx) {
+      rows.push_back({static_cast<int32_t>(batch_idx), static_cast<int32_t>(row_idx)});
+    }
+  }
+  auto less = [this](const RowRef& a, const RowRef& b) { return RowLess(a, b); };
+  int64_t limit = plan_node_->limit();
+  if (limit > 0 && limit < static_cast<int64_t>(rows.size())) {
+    std::partial_sort(rows.begin(), rows.begin() + limit, rows.end(), less);
+    rows.resize(limit);
+  } else {
+    std::sort(rows.begin(), rows.end(), less);
+  }
+  return rows;
+}
+
+Status SortNode::GatherRows(const RowRef* rows, int64_t num_rows,
+                            std::vector<std::shared_ptr<arrow::Array>>* columns) const {
+  columns->resize(buffered_cols_.size());
+  for (size_t col = 0; col < buffered_cols_.size(); ++col) {
+#define TYPE_CASE(_dt_) \
+  PL_RETURN_IF_ERROR(GatherColumn<_dt_>(buffered_cols_[col], rows, num_rows, &(*columns)[col]));
+    PL_SWITCH_FOREACH_DATATYPE(buffered_types_[col], TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return Status::OK();
+}
+
+Status SortNode::CompactToLimit() {
+  auto rows = SortedRows();
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  PL_RETURN_IF_ERROR(GatherRows(rows.data(), rows.size(), &columns));
+  // The kept rows replace the buffer as a single batch, in sorted order. Since ties were broken by
+  // input order, the order of equal rows is preserved.
+  for (size_t col = 0; col < columns.size(); ++col) {
+    buffered_cols_[col] = {columns[col]};
+  }
+  batch_num_rows_ = {static_cast<int64_t>(rows.size())};
+  num_buffered_rows_ = rows.size();
+  return Status::OK();
+}
+
+Status SortNode::EmitSortedRows(ExecState* exec_state) {
+  auto rows = SortedRows();
+  int64_t num_rows = rows.size();
+  if (num_rows == 0) {
+    PL_ASSIGN_OR_RETURN(auto rb, RowBatch::WithZeroRows(*output_descriptor_, /*eow*/ true,
+                                                        /*eos*/ true));
+    return SendRowBatchToChildren(exec_state, *rb);
+  }
+
+  size_t num_output_cols = plan_node_->selected_cols().size();
+  for (int64_t offset = 0; offset < num_rows; offset += kDefaultSortRowBatchSize) {
+    int64_t batch_size = std::min(kDefaultSortRowBatchSize, num_rows - offset);
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    PL_RETURN_IF_ERROR(GatherRows(rows.data() + offset, batch_size, &columns));
+
+    bool last = offset + batch_size == num_rows;
+    RowBatch output_rb(*output_descriptor_, batch_size);
+    output_rb.set_eow(last);
+    output_rb.set_eos(last);
+    for (size_t col = 0; col < num_output_cols; ++col) {
+      PL_RETURN_IF_ERROR(output_rb.AddColumn(columns[col]));
+    }
+    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  }
+  return Status::OK();
+}
+
+Status SortNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (rb.num_rows() > 0) {
+    for (size_t col = 0; col < buffered_input_cols_.size(); ++col) {
+      buffered_cols_[col].push_back(rb.ColumnAt(buffered_input_cols_[col]));
+    }
+    batch_num_rows_.push_back(rb.num_rows());
+    num_buffered_rows_ += rb.num_rows();
+  }
+
+  int64_t limit = plan_node_->limit();
+  if (limit > 0 && num_buffered_rows_ >= kTopKCompactionFactor * limit) {
+    PL_RETURN_IF_ERROR(CompactToLimit());
+  }
+
+  if (rb.eos()) {
+    return EmitSortedRows(exec_state);
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/common/base/status.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+constexpr int64_t kDefaultSortRowBatchSize = 1024;
+
+/**
+ * SortNode buffers its input and, once it has seen the end of stream, outputs it ordered by the
+ * sort columns. Rows that compare equal keep their input order.
+ *
+ * If the plan sets a limit, the node is a top-k: whenever the buffered rows grow past twice the
+ * limit, only the first limit rows (in sorted order) are kept, so the state stays bounded by the
+ * limit rather than by the input size.
+ */
+class SortNode : public ProcessingNode {
+ public:
+  SortNode() = default;
+  virtual ~SortNode() = default;
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  // A reference to a row of one of the buffered batches.
+  struct RowRef {
+    int32_t batch_idx;
+    int32_t row_idx;
+  };
+  using CompareFn = int (*)(const arrow::Array*, int64_t, const arrow::Array*, int64_t);
+
+  bool RowLess(const RowRef& a, const RowRef& b) const;
+  // Returns the buffered rows in sorted order, truncated to the limit (if there is one).
+  std::vector<RowRef> SortedRows() const;
+  Status GatherRows(const RowRef* rows, int64_t num_rows,
+                    std::vector<std::shared_ptr<arrow::Array>>* columns) const;
+  Status CompactToLimit();
+  Status EmitSortedRows(ExecState* exec_state);
+
+  // The input columns that are buffered: the output columns followed by any sort columns that
+  // aren't also output.
+  std::vector<int64_t> buffered_input_cols_;
+  std::vector<types::DataType> buffered_types_;
+  // For each sort column, its index in buffered_input_cols_.
+  std::vector<int64_t> sort_buffer_idx_;
+  std::vector<bool> descending_;
+  std::vector<CompareFn> compare_fns_;
+
+  // The buffered input, indexed by [buffered column][batch].
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> buffered_cols_;
+  std::vector<int64_t> batch_num_rows_;
+  int64_t num_buffered_rows_ = 0;
+
+  std::unique_ptr<plan::SortOperator> plan_node_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
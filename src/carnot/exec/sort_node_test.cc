@@ -0,0 +1,240 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/sort_node.h"
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+// Input: [int_col:Int64, str_col:String, float_col:Float64]
+// Output: [str_col:String, int_col:Int64]
+// Sorted by int_col descending, then by float_col ascending.
+constexpr char kSortOperatorTmpl[] = R"(
+sort_columns {
+  column {
+    index: 0
+  }
+  descending: true
+}
+sort_columns {
+  column {
+    index: 2
+  }
+}
+columns {
+  index: 1
+}
+columns {
+  index: 0
+}
+limit: $0
+)";
+
+std::unique_ptr<plan::Operator> SortPlanNode(int64_t limit) {
+  planpb::Operator op_pb;
+  EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(planpb::testutils::kOperatorProtoTmpl, "SORT_OPERATOR", "sort_op",
+                       absl::Substitute(kSortOperatorTmpl, limit)),
+      &op_pb));
+  return plan::SortOperator::FromProto(op_pb, 1);
+}
+
+class SortNodeTest : public ::testing::Test {
+ public:
+  SortNodeTest() {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  RowDescriptor input_rd_{types::DataType::INT64, types::DataType::STRING,
+                          types::DataType::FLOAT64};
+  RowDescriptor output_rd_{types::DataType::STRING, types::DataType::INT64};
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+};
+
+TEST_F(SortNodeTest, full_sort) {
+  auto plan_node = SortPlanNode(0);
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node, output_rd_,
+                                                                   {input_rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 3, 2})
+                       .AddColumn<types::StringValue>({"a", "b", "c"})
+                       .AddColumn<types::Float64Value>({0.5, 1.5, 2.5})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({2, 3, 1})
+                       .AddColumn<types::StringValue>({"d", "e", "f"})
+                       .AddColumn<types::Float64Value>({0.1, 1.5, 0.2})
+                       .get(),
+                   0, 1)
+      // Ties on both sort columns ("b" and "e") keep their input order.
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 6, true, true)
+                          .AddColumn<types::StringValue>({"b", "e", "d", "c", "f", "a"})
+                          .AddColumn<types::Int64Value>({3, 3, 2, 2, 1, 1})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, top_k) {
+  auto plan_node = SortPlanNode(2);
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node, output_rd_,
+                                                                   {input_rd_}, exec_state_.get());
+  // Each batch pushes the buffer past twice the limit, so it gets compacted as it goes.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 5, 2, 5})
+                       .AddColumn<types::StringValue>({"a", "b", "c", "d"})
+                       .AddColumn<types::Float64Value>({0.0, 2.0, 0.0, 1.0})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({4, 7, 0})
+                       .AddColumn<types::StringValue>({"e", "f", "g"})
+                       .AddColumn<types::Float64Value>({0.0, 0.0, 0.0})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({5, 3})
+                       .AddColumn<types::StringValue>({"h", "i"})
+                       .AddColumn<types::Float64Value>({0.5, 0.0})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 2, true, true)
+                          .AddColumn<types::StringValue>({"f", "h"})
+                          .AddColumn<types::Int64Value>({7, 5})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, nan_sorts_last) {
+  constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+  // The int_col ties everywhere, so rows are ordered by float_col ascending, with NaN last.
+  for (int64_t limit : {0, 3}) {
+    auto plan_node = SortPlanNode(limit);
+    auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(
+        *plan_node, output_rd_, {input_rd_}, exec_state_.get());
+    tester
+        .ConsumeNext(RowBatchBuilder(input_rd_, 4, /*eow*/ false, /*eos*/ false)
+                         .AddColumn<types::Int64Value>({1, 1, 1, 1})
+                         .AddColumn<types::StringValue>({"a", "b", "c", "d"})
+                         .AddColumn<types::Float64Value>({kNaN, 2.0, kNaN, -1.0})
+                         .get(),
+                     0, 0)
+        .ConsumeNext(RowBatchBuilder(input_rd_, 3, /*eow*/ true, /*eos*/ true)
+                         .AddColumn<types::Int64Value>({1, 1, 1})
+                         .AddColumn<types::StringValue>({"e", "f", "g"})
+                         .AddColumn<types::Float64Value>({0.5, kNaN, 3.0})
+                         .get(),
+                     0, 1);
+    if (limit == 0) {
+      tester.ExpectRowBatch(RowBatchBuilder(output_rd_, 7, true, true)
+                                .AddColumn<types::StringValue>({"d", "e", "b", "g", "a", "c", "f"})
+                                .AddColumn<types::Int64Value>({1, 1, 1, 1, 1, 1, 1})
+                                .get());
+    } else {
+      tester.ExpectRowBatch(RowBatchBuilder(output_rd_, 3, true, true)
+                                .AddColumn<types::StringValue>({"d", "e", "b"})
+                                .AddColumn<types::Int64Value>({1, 1, 1})
+                                .get());
+    }
+    tester.Close();
+  }
+}
+
+TEST_F(SortNodeTest, empty_input) {
+  auto plan_node = SortPlanNode(10);
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node, output_rd_,
+                                                                   {input_rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_, 0, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({})
+                       .AddColumn<types::StringValue>({})
+                       .AddColumn<types::Float64Value>({})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 0, true, true)
+                          .AddColumn<types::StringValue>({})
+                          .AddColumn<types::Int64Value>({})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, multiple_output_batches) {
+  auto plan_node = SortPlanNode(0);
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(*plan_node, output_rd_,
+                                                                   {input_rd_}, exec_state_.get());
+  int64_t num_rows = kDefaultSortRowBatchSize + 10;
+  std::vector<types::Int64Value> ints;
+  std::vector<types::StringValue> strs;
+  std::vector<types::Float64Value> floats;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    ints.emplace_back(i);
+    strs.emplace_back(std::to_string(i));
+    floats.emplace_back(0.0);
+  }
+  RowBatchBuilder input_rb(input_rd_, num_rows, /*eow*/ true, /*eos*/ true);
+  input_rb.AddColumn<types::Int64Value>(ints)
+      .AddColumn<types::StringValue>(strs)
+      .AddColumn<types::Float64Value>(floats);
+
+  tester.ConsumeNext(input_rb.get(), 0, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, kDefaultSortRowBatchSize, false, false)
+                          .AddColumn<types::StringValue>(std::vector<types::StringValue>(
+                              strs.rbegin(), strs.rbegin() + kDefaultSortRowBatchSize))
+                          .AddColumn<types::Int64Value>(std::vector<types::Int64Value>(
+                              ints.rbegin(), ints.rbegin() + kDefaultSortRowBatchSize))
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 10, true, true)
+                          .AddColumn<types::StringValue>({"9", "8", "7", "6", "5", "4", "3",
+                                                          "2", "1", "0"})
+                          .AddColumn<types::Int64Value>({9, 8, 7, 6, 5, 4, 3, 2, 1, 0})
+                          .get())
+      .Close();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
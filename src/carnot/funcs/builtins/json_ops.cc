@@ -18,6 +18,8 @@
 
 #include "src/carnot/funcs/builtins/json_ops.h"
 
+#include <limits>
+
 #include "src/carnot/udf/registry.h"
 
 namespace px {
@@ -26,6 +28,155 @@ namespace builtins {
 
 using types::StringValue;
 
+bool JSONPluckHandler::Pluck(const char* json) {
+  rapidjson::Reader reader;
+  rapidjson::StringStream stream(json);
+  // The handler stops the parse once the value is read, which the reader reports as an error.
+  reader.Parse(stream, *this);
+  return state_ == State::kDone;
+}
+
+bool JSONPluckHandler::ScalarValue(ValueType value_type) {
+  switch (state_) {
+    case State::kKeyFound:
+      value_type_ = value_type;
+      state_ = State::kDone;
+      return false;
+    case State::kReadingValue:
+      return true;
+    case State::kSearching:
+      // A scalar at the root means the document isn't an object.
+      return depth_ > 0;
+    case State::kDone:
+      return false;
+  }
+  return false;
+}
+
+bool JSONPluckHandler::StartNestedValue() {
+  switch (state_) {
+    case State::kKeyFound:
+      value_type_ = ValueType::kOther;
+      state_ = State::kReadingValue;
+      depth_ = 1;
+      return true;
+    case State::kReadingValue:
+      ++depth_;
+      return true;
+    case State::kSearching:
+      ++depth_;
+      return true;
+    case State::kDone:
+      return false;
+  }
+  return false;
+}
+
+bool JSONPluckHandler::EndNestedValue() {
+  --depth_;
+  if (state_ == State::kReadingValue && depth_ == 0) {
+    state_ = State::kDone;
+    return false;
+  }
+  return true;
+}
+
+bool JSONPluckHandler::Null() {
+  if (state_ != State::kSearching) {
+    writer_.Null();
+  }
+  return ScalarValue(ValueType::kNull);
+}
+
+bool JSONPluckHandler::Bool(bool b) {
+  if (state_ != State::kSearching) {
+    writer_.Bool(b);
+  }
+  return ScalarValue(ValueType::kOther);
+}
+
+bool JSONPluckHandler::Int(int i) { return Int64(i); }
+
+bool JSONPluckHandler::Uint(unsigned u) { return Int64(u); }
+
+bool JSONPluckHandler::Int64(int64_t i) {
+  if (state_ != State::kSearching) {
+    writer_.Int64(i);
+    int64_value_ = i;
+  }
+  return ScalarValue(ValueType::kInt64);
+}
+
+bool JSONPluckHandler::Uint64(uint64_t u) {
+  if (u <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+    return Int64(static_cast<int64_t>(u));
+  }
+  if (state_ != State::kSearching) {
+    writer_.Uint64(u);
+  }
+  return ScalarValue(ValueType::kOther);
+}
+
+bool JSONPluckHandler::Double(double d) {
+  if (state_ != State::kSearching) {
+    writer_.Double(d);
+    double_value_ = d;
+  }
+  return ScalarValue(ValueType::kDouble);
+}
+
+bool JSONPluckHandler::String(const char* str, rapidjson::SizeType length, bool copy) {
+  if (state_ == State::kKeyFound) {
+    string_value_.assign(str, length);
+  }
+  if (state_ != State::kSearching) {
+    writer_.String(str, length, copy);
+  }
+  return ScalarValue(ValueType::kString);
+}
+
+bool JSONPluckHandler::StartObject() {
+  if (state_ != State::kSearching) {
+    writer_.StartObject();
+  }
+  return StartNestedValue();
+}
+
+bool JSONPluckHandler::Key(const char* str, rapidjson::SizeType length, bool copy) {
+  if (state_ == State::kReadingValue) {
+    writer_.Key(str, length, copy);
+  } else if (state_ == State::kSearching && depth_ == 1 &&
+             std::string_view(str, length) == key_) {
+    state_ = State::kKeyFound;
+  }
+  return true;
+}
+
+bool JSONPluckHandler::EndObject(rapidjson::SizeType member_count) {
+  if (state_ == State::kReadingValue) {
+    writer_.EndObject(member_count);
+  }
+  return EndNestedValue();
+}
+
+bool JSONPluckHandler::StartArray() {
+  if (state_ == State::kSearching && depth_ == 0) {
+    // The document is an array, not an object.
+    return false;
+  }
+  if (state_ != State::kSearching) {
+    writer_.StartArray();
+  }
+  return StartNestedValue();
+}
+
+bool JSONPluckHandler::EndArray(rapidjson::SizeType element_count) {
+  if (state_ == State::kReadingValue) {
+    writer_.EndArray(element_count);
+  }
+  return EndNestedValue();
+}
+
 void RegisterJSONOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<PluckUDF>("pluck");
   registry->RegisterOrDie<PluckAsInt64UDF>("pluck_int64");
@@ -19,10 +19,12 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
@@ -33,36 +35,99 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+/**
+ * JSONPluckHandler is a SAX handler that finds the value of a top level key of a JSON object
+ * without building a document. Parsing stops as soon as the value has been read, so the rest of
+ * the input is never scanned.
+ */
+class JSONPluckHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JSONPluckHandler> {
+ public:
+  enum class ValueType {
+    kNull,
+    kInt64,
+    kDouble,
+    kString,
+    // Booleans, integers that don't fit in an int64, objects and arrays.
+    kOther,
+  };
+
+  explicit JSONPluckHandler(const char* key) : key_(key), writer_(buffer_) {}
+
+  /**
+   * Scans the null terminated json for the key.
+   * @return true if the input is an object and the value of the key was read completely.
+   */
+  bool Pluck(const char* json);
+
+  ValueType value_type() const { return value_type_; }
+  int64_t int64_value() const { return int64_value_; }
+  double double_value() const { return double_value_; }
+  // The unescaped value of a string.
+  const std::string& string_value() const { return string_value_; }
+  // The serialized value, for any type.
+  std::string_view json_value() const { return {buffer_.GetString(), buffer_.GetSize()}; }
+
+  // SAX events, called by rapidjson::Reader. Returning false stops parsing.
+  bool Null();
+  bool Bool(bool b);
+  bool Int(int i);
+  bool Uint(unsigned u);
+  bool Int64(int64_t i);
+  bool Uint64(uint64_t u);
+  bool Double(double d);
+  bool String(const char* str, rapidjson::SizeType length, bool copy);
+  bool StartObject();
+  bool Key(const char* str, rapidjson::SizeType length, bool copy);
+  bool EndObject(rapidjson::SizeType member_count);
+  bool StartArray();
+  bool EndArray(rapidjson::SizeType element_count);
+
+ private:
+  enum class State {
+    kSearching,
+    // The key was found, the next value is the one to pluck.
+    kKeyFound,
+    // Reading a nested object or array value.
+    kReadingValue,
+    kDone,
+  };
+
+  bool ScalarValue(ValueType value_type);
+  bool StartNestedValue();
+  bool EndNestedValue();
+
+  std::string_view key_;
+  State state_ = State::kSearching;
+  // Nesting depth of the document while searching for the key, and of the value while reading it.
+  int depth_ = 0;
+
+  ValueType value_type_ = ValueType::kNull;
+  int64_t int64_value_ = 0;
+  double double_value_ = 0;
+  std::string string_value_;
+  rapidjson::StringBuffer buffer_;
+  rapidjson::Writer<rapidjson::StringBuffer> writer_;
+};
+
 // TODO(zasgar): PL-419 To have proper support for JSON we need structs and nullable types.
 // Revisit when we have them.
 class PluckUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    JSONPluckHandler handler(key.data());
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
+    if (!handler.Pluck(in.data())) {
       return "";
     }
-    if (!d.IsObject()) {
-      return "";
-    }
-    if (!d.HasMember(key.data())) {
-      return "";
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
-      return "";
-    }
-    if (plucked_value.IsString()) {
-      return plucked_value.GetString();
+    switch (handler.value_type()) {
+      case JSONPluckHandler::ValueType::kNull:
+        return "";
+      case JSONPluckHandler::ValueType::kString:
+        return handler.string_value();
+      default:
+        // This is robust to nested JSON.
+        return std::string(handler.json_value());
     }
-
-    // This is robust to nested JSON.
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    plucked_value.Accept(writer);
-    return sb.GetString();
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -87,24 +152,13 @@ class PluckUDF : public udf::ScalarUDF {
 class PluckAsInt64UDF : public udf::ScalarUDF {
  public:
   Int64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    JSONPluckHandler handler(key.data());
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return 0;
-    }
-    if (!d.IsObject()) {
-      return 0;
-    }
-    if (!d.HasMember(key.data())) {
+    if (!handler.Pluck(in.data())) {
       return 0;
     }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
-      return 0;
-    }
-    if (plucked_value.IsInt64()) {
-      return plucked_value.GetInt64();
+    if (handler.value_type() == JSONPluckHandler::ValueType::kInt64) {
+      return handler.int64_value();
     }
     return 0;
   }
@@ -131,24 +185,13 @@ class PluckAsInt64UDF : public udf::ScalarUDF {
 class PluckAsFloat64UDF : public udf::ScalarUDF {
  public:
   Float64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+    JSONPluckHandler handler(key.data());
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return 0.0;
-    }
-    if (!d.IsObject()) {
-      return 0.0;
-    }
-    if (!d.HasMember(key.data())) {
-      return 0.0;
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
+    if (!handler.Pluck(in.data())) {
       return 0.0;
     }
-    if (plucked_value.IsDouble()) {
-      return plucked_value.GetDouble();
+    if (handler.value_type() == JSONPluckHandler::ValueType::kDouble) {
+      return handler.double_value();
     }
     return 0.0;
   }
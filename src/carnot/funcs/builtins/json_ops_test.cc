@@ -60,6 +60,23 @@ TEST(JSONOps, PluckUDF_non_object_input_return_empty) {
   udf_tester.ForInput("[\"asdad\"]", "str_key").Expect("");
 }
 
+TEST(JSONOps, PluckUDF_only_matches_top_level_keys) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  udf_tester.ForInput(R"({"a": {"b": 1}, "b": [1, {"c": null}, "x"]})", "b")
+      .Expect(R"([1,{"c":null},"x"])");
+  udf_tester.ForInput(R"({"a": {"b": 1}})", "b").Expect("");
+  udf_tester.ForInput(R"({"a": null, "b": true})", "a").Expect("");
+  udf_tester.ForInput(R"({"a": null, "b": true})", "b").Expect("true");
+}
+
+TEST(JSONOps, PluckUDF_stops_after_value) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  // The input past the plucked value isn't scanned.
+  udf_tester.ForInput(R"({"a": "abc", "b": )", "a").Expect("abc");
+  // A value that isn't complete is never returned.
+  udf_tester.ForInput(R"({"a": {"b": 1)", "a").Expect("");
+}
+
 TEST(JSONOps, PluckAsInt64UDF) {
   auto udf_tester = udf::UDFTester<PluckAsInt64UDF>();
   udf_tester.ForInput(kTestJSONStr, "str_key").Expect(0);
@@ -68,6 +85,13 @@ TEST(JSONOps, PluckAsInt64UDF) {
   udf_tester.ForInput(kTestJSONStr, "str_plain").Expect(0);
 }
 
+TEST(JSONOps, PluckAsInt64UDF_out_of_range_return_zero) {
+  auto udf_tester = udf::UDFTester<PluckAsInt64UDF>();
+  udf_tester.ForInput(R"({"a": 9223372036854775807})", "a").Expect(9223372036854775807);
+  udf_tester.ForInput(R"({"a": 9223372036854775808})", "a").Expect(0);
+  udf_tester.ForInput(R"({"a": -12})", "a").Expect(-12);
+}
+
 TEST(JSONOps, PluckAsInt64UDF_bad_input_return_empty) {
   auto udf_tester = udf::UDFTester<PluckAsInt64UDF>();
   udf_tester.ForInput("sdasdsa", "int64_key").Expect(0);
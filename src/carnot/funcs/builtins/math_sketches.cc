@@ -18,6 +18,12 @@
 
 #include "src/carnot/funcs/builtins/math_sketches.h"
 
+#include <algorithm>
+#include <cmath>
+
+// NOLINTNEXTLINE: build/include_subdir
+#include "xxhash.h"
+
 namespace px {
 namespace carnot {
 namespace builtins {
@@ -25,6 +31,257 @@ namespace builtins {
 void RegisterMathSketchesOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<QuantilesUDA<types::Int64Value>>("quantiles");
   registry->RegisterOrDie<QuantilesUDA<types::Float64Value>>("quantiles");
+  registry->RegisterOrDie<DDSketchQuantilesUDA<types::Int64Value>>("quantiles_ddsketch");
+  registry->RegisterOrDie<DDSketchQuantilesUDA<types::Float64Value>>("quantiles_ddsketch");
+  registry->RegisterOrDie<CountDistinctUDA<types::Int64Value>>("count_distinct");
+  registry->RegisterOrDie<CountDistinctUDA<types::Time64NSValue>>("count_distinct");
+  registry->RegisterOrDie<CountDistinctUDA<types::StringValue>>("count_distinct");
+  registry->RegisterOrDie<CountDistinctUDA<types::UInt128Value>>("count_distinct");
+}
+
+uint64_t SketchHash(std::string_view bytes) { return XXH64(bytes.data(), bytes.size(), 0); }
+
+namespace {
+
+template <typename T>
+void AppendBytes(const T& val, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&val), sizeof(val));
+}
+
+// Reads a T from the front of data and advances it.
+template <typename T>
+bool ConsumeBytes(std::string_view* data, T* val) {
+  if (data->size() < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(val, data->data(), sizeof(T));
+  data->remove_prefix(sizeof(T));
+  return true;
+}
+
+// The first byte of a serialized HyperLogLog.
+enum class HLLEncoding : uint8_t {
+  // All of the registers.
+  kDense = 0,
+  // (uint16_t index, uint8_t value) for each non-zero register.
+  kSparse = 1,
+};
+
+constexpr size_t kSparseHLLEntrySize = sizeof(uint16_t) + sizeof(uint8_t);
+
+}  // namespace
+
+void HyperLogLog::AddHash(uint64_t hash) {
+  uint64_t idx = hash >> (64 - kPrecision);
+  // The sentinel bit bounds the rank for a hash whose remaining bits are all zero.
+  uint64_t remaining = (hash << kPrecision) | (uint64_t{1} << (kPrecision - 1));
+  auto rank = static_cast<uint8_t>(__builtin_clzll(remaining) + 1);
+  registers_[idx] = std::max(registers_[idx], rank);
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+  for (int64_t i = 0; i < kNumRegisters; ++i) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+}
+
+int64_t HyperLogLog::Estimate() const {
+  constexpr double m = kNumRegisters;
+  constexpr double alpha = 0.7213 / (1 + 1.079 / m);
+  double sum = 0;
+  int64_t num_zeros = 0;
+  for (uint8_t reg : registers_) {
+    sum += std::ldexp(1.0, -reg);
+    num_zeros += reg == 0;
+  }
+  double estimate = alpha * m * m / sum;
+  // Linear counting is more accurate for small cardinalities.
+  if (estimate <= 2.5 * m && num_zeros > 0) {
+    estimate = m * std::log(m / num_zeros);
+  }
+  return std::llround(estimate);
+}
+
+std::string HyperLogLog::Serialize() const {
+  int64_t num_nonzero = std::count_if(registers_.begin(), registers_.end(),
+                                      [](uint8_t reg) { return reg != 0; });
+  std::string out;
+  if (num_nonzero * static_cast<int64_t>(kSparseHLLEntrySize) >= kNumRegisters) {
+    out.reserve(1 + kNumRegisters);
+    AppendBytes(HLLEncoding::kDense, &out);
+    out.append(reinterpret_cast<const char*>(registers_.data()), registers_.size());
+    return out;
+  }
+  out.reserve(1 + num_nonzero * kSparseHLLEntrySize);
+  AppendBytes(HLLEncoding::kSparse, &out);
+  for (int64_t i = 0; i < kNumRegisters; ++i) {
+    if (registers_[i] != 0) {
+      AppendBytes(static_cast<uint16_t>(i), &out);
+      AppendBytes(registers_[i], &out);
+    }
+  }
+  return out;
+}
+
+Status HyperLogLog::Deserialize(std::string_view data) {
+  HLLEncoding encoding = HLLEncoding::kDense;
+  if (!ConsumeBytes(&data, &encoding)) {
+    return error::InvalidArgument("Empty HyperLogLog state");
+  }
+  std::fill(registers_.begin(), registers_.end(), 0);
+  switch (encoding) {
+    case HLLEncoding::kDense:
+      if (data.size() != static_cast<size_t>(kNumRegisters)) {
+        return error::InvalidArgument("Dense HyperLogLog state has $0 registers, expected $1",
+                                      data.size(), kNumRegisters);
+      }
+      std::memcpy(registers_.data(), data.data(), data.size());
+      return Status::OK();
+    case HLLEncoding::kSparse:
+      if (data.size() % kSparseHLLEntrySize != 0) {
+        return error::InvalidArgument("Invalid sparse HyperLogLog state of size $0", data.size());
+      }
+      while (!data.empty()) {
+        uint16_t idx = 0;
+        uint8_t reg = 0;
+        ConsumeBytes(&data, &idx);
+        ConsumeBytes(&data, &reg);
+        if (idx >= kNumRegisters) {
+          return error::InvalidArgument("HyperLogLog register $0 is out of range", idx);
+        }
+        registers_[idx] = reg;
+      }
+      return Status::OK();
+  }
+  return error::InvalidArgument("Unknown HyperLogLog encoding $0", static_cast<int>(encoding));
+}
+
+DDSketch::DDSketch()
+    : gamma_((1 + kRelativeAccuracy) / (1 - kRelativeAccuracy)), log_gamma_(std::log(gamma_)) {}
+
+int32_t DDSketch::BinIndex(double magnitude) const {
+  return static_cast<int32_t>(std::ceil(std::log(magnitude) / log_gamma_));
+}
+
+double DDSketch::BinValue(int32_t index) const {
+  // The bin with index i holds the values in (gamma^(i-1), gamma^i]. This value is within the
+  // relative accuracy of both ends.
+  return 2 * std::pow(gamma_, index) / (gamma_ + 1);
+}
+
+void DDSketch::Add(double value) {
+  if (!std::isfinite(value)) {
+    return;
+  }
+  if (value > kMinIndexableValue) {
+    ++positive_bins_[BinIndex(value)];
+  } else if (value < -kMinIndexableValue) {
+    ++negative_bins_[BinIndex(-value)];
+  } else {
+    ++zero_count_;
+  }
+  min_ = count_ == 0 ? value : std::min(min_, value);
+  max_ = count_ == 0 ? value : std::max(max_, value);
+  ++count_;
+}
+
+void DDSketch::Merge(const DDSketch& other) {
+  if (other.count_ == 0) {
+    return;
+  }
+  for (const auto& [idx, count] : other.positive_bins_) {
+    positive_bins_[idx] += count;
+  }
+  for (const auto& [idx, count] : other.negative_bins_) {
+    negative_bins_[idx] += count;
+  }
+  zero_count_ += other.zero_count_;
+  min_ = count_ == 0 ? other.min_ : std::min(min_, other.min_);
+  max_ = count_ == 0 ? other.max_ : std::max(max_, other.max_);
+  count_ += other.count_;
+}
+
+double DDSketch::Quantile(double q) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  q = std::clamp(q, 0.0, 1.0);
+  auto rank = static_cast<uint64_t>(q * (count_ - 1));
+  uint64_t seen = 0;
+  double value = max_;
+  // Walk the bins in increasing order of value: negative values from the largest magnitude down,
+  // then zero, then positive values.
+  bool found = false;
+  for (auto it = negative_bins_.rbegin(); it != negative_bins_.rend() && !found; ++it) {
+    seen += it->second;
+    if (seen > rank) {
+      value = -BinValue(it->first);
+      found = true;
+    }
+  }
+  if (!found) {
+    seen += zero_count_;
+    if (seen > rank) {
+      value = 0;
+      found = true;
+    }
+  }
+  for (auto it = positive_bins_.begin(); it != positive_bins_.end() && !found; ++it) {
+    seen += it->second;
+    if (seen > rank) {
+      value = BinValue(it->first);
+      found = true;
+    }
+  }
+  return std::clamp(value, min_, max_);
+}
+
+std::string DDSketch::Serialize() const {
+  std::string out;
+  out.reserve(4 * sizeof(uint64_t) + 2 * sizeof(double) +
+              (positive_bins_.size() + negative_bins_.size()) *
+                  (sizeof(int32_t) + sizeof(uint64_t)));
+  AppendBytes(count_, &out);
+  AppendBytes(zero_count_, &out);
+  AppendBytes(min_, &out);
+  AppendBytes(max_, &out);
+  for (const auto* bins : {&negative_bins_, &positive_bins_}) {
+    AppendBytes(static_cast<uint64_t>(bins->size()), &out);
+    for (const auto& [idx, count] : *bins) {
+      AppendBytes(idx, &out);
+      AppendBytes(count, &out);
+    }
+  }
+  return out;
+}
+
+Status DDSketch::Deserialize(std::string_view data) {
+  positive_bins_.clear();
+  negative_bins_.clear();
+  uint64_t bins_count = 0;
+  if (!ConsumeBytes(&data, &count_) || !ConsumeBytes(&data, &zero_count_) ||
+      !ConsumeBytes(&data, &min_) || !ConsumeBytes(&data, &max_)) {
+    return error::InvalidArgument("DDSketch state is truncated");
+  }
+  for (auto* bins : {&negative_bins_, &positive_bins_}) {
+    uint64_t num_bins = 0;
+    if (!ConsumeBytes(&data, &num_bins)) {
+      return error::InvalidArgument("DDSketch state is truncated");
+    }
+    for (uint64_t i = 0; i < num_bins; ++i) {
+      int32_t idx = 0;
+      uint64_t count = 0;
+      if (!ConsumeBytes(&data, &idx) || !ConsumeBytes(&data, &count)) {
+        return error::InvalidArgument("DDSketch state is truncated");
+      }
+      (*bins)[idx] += count;
+      bins_count += count;
+    }
+  }
+  if (!data.empty() || bins_count + zero_count_ != count_) {
+    return error::InvalidArgument("DDSketch state is inconsistent");
+  }
+  return Status::OK();
 }
 
 }  // namespace builtins
@@ -21,7 +21,15 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
 #include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
 #include "src/shared/types/types.h"
 #include "tdigest/tdigest.h"
 
@@ -29,6 +37,27 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+/**
+ * Serializes the percentiles reported by the quantiles UDAs as a JSON object.
+ * @param quantile A function that returns the value at the given quantile.
+ */
+template <typename TQuantileFn>
+StringValue QuantilesToJSON(TQuantileFn quantile) {
+  rapidjson::Document d;
+  d.SetObject();
+  d.AddMember("p01", quantile(0.01), d.GetAllocator());
+  d.AddMember("p10", quantile(0.10), d.GetAllocator());
+  d.AddMember("p25", quantile(0.25), d.GetAllocator());
+  d.AddMember("p50", quantile(0.50), d.GetAllocator());
+  d.AddMember("p75", quantile(0.75), d.GetAllocator());
+  d.AddMember("p90", quantile(0.90), d.GetAllocator());
+  d.AddMember("p99", quantile(0.99), d.GetAllocator());
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  d.Accept(writer);
+  return sb.GetString();
+}
+
 // TODO(zasgar): PL-419 Replace this when we add support for structs.
 template <typename TArg>
 class QuantilesUDA : public udf::UDA {
@@ -38,19 +67,32 @@ class QuantilesUDA : public udf::UDA {
   void Merge(FunctionContext*, const QuantilesUDA& other) { digest_.merge(&other.digest_); }
 
   StringValue Finalize(FunctionContext*) {
-    rapidjson::Document d;
-    d.SetObject();
-    d.AddMember("p01", digest_.quantile(0.01), d.GetAllocator());
-    d.AddMember("p10", digest_.quantile(0.10), d.GetAllocator());
-    d.AddMember("p25", digest_.quantile(0.25), d.GetAllocator());
-    d.AddMember("p50", digest_.quantile(0.50), d.GetAllocator());
-    d.AddMember("p75", digest_.quantile(0.75), d.GetAllocator());
-    d.AddMember("p90", digest_.quantile(0.90), d.GetAllocator());
-    d.AddMember("p99", digest_.quantile(0.99), d.GetAllocator());
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    d.Accept(writer);
-    return sb.GetString();
+    return QuantilesToJSON([this](double q) { return digest_.quantile(q); });
+  }
+
+  // The partial state is the list of (mean, weight) pairs of the compressed centroids.
+  StringValue Serialize(FunctionContext*) {
+    digest_.compress();
+    std::vector<double> centroids;
+    centroids.reserve(2 * digest_.processed().size());
+    for (const auto& centroid : digest_.processed()) {
+      centroids.push_back(centroid.mean());
+      centroids.push_back(centroid.weight());
+    }
+    return StringValue(reinterpret_cast<const char*>(centroids.data()),
+                       centroids.size() * sizeof(double));
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    if (data.size() % (2 * sizeof(double)) != 0) {
+      return error::InvalidArgument("Invalid quantiles state of size $0", data.size());
+    }
+    std::vector<double> centroids(data.size() / sizeof(double));
+    std::memcpy(centroids.data(), data.data(), data.size());
+    for (size_t i = 0; i < centroids.size(); i += 2) {
+      digest_.add(centroids[i], centroids[i + 1]);
+    }
+    return Status::OK();
   }
 
   static udf::InfRuleVec SemanticInferenceRules() {
@@ -81,6 +123,164 @@ class QuantilesUDA : public udf::UDA {
   tdigest::TDigest digest_;
 };
 
+/**
+ * Returns a hash of the value that is the same in every process, so that sketches built from the
+ * hashes on different agents can be merged.
+ */
+uint64_t SketchHash(std::string_view bytes);
+
+template <typename TArg>
+uint64_t SketchHash(const TArg& val) {
+  if constexpr (std::is_same_v<TArg, types::StringValue>) {
+    return SketchHash(std::string_view(val));
+  } else if constexpr (std::is_same_v<TArg, types::UInt128Value>) {
+    uint64_t words[2] = {val.High64(), val.Low64()};
+    return SketchHash(std::string_view(reinterpret_cast<const char*>(words), sizeof(words)));
+  } else {
+    return SketchHash(std::string_view(reinterpret_cast<const char*>(&val.val), sizeof(val.val)));
+  }
+}
+
+/**
+ * HyperLogLog estimates the number of distinct values it has seen, using a fixed number of one
+ * byte registers. The standard error of the estimate is about 1.04 / sqrt(kNumRegisters).
+ */
+class HyperLogLog {
+ public:
+  static constexpr int kPrecision = 12;
+  static constexpr int64_t kNumRegisters = 1 << kPrecision;
+
+  HyperLogLog() : registers_(kNumRegisters, 0) {}
+
+  void AddHash(uint64_t hash);
+  void Merge(const HyperLogLog& other);
+  int64_t Estimate() const;
+
+  /**
+   * Serializes the registers. Sketches with few non-zero registers only store those, so that the
+   * state of small groups stays small.
+   */
+  std::string Serialize() const;
+  Status Deserialize(std::string_view data);
+
+ private:
+  std::vector<uint8_t> registers_;
+};
+
+/**
+ * DDSketch computes quantiles with a relative error guarantee: the value it returns for any
+ * quantile is within kRelativeAccuracy of the exact value. Values are counted in logarithmically
+ * sized bins, so the sketch only grows with the range of the values and not with their count.
+ */
+class DDSketch {
+ public:
+  static constexpr double kRelativeAccuracy = 0.01;
+  // Values with a smaller magnitude than this are counted as zero.
+  static constexpr double kMinIndexableValue = 1e-9;
+
+  DDSketch();
+
+  // Non-finite values are ignored.
+  void Add(double value);
+  void Merge(const DDSketch& other);
+  // Returns 0 if the sketch is empty.
+  double Quantile(double q) const;
+  uint64_t count() const { return count_; }
+
+  std::string Serialize() const;
+  Status Deserialize(std::string_view data);
+
+ private:
+  int32_t BinIndex(double magnitude) const;
+  double BinValue(int32_t index) const;
+
+  double gamma_;
+  double log_gamma_;
+  // Counts of the values in each bin, by bin index. Negative values are binned by magnitude.
+  std::map<int32_t, uint64_t> positive_bins_;
+  std::map<int32_t, uint64_t> negative_bins_;
+  uint64_t zero_count_ = 0;
+  uint64_t count_ = 0;
+  double min_ = 0;
+  double max_ = 0;
+};
+
+template <typename TArg>
+class CountDistinctUDA : public udf::UDA {
+ public:
+  void Update(FunctionContext*, TArg val) { hll_.AddHash(SketchHash(val)); }
+  void Merge(FunctionContext*, const CountDistinctUDA& other) { hll_.Merge(other.hll_); }
+  Int64Value Finalize(FunctionContext*) { return hll_.Estimate(); }
+
+  StringValue Serialize(FunctionContext*) { return hll_.Serialize(); }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) { return hll_.Deserialize(data); }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Approximates the number of distinct values in the aggregate group.")
+        .Details(
+            "Estimates the number of distinct values using "
+            "[HyperLogLog](https://en.wikipedia.org/wiki/HyperLogLog). The estimate has a "
+            "standard error of about 1.6%, and the state is at most a few kilobytes per group no "
+            "matter how many values are aggregated, so it can be computed on each agent and "
+            "merged.")
+        .Example("df = df.agg(num_clients=('remote_addr', px.count_distinct))")
+        .Arg("val", "The data to count the distinct values of.")
+        .Returns("The approximate number of distinct values.");
+  }
+
+ protected:
+  HyperLogLog hll_;
+};
+
+// TODO(zasgar): PL-419 Replace this when we add support for structs.
+template <typename TArg>
+class DDSketchQuantilesUDA : public udf::UDA {
+ public:
+  void Update(FunctionContext*, TArg val) { sketch_.Add(val.val); }
+  void Merge(FunctionContext*, const DDSketchQuantilesUDA& other) { sketch_.Merge(other.sketch_); }
+
+  StringValue Finalize(FunctionContext*) {
+    return QuantilesToJSON([this](double q) { return sketch_.Quantile(q); });
+  }
+
+  StringValue Serialize(FunctionContext*) { return sketch_.Serialize(); }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    return sketch_.Deserialize(data);
+  }
+
+  static udf::InfRuleVec SemanticInferenceRules() {
+    return {
+        udf::ExplicitRule::Create<DDSketchQuantilesUDA>(types::ST_QUANTILES, {types::ST_NONE}),
+        udf::ExplicitRule::Create<DDSketchQuantilesUDA>(types::ST_DURATION_NS_QUANTILES,
+                                                        {types::ST_DURATION_NS})};
+  }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder(
+               "Approximates the distribution of the aggregated data with a relative error "
+               "guarantee.")
+        .Details(
+            "Calculates several useful percentiles of the aggregated data using "
+            "[DDSketch](https://arxiv.org/abs/1908.10693). Each percentile is within 1% of the "
+            "exact value, which makes it well suited to latencies. Returns a serialized JSON "
+            "object with the keys for 1%, 10%, 25%, 50%, 75%, 90%, and 99%. You can use "
+            "`px.pluck_float64` to grab the specific values from the result.")
+        .Example(R"doc(
+        | # Calculate the quantiles.
+        | df = df.agg(latency_dist=('latency', px.quantiles_ddsketch))
+        | # Pluck p99 from the quantiles.
+        | df.p99 = px.pluck_float64(df.latency_dist, 'p99')
+        )doc")
+        .Arg("val", "The data to calculate the quantiles distribution.")
+        .Returns("The quantiles data, serialized as a JSON dictionary.");
+  }
+
+ protected:
+  DDSketch sketch_;
+};
+
 void RegisterMathSketchesOrDie(udf::Registry* registry);
 
 }  // namespace builtins
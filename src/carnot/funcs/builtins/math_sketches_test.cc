@@ -19,6 +19,10 @@
 #include <gtest/gtest.h>
 #include <rapidjson/document.h>
 
+#include <cmath>
+
+#include <absl/strings/str_cat.h>
+
 #include "src/carnot/funcs/builtins/math_sketches.h"
 #include "src/carnot/udf/test_utils.h"
 #include "src/common/base/base.h"
@@ -69,6 +73,97 @@ TEST(MathSketches, quantiles_int64) {
   EXPECT_DOUBLE_EQ(d["p99"].GetDouble(), 6);
 }
 
+TEST(MathSketches, quantiles_serialize) {
+  auto uda_tester = udf::UDATester<QuantilesUDA<types::Float64Value>>();
+  for (int i = 1; i <= 1000; ++i) {
+    uda_tester.ForInput(i);
+  }
+  auto expected = uda_tester.Result();
+
+  auto other_tester = udf::UDATester<QuantilesUDA<types::Float64Value>>();
+  ASSERT_OK(other_tester.Deserialize(uda_tester.Serialize()));
+  auto res = other_tester.Result();
+
+  rapidjson::Document expected_doc;
+  expected_doc.Parse(expected.data());
+  rapidjson::Document d;
+  d.Parse(res.data());
+  for (const auto& key : {"p01", "p10", "p50", "p90", "p99"}) {
+    EXPECT_NEAR(d[key].GetDouble(), expected_doc[key].GetDouble(), 1.0) << key;
+  }
+  EXPECT_NOT_OK(other_tester.Deserialize("abc"));
+}
+
+TEST(MathSketches, count_distinct_int64) {
+  auto uda_tester = udf::UDATester<CountDistinctUDA<types::Int64Value>>();
+  uda_tester.ForInput(1).ForInput(2).ForInput(2).ForInput(3).ForInput(3).ForInput(3).Expect(3);
+}
+
+TEST(MathSketches, count_distinct_string) {
+  auto uda_tester = udf::UDATester<CountDistinctUDA<types::StringValue>>();
+  auto other_tester = udf::UDATester<CountDistinctUDA<types::StringValue>>();
+  constexpr int kNumDistinct = 20000;
+  for (int i = 0; i < kNumDistinct; ++i) {
+    auto* tester = i % 2 == 0 ? &uda_tester : &other_tester;
+    tester->ForInput(absl::StrCat("client-", i));
+    tester->ForInput(absl::StrCat("client-", i));
+  }
+  // The partial state of one agent is merged into the other.
+  ASSERT_OK(uda_tester.Deserialize(other_tester.Serialize()));
+  EXPECT_NEAR(uda_tester.Result().val, kNumDistinct, 0.05 * kNumDistinct);
+}
+
+TEST(MathSketches, count_distinct_sparse_state) {
+  auto uda_tester = udf::UDATester<CountDistinctUDA<types::Int64Value>>();
+  for (int i = 0; i < 10; ++i) {
+    uda_tester.ForInput(i);
+  }
+  // Only the non-zero registers are stored.
+  EXPECT_LT(uda_tester.Serialize().size(), 64);
+
+  auto other_tester = udf::UDATester<CountDistinctUDA<types::Int64Value>>();
+  ASSERT_OK(other_tester.Deserialize(uda_tester.Serialize()));
+  EXPECT_EQ(10, other_tester.Result().val);
+  EXPECT_NOT_OK(other_tester.Deserialize(""));
+}
+
+TEST(MathSketches, quantiles_ddsketch) {
+  auto uda_tester = udf::UDATester<DDSketchQuantilesUDA<types::Int64Value>>();
+  auto other_tester = udf::UDATester<DDSketchQuantilesUDA<types::Int64Value>>();
+  for (int i = 1; i <= 1000; ++i) {
+    (i % 3 == 0 ? &uda_tester : &other_tester)->ForInput(i);
+  }
+  ASSERT_OK(uda_tester.Deserialize(other_tester.Serialize()));
+  auto res = uda_tester.Result();
+
+  rapidjson::Document d;
+  d.Parse(res.data());
+  EXPECT_NEAR(d["p01"].GetDouble(), 10, 10 * DDSketch::kRelativeAccuracy);
+  EXPECT_NEAR(d["p50"].GetDouble(), 500, 500 * DDSketch::kRelativeAccuracy);
+  EXPECT_NEAR(d["p90"].GetDouble(), 900, 900 * DDSketch::kRelativeAccuracy);
+  EXPECT_NEAR(d["p99"].GetDouble(), 990, 990 * DDSketch::kRelativeAccuracy);
+}
+
+TEST(MathSketches, ddsketch_negative_and_zero_values) {
+  DDSketch sketch;
+  for (double value : {-100.0, -1.0, 0.0, 0.0, 1.0, 100.0}) {
+    sketch.Add(value);
+  }
+  sketch.Add(std::nan(""));
+  EXPECT_EQ(6, sketch.count());
+  EXPECT_NEAR(-100, sketch.Quantile(0), 100 * DDSketch::kRelativeAccuracy);
+  EXPECT_NEAR(-1, sketch.Quantile(0.2), DDSketch::kRelativeAccuracy);
+  EXPECT_DOUBLE_EQ(0, sketch.Quantile(0.5));
+  EXPECT_NEAR(1, sketch.Quantile(0.8), DDSketch::kRelativeAccuracy);
+  EXPECT_NEAR(100, sketch.Quantile(1), 100 * DDSketch::kRelativeAccuracy);
+
+  DDSketch other;
+  ASSERT_OK(other.Deserialize(sketch.Serialize()));
+  EXPECT_EQ(6, other.count());
+  EXPECT_DOUBLE_EQ(0, other.Quantile(0.5));
+  EXPECT_NOT_OK(other.Deserialize("abc"));
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
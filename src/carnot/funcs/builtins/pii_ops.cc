@@ -17,6 +17,8 @@
  */
 #include <algorithm>
 #include <map>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/funcs/builtins/pii_ops.h"
@@ -235,17 +237,44 @@ static std::map<Tag::Type, std::string_view> type_to_sub_str_ = {
     SUB_STR(Tag::Type::IMEISV),
 };
 
+struct PIITaggers {
+  PIITaggers() {
+    // Order is important here. For example, IPv6 has to go before IPv4 to support IPv6 addresses
+    // with the lowest 32 bits written like IPv4. Also Email has to go before IP since IP addresses
+    // can be part of valid emails.
+    taggers.push_back(std::make_unique<RegexTagger<Tag::Type::EMAIL_ADDR>>());
+    taggers.push_back(std::make_unique<RegexTagger<Tag::Type::IPv6>>());
+    taggers.push_back(std::make_unique<RegexTagger<Tag::Type::IPv4>>());
+    taggers.push_back(std::make_unique<RegexTagger<Tag::Type::MAC_ADDR>>());
+    taggers.push_back(std::make_unique<RegexTagger<Tag::Type::IMEI>>());
+    taggers.push_back(std::make_unique<RegexTagger<Tag::Type::IMEISV>>());
+    taggers.push_back(std::make_unique<RegexTagger<Tag::Type::CC_NUMBER>>());
+
+    re2::RE2::Options opts;
+    opts.set_max_mem(kPatternSetMaxMem);
+    auto set = std::make_unique<re2::RE2::Set>(opts, re2::RE2::UNANCHORED);
+    bool added_all = true;
+    for (const auto& tagger : taggers) {
+      added_all = added_all && set->Add(tagger->Pattern(), nullptr) >= 0;
+    }
+    // The patterns are defined at compile time, so a DCHECK is ok here.
+    DCHECK(added_all);
+    if (added_all && set->Compile()) {
+      pattern_set = std::move(set);
+    }
+  }
+
+  static constexpr int64_t kPatternSetMaxMem = 64 << 20;
+
+  std::vector<std::unique_ptr<Tagger>> taggers;
+  // Matches the patterns of all of the taggers in a single pass over the input. The pattern at
+  // index i is the pattern of taggers[i].
+  std::unique_ptr<re2::RE2::Set> pattern_set;
+};
+
 Status RedactPIIUDF::Init(FunctionContext*) {
-  // Order is important here. For example, IPv6 has to go before IPv4 to support IPv6 addresses with
-  // the lowest 32 bits written like IPv4. Also Email has to go before IP since IP addresses can be
-  // part of valid emails.
-  taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::EMAIL_ADDR>>());
-  taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IPv6>>());
-  taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IPv4>>());
-  taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::MAC_ADDR>>());
-  taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IMEI>>());
-  taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IMEISV>>());
-  taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::CC_NUMBER>>());
+  static const PIITaggers* pii_taggers = new PIITaggers();
+  pii_taggers_ = pii_taggers;
   return Status::OK();
 }
 
@@ -305,8 +334,30 @@ static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag
 }
 
 StringValue RedactPIIUDF::Exec(FunctionContext*, StringValue input) {
+  const auto& taggers = pii_taggers_->taggers;
+  // Find which taggers' patterns occur in the input at all, so that only those taggers have to
+  // scan it for tags. If the set runs out of memory, every tagger scans the input.
+  std::vector<bool> may_match(taggers.size(), true);
+  if (pii_taggers_->pattern_set != nullptr) {
+    std::vector<int> matches;
+    re2::RE2::Set::ErrorInfo error_info;
+    bool matched = pii_taggers_->pattern_set->Match(input, &matches, &error_info);
+    if (!matched && error_info.kind == re2::RE2::Set::kNoError) {
+      return input;
+    }
+    if (matched) {
+      may_match.assign(taggers.size(), false);
+      for (int idx : matches) {
+        may_match[idx] = true;
+      }
+    }
+  }
+
   std::vector<Tag> tags;
-  for (const auto& tagger : taggers_) {
+  for (const auto& [idx, tagger] : Enumerate(taggers)) {
+    if (!may_match[idx]) {
+      continue;
+    }
     auto s = tagger->AddTags(&input, &tags);
     if (!s.ok()) {
       return "Invalid regex: " + s.msg();
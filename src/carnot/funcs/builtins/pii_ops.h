@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "re2/re2.h"
+#include "re2/set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -54,9 +55,14 @@ struct TagTypeTraits {};
 class Tagger {
  public:
   virtual ~Tagger() = default;
-  virtual Status AddTags(std::string* input, std::vector<Tag>* tags) = 0;
+  virtual Status AddTags(std::string* input, std::vector<Tag>* tags) const = 0;
+  // The regex pattern that a string must contain for the tagger to find any tags in it.
+  virtual std::string_view Pattern() const = 0;
 };
 
+// The taggers used by RedactPIIUDF, which are shared by all of its instances.
+struct PIITaggers;
+
 class RedactPIIUDF : public udf::ScalarUDF {
  public:
   Status Init(FunctionContext*);
@@ -77,7 +83,7 @@ class RedactPIIUDF : public udf::ScalarUDF {
   }
 
  private:
-  std::vector<std::unique_ptr<Tagger>> taggers_;
+  const PIITaggers* pii_taggers_ = nullptr;
 };
 
 void RegisterPIIOpsOrDie(udf::Registry* registry);
@@ -90,7 +96,7 @@ class RegexTagger : public Tagger {
     DCHECK_EQ(regex_.error_code(), RE2::NoError) << regex_.error();
   }
 
-  Status AddTags(std::string* input, std::vector<Tag>* tags) {
+  Status AddTags(std::string* input, std::vector<Tag>* tags) const override {
     re2::StringPiece input_piece(input->data(), input->length());
     auto prev_length = input_piece.length();
     int curr_idx = 0;
@@ -116,6 +122,8 @@ class RegexTagger : public Tagger {
     return Status::OK();
   }
 
+  std::string_view Pattern() const override { return TagTypeTraits<TTag>::BuildRegexPattern(); }
+
  private:
   re2::RE2 regex_;
 };
@@ -29,6 +29,7 @@
 #include <utility>
 #include <vector>
 #include "re2/re2.h"
+#include "re2/set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -126,6 +127,9 @@ class MatchRegexRule : public udf::ScalarUDF {
       return Status(statuspb::Code::INVALID_ARGUMENT, "unable to parse string as json");
     }
     // Populate the parse regular expressions into self::regex_rules.
+    regex_rules.clear();
+    regex_rules_length = 0;
+    std::vector<std::string> patterns;
     for (rapidjson::Value::ConstMemberIterator itr = regex_rules_json.MemberBegin();
          itr != regex_rules_json.MemberEnd(); ++itr) {
       RegexMatchUDF regex_match_udf;
@@ -133,12 +137,26 @@ class MatchRegexRule : public udf::ScalarUDF {
       std::string regex_pattern = itr->value.GetString();
       PL_RETURN_IF_ERROR(regex_match_udf.Init(ctx, regex_pattern));
       regex_rules.emplace_back(make_pair(name, std::move(regex_match_udf)));
+      patterns.push_back(std::move(regex_pattern));
       regex_rules_length++;
     }
+    BuildRuleSet(patterns);
     return Status::OK();
   }
 
   types::StringValue Exec(FunctionContext* ctx, StringValue value) {
+    if (rule_set_ != nullptr) {
+      // Match all of the rules in a single pass, and fall back to matching them one at a time if
+      // the set runs out of memory.
+      std::vector<int> matches;
+      re2::RE2::Set::ErrorInfo error_info;
+      if (rule_set_->Match(value, &matches, &error_info)) {
+        return regex_rules[rule_idx_[*std::min_element(matches.begin(), matches.end())]].first;
+      }
+      if (error_info.kind == re2::RE2::Set::kNoError) {
+        return "";
+      }
+    }
     for (int i = 0; i < regex_rules_length; i++) {
       if (regex_rules[i].second.Exec(ctx, value).val) {
         return regex_rules[i].first;
@@ -169,8 +187,29 @@ class MatchRegexRule : public udf::ScalarUDF {
   }
 
  private:
+  // Builds a set that matches all of the valid patterns at once. Invalid patterns never match, so
+  // they are left out.
+  void BuildRuleSet(const std::vector<std::string>& patterns) {
+    re2::RE2::Options opts;
+    opts.set_log_errors(false);
+    rule_set_.reset();
+    rule_idx_.clear();
+    auto rule_set = std::make_unique<re2::RE2::Set>(opts, re2::RE2::ANCHOR_BOTH);
+    for (const auto& [i, pattern] : Enumerate(patterns)) {
+      if (rule_set->Add(pattern, nullptr) >= 0) {
+        rule_idx_.push_back(i);
+      }
+    }
+    if (rule_set->Compile()) {
+      rule_set_ = std::move(rule_set);
+    }
+  }
+
   int regex_rules_length = 0;
   std::vector<std::pair<std::string, RegexMatchUDF> > regex_rules;
+  std::unique_ptr<re2::RE2::Set> rule_set_;
+  // The index in regex_rules of each pattern in rule_set_.
+  std::vector<int64_t> rule_idx_;
 };
 
 void RegisterRegexOpsOrDie(udf::Registry* registry);
@@ -91,6 +91,15 @@ TEST(RegexOps, regex_match_rules) {
   EXPECT_NOT_OK(MatchRegexRule().Init(nullptr, "(?i).*onpointerenter.*"));
 }
 
+TEST(RegexOps, regex_match_rules_first_match) {
+  auto udf_tester = udf::UDFTester<MatchRegexRule>();
+  udf_tester.Init(R"({"select": ".*SELECT.*", "bad": "(abc", "star": ".*\\*.*", "any": ".*"})");
+  // The first rule in order that matches is returned, and invalid rules never match.
+  udf_tester.ForInput("SELECT * FROM t").Expect("select");
+  udf_tester.ForInput("abc * def").Expect("star");
+  udf_tester.ForInput("(abc").Expect("any");
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
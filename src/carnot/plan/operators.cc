@@ -74,6 +74,8 @@ std::unique_ptr<Operator> Operator::FromProto(const planpb::Operator& pb, int64_
       return CreateOperator<FilterOperator>(id, pb.filter_op());
     case planpb::LIMIT_OPERATOR:
       return CreateOperator<LimitOperator>(id, pb.limit_op());
+    case planpb::SORT_OPERATOR:
+      return CreateOperator<SortOperator>(id, pb.sort_op());
     case planpb::UNION_OPERATOR:
       return CreateOperator<UnionOperator>(id, pb.union_op());
     case planpb::JOIN_OPERATOR:
@@ -92,6 +94,37 @@ std::unique_ptr<Operator> Operator::FromProto(const planpb::Operator& pb, int64_
  * Memory Source Operator Implementation.
  */
 
+namespace {
+
+void CollectColumnIndices(const planpb::ScalarExpression& expr, std::vector<int64_t>* indices) {
+  if (expr.has_column()) {
+    indices->push_back(expr.column().index());
+    return;
+  }
+  if (expr.has_func()) {
+    for (const auto& arg : expr.func().args()) {
+      CollectColumnIndices(arg, indices);
+    }
+  }
+}
+
+void RemapColumnIndices(const std::vector<int64_t>& sorted_indices,
+                        planpb::ScalarExpression* expr) {
+  if (expr->has_column()) {
+    auto it = std::lower_bound(sorted_indices.begin(), sorted_indices.end(),
+                               expr->column().index());
+    expr->mutable_column()->set_index(std::distance(sorted_indices.begin(), it));
+    return;
+  }
+  if (expr->has_func()) {
+    for (auto& arg : *expr->mutable_func()->mutable_args()) {
+      RemapColumnIndices(sorted_indices, &arg);
+    }
+  }
+}
+
+}  // namespace
+
 std::string MemorySourceOperator::DebugString() const { return "Op:MemorySource"; }
 
 Status MemorySourceOperator::Init(const planpb::MemorySourceOperator& pb) {
@@ -100,6 +133,23 @@ Status MemorySourceOperator::Init(const planpb::MemorySourceOperator& pb) {
   for (int i = 0; i < pb_.column_idxs_size(); ++i) {
     column_idxs_.emplace_back(pb_.column_idxs(i));
   }
+  if (pb_.has_predicate()) {
+    PL_ASSIGN_OR_RETURN(predicate_, ScalarExpression::FromProto(pb_.predicate()));
+
+    CollectColumnIndices(pb_.predicate(), &predicate_columns_);
+    std::sort(predicate_columns_.begin(), predicate_columns_.end());
+    predicate_columns_.erase(std::unique(predicate_columns_.begin(), predicate_columns_.end()),
+                             predicate_columns_.end());
+    for (int64_t col_idx : predicate_columns_) {
+      if (col_idx < 0 || col_idx >= static_cast<int64_t>(column_idxs_.size())) {
+        return error::InvalidArgument("Predicate column $0 is out of range for $1 columns",
+                                      col_idx, column_idxs_.size());
+      }
+    }
+    planpb::ScalarExpression scan_predicate_pb = pb_.predicate();
+    RemapColumnIndices(predicate_columns_, &scan_predicate_pb);
+    PL_ASSIGN_OR_RETURN(scan_predicate_, ScalarExpression::FromProto(scan_predicate_pb));
+  }
   is_initialized_ = true;
   return Status::OK();
 }
@@ -212,6 +262,20 @@ Status AggregateOperator::Init(const planpb::AggregateOperator& pb) {
   for (int idx = 0; idx < pb_.groups_size(); ++idx) {
     groups_.emplace_back(GroupInfo{pb_.group_names(idx), pb_.groups(idx).index()});
   }
+  if (pb_.has_time_window()) {
+    const auto& window = pb_.time_window();
+    if (window.group_index() < 0 || window.group_index() >= pb_.groups_size()) {
+      return error::InvalidArgument("time window group index $0 is out of range",
+                                    window.group_index());
+    }
+    if (window.size_ns() <= 0 || window.slide_ns() <= 0 || window.slide_ns() > window.size_ns()) {
+      return error::InvalidArgument(
+          "time window needs 0 < slide ($0) <= size ($1)", window.slide_ns(), window.size_ns());
+    }
+    if (window.allowed_lateness_ns() < 0) {
+      return error::InvalidArgument("time window allowed lateness can't be negative");
+    }
+  }
 
   is_initialized_ = true;
   return Status::OK();
@@ -448,6 +512,74 @@ StatusOr<table_store::schema::Relation> LimitOperator::OutputRelation(
   return output_relation;
 }
 
+/**
+ * Sort Operator Implementation.
+ */
+std::string SortOperator::DebugString() const {
+  std::vector<std::string> sort_strs;
+  for (size_t i = 0; i < sort_cols_.size(); ++i) {
+    sort_strs.push_back(absl::Substitute("$0 $1", sort_cols_[i], descending_[i] ? "desc" : "asc"));
+  }
+  return absl::Substitute("Op:Sort(by: [$0], limit: $1, cols: [$2])",
+                          absl::StrJoin(sort_strs, ","), limit(),
+                          absl::StrJoin(selected_cols_, ","));
+}
+
+Status SortOperator::Init(const planpb::SortOperator& pb) {
+  pb_ = pb;
+  if (pb_.limit() < 0) {
+    return error::InvalidArgument("Sort limit must not be negative, received $0", pb_.limit());
+  }
+
+  selected_cols_.reserve(pb_.columns_size());
+  for (auto i = 0; i < pb_.columns_size(); ++i) {
+    selected_cols_.push_back(pb_.columns(i).index());
+  }
+  sort_cols_.reserve(pb_.sort_columns_size());
+  descending_.reserve(pb_.sort_columns_size());
+  for (const auto& sort_col : pb_.sort_columns()) {
+    sort_cols_.push_back(sort_col.column().index());
+    descending_.push_back(sort_col.descending());
+  }
+
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> SortOperator::OutputRelation(
+    const table_store::schema::Schema& schema, const PlanState& /*state*/,
+    const std::vector<int64_t>& input_ids) const {
+  DCHECK(is_initialized_) << "Not initialized";
+
+  if (input_ids.size() != 1) {
+    return error::InvalidArgument("Sort operator must have exactly one input");
+  }
+  if (!schema.HasRelation(input_ids[0])) {
+    return error::NotFound("Missing relation ($0) for input of SortOperator", input_ids[0]);
+  }
+
+  PL_ASSIGN_OR_RETURN(const table_store::schema::Relation& input_relation,
+                      schema.GetRelation(input_ids[0]));
+  for (auto sort_col_idx : sort_cols_) {
+    if (sort_col_idx < 0 || sort_col_idx >= static_cast<int64_t>(input_relation.NumColumns())) {
+      return error::InvalidArgument("Sort column index $0 is out of bounds, number of columns is $1",
+                                    sort_col_idx, input_relation.NumColumns());
+    }
+  }
+
+  table_store::schema::Relation output_relation;
+  for (auto selected_col_idx : selected_cols_) {
+    CHECK_LT(selected_col_idx, static_cast<int64_t>(input_relation.NumColumns()))
+        << absl::Substitute("Column index $0 is out of bounds, number of columns is $1",
+                            selected_col_idx, input_relation.NumColumns());
+
+    output_relation.AddColumn(input_relation.GetColumnType(selected_col_idx),
+                              input_relation.GetColumnName(selected_col_idx),
+                              input_relation.GetColumnDesc(selected_col_idx));
+  }
+  return output_relation;
+}
+
 /**
  * Zip Operator Implementation.
  */
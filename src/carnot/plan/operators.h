@@ -96,10 +96,22 @@ class MemorySourceOperator : public Operator {
   std::vector<int64_t> Columns() const { return column_idxs_; }
   const types::TabletID& Tablet() const { return pb_.tablet(); }
   bool infinite_stream() const { return pb_.streaming(); }
+  // The predicate of the filter following this source, or nullptr if there isn't one.
+  const std::shared_ptr<const ScalarExpression>& predicate() const { return predicate_; }
+  // The output columns that the predicate reads, in increasing order.
+  const std::vector<int64_t>& predicate_columns() const { return predicate_columns_; }
+  // The predicate with its column references indexing into predicate_columns() instead of the
+  // output columns, so that it can be evaluated on a batch of just the columns it reads.
+  const std::shared_ptr<const ScalarExpression>& scan_predicate() const {
+    return scan_predicate_;
+  }
 
  private:
   planpb::MemorySourceOperator pb_;
   std::vector<int64_t> column_idxs_;
+  std::shared_ptr<const ScalarExpression> predicate_;
+  std::vector<int64_t> predicate_columns_;
+  std::shared_ptr<const ScalarExpression> scan_predicate_;
 };
 
 class MapOperator : public Operator {
@@ -143,6 +155,8 @@ class AggregateOperator : public Operator {
   const std::vector<GroupInfo>& groups() const { return groups_; }
   const std::vector<std::shared_ptr<AggregateExpression>>& values() const { return values_; }
   bool windowed() const { return pb_.windowed(); }
+  bool has_time_window() const { return pb_.has_time_window(); }
+  const planpb::AggregateOperator::TimeWindow& time_window() const { return pb_.time_window(); }
 
  private:
   std::vector<std::shared_ptr<AggregateExpression>> values_;
@@ -214,6 +228,9 @@ class GRPCSinkOperator : public Operator {
   }
   std::string table_name() const { return pb_.output_table().table_name(); }
 
+  // Whether the row batches are sent in the flat columnar encoding (FlatRowBatchData).
+  bool flat_row_batches() const { return pb_.flat_row_batches(); }
+
  private:
   planpb::GRPCSinkOperator pb_;
 };
@@ -261,6 +278,31 @@ class LimitOperator : public Operator {
   planpb::LimitOperator pb_;
 };
 
+class SortOperator : public Operator {
+ public:
+  explicit SortOperator(int64_t id) : Operator(id, planpb::SORT_OPERATOR) {}
+  ~SortOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::SortOperator& pb);
+  std::string DebugString() const override;
+  const std::vector<int64_t>& selected_cols() const { return selected_cols_; }
+  // The input column indices to sort by, in order of precedence.
+  const std::vector<int64_t>& sort_cols() const { return sort_cols_; }
+  const std::vector<bool>& descending() const { return descending_; }
+
+  // The maximum number of rows to output, or 0 if every row is output.
+  int64_t limit() const { return pb_.limit(); }
+
+ private:
+  std::vector<int64_t> selected_cols_;
+  std::vector<int64_t> sort_cols_;
+  std::vector<bool> descending_;
+  planpb::SortOperator pb_;
+};
+
 class UnionOperator : public Operator {
  public:
   explicit UnionOperator(int64_t id) : Operator(id, planpb::UNION_OPERATOR) {}
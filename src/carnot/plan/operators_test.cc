@@ -120,6 +120,23 @@ TEST_F(OperatorTest, from_proto_mem_src) {
   EXPECT_FALSE(src_plan_node->infinite_stream());
 }
 
+TEST_F(OperatorTest, from_proto_mem_src_with_predicate) {
+  auto src_pb = planpb::testutils::CreateTestSource1PB();
+  auto src_op = Operator::FromProto(src_pb, 1);
+  EXPECT_EQ(nullptr, static_cast<const plan::MemorySourceOperator*>(src_op.get())->predicate());
+
+  auto filter_pb = planpb::testutils::CreateTestFilterTwoCols();
+  *src_pb.mutable_mem_source_op()->mutable_predicate() = filter_pb.filter_op().expression();
+  src_op = Operator::FromProto(src_pb, 1);
+  EXPECT_TRUE(src_op->is_initialized());
+  const auto* src_plan_node = static_cast<const plan::MemorySourceOperator*>(src_op.get());
+  ASSERT_NE(nullptr, src_plan_node->predicate());
+  EXPECT_EQ(Expression::kFunc, src_plan_node->predicate()->ExpressionType());
+  EXPECT_THAT(src_plan_node->predicate_columns(), ElementsAre(0));
+  ASSERT_NE(nullptr, src_plan_node->scan_predicate());
+  EXPECT_EQ(Expression::kFunc, src_plan_node->scan_predicate()->ExpressionType());
+}
+
 TEST_F(OperatorTest, from_proto_streaming_source) {
   auto src_pb = planpb::testutils::CreateTestStreamingSource1PB();
   auto src_op = Operator::FromProto(src_pb, 1);
@@ -239,6 +256,19 @@ TEST_F(OperatorTest, from_proto_drop_limit) {
   auto limit_typed_op = static_cast<LimitOperator*>(limit_op.get());
   EXPECT_THAT(limit_typed_op->selected_cols(), ElementsAre(0, 2));
 }
+TEST_F(OperatorTest, from_proto_sort) {
+  auto sort_pb = planpb::testutils::CreateTestSort1PB();
+  auto sort_op = Operator::FromProto(sort_pb, 1);
+  EXPECT_EQ(1, sort_op->id());
+  EXPECT_TRUE(sort_op->is_initialized());
+  EXPECT_EQ(planpb::OperatorType::SORT_OPERATOR, sort_op->op_type());
+  auto sort_typed_op = static_cast<SortOperator*>(sort_op.get());
+  EXPECT_THAT(sort_typed_op->sort_cols(), ElementsAre(1, 0));
+  EXPECT_THAT(sort_typed_op->descending(), ElementsAre(true, false));
+  EXPECT_THAT(sort_typed_op->selected_cols(), ElementsAre(0, 2));
+  EXPECT_EQ(10, sort_typed_op->limit());
+}
+
 TEST_F(OperatorTest, from_proto_join_with_time) {
   auto join_pb = planpb::testutils::CreateTestJoinWithTimePB();
   auto join_op = std::make_unique<JoinOperator>(1);
@@ -366,6 +396,50 @@ TEST_F(OperatorTest, output_relation_agg) {
   EXPECT_EQ(expected_relation, rel);
 }
 
+TEST_F(OperatorTest, from_proto_agg_time_window) {
+  auto agg_pb = planpb::testutils::CreateTestBlockingAgg1PB();
+  auto* window = agg_pb.mutable_agg_op()->mutable_time_window();
+  window->set_group_index(0);
+  window->set_size_ns(10);
+  window->set_slide_ns(5);
+  auto agg_op = std::make_unique<AggregateOperator>(1);
+  EXPECT_OK(agg_op->Init(agg_pb.agg_op()));
+  EXPECT_TRUE(agg_op->has_time_window());
+  EXPECT_EQ(10, agg_op->time_window().size_ns());
+  EXPECT_EQ(5, agg_op->time_window().slide_ns());
+}
+
+TEST_F(OperatorTest, from_proto_agg_time_window_invalid) {
+  auto agg_pb = planpb::testutils::CreateTestBlockingAgg1PB();
+  auto* window = agg_pb.mutable_agg_op()->mutable_time_window();
+  window->set_group_index(0);
+  window->set_size_ns(10);
+  window->set_slide_ns(20);
+  auto agg_op = std::make_unique<AggregateOperator>(1);
+  auto s = agg_op->Init(agg_pb.agg_op());
+  EXPECT_NOT_OK(s);
+  EXPECT_EQ(s.msg(), "time window needs 0 < slide (20) <= size (10)");
+
+  window->set_slide_ns(10);
+  window->set_group_index(1);
+  s = agg_op->Init(agg_pb.agg_op());
+  EXPECT_NOT_OK(s);
+  EXPECT_EQ(s.msg(), "time window group index 1 is out of range");
+
+  window->set_group_index(-1);
+  s = agg_op->Init(agg_pb.agg_op());
+  EXPECT_NOT_OK(s);
+  EXPECT_EQ(s.msg(), "time window group index -1 is out of range");
+
+  // A time window needs a group to window on, rather than falling back to a global aggregate.
+  window->set_group_index(0);
+  agg_pb.mutable_agg_op()->clear_groups();
+  agg_pb.mutable_agg_op()->clear_group_names();
+  s = agg_op->Init(agg_pb.agg_op());
+  EXPECT_NOT_OK(s);
+  EXPECT_EQ(s.msg(), "time window group index 0 is out of range");
+}
+
 TEST_F(OperatorTest, output_relation_filter) {
   auto filter_pb = planpb::testutils::CreateTestFilter1PB();
   auto filter_op = Operator::FromProto(filter_pb, 2);
@@ -415,6 +489,18 @@ TEST_F(OperatorTest, output_relation_drop_limit) {
   EXPECT_EQ(expected_relation, rel);
 }
 
+TEST_F(OperatorTest, output_relation_sort) {
+  auto sort_pb = planpb::testutils::CreateTestSort1PB();
+  auto sort_op = Operator::FromProto(sort_pb, 1);
+
+  auto rel =
+      sort_op->OutputRelation(schema_, *state_, std::vector<int64_t>({0})).ConsumeValueOrDie();
+  Relation expected_relation;
+  expected_relation.AddColumn(types::DataType::INT64, "col0");
+  expected_relation.AddColumn(types::DataType::STRING, "col2");
+  EXPECT_EQ(expected_relation, rel);
+}
+
 TEST_F(OperatorTest, output_relation_union) {
   auto union_pb = planpb::testutils::CreateTestUnionOrderedPB();
   auto union_op = Operator::FromProto(union_pb, 4);
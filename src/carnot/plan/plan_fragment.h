@@ -70,6 +70,7 @@ class PlanFragmentWalker {
   using FilterWalkFn = std::function<Status(const FilterOperator&)>;
   using LimitWalkFn = std::function<Status(const LimitOperator&)>;
   using UnionWalkFn = std::function<Status(const UnionOperator&)>;
+  using SortWalkFn = std::function<Status(const SortOperator&)>;
   using JoinWalkFn = std::function<Status(const JoinOperator&)>;
   using GRPCSinkWalkFn = std::function<Status(const GRPCSinkOperator&)>;
   using GRPCSourceWalkFn = std::function<Status(const GRPCSourceOperator&)>;
@@ -136,6 +137,16 @@ class PlanFragmentWalker {
     return *this;
   }
 
+  /**
+   * Register callback for when a sort operator is encountered.
+   * @param fn The function to call when a SortOperator is encountered.
+   * @return self to allow chaining
+   */
+  PlanFragmentWalker& OnSort(const SortWalkFn& fn) {
+    on_sort_walk_fn_ = fn;
+    return *this;
+  }
+
   /**
    * Register callback for when a union operator is encountered.
    * @param fn The function to call when a UnionOperator is encountered.
@@ -195,6 +206,7 @@ class PlanFragmentWalker {
   FilterWalkFn on_filter_walk_fn_;
   LimitWalkFn on_limit_walk_fn_;
   UnionWalkFn on_union_walk_fn_;
+  SortWalkFn on_sort_walk_fn_;
   JoinWalkFn on_join_walk_fn_;
   GRPCSinkWalkFn on_grpc_sink_walk_fn_;
   GRPCSourceWalkFn on_grpc_source_walk_fn_;
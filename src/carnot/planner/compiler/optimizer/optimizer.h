@@ -26,6 +26,8 @@
 #include "src/carnot/planner/compiler/optimizer/merge_nodes_rule.h"
 #include "src/carnot/planner/compiler/optimizer/prune_unconnected_operators_rule.h"
 #include "src/carnot/planner/compiler/optimizer/prune_unused_columns_rule.h"
+#include "src/carnot/planner/compiler/optimizer/push_limit_into_sort_rule.h"
+#include "src/carnot/planner/compiler/optimizer/time_window_agg_rule.h"
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
 #include "src/carnot/planner/ir/ir.h"
@@ -62,10 +64,22 @@ class Optimizer : public RuleExecutor<IR> {
     prune_unused_columns->AddRule<PruneUnusedColumnsRule>();
   }
 
+  void CreatePushLimitIntoSortBatch() {
+    RuleBatch* push_limit_batch = CreateRuleBatch<FailOnMax>("PushLimitIntoSort", 2);
+    push_limit_batch->AddRule<PushLimitIntoSortRule>();
+  }
+
+  void CreateTimeWindowAggBatch() {
+    RuleBatch* time_window_batch = CreateRuleBatch<FailOnMax>("TimeWindowAgg", 2);
+    time_window_batch->AddRule<TimeWindowAggRule>();
+  }
+
   Status Init() {
     CreatePruneUnconnectedOpsBatch();
     CreateMergeNodesBatch();
     CreatePruneUnusedColumnsBatch();
+    CreatePushLimitIntoSortBatch();
+    CreateTimeWindowAggBatch();
     return Status::OK();
   }
 
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/compiler/optimizer/push_limit_into_sort_rule.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+StatusOr<bool> PushLimitIntoSortRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Limit())) {
+    return false;
+  }
+  LimitIR* limit = static_cast<LimitIR*>(ir_node);
+  // A pem-only limit doesn't bound the final output, so the sort still needs every row.
+  if (limit->pem_only() || !limit->limit_value_set()) {
+    return false;
+  }
+  DCHECK_EQ(limit->parents().size(), 1UL);
+  OperatorIR* parent = limit->parents()[0];
+  // The sort can only be bounded if the limit is the only consumer of its output.
+  if (!Match(parent, Sort()) || parent->Children().size() != 1) {
+    return false;
+  }
+  SortIR* sort = static_cast<SortIR*>(parent);
+  if (sort->has_limit() && sort->limit() <= limit->limit_value()) {
+    return false;
+  }
+  sort->SetLimit(limit->limit_value());
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/optimizer/push_limit_into_sort_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+class PushLimitIntoSortRuleTest : public RulesTest {
+ protected:
+  SortIR* MakeSort(OperatorIR* parent) {
+    return graph
+        ->CreateNode<SortIR>(ast, parent, std::vector<ColumnIR*>{MakeColumn("count", 0)},
+                             std::vector<bool>{true})
+        .ConsumeValueOrDie();
+  }
+};
+
+TEST_F(PushLimitIntoSortRuleTest, sets_sort_limit) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeRelation());
+  SortIR* sort = MakeSort(mem_src);
+  LimitIR* limit = MakeLimit(sort, 10);
+  MakeMemSink(limit, "out");
+
+  PushLimitIntoSortRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+  EXPECT_TRUE(sort->has_limit());
+  EXPECT_EQ(sort->limit(), 10);
+
+  // Running the rule again should be a no-op.
+  result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+}
+
+TEST_F(PushLimitIntoSortRuleTest, sort_with_multiple_children) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeRelation());
+  SortIR* sort = MakeSort(mem_src);
+  LimitIR* limit = MakeLimit(sort, 10);
+  MakeMemSink(limit, "out");
+  MakeMemSink(sort, "all");
+
+  PushLimitIntoSortRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(sort->has_limit());
+}
+
+TEST_F(PushLimitIntoSortRuleTest, pem_only_limit) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeRelation());
+  SortIR* sort = MakeSort(mem_src);
+  LimitIR* limit = MakeLimit(sort, 10, /* pem_only */ true);
+  MakeMemSink(limit, "out");
+
+  PushLimitIntoSortRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(sort->has_limit());
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
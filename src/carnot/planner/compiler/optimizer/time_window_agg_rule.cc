@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/compiler/optimizer/time_window_agg_rule.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+int64_t TimeWindowAggRule::BinnedTimeWindow(OperatorIR* op, std::string col_name) {
+  int64_t window_ns = 0;
+  while (true) {
+    if (Match(op, MemorySource())) {
+      return window_ns > 0 && col_name == "time_" ? window_ns : 0;
+    }
+    if (op->parents().size() != 1) {
+      return 0;
+    }
+    if (Match(op, Map())) {
+      MapIR* map = static_cast<MapIR*>(op);
+      const ColumnExpression* expr = nullptr;
+      for (const auto& col_expr : map->col_exprs()) {
+        if (col_expr.name == col_name) {
+          expr = &col_expr;
+        }
+      }
+      if (expr == nullptr && !map->keep_input_columns()) {
+        return 0;
+      }
+      if (expr != nullptr) {
+        if (Match(expr->node, ColumnNode())) {
+          col_name = static_cast<ColumnIR*>(expr->node)->col_name();
+        } else if (window_ns == 0 && Match(expr->node, Func())) {
+          // px.bin(t, w) is t - t % w, so its values are the starts of tumbling windows of w.
+          FuncIR* func = static_cast<FuncIR*>(expr->node);
+          if (func->func_name() != "bin" || func->all_args().size() != 2 ||
+              !Match(func->all_args()[0], ColumnNode()) || !Match(func->all_args()[1], Int())) {
+            return 0;
+          }
+          window_ns = static_cast<IntIR*>(func->all_args()[1])->val();
+          if (window_ns <= 0) {
+            return 0;
+          }
+          col_name = static_cast<ColumnIR*>(func->all_args()[0])->col_name();
+        } else {
+          return 0;
+        }
+      }
+    } else if (!Match(op, Filter())) {
+      return 0;
+    }
+    op = op->parents()[0];
+  }
+}
+
+StatusOr<bool> TimeWindowAggRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, BlockingAgg())) {
+    return false;
+  }
+  BlockingAggIR* agg = static_cast<BlockingAggIR*>(ir_node);
+  if (agg->has_time_window() || agg->parents().size() != 1) {
+    return false;
+  }
+  for (const auto& [group_idx, group] : Enumerate(agg->groups())) {
+    int64_t window_ns = BinnedTimeWindow(agg->parents()[0], group->col_name());
+    if (window_ns > 0) {
+      agg->SetTimeWindow(group_idx, window_ns, /*allowed_lateness_ns*/ window_ns);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
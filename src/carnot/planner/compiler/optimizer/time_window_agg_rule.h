@@ -0,0 +1,58 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief This rule lowers an aggregate that groups by px.bin(time_, w) into a time windowed
+ * aggregate with tumbling windows of w, so that each window is emitted and its state freed once
+ * the source's time has moved past it instead of at the end of the stream.
+ *
+ * The rule only applies when the binned column can be traced back to the time_ column of a
+ * memory source through Maps and Filters, since other operators don't keep rows in time order.
+ * Rows more than one window behind the latest time seen are dropped.
+ */
+class TimeWindowAggRule : public Rule {
+ public:
+  TimeWindowAggRule()
+      : Rule(nullptr, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  /**
+   * @brief Returns the width of the bin if the column col_name of op is px.bin(time_, w) of a
+   * memory source, and 0 otherwise.
+   */
+  static int64_t BinnedTimeWindow(OperatorIR* op, std::string col_name);
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
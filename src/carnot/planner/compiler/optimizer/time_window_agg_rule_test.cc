@@ -0,0 +1,137 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/optimizer/time_window_agg_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+constexpr int64_t kWindowNS = 10 * 1000 * 1000 * 1000LL;
+
+class TimeWindowAggRuleTest : public RulesTest {
+ protected:
+  FuncIR* MakeBin(const std::string& col_name, int64_t window_ns) {
+    return MakeFunc("bin", {MakeColumn(col_name, 0), MakeInt(window_ns)});
+  }
+  BlockingAggIR* MakeAgg(OperatorIR* parent, const std::vector<std::string>& groups) {
+    std::vector<ColumnIR*> group_cols;
+    for (const auto& group : groups) {
+      group_cols.push_back(MakeColumn(group, 0));
+    }
+    return MakeBlockingAgg(parent, group_cols, {{"mean", MakeMeanFunc(MakeColumn("cpu0", 0))}});
+  }
+};
+
+TEST_F(TimeWindowAggRuleTest, lowers_binned_time_group) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeTimeRelation());
+  FilterIR* filter = MakeFilter(mem_src, MakeEqualsFunc(MakeColumn("cpu1", 0), MakeFloat(1.0)));
+  MapIR* map = MakeMap(filter, {{"window", MakeBin("time_", kWindowNS)}},
+                       /*keep_input_columns*/ true);
+  BlockingAggIR* agg = MakeAgg(map, {"cpu2", "window"});
+  MakeMemSink(agg, "out");
+
+  TimeWindowAggRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+  ASSERT_TRUE(agg->has_time_window());
+  EXPECT_EQ(agg->time_window().group_index(), 1);
+  EXPECT_EQ(agg->time_window().size_ns(), kWindowNS);
+  EXPECT_EQ(agg->time_window().slide_ns(), kWindowNS);
+  EXPECT_EQ(agg->time_window().allowed_lateness_ns(), kWindowNS);
+
+  // Running the rule again should be a no-op.
+  result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+}
+
+TEST_F(TimeWindowAggRuleTest, follows_renames) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeTimeRelation());
+  MapIR* rename =
+      MakeMap(mem_src, {{"t", MakeColumn("time_", 0)}, {"cpu0", MakeColumn("cpu0", 0)}});
+  MapIR* bin = MakeMap(rename, {{"window", MakeBin("t", kWindowNS)}}, /*keep_input_columns*/ true);
+  MapIR* rename_window =
+      MakeMap(bin, {{"w", MakeColumn("window", 0)}, {"cpu0", MakeColumn("cpu0", 0)}});
+  BlockingAggIR* agg = MakeAgg(rename_window, {"w"});
+  MakeMemSink(agg, "out");
+
+  TimeWindowAggRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+  ASSERT_TRUE(agg->has_time_window());
+  EXPECT_EQ(agg->time_window().group_index(), 0);
+  EXPECT_EQ(agg->time_window().size_ns(), kWindowNS);
+}
+
+TEST_F(TimeWindowAggRuleTest, unbinned_time_group) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeTimeRelation());
+  BlockingAggIR* agg = MakeAgg(mem_src, {"time_"});
+  MakeMemSink(agg, "out");
+
+  TimeWindowAggRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(agg->has_time_window());
+}
+
+TEST_F(TimeWindowAggRuleTest, binned_column_that_is_not_time) {
+  MemorySourceIR* mem_src = MakeMemSource(MakeTimeRelation());
+  MapIR* map =
+      MakeMap(mem_src, {{"window", MakeBin("cpu1", kWindowNS)}}, /*keep_input_columns*/ true);
+  BlockingAggIR* agg = MakeAgg(map, {"window"});
+  MakeMemSink(agg, "out");
+
+  TimeWindowAggRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(agg->has_time_window());
+}
+
+// A union interleaves its parents, so the rows reaching the agg aren't in time order.
+TEST_F(TimeWindowAggRuleTest, union_between_source_and_agg) {
+  MemorySourceIR* mem_src1 = MakeMemSource(MakeTimeRelation());
+  MemorySourceIR* mem_src2 = MakeMemSource(MakeTimeRelation());
+  UnionIR* union_op = MakeUnion({mem_src1, mem_src2});
+  MapIR* map = MakeMap(union_op, {{"window", MakeBin("time_", kWindowNS)}},
+                       /*keep_input_columns*/ true);
+  BlockingAggIR* agg = MakeAgg(map, {"window"});
+  MakeMemSink(agg, "out");
+
+  TimeWindowAggRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(agg->has_time_window());
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -35,6 +35,7 @@ StatusOr<bool> SetSourceGroupGRPCAddressRule::Apply(IRNode* ir_node) {
   if (Match(ir_node, GRPCSourceGroup())) {
     static_cast<GRPCSourceGroupIR*>(ir_node)->SetGRPCAddress(grpc_address_);
     static_cast<GRPCSourceGroupIR*>(ir_node)->SetSSLTargetName(ssl_targetname_);
+    static_cast<GRPCSourceGroupIR*>(ir_node)->SetAcceptsFlatRowBatches(accepts_flat_row_batches_);
     return true;
   }
   return false;
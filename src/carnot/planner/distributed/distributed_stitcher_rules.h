@@ -41,15 +41,18 @@ using distributedpb::CarnotInfo;
  */
 class SetSourceGroupGRPCAddressRule : public Rule {
  public:
-  SetSourceGroupGRPCAddressRule(const std::string& grpc_address, const std::string& ssl_targetname)
+  SetSourceGroupGRPCAddressRule(const std::string& grpc_address, const std::string& ssl_targetname,
+                                bool accepts_flat_row_batches)
       : Rule(nullptr, /*use_topo*/ false, /*reverse_topological_execution*/ false),
         grpc_address_(grpc_address),
-        ssl_targetname_(ssl_targetname) {}
+        ssl_targetname_(ssl_targetname),
+        accepts_flat_row_batches_(accepts_flat_row_batches) {}
 
  private:
   StatusOr<bool> Apply(IRNode* node) override;
   std::string grpc_address_;
   std::string ssl_targetname_;
+  bool accepts_flat_row_batches_;
 };
 
 /**
@@ -63,7 +66,8 @@ class DistributedSetSourceGroupGRPCAddressRule : public DistributedRule {
 
   StatusOr<bool> Apply(CarnotInstance* carnot_instance) override {
     SetSourceGroupGRPCAddressRule rule(carnot_instance->carnot_info().grpc_address(),
-                                       carnot_instance->carnot_info().ssl_targetname());
+                                       carnot_instance->carnot_info().ssl_targetname(),
+                                       carnot_instance->carnot_info().accepts_flat_row_batches());
     return rule.Execute(carnot_instance->plan());
   }
 };
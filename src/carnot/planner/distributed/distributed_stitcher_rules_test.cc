@@ -240,6 +240,34 @@ TEST_F(StitcherTest, one_pem_one_kelvin) {
   }
 }
 
+TEST_F(StitcherTest, flat_row_batches_to_accepting_kelvin) {
+  auto ps = LoadDistributedStatePb(kOnePEMOneKelvinDistributedState);
+  for (auto& carnot_info : *ps.mutable_carnot_info()) {
+    if (carnot_info.query_broker_address() == "kelvin") {
+      carnot_info.set_accepts_flat_row_batches(true);
+    }
+  }
+  auto physical_plan = MakeDistributedPlan(ps);
+  CarnotInstance* pem = physical_plan->Get(1);
+
+  DistributedSetSourceGroupGRPCAddressRule rule;
+  ASSERT_OK(rule.Execute(physical_plan.get()));
+  AssociateDistributedPlanEdgesRule distributed_edges_rule;
+  ASSERT_OK(distributed_edges_rule.Execute(physical_plan.get()));
+  DistributedIRRule<GRPCSourceGroupConversionRule> distributed_grpc_source_conv_rule;
+  ASSERT_OK(distributed_grpc_source_conv_rule.Execute(physical_plan.get()));
+
+  auto sinks = pem->plan()->FindNodesThatMatch(InternalGRPCSink());
+  ASSERT_GT(sinks.size(), 0);
+  for (auto ir_node : sinks) {
+    auto sink = static_cast<GRPCSinkIR*>(ir_node);
+    EXPECT_TRUE(sink->flat_row_batches());
+    planpb::Operator op;
+    ASSERT_OK(sink->ToProto(&op, pem->id()));
+    EXPECT_TRUE(op.grpc_sink_op().flat_row_batches());
+  }
+}
+
 TEST_F(StitcherTest, three_pems_one_kelvin) {
   auto ps = LoadDistributedStatePb(kThreePEMsOneKelvinDistributedState);
   auto physical_plan = MakeDistributedPlan(ps);
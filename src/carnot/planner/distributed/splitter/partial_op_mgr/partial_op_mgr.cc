@@ -44,6 +44,23 @@ StatusOr<OperatorIR*> LimitOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR
   return new_limit;
 }
 
+StatusOr<OperatorIR*> SortOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
+  DCHECK(Matches(op));
+  SortIR* sort = static_cast<SortIR*>(op);
+  PL_ASSIGN_OR_RETURN(SortIR * new_sort, plan->CopyNode(sort));
+  PL_RETURN_IF_ERROR(new_sort->CopyParentsFrom(sort));
+  return new_sort;
+}
+
+StatusOr<OperatorIR*> SortOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                                           OperatorIR* op) const {
+  DCHECK(Matches(op));
+  SortIR* sort = static_cast<SortIR*>(op);
+  PL_ASSIGN_OR_RETURN(SortIR * new_sort, plan->CopyNode(sort));
+  PL_RETURN_IF_ERROR(new_sort->AddParent(new_parent));
+  return new_sort;
+}
+
 StatusOr<OperatorIR*> AggOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
   DCHECK(Matches(op));
   BlockingAggIR* agg = static_cast<BlockingAggIR*>(op);
@@ -78,6 +95,9 @@ StatusOr<OperatorIR*> AggOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR*
 
   new_agg->SetPartialAgg(false);
   new_agg->SetFinalizeResults(true);
+  // The partial aggs of every agent are interleaved on the way here, so the merge can't assume
+  // that the windows arrive in time order. It merges the windows as plain groups instead.
+  new_agg->ClearTimeWindow();
   DCHECK(Match(new_agg, FinalizeAgg()));
   return new_agg;
 }
@@ -68,6 +68,41 @@ TEST_F(PartialOpMgrTest, limit_test) {
   EXPECT_NE(merge_limit, limit);
 }
 
+TEST_F(PartialOpMgrTest, sort_test) {
+  auto mem_src = MakeMemSource(MakeRelation());
+  auto sort = graph
+                  ->CreateNode<SortIR>(ast, mem_src, std::vector<ColumnIR*>{MakeColumn("count", 0)},
+                                       std::vector<bool>{true})
+                  .ConsumeValueOrDie();
+  MakeMemSink(sort, "out");
+
+  SortOperatorMgr mgr;
+  // A sort without a limit has to see every row, so it can't be split.
+  EXPECT_FALSE(mgr.Matches(sort));
+  sort->SetLimit(10);
+  EXPECT_TRUE(mgr.Matches(sort));
+
+  auto prepare_sort_or_s = mgr.CreatePrepareOperator(graph.get(), sort);
+  ASSERT_OK(prepare_sort_or_s);
+  OperatorIR* prepare_sort_uncasted = prepare_sort_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(prepare_sort_uncasted, Sort());
+  SortIR* prepare_sort = static_cast<SortIR*>(prepare_sort_uncasted);
+  EXPECT_EQ(prepare_sort->limit(), 10);
+  EXPECT_THAT(prepare_sort->descending(), ElementsAre(true));
+  EXPECT_EQ(prepare_sort->parents(), sort->parents());
+  EXPECT_NE(prepare_sort, sort);
+
+  auto mem_src2 = MakeMemSource(MakeRelation());
+  auto merge_sort_or_s = mgr.CreateMergeOperator(graph.get(), mem_src2, sort);
+  ASSERT_OK(merge_sort_or_s);
+  OperatorIR* merge_sort_uncasted = merge_sort_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(merge_sort_uncasted, Sort());
+  SortIR* merge_sort = static_cast<SortIR*>(merge_sort_uncasted);
+  EXPECT_EQ(merge_sort->limit(), 10);
+  EXPECT_EQ(merge_sort->parents()[0], mem_src2);
+  EXPECT_NE(merge_sort, sort);
+}
+
 TEST_F(PartialOpMgrTest, agg_test) {
   auto relation = MakeRelation();
   relation.AddColumn(types::STRING, "service");
@@ -124,6 +159,37 @@ TEST_F(PartialOpMgrTest, agg_test) {
   EXPECT_THAT(*merge_agg->resolved_table_type(), IsTableType(agg_relation));
 }
 
+// The partial aggs keep the time window, the merge of all of the agents' partials doesn't.
+TEST_F(PartialOpMgrTest, agg_with_time_window) {
+  auto relation = MakeTimeRelation();
+  auto mem_src = MakeMemSource("source", relation);
+  compiler_state_->relation_map()->emplace("source", relation);
+  auto time_col = MakeColumn("time_", 0);
+  EXPECT_OK(time_col->SetResolvedType(ValueType::Create(types::TIME64NS, types::ST_NONE)));
+  auto mean_func = MakeMeanFunc(MakeColumn("cpu0", 0));
+  auto agg = MakeBlockingAgg(mem_src, {time_col}, {{"mean", mean_func}});
+  agg->SetTimeWindow(/*group_index*/ 0, /*window_ns*/ 100, /*allowed_lateness_ns*/ 100);
+  MakeMemSink(agg, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  AggOperatorMgr mgr;
+  ASSERT_OK_AND_ASSIGN(OperatorIR * prepare_agg, mgr.CreatePrepareOperator(graph.get(), agg));
+  ASSERT_MATCH(prepare_agg, PartialAgg());
+  EXPECT_TRUE(static_cast<BlockingAggIR*>(prepare_agg)->has_time_window());
+  EXPECT_EQ(static_cast<BlockingAggIR*>(prepare_agg)->time_window().size_ns(), 100);
+
+  auto mem_src2 = MakeMemSource(MakeTimeRelation());
+  ASSERT_OK_AND_ASSIGN(OperatorIR * merge_agg,
+                       mgr.CreateMergeOperator(graph.get(), mem_src2, agg));
+  ASSERT_MATCH(merge_agg, FinalizeAgg());
+  EXPECT_FALSE(static_cast<BlockingAggIR*>(merge_agg)->has_time_window());
+  planpb::Operator pb;
+  ASSERT_OK(merge_agg->ToProto(&pb));
+  EXPECT_FALSE(pb.agg_op().has_time_window());
+}
+
 // This tests aggs with functions that can't partial. We don't partial the agg if that's the case.
 TEST_F(PartialOpMgrTest, agg_where_fn_cant_partial) {
   auto mem_src = MakeMemSource(MakeRelation());
@@ -421,6 +421,11 @@ Status Splitter::InsertGRPCBridge(IR* plan, OperatorIR* parent,
     // Go through the blocking_children and replace the parent with the new child.
     for (auto child : blocking_children) {
       PL_RETURN_IF_ERROR(child->ReplaceParent(parent, grpc_source_group));
+      // The rows of every agent are interleaved by the GRPCSourceGroup, so they are no longer in
+      // time order.
+      if (Match(child, BlockingAgg())) {
+        static_cast<BlockingAggIR*>(child)->ClearTimeWindow();
+      }
     }
     ++grpc_id_counter_;
     return Status::OK();
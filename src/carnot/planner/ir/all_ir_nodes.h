@@ -43,6 +43,7 @@
 #include "src/carnot/planner/ir/metadata_ir.h"
 #include "src/carnot/planner/ir/operator_ir.h"
 #include "src/carnot/planner/ir/rolling_ir.h"
+#include "src/carnot/planner/ir/sort_ir.h"
 #include "src/carnot/planner/ir/stream_ir.h"
 #include "src/carnot/planner/ir/string_ir.h"
 #include "src/carnot/planner/ir/tablet_source_group_ir.h"
@@ -127,6 +127,9 @@ Status BlockingAggIR::ToProto(planpb::Operator* op) const {
   pb->set_windowed(false);
   pb->set_partial_agg(partial_agg_);
   pb->set_finalize_results(finalize_results_);
+  if (has_time_window_) {
+    *pb->mutable_time_window() = time_window_;
+  }
 
   op->set_op_type(planpb::AGGREGATE_OPERATOR);
   return Status::OK();
@@ -155,6 +158,8 @@ Status BlockingAggIR::CopyFromNodeImpl(
   finalize_results_ = blocking_agg->finalize_results_;
   partial_agg_ = blocking_agg->partial_agg_;
   pre_split_proto_ = blocking_agg->pre_split_proto_;
+  time_window_ = blocking_agg->time_window_;
+  has_time_window_ = blocking_agg->has_time_window_;
 
   return Status::OK();
 }
@@ -75,6 +75,25 @@ class BlockingAggIR : public GroupAcceptorIR {
     pre_split_proto_ = pre_split_proto;
   }
 
+  /**
+   * @brief Aggregates the group at group_index, a TIME64NS column, in tumbling windows of
+   * window_ns instead of until the end of the stream. Rows which arrive more than
+   * allowed_lateness_ns behind the latest time seen are dropped.
+   */
+  void SetTimeWindow(int64_t group_index, int64_t window_ns, int64_t allowed_lateness_ns) {
+    time_window_.set_group_index(group_index);
+    time_window_.set_size_ns(window_ns);
+    time_window_.set_slide_ns(window_ns);
+    time_window_.set_allowed_lateness_ns(allowed_lateness_ns);
+    has_time_window_ = true;
+  }
+  void ClearTimeWindow() {
+    time_window_.Clear();
+    has_time_window_ = false;
+  }
+  bool has_time_window() const { return has_time_window_; }
+  const planpb::AggregateOperator::TimeWindow& time_window() const { return time_window_; }
+
  protected:
   StatusOr<absl::flat_hash_set<std::string>> PruneOutputColumnsToImpl(
       const absl::flat_hash_set<std::string>& output_colnames) override;
@@ -87,6 +106,9 @@ class BlockingAggIR : public GroupAcceptorIR {
   // Whether this finalizes the result of a partial aggregate.
   bool finalize_results_ = true;
   planpb::AggregateOperator pre_split_proto_;
+  // The event time window to aggregate in, if has_time_window_ is set.
+  planpb::AggregateOperator::TimeWindow time_window_;
+  bool has_time_window_ = false;
 };
 }  // namespace planner
 }  // namespace carnot
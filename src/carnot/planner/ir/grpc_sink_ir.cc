@@ -29,6 +29,7 @@ Status GRPCSinkIR::CopyFromNodeImpl(const IRNode* node,
   destination_id_ = grpc_sink->destination_id_;
   destination_address_ = grpc_sink->destination_address_;
   destination_ssl_targetname_ = grpc_sink->destination_ssl_targetname_;
+  flat_row_batches_ = grpc_sink->flat_row_batches_;
   name_ = grpc_sink->name_;
   out_columns_ = grpc_sink->out_columns_;
   return Status::OK();
@@ -62,6 +63,7 @@ Status GRPCSinkIR::ToProto(planpb::Operator* op, int64_t agent_id) const {
     return CreateIRNodeError("No agent ID '$0' found in grpc sink '$1'", agent_id, DebugString());
   }
   pb->set_grpc_source_id(agent_id_to_destination_id_.find(agent_id)->second);
+  pb->set_flat_row_batches(flat_row_batches_);
   return Status::OK();
 }
 
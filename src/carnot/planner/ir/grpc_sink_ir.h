@@ -113,6 +113,10 @@ class GRPCSinkIR : public OperatorIR {
   const std::string& destination_address() const { return destination_address_; }
   bool DestinationAddressSet() const { return destination_address_ != ""; }
   const std::string& destination_ssl_targetname() const { return destination_ssl_targetname_; }
+  // Whether the row batches are sent in the flat columnar encoding. Only used when the destination
+  // is another Carnot instance.
+  void SetFlatRowBatches(bool flat_row_batches) { flat_row_batches_ = flat_row_batches; }
+  bool flat_row_batches() const { return flat_row_batches_; }
 
   bool has_output_table() const { return sink_type_ == GRPCSinkType::kExternal; }
   std::string name() const { return name_; }
@@ -149,6 +153,7 @@ class GRPCSinkIR : public OperatorIR {
  private:
   std::string destination_address_ = "";
   std::string destination_ssl_targetname_ = "";
+  bool flat_row_batches_ = false;
   GRPCSinkType sink_type_ = GRPCSinkType::kTypeNotSet;
   // Used when GRPCSinkType = kInternal.
   int64_t destination_id_ = -1;
@@ -61,6 +61,10 @@ class GRPCSourceGroupIR : public OperatorIR {
 
   void SetGRPCAddress(const std::string& grpc_address) { grpc_address_ = grpc_address; }
   void SetSSLTargetName(const std::string& ssl_targetname) { ssl_targetname_ = ssl_targetname; }
+  // Whether the Carnot instance running this source can receive flat row batches.
+  void SetAcceptsFlatRowBatches(bool accepts_flat_row_batches) {
+    accepts_flat_row_batches_ = accepts_flat_row_batches;
+  }
 
   /**
    * @brief Associate the passed in GRPCSinkOperator with this Source Group. The sink_op passed in
@@ -99,6 +103,7 @@ class GRPCSourceGroupIR : public OperatorIR {
   int64_t source_id_ = -1;
   std::string grpc_address_ = "";
   std::string ssl_targetname_ = "";
+  bool accepts_flat_row_batches_ = false;
   std::vector<std::pair<GRPCSinkIR*, absl::flat_hash_set<int64_t>>> dependent_sinks_;
 };
 }  // namespace planner
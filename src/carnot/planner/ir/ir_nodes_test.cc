@@ -400,6 +400,26 @@ TEST_F(ToProtoTest, filter_to_proto) {
   EXPECT_THAT(pb, EqualsProto(kExpectedFilterPb)) << pb.DebugString();
 }
 
+TEST_F(ToProtoTest, memory_source_with_filter_child_to_proto) {
+  MakeInt(1);
+  auto rel = MakeRelation();
+  auto mem_src = MakeMemSource("table", rel);
+  compiler_state_->relation_map()->emplace("table", rel);
+  auto equals = MakeEqualsFunc(MakeColumn("cpu0", 0), MakeColumn("cpu2", 0));
+  MakeFilter(mem_src, equals);
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  planpb::Operator pb;
+  EXPECT_OK(mem_src->ToProto(&pb));
+  planpb::Operator expected_filter_pb;
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::MergeFromString(kExpectedFilterPb, &expected_filter_pb));
+  EXPECT_THAT(pb.mem_source_op().predicate(),
+              EqualsProto(expected_filter_pb.filter_op().expression().DebugString()));
+}
+
 constexpr char kExpectedAggPb[] = R"(
   op_type: AGGREGATE_OPERATOR
   agg_op {
@@ -515,6 +535,61 @@ TEST_F(ToProtoTest, agg_ir_with_presplit_proto) {
   EXPECT_THAT(cloned_pb, EqualsProto(kExpectedAggPb));
 }
 
+TEST_F(ToProtoTest, agg_ir_with_time_window) {
+  auto mem_src = graph
+                     ->CreateNode<MemorySourceIR>(
+                         ast, "source", std::vector<std::string>{"col1", "group1", "column"})
+                     .ValueOrDie();
+  table_store::schema::Relation rel({types::INT64, types::INT64, types::INT64},
+                                    {"col1", "group1", "column"});
+  compiler_state_->relation_map()->emplace("source", rel);
+  auto constant = graph->CreateNode<IntIR>(ast, 10).ValueOrDie();
+  auto col = graph->CreateNode<ColumnIR>(ast, "column", /*parent_op_idx*/ 0).ValueOrDie();
+  EXPECT_OK(col->SetResolvedType(ValueType::Create(types::INT64, types::ST_NONE)));
+
+  auto agg_func = graph
+                      ->CreateNode<FuncIR>(ast, FuncIR::Op{FuncIR::Opcode::non_op, "", "mean"},
+                                           std::vector<ExpressionIR*>{constant, col})
+                      .ValueOrDie();
+  EXPECT_OK(AddUDAToRegistry("mean", types::INT64, {types::INT64, types::INT64}));
+  auto group1 = graph->CreateNode<ColumnIR>(ast, "group1", /*parent_op_idx*/ 0).ValueOrDie();
+  EXPECT_OK(group1->SetResolvedType(ValueType::Create(types::INT64, types::ST_NONE)));
+
+  auto agg = graph
+                 ->CreateNode<BlockingAggIR>(ast, mem_src, std::vector<ColumnIR*>{group1},
+                                             ColExpressionVector{{"mean", agg_func}})
+                 .ValueOrDie();
+  agg->SetTimeWindow(/*group_index*/ 0, /*window_ns*/ 100, /*allowed_lateness_ns*/ 50);
+
+  ASSERT_OK(ResolveOperatorType(mem_src, compiler_state_.get()));
+  ASSERT_OK(ResolveOperatorType(agg, compiler_state_.get()));
+
+  planpb::Operator expected_pb;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(kExpectedAggPb, &expected_pb));
+  auto window_pb = expected_pb.mutable_agg_op()->mutable_time_window();
+  window_pb->set_group_index(0);
+  window_pb->set_size_ns(100);
+  window_pb->set_slide_ns(100);
+  window_pb->set_allowed_lateness_ns(50);
+
+  planpb::Operator pb;
+  ASSERT_OK(agg->ToProto(&pb));
+  EXPECT_THAT(pb, EqualsProto(expected_pb.DebugString()));
+
+  // Copies keep the window, and clearing it restores the plain aggregate.
+  ASSERT_OK_AND_ASSIGN(BlockingAggIR * cloned_agg, graph->CopyNode(agg));
+  ASSERT_OK(cloned_agg->CopyParentsFrom(agg));
+  planpb::Operator cloned_pb;
+  ASSERT_OK(cloned_agg->ToProto(&cloned_pb));
+  EXPECT_THAT(cloned_pb, EqualsProto(expected_pb.DebugString()));
+
+  cloned_agg->ClearTimeWindow();
+  EXPECT_FALSE(cloned_agg->has_time_window());
+  cloned_pb.Clear();
+  ASSERT_OK(cloned_agg->ToProto(&cloned_pb));
+  EXPECT_THAT(cloned_pb, EqualsProto(kExpectedAggPb));
+}
+
 constexpr char kExpectedLimitPb[] = R"(
   op_type: LIMIT_OPERATOR
   limit_op {
@@ -17,7 +17,9 @@
  */
 
 #include "src/carnot/planner/ir/memory_source_ir.h"
+#include "src/carnot/planner/ir/filter_ir.h"
 #include "src/carnot/planner/ir/ir.h"
+#include "src/carnot/planner/ir/pattern_match.h"
 
 namespace px {
 namespace carnot {
@@ -61,6 +63,14 @@ Status MemorySourceIR::ToProto(planpb::Operator* op) const {
   }
 
   pb->set_streaming(streaming());
+
+  // Pass the predicate of a filter that directly follows this source down to it, so that the source
+  // can skip the batches that can't match it. The filter's columns refer to this source's columns.
+  auto children = Children();
+  if (children.size() == 1 && Match(children[0], Filter())) {
+    auto filter = static_cast<FilterIR*>(children[0]);
+    PL_RETURN_IF_ERROR(filter->filter_expr()->ToProto(pb->mutable_predicate()));
+  }
   return Status::OK();
 }
 
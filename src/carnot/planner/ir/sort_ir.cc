@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/ir/sort_ir.h"
+
+#include <absl/strings/str_join.h>
+
+#include "src/carnot/planner/ir/ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+Status SortIR::Init(OperatorIR* parent, const std::vector<ColumnIR*>& sort_columns,
+                    const std::vector<bool>& descending) {
+  if (sort_columns.size() != descending.size()) {
+    return CreateIRNodeError("Expected $0 sort directions, received $1", sort_columns.size(),
+                             descending.size());
+  }
+  PL_RETURN_IF_ERROR(AddParent(parent));
+  descending_ = descending;
+  return SetSortColumns(sort_columns);
+}
+
+Status SortIR::SetSortColumns(const std::vector<ColumnIR*>& sort_columns) {
+  DCHECK(sort_columns_.empty());
+  sort_columns_.resize(sort_columns.size());
+  for (size_t i = 0; i < sort_columns.size(); ++i) {
+    PL_ASSIGN_OR_RETURN(sort_columns_[i], graph()->OptionallyCloneWithEdge(this, sort_columns[i]));
+  }
+  return Status::OK();
+}
+
+std::string SortIR::DebugString() const {
+  std::vector<std::string> sort_strs;
+  for (size_t i = 0; i < sort_columns_.size(); ++i) {
+    sort_strs.push_back(absl::Substitute("$0 $1", sort_columns_[i]->col_name(),
+                                         descending_[i] ? "desc" : "asc"));
+  }
+  return absl::Substitute("$0(id=$1, by=[$2], limit=$3)", type_string(), id(),
+                          absl::StrJoin(sort_strs, ", "), limit_);
+}
+
+StatusOr<std::vector<absl::flat_hash_set<std::string>>> SortIR::RequiredInputColumns() const {
+  DCHECK(is_type_resolved());
+  absl::flat_hash_set<std::string> required{resolved_table_type()->ColumnNames().begin(),
+                                            resolved_table_type()->ColumnNames().end()};
+  for (const ColumnIR* sort_col : sort_columns_) {
+    required.insert(sort_col->col_name());
+  }
+  return std::vector<absl::flat_hash_set<std::string>>{required};
+}
+
+Status SortIR::ToProto(planpb::Operator* op) const {
+  auto pb = op->mutable_sort_op();
+  op->set_op_type(planpb::SORT_OPERATOR);
+  DCHECK_EQ(parents().size(), 1UL);
+
+  DCHECK(parents()[0]->is_type_resolved());
+  auto parent_table_type = parents()[0]->resolved_table_type();
+  auto parent_id = parents()[0]->id();
+
+  DCHECK(is_type_resolved());
+  for (const std::string& col_name : resolved_table_type()->ColumnNames()) {
+    planpb::Column* col_pb = pb->add_columns();
+    col_pb->set_node(parent_id);
+    DCHECK(parent_table_type->HasColumn(col_name));
+    col_pb->set_index(parent_table_type->GetColumnIndex(col_name));
+  }
+  for (size_t i = 0; i < sort_columns_.size(); ++i) {
+    auto sort_col_pb = pb->add_sort_columns();
+    PL_RETURN_IF_ERROR(sort_columns_[i]->ToProto(sort_col_pb->mutable_column()));
+    sort_col_pb->set_descending(descending_[i]);
+  }
+  pb->set_limit(limit_);
+  return Status::OK();
+}
+
+Status SortIR::CopyFromNodeImpl(const IRNode* node,
+                                absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) {
+  const SortIR* sort = static_cast<const SortIR*>(node);
+  std::vector<ColumnIR*> new_sort_columns;
+  for (const ColumnIR* column : sort->sort_columns_) {
+    PL_ASSIGN_OR_RETURN(ColumnIR * new_column, graph()->CopyNode(column, copied_nodes_map));
+    new_sort_columns.push_back(new_column);
+  }
+  PL_RETURN_IF_ERROR(SetSortColumns(new_sort_columns));
+  descending_ = sort->descending_;
+  limit_ = sort->limit_;
+  return Status::OK();
+}
+
+Status SortIR::ResolveType(CompilerState* compiler_state) {
+  DCHECK_EQ(1U, parent_types().size());
+  for (ColumnIR* sort_col : sort_columns_) {
+    PL_RETURN_IF_ERROR(ResolveExpressionType(sort_col, compiler_state, parent_types()));
+  }
+  PL_ASSIGN_OR_RETURN(auto type_ptr, OperatorIR::DefaultResolveType(parent_types()));
+  return SetResolvedType(type_ptr);
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
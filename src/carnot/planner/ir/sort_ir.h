@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/column_ir.h"
+#include "src/carnot/planner/ir/operator_ir.h"
+#include "src/carnot/planner/types/types.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief SortIR orders its input by the sort columns. If a limit is set, it only outputs the
+ * first rows of the sorted result, which makes it a top-k that can be split into a top-k on each
+ * agent followed by a top-k over their results.
+ */
+class SortIR : public OperatorIR {
+ public:
+  SortIR() = delete;
+  explicit SortIR(int64_t id) : OperatorIR(id, IRNodeType::kSort) {}
+
+  Status Init(OperatorIR* parent, const std::vector<ColumnIR*>& sort_columns,
+              const std::vector<bool>& descending);
+
+  std::string DebugString() const override;
+  Status ToProto(planpb::Operator*) const override;
+  Status ResolveType(CompilerState* compiler_state);
+
+  const std::vector<ColumnIR*>& sort_columns() const { return sort_columns_; }
+  const std::vector<bool>& descending() const { return descending_; }
+
+  void SetLimit(int64_t limit) { limit_ = limit; }
+  bool has_limit() const { return limit_ > 0; }
+  int64_t limit() const { return limit_; }
+
+  Status CopyFromNodeImpl(const IRNode* node,
+                          absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) override;
+  inline bool IsBlocking() const override { return true; }
+
+  StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
+
+ protected:
+  StatusOr<absl::flat_hash_set<std::string>> PruneOutputColumnsToImpl(
+      const absl::flat_hash_set<std::string>& output_cols) override {
+    return output_cols;
+  }
+
+ private:
+  Status SetSortColumns(const std::vector<ColumnIR*>& sort_columns);
+
+  std::vector<ColumnIR*> sort_columns_;
+  std::vector<bool> descending_;
+  // The number of rows to output, or 0 to output all of them.
+  int64_t limit_ = 0;
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
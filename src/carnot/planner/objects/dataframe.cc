@@ -233,6 +233,29 @@ StatusOr<QLObjectPtr> LimitHandler(IR* graph, OperatorIR* op, const pypa::AstPtr
   return Dataframe::Create(limit_op, visitor);
 }
 
+// Handles the sort() DataFrame logic.
+StatusOr<QLObjectPtr> SortHandler(IR* graph, OperatorIR* op, const pypa::AstPtr& ast,
+                                  const ParsedArgs& args, ASTVisitor* visitor) {
+  PL_ASSIGN_OR_RETURN(std::vector<std::string> sort_names,
+                      ParseAsListOfStrings(args.GetArg("by"), "by"));
+  if (sort_names.empty()) {
+    return CreateAstError(ast, "sort() requires at least one column in 'by'");
+  }
+  PL_ASSIGN_OR_RETURN(BoolIR * ascending, GetArgAs<BoolIR>(ast, args, "ascending"));
+
+  std::vector<ColumnIR*> sort_columns;
+  for (const std::string& name : sort_names) {
+    // parent_op_idx is 0 because sort only has one parent.
+    PL_ASSIGN_OR_RETURN(ColumnIR * col, graph->CreateNode<ColumnIR>(ast, name,
+                                                                    /* parent_op_idx */ 0));
+    sort_columns.push_back(col);
+  }
+  std::vector<bool> descending(sort_columns.size(), !ascending->val());
+  PL_ASSIGN_OR_RETURN(SortIR * sort_op,
+                      graph->CreateNode<SortIR>(ast, op, sort_columns, descending));
+  return Dataframe::Create(sort_op, visitor);
+}
+
 class SubscriptHandler {
  public:
   /**
@@ -459,6 +482,22 @@ Status Dataframe::Init() {
   PL_RETURN_IF_ERROR(limitfn->SetDocString(kLimitOpDocstring));
   AddMethod(kLimitOpID, limitfn);
 
+  /**
+   * # Equivalent to the python method method syntax:
+   * def sort(self, by, ascending=True):
+   *     ...
+   */
+  PL_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> sortfn,
+      FuncObject::Create(kSortOpID, {"by", "ascending"}, {{"ascending", "True"}},
+                         /* has_variable_len_args */ false,
+                         /* has_variable_len_kwargs */ false,
+                         std::bind(&SortHandler, graph(), op(), std::placeholders::_1,
+                                   std::placeholders::_2, std::placeholders::_3),
+                         ast_visitor()));
+  PL_RETURN_IF_ERROR(sortfn->SetDocString(kSortOpDocstring));
+  AddMethod(kSortOpID, sortfn);
+
   /**
    *
    * # Equivalent to the python method method syntax:
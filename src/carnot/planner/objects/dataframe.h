@@ -266,6 +266,30 @@ class Dataframe : public QLObject {
     px.DataFrame: DataFrame with the first n rows.
   )doc";
 
+  inline static constexpr char kSortOpID[] = "sort";
+  inline static constexpr char kSortOpDocstring[] = R"doc(
+  Sorts the rows by the specified columns.
+
+  Returns a DataFrame with the rows ordered by the `by` columns, in the order in which
+  they are listed. A `head()` that directly follows a sort is computed as a top-k
+  on each agent, so only the top rows of every agent are sent over the network.
+
+  :topic: dataframe_ops
+  :opname: Sort
+
+  Examples:
+    df = px.DataFrame('http_events')
+    # Keep the 10 slowest http requests.
+    df = df.sort('resp_latency_ns', ascending=False).head(10)
+
+  Args:
+    by (Union[str,List[str]]): The columns to sort by, either as a string or a list.
+    ascending (bool): Whether to sort in ascending order. If not set, default is True.
+
+  Returns:
+    px.DataFrame: DataFrame with the rows sorted by the `by` columns.
+  )doc";
+
   inline static constexpr char kMergeOpID[] = "merge";
   inline static constexpr char kMergeOpDocstring[] = R"doc(
   Merges the input DataFrame with this one using a database-style join.
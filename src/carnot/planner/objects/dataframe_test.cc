@@ -249,6 +249,24 @@ TEST_F(DataframeTest, LimitNonIntArgument) {
               HasCompilerError("Expected arg 'n' as type 'Int', received 'String'"));
 }
 
+TEST_F(DataframeTest, CreateSort) {
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<FuncObject> func_obj, df->GetMethod(Dataframe::kSortOpID));
+  BoolIR* ascending = graph->CreateNode<BoolIR>(ast, false).ConsumeValueOrDie();
+  ArgMap args{{{"ascending", ToQLObject(ascending)}},
+              {MakeListObj(MakeString("latency"), MakeString("service"))}};
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<QLObject> obj, func_obj->Call(args, ast));
+  ASSERT_EQ(obj->type_descriptor().type(), QLObjectType::kDataframe);
+  auto sort_obj = std::static_pointer_cast<Dataframe>(obj);
+
+  ASSERT_MATCH(sort_obj->op(), Sort());
+  SortIR* sort = static_cast<SortIR*>(sort_obj->op());
+  ASSERT_EQ(sort->sort_columns().size(), 2);
+  EXPECT_MATCH(sort->sort_columns()[0], ColumnNode("latency", 0));
+  EXPECT_MATCH(sort->sort_columns()[1], ColumnNode("service", 0));
+  EXPECT_THAT(sort->descending(), ElementsAre(true, true));
+  EXPECT_FALSE(sort->has_limit());
+}
+
 TEST_F(DataframeTest, SubscriptFilterRows) {
   ASSERT_OK_AND_ASSIGN(std::shared_ptr<FuncObject> func_obj, df->GetSubscriptMethod());
   auto eq_func = MakeEqualsFunc(MakeColumn("service", 0), MakeString("blah"));
@@ -335,6 +335,31 @@ columns {
   index: 2
 }
 )";
+constexpr char kSortOperator1[] = R"(
+sort_columns {
+  column {
+    node: 1
+    index: 1
+  }
+  descending: true
+}
+sort_columns {
+  column {
+    node: 1
+    index: 0
+  }
+}
+columns {
+  node: 1
+  index: 0
+}
+columns {
+  node: 1
+  index: 2
+}
+limit: 10
+)";
+
 // relation 1: [abc, time_]
 // relation 2: [time_, abc]
 // maps to output relation:
@@ -1470,6 +1495,13 @@ planpb::Operator CreateTestLimit1PB() {
   return op;
 }
 
+planpb::Operator CreateTestSort1PB() {
+  planpb::Operator op;
+  auto op_proto = absl::Substitute(kOperatorProtoTmpl, "SORT_OPERATOR", "sort_op", kSortOperator1);
+  CHECK(google::protobuf::TextFormat::MergeFromString(op_proto, &op)) << "Failed to parse proto";
+  return op;
+}
+
 planpb::Operator CreateTestDropLimit1PB() {
   planpb::Operator op;
   auto op_proto =
@@ -58,6 +58,28 @@ class AnyUDA : public BaseFunc {
   virtual ~AnyUDA() = default;
 };
 
+/**
+ * FusedOp identifies the builtin arithmetic, comparison and boolean operators, which the
+ * expression evaluators can compute inline over fixed width columns, without calling Exec.
+ */
+enum class FusedOp : uint8_t {
+  kNone = 0,
+  kAdd,
+  kSubtract,
+  kMultiply,
+  kDivide,
+  kNegate,
+  kEqual,
+  kNotEqual,
+  kLessThan,
+  kLessThanEqual,
+  kGreaterThan,
+  kGreaterThanEqual,
+  kLogicalAnd,
+  kLogicalOr,
+  kLogicalNot,
+};
+
 /**
  * ScalarUDF is a wrapper around a stateless function that can take one more more UDF values
  * and return a single UDF value.
@@ -74,6 +96,17 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * It can also _optionally_ implement:
+ *      static constexpr bool MemoizeWithinBatch() { return true; }
+ *  When this returns true, Exec is called once per distinct set of arguments in a batch and the
+ *  result is reused for the repeated rows. Only UDFs whose result depends solely on the arguments
+ *  and on state that is fixed for the batch (eg. the metadata state) should opt in.
+ *
+ * And:
+ *      static constexpr FusedOp Fused() { return FusedOp::kAdd; }
+ *  When Exec computes exactly the C++ operator on the values of its arguments, this lets the
+ *  expression evaluators fuse the UDF with the neighbouring operators of an expression.
  */
 class ScalarUDF : public AnyUDF {
  public:
@@ -167,6 +200,28 @@ struct has_udf_executor_fn<T, std::void_t<decltype(&T::Executor)>> : std::true_t
       "If an executor function exists, it must have the form: UDFSourceExecutor Executor()");
 };
 
+// SFINAE test for MemoizeWithinBatch fn.
+template <typename T, typename = void>
+struct has_udf_memoize_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_memoize_fn<T, std::void_t<decltype(&T::MemoizeWithinBatch)>> : std::true_type {
+  static_assert(std::is_same_v<decltype(&T::MemoizeWithinBatch), bool (*)()>,
+                "If a MemoizeWithinBatch function exists, it must have the form: "
+                "static constexpr bool MemoizeWithinBatch()");
+};
+
+// SFINAE test for Fused fn.
+template <typename T, typename = void>
+struct has_udf_fused_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_fused_fn<T, std::void_t<decltype(&T::Fused)>> : std::true_type {
+  static_assert(std::is_same_v<decltype(&T::Fused), FusedOp (*)()>,
+                "If a Fused function exists, it must have the form: "
+                "static constexpr FusedOp Fused()");
+};
+
 template <typename T, typename = void>
 struct check_executor_fn {};
 
@@ -228,6 +283,30 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasExecutor() { return has_udf_executor_fn<T>::value; }
 
+  /**
+   * Checks if Exec results can be reused for repeated arguments within a batch.
+   * @return true if the UDF opted in with MemoizeWithinBatch() and takes at least one argument.
+   */
+  static constexpr bool MemoizeWithinBatch() {
+    if constexpr (has_udf_memoize_fn<T>::value) {
+      return T::MemoizeWithinBatch() && ExecArguments().size() > 0;
+    } else {
+      return false;
+    }
+  }
+
+  /**
+   * The operator that Exec computes, if the UDF opted in to being fused.
+   * @return FusedOp::kNone if the UDF can't be fused.
+   */
+  static constexpr FusedOp Fused() {
+    if constexpr (has_udf_fused_fn<T>::value) {
+      return T::Fused();
+    } else {
+      return FusedOp::kNone;
+    }
+  }
+
   template <typename Q = T, std::enable_if_t<ScalarUDFTraits<Q>::HasInit(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return GetArgumentTypesHelper(&Q::Init);
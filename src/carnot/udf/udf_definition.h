@@ -105,6 +105,7 @@ class ScalarUDFDefinition : public UDFDefinition {
                                exec_arguments_.end());
 
     make_fn_ = ScalarUDFWrapper<TUDF>::Make;
+    fused_op_ = ScalarUDFTraits<TUDF>::Fused();
 
     if constexpr (ScalarUDFTraits<TUDF>::HasExecutor()) {
       executor_ = TUDF::Executor();
@@ -144,6 +145,7 @@ class ScalarUDFDefinition : public UDFDefinition {
   const std::vector<types::DataType>& exec_arguments() const { return exec_arguments_; }
   const std::vector<types::DataType>& init_arguments() const { return init_arguments_; }
   udfspb::UDFSourceExecutor executor() const { return executor_; }
+  FusedOp fused_op() const { return fused_op_; }
 
   const std::vector<types::DataType>& RegistryArgTypes() override { return registry_arguments_; }
   size_t Arity() const { return exec_arguments_.size(); }
@@ -155,6 +157,7 @@ class ScalarUDFDefinition : public UDFDefinition {
   std::vector<types::DataType> registry_arguments_;
   types::DataType exec_return_type_;
   udfspb::UDFSourceExecutor executor_;
+  FusedOp fused_op_ = FusedOp::kNone;
   std::function<std::unique_ptr<ScalarUDF>()> make_fn_;
   std::function<Status(ScalarUDF*, FunctionContext* ctx,
                        const std::vector<const types::ColumnWrapper*>& inputs,
@@ -51,6 +51,18 @@ class AddUDF : public ScalarUDF {
   }
 };
 
+class MemoizedConcatUDF : public ScalarUDF {
+ public:
+  types::StringValue Exec(FunctionContext*, types::StringValue str, types::Int64Value i) {
+    ++exec_count;
+    return absl::Substitute("$0-$1", str, i.val);
+  }
+
+  static constexpr bool MemoizeWithinBatch() { return true; }
+
+  int exec_count = 0;
+};
+
 class InitArgUDF : public ScalarUDF {
  public:
   Status Init(FunctionContext*, types::StringValue str, types::Int64Value i) {
@@ -136,6 +148,51 @@ TEST(UDFDefinition, arrow_write) {
   EXPECT_EQ(6, resArr->Value(1));
 }
 
+TEST(UDFDefinition, memoized_exec) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("memoized_concat");
+  EXPECT_OK(def.Init<MemoizedConcatUDF>());
+
+  types::StringValueColumnWrapper v1({"a", "b", "a", "a", "b"});
+  types::Int64ValueColumnWrapper v2({1, 1, 1, 2, 1});
+
+  types::StringValueColumnWrapper out(v1.Size());
+  auto u = def.Make();
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1, &v2}, &out, v1.Size()));
+
+  EXPECT_EQ(3, static_cast<MemoizedConcatUDF*>(u.get())->exec_count);
+  EXPECT_EQ("a-1", out[0]);
+  EXPECT_EQ("b-1", out[1]);
+  EXPECT_EQ("a-1", out[2]);
+  EXPECT_EQ("a-2", out[3]);
+  EXPECT_EQ("b-1", out[4]);
+}
+
+TEST(UDFDefinition, memoized_exec_arrow) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::StringValue> v1 = {"a", "b", "a", "a", "b"};
+  std::vector<types::Int64Value> v2 = {1, 1, 1, 2, 1};
+
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  auto v2a = ToArrow(v2, arrow::default_memory_pool());
+
+  auto output_builder = std::make_shared<arrow::StringBuilder>();
+  auto u = std::make_shared<MemoizedConcatUDF>();
+  EXPECT_OK(ScalarUDFWrapper<MemoizedConcatUDF>::ExecBatchArrow(
+      u.get(), &ctx, {v1a.get(), v2a.get()}, output_builder.get(), v1.size()));
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_OK(output_builder->Finish(&res));
+  auto* res_arr = static_cast<arrow::StringArray*>(res.get());
+  EXPECT_EQ(3, u->exec_count);
+  ASSERT_EQ(5, res_arr->length());
+  EXPECT_EQ("a-1", res_arr->GetString(0));
+  EXPECT_EQ("b-1", res_arr->GetString(1));
+  EXPECT_EQ("a-1", res_arr->GetString(2));
+  EXPECT_EQ("a-2", res_arr->GetString(3));
+  EXPECT_EQ("b-1", res_arr->GetString(4));
+}
+
 TEST(UDFDefinition, init_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("initargudf");
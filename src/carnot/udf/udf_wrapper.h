@@ -20,8 +20,13 @@
 
 #include <arrow/array.h>
 
+#include <absl/container/flat_hash_map.h>
+
 #include <memory>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/udf/udf.h"
@@ -39,6 +44,10 @@ namespace udf {
 // it's better to keep this number small.
 const int kStringAssumedSizeHeuristic = 10;
 
+// The maximum number of distinct argument sets a memoized UDF remembers within a batch. Rows with
+// arguments past this limit are still evaluated, but their results aren't remembered.
+const size_t kMaxMemoizedArgsPerBatch = 1024;
+
 // This function takes in a generic types::BaseValueType and then converts it to actual
 // UDFValue type. This function is unsafe and will produce wrong results (or crash)
 // if used incorrectly.
@@ -68,6 +77,59 @@ Status ExecWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
   return Status::OK();
 }
 
+// Returns the key used to look up the memoized result for a UDF argument. Strings are keyed by a
+// view of the input value, which outlives the batch evaluation.
+template <typename T>
+inline auto MemoKey(const T& v) {
+  return v.val;
+}
+
+template <>
+inline auto MemoKey<types::StringValue>(const types::StringValue& s) {
+  return std::string_view(s);
+}
+
+template <types::DataType TDataType>
+inline auto ArrowMemoKey(const arrow::Array* arr, int64_t idx) {
+  if constexpr (TDataType == types::DataType::STRING) {
+    int32_t length = 0;
+    const uint8_t* data = static_cast<const arrow::StringArray*>(arr)->GetValue(idx, &length);
+    return std::string_view(reinterpret_cast<const char*>(data), length);
+  } else {
+    using value_type = typename types::DataTypeTraits<TDataType>::value_type;
+    return MemoKey(value_type(types::GetValueFromArrowArray<TDataType>(arr, idx)));
+  }
+}
+
+/**
+ * Same as ExecWrapper, but calls Exec only once for each distinct set of arguments in the batch
+ * and copies the result to the rows that repeat them. Used for UDFs that opt in with
+ * MemoizeWithinBatch().
+ */
+template <typename TUDF, typename TOutput, std::size_t... I>
+Status MemoizedExecWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                           const std::vector<const types::BaseValueType*>& args,
+                           std::index_sequence<I...>) {
+  constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  using KeyType =
+      std::tuple<decltype(MemoKey(*CastToUDFValueType<exec_argument_types[I]>(args[I])))...>;
+  // Maps the arguments to the first row that had them, whose output is already computed.
+  absl::flat_hash_map<KeyType, size_t> computed_rows;
+  for (size_t idx = 0; idx < count; ++idx) {
+    KeyType key(MemoKey(CastToUDFValueType<exec_argument_types[I]>(args[I])[idx])...);
+    auto it = computed_rows.find(key);
+    if (it != computed_rows.end()) {
+      out[idx] = out[it->second];
+      continue;
+    }
+    out[idx] = udf->Exec(ctx, CastToUDFValueType<exec_argument_types[I]>(args[I])[idx]...);
+    if (computed_rows.size() < kMaxMemoizedArgsPerBatch) {
+      computed_rows.emplace(std::move(key), idx);
+    }
+  }
+  return Status::OK();
+}
+
 template <typename TUDF, std::size_t... I>
 Status InitWrapper(TUDF* udf, FunctionContext* ctx,
                    const std::vector<std::shared_ptr<types::BaseValueType>>& args,
@@ -132,6 +194,59 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   return Status::OK();
 }
 
+/**
+ * Same as ExecWrapperArrow, but calls Exec only once for each distinct set of arguments in the
+ * batch and appends the remembered result for the rows that repeat them.
+ */
+template <typename TUDF, typename TOutput, std::size_t... I>
+Status MemoizedExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                                const std::vector<arrow::Array*>& args,
+                                std::index_sequence<I...>) {
+  static constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  using KeyType = std::tuple<decltype(ArrowMemoKey<exec_argument_types[I]>(args[I], 0))...>;
+  using ResultType = decltype(UnWrap(
+      udf->Exec(ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], 0)...)));
+
+  CHECK(out->Reserve(count).ok());
+  size_t reserved = count * kStringAssumedSizeHeuristic;
+  size_t total_size = 0;
+  // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
+  if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
+    CHECK(out->ReserveData(reserved).ok());
+  }
+  // Maps the arguments to the index of their result in results.
+  absl::flat_hash_map<KeyType, size_t> result_idx;
+  std::vector<ResultType> results;
+  for (size_t idx = 0; idx < count; ++idx) {
+    KeyType key(ArrowMemoKey<exec_argument_types[I]>(args[I], idx)...);
+    auto it = result_idx.find(key);
+    ResultType computed;
+    const ResultType* res = &computed;
+    if (it != result_idx.end()) {
+      res = &results[it->second];
+    } else {
+      computed = UnWrap(
+          udf->Exec(ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...));
+      if (results.size() < kMaxMemoizedArgsPerBatch) {
+        result_idx.emplace(std::move(key), results.size());
+        results.push_back(std::move(computed));
+        res = &results.back();
+      }
+    }
+
+    // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
+    if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
+      total_size += res->size();
+      while (total_size >= reserved) {
+        reserved *= 2;
+        PL_RETURN_IF_ERROR(out->ReserveData(reserved));
+      }
+    }
+    out->UnsafeAppend(*res);
+  }
+  return Status::OK();
+}
+
 /**
  * Checks types between column wrapper and array of types::UDFDataTypes.
  * @return true if all types match.
@@ -200,10 +315,15 @@ struct ScalarUDFWrapper {
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
-    return ExecWrapperArrow<TUDF>(
-        static_cast<TUDF*>(udf), ctx, count,
-        static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output),
-        inputs, std::make_index_sequence<exec_argument_types.size()>{});
+    auto* casted_output =
+        static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output);
+    if constexpr (ScalarUDFTraits<TUDF>::MemoizeWithinBatch()) {
+      return MemoizedExecWrapperArrow<TUDF>(
+          static_cast<TUDF*>(udf), ctx, count, casted_output, inputs,
+          std::make_index_sequence<exec_argument_types.size()>{});
+    }
+    return ExecWrapperArrow<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output, inputs,
+                                  std::make_index_sequence<exec_argument_types.size()>{});
   }
 
   /**
@@ -241,6 +361,11 @@ struct ScalarUDFWrapper {
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
+    if constexpr (ScalarUDFTraits<TUDF>::MemoizeWithinBatch()) {
+      return MemoizedExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                                       input_as_base_value,
+                                       std::make_index_sequence<exec_argument_types.size()>{});
+    }
     return ExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
                              input_as_base_value,
                              std::make_index_sequence<exec_argument_types.size()>{});
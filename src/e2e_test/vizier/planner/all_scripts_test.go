@@ -243,14 +243,15 @@ func makePEMCarnotInfo(id uuid.UUID) *distributedpb.CarnotInfo {
 
 func makeKelvinCarnotInfo(id uuid.UUID) *distributedpb.CarnotInfo {
 	return &distributedpb.CarnotInfo{
-		HasGRPCServer:        true,
-		HasDataStore:         false,
-		ProcessesData:        true,
-		AcceptsRemoteSources: true,
-		AgentID:              utils.ProtoFromUUID(id),
-		QueryBrokerAddress:   "kelvin" + id.String(),
-		GRPCAddress:          "1.1.1.1",
-		SSLTargetName:        "ssl_targetname",
+		HasGRPCServer:         true,
+		HasDataStore:          false,
+		ProcessesData:         true,
+		AcceptsRemoteSources:  true,
+		AcceptsFlatRowBatches: true,
+		AgentID:               utils.ProtoFromUUID(id),
+		QueryBrokerAddress:    "kelvin" + id.String(),
+		GRPCAddress:           "1.1.1.1",
+		SSLTargetName:         "ssl_targetname",
 	}
 }
 
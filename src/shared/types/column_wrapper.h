@@ -22,6 +22,8 @@
 #include <arrow/buffer.h>
 #include <arrow/builder.h>
 
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -92,6 +94,13 @@ class ColumnWrapper {
   // CopyIndexes leaves the original untouched, while MoveIndexes destroys the moved indexes.
   virtual SharedColumnWrapper CopyIndexes(const std::vector<size_t>& indexes) const = 0;
   virtual SharedColumnWrapper MoveIndexes(const std::vector<size_t>& indexes) = 0;
+
+  // Moves all the values of other, which must have the same data type, to the end of this column.
+  // other is left empty.
+  virtual void MoveAppend(ColumnWrapper* other) = 0;
+
+  // Removes the values at and after index size, keeping the first size values in place.
+  virtual void Truncate(size_t size) = 0;
 };
 
 /**
@@ -164,6 +173,23 @@ class ColumnWrapperTmpl : public ColumnWrapper {
     return col;
   }
 
+  void MoveAppend(ColumnWrapper* other) override {
+    DCHECK_EQ(other->data_type(), data_type());
+    auto& other_data = static_cast<ColumnWrapperTmpl<T>*>(other)->data_;
+    if (data_.empty()) {
+      data_.swap(other_data);
+    } else {
+      data_.insert(data_.end(), std::make_move_iterator(other_data.begin()),
+                   std::make_move_iterator(other_data.end()));
+    }
+    other_data.clear();
+  }
+
+  void Truncate(size_t size) override {
+    DCHECK_LE(size, data_.size());
+    data_.erase(data_.begin() + size, data_.end());
+  }
+
  private:
   std::vector<T> data_;
 };
@@ -173,14 +199,276 @@ int64_t ColumnWrapperTmpl<T>::Bytes() const {
   return Size() * sizeof(T);
 }
 
+/**
+ * The string column stores its values either as a vector of strings, or as an arena of
+ * arrow-compatible offsets and bytes, when it is created by MakeArena(). The arena avoids an
+ * allocation per value, and is handed to arrow without a copy by ShareAsArrow(). Arrow arrays hold
+ * their own reference to the arena, and a column copies its arena before modifying one that is
+ * shared, so the arrays stay valid whatever happens to the column afterwards.
+ * Const accesses only read the arena (eg. View() and the const operator[]), so they can run
+ * concurrently. The non-const accesses that need a StringValue reference or pointer first convert
+ * the arena into the vector of strings with Unpack(), so an arena column behaves like any other
+ * string column. A const raw pointer can't be served from an arena, so arena columns must be
+ * unpacked before their const UnsafeRawData() is used.
+ */
 template <>
-inline int64_t ColumnWrapperTmpl<StringValue>::Bytes() const {
-  int64_t bytes = 0;
-  for (const auto& data : data_) {
-    bytes += data.bytes();
+class ColumnWrapperTmpl<StringValue> : public ColumnWrapper {
+ public:
+  // Arena storage, in the layout of arrow::StringArray: value i is
+  // bytes[offsets[i], offsets[i + 1]).
+  struct Arena {
+    std::vector<int32_t> offsets = {0};
+    std::string bytes;
+  };
+
+  explicit ColumnWrapperTmpl(size_t size) : data_(size) {}
+  explicit ColumnWrapperTmpl(size_t size, const StringValue& val) : data_(size, val) {}
+  explicit ColumnWrapperTmpl(const std::vector<StringValue>& vals) : data_(vals) {}
+
+  ~ColumnWrapperTmpl() override = default;
+
+  // Creates an empty column that stores its values in an arena.
+  static std::shared_ptr<ColumnWrapperTmpl<StringValue>> MakeArena() {
+    auto col = std::make_shared<ColumnWrapperTmpl<StringValue>>(0);
+    col->arena_ = std::make_shared<Arena>();
+    return col;
   }
-  return bytes;
-}
+
+  StringValue* UnsafeRawData() override {
+    Unpack();
+    return data_.data();
+  }
+  const StringValue* UnsafeRawData() const override {
+    DCHECK(arena_ == nullptr) << "Unpack() the arena column before taking a pointer to its values";
+    return data_.data();
+  }
+  DataType data_type() const override { return DataType::STRING; }
+
+  size_t Size() const override { return arena_ ? arena_->offsets.size() - 1 : data_.size(); }
+  bool Empty() const override { return Size() == 0; }
+
+  std::shared_ptr<arrow::Array> ConvertToArrow(arrow::MemoryPool* mem_pool) override {
+    if (!arena_) {
+      return ToArrow(data_, mem_pool);
+    }
+    arrow::StringBuilder builder(mem_pool);
+    PL_CHECK_OK(builder.Reserve(Size()));
+    PL_CHECK_OK(builder.ReserveData(arena_->bytes.size()));
+    for (size_t i = 0; i < Size(); ++i) {
+      std::string_view val = View(i);
+      builder.UnsafeAppend(val.data(), static_cast<int32_t>(val.size()));
+    }
+    std::shared_ptr<arrow::Array> arr;
+    PL_CHECK_OK(builder.Finish(&arr));
+    return arr;
+  }
+
+  StringValue operator[](size_t idx) const {
+    return arena_ ? StringValue(std::string(View(idx))) : data_[idx];
+  }
+
+  StringValue& operator[](size_t idx) {
+    Unpack();
+    return data_[idx];
+  }
+
+  // Returns a view of the value at idx, without converting the arena.
+  std::string_view View(size_t idx) const {
+    if (arena_) {
+      const std::vector<int32_t>& offsets = arena_->offsets;
+      return std::string_view(arena_->bytes.data() + offsets[idx], offsets[idx + 1] - offsets[idx]);
+    }
+    return data_[idx];
+  }
+
+  void Append(StringValue val) {
+    if (arena_) {
+      AppendView(val);
+    } else {
+      data_.push_back(std::move(val));
+    }
+  }
+
+  // Appends a copy of val. Unlike Append(), it doesn't require a StringValue, so arena columns
+  // can be appended to without allocating.
+  void AppendView(std::string_view val) {
+    if (arena_ && arena_->bytes.size() + val.size() > kMaxArenaBytes) {
+      // Arrow string arrays use 32-bit offsets.
+      Unpack();
+    }
+    if (arena_) {
+      Arena* arena = MutableArena();
+      arena->bytes.append(val);
+      arena->offsets.push_back(static_cast<int32_t>(arena->bytes.size()));
+    } else {
+      data_.emplace_back(std::string(val));
+    }
+  }
+
+  void Reserve(size_t size) override {
+    if (arena_) {
+      MutableArena()->offsets.reserve(size + 1);
+    } else {
+      data_.reserve(size);
+    }
+  }
+
+  void ShrinkToFit() override {
+    data_.shrink_to_fit();
+    if (arena_) {
+      Arena* arena = MutableArena();
+      arena->offsets.shrink_to_fit();
+      arena->bytes.shrink_to_fit();
+    }
+  }
+
+  void Resize(size_t size) {
+    Unpack();
+    data_.resize(size);
+  }
+
+  void Clear() override {
+    data_.clear();
+    if (arena_.use_count() > 1) {
+      arena_ = std::make_shared<Arena>();
+    } else if (arena_) {
+      arena_->offsets.resize(1);
+      arena_->bytes.clear();
+    }
+  }
+
+  int64_t Bytes() const override {
+    if (arena_) {
+      return arena_->bytes.size();
+    }
+    int64_t bytes = 0;
+    for (const auto& data : data_) {
+      bytes += data.bytes();
+    }
+    return bytes;
+  }
+
+  void AppendFromVector(const std::vector<StringValue>& value_vector) {
+    for (const auto& value : value_vector) {
+      AppendView(value);
+    }
+  }
+
+  bool is_arena() const { return arena_ != nullptr; }
+  // The arena of the column, or null if the column isn't an arena.
+  std::shared_ptr<const Arena> arena() const { return arena_; }
+
+  // Converts the arena into the vector of strings. No-op for columns that aren't arenas.
+  // Arrow arrays that share the arena keep it alive, but views into it from the column are
+  // invalidated.
+  void Unpack() {
+    if (!arena_) {
+      return;
+    }
+    data_.reserve(Size());
+    for (size_t i = 0; i < Size(); ++i) {
+      data_.emplace_back(std::string(View(i)));
+    }
+    arena_.reset();
+  }
+  // Return a new SharedColumnWrapper with values according to the spec:
+  //    { data[idx[0]], data[idx[1]], data[idx[2]], ... }
+  // Arena columns return an arena column.
+  SharedColumnWrapper CopyIndexes(const std::vector<size_t>& indexes) const override {
+    DCHECK_LE(indexes.size(), Size());
+    if (arena_) {
+      return GatherArena(indexes);
+    }
+    auto copy = std::make_shared<ColumnWrapperTmpl<StringValue>>(indexes.size());
+    for (size_t i = 0; i < indexes.size(); ++i) {
+      copy->data_[i] = data_[indexes[i]];
+    }
+    return copy;
+  }
+
+  // Return a new SharedColumnWrapper with values according to the spec:
+  //    { data[idx[0]], data[idx[1]], data[idx[2]], ... }
+  // Warning: Indexes in "this" ColumnWrapper have their contents moved,
+  // so "this" should be discarded.
+  SharedColumnWrapper MoveIndexes(const std::vector<size_t>& indexes) override {
+    DCHECK_LE(indexes.size(), Size());
+    if (arena_) {
+      return GatherArena(indexes);
+    }
+    auto col = std::make_shared<ColumnWrapperTmpl<StringValue>>(indexes.size());
+    for (size_t i = 0; i < indexes.size(); ++i) {
+      col->data_[i] = std::move(data_[indexes[i]]);
+    }
+    return col;
+  }
+
+  void MoveAppend(ColumnWrapper* other) override {
+    DCHECK_EQ(other->data_type(), data_type());
+    auto* other_col = static_cast<ColumnWrapperTmpl<StringValue>*>(other);
+    if (arena_ && other_col->arena_ &&
+        arena_->bytes.size() + other_col->arena_->bytes.size() <= kMaxArenaBytes) {
+      const Arena& other_arena = *other_col->arena_;
+      Arena* arena = MutableArena();
+      const int32_t base = static_cast<int32_t>(arena->bytes.size());
+      arena->bytes.append(other_arena.bytes);
+      arena->offsets.reserve(arena->offsets.size() + other_col->Size());
+      for (size_t i = 1; i < other_arena.offsets.size(); ++i) {
+        arena->offsets.push_back(base + other_arena.offsets[i]);
+      }
+      other_col->Clear();
+      return;
+    }
+    Unpack();
+    other_col->Unpack();
+    if (data_.empty()) {
+      data_.swap(other_col->data_);
+    } else {
+      data_.insert(data_.end(), std::make_move_iterator(other_col->data_.begin()),
+                   std::make_move_iterator(other_col->data_.end()));
+    }
+    other_col->data_.clear();
+  }
+
+  void Truncate(size_t size) override {
+    DCHECK_LE(size, Size());
+    if (arena_) {
+      Arena* arena = MutableArena();
+      arena->offsets.resize(size + 1);
+      arena->bytes.resize(arena->offsets.back());
+    } else {
+      data_.erase(data_.begin() + size, data_.end());
+    }
+  }
+
+ private:
+  static constexpr size_t kMaxArenaBytes = std::numeric_limits<int32_t>::max();
+
+  SharedColumnWrapper GatherArena(const std::vector<size_t>& indexes) const {
+    auto col = MakeArena();
+    col->arena_->offsets.reserve(indexes.size() + 1);
+    size_t total_bytes = 0;
+    for (size_t idx : indexes) {
+      total_bytes += arena_->offsets[idx + 1] - arena_->offsets[idx];
+    }
+    col->arena_->bytes.reserve(total_bytes);
+    for (size_t idx : indexes) {
+      col->AppendView(View(idx));
+    }
+    return col;
+  }
+
+  // Returns the arena for modification, after copying it if arrow arrays still share it.
+  Arena* MutableArena() {
+    if (arena_.use_count() > 1) {
+      arena_ = std::make_shared<Arena>(*arena_);
+    }
+    return arena_.get();
+  }
+
+  std::vector<StringValue> data_;
+  // Null unless the column is an arena.
+  std::shared_ptr<Arena> arena_;
+};
 
 // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
 using BoolValueColumnWrapper = ColumnWrapperTmpl<BoolValue>;
@@ -288,6 +576,85 @@ inline SharedColumnWrapper ColumnWrapper::Make(DataType data_type, size_t size)
   }
 }
 
+/**
+ * An arrow::Buffer that points at the data of a ColumnWrapper and keeps the ColumnWrapper alive.
+ * The ColumnWrapper must not be modified once it has been wrapped.
+ */
+class ColumnWrapperBuffer : public arrow::Buffer {
+ public:
+  explicit ColumnWrapperBuffer(SharedColumnWrapper col)
+      : arrow::Buffer(reinterpret_cast<const uint8_t*>(col->UnsafeRawData()), col->Bytes()),
+        col_(std::move(col)) {}
+
+ private:
+  SharedColumnWrapper col_;
+};
+
+/**
+ * An arrow::Buffer that points into the arena of a string column and keeps the arena alive, even
+ * after the column itself converts or drops it.
+ */
+class StringArenaBuffer : public arrow::Buffer {
+ public:
+  using Arena = StringValueColumnWrapper::Arena;
+
+  StringArenaBuffer(std::shared_ptr<const Arena> arena, const void* data, int64_t size)
+      : arrow::Buffer(reinterpret_cast<const uint8_t*>(data), size), arena_(std::move(arena)) {}
+
+ private:
+  std::shared_ptr<const Arena> arena_;
+};
+
+template <DataType TDataType>
+inline std::shared_ptr<arrow::Array> ShareFixedWidthAsArrow(SharedColumnWrapper col) {
+  using value_type = typename DataTypeTraits<TDataType>::value_type;
+  using native_type = typename DataTypeTraits<TDataType>::native_type;
+  static_assert(sizeof(value_type) == sizeof(native_type),
+                "Value type must have the same layout as its arrow native type");
+  int64_t length = col->Size();
+  auto buffer = std::make_shared<ColumnWrapperBuffer>(std::move(col));
+  return std::make_shared<typename DataTypeTraits<TDataType>::arrow_array_type>(length, buffer);
+}
+
+inline std::shared_ptr<arrow::Array> ShareStringArenaAsArrow(SharedColumnWrapper col) {
+  const auto* strings = static_cast<const StringValueColumnWrapper*>(col.get());
+  int64_t length = strings->Size();
+  std::shared_ptr<const StringArenaBuffer::Arena> arena = strings->arena();
+  auto offsets_buffer = std::make_shared<StringArenaBuffer>(
+      arena, arena->offsets.data(), static_cast<int64_t>(arena->offsets.size() * sizeof(int32_t)));
+  auto bytes_buffer = std::make_shared<StringArenaBuffer>(
+      arena, arena->bytes.data(), static_cast<int64_t>(arena->bytes.size()));
+  return std::make_shared<arrow::StringArray>(length, offsets_buffer, bytes_buffer);
+}
+
+/**
+ * Converts a column wrapper to an arrow array. The int64, float64 and time64 columns, and string
+ * columns built in an arena, already have arrow's memory layout, so the array shares their buffers
+ * instead of copying them. Other types are copied into mem_pool.
+ * @param col the column. Columns of fixed width types must not be modified afterwards.
+ * @param mem_pool the MemoryPool to copy the columns that can't be shared into.
+ * @return the arrow array.
+ * PL_CARNOT_UPDATE_FOR_NEW_TYPES.
+ */
+inline std::shared_ptr<arrow::Array> ShareAsArrow(const SharedColumnWrapper& col,
+                                                  arrow::MemoryPool* mem_pool) {
+  switch (col->data_type()) {
+    case DataType::INT64:
+      return ShareFixedWidthAsArrow<DataType::INT64>(col);
+    case DataType::FLOAT64:
+      return ShareFixedWidthAsArrow<DataType::FLOAT64>(col);
+    case DataType::TIME64NS:
+      return ShareFixedWidthAsArrow<DataType::TIME64NS>(col);
+    case DataType::STRING:
+      if (static_cast<const StringValueColumnWrapper*>(col.get())->is_arena()) {
+        return ShareStringArenaAsArrow(col);
+      }
+      return col->ConvertToArrow(mem_pool);
+    default:
+      return col->ConvertToArrow(mem_pool);
+  }
+}
+
 template <class TValueType>
 inline void ColumnWrapper::Append(TValueType val) {
   CHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type)
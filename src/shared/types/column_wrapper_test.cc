@@ -151,6 +151,142 @@ TEST(ColumnWrapper, FromArrowString) {
   EXPECT_TRUE(converted_to_arrow->Equals(arr));
 }
 
+TEST(ColumnWrapper, ShareAsArrowInt64) {
+  arrow::Int64Builder builder;
+  PL_CHECK_OK(builder.Append(1));
+  PL_CHECK_OK(builder.Append(2));
+  PL_CHECK_OK(builder.Append(3));
+
+  std::shared_ptr<arrow::Array> arr;
+  PL_CHECK_OK(builder.Finish(&arr));
+
+  auto wrapper = ColumnWrapper::FromArrow(arr);
+  const void* raw_data = wrapper->UnsafeRawData();
+  auto shared = ShareAsArrow(wrapper, arrow::default_memory_pool());
+  // The array should point at the column wrapper's data rather than a copy of it, and keep the
+  // data alive after the wrapper is released.
+  EXPECT_EQ(raw_data, static_cast<arrow::Int64Array*>(shared.get())->raw_values());
+  wrapper.reset();
+  EXPECT_TRUE(shared->Equals(arr));
+}
+
+TEST(ColumnWrapper, ShareAsArrowString) {
+  arrow::StringBuilder builder;
+  PL_CHECK_OK(builder.Append("abc"));
+  PL_CHECK_OK(builder.Append("def"));
+
+  std::shared_ptr<arrow::Array> arr;
+  PL_CHECK_OK(builder.Finish(&arr));
+
+  auto wrapper = ColumnWrapper::FromArrow(arr);
+  auto shared = ShareAsArrow(wrapper, arrow::default_memory_pool());
+  EXPECT_TRUE(shared->Equals(arr));
+}
+
+TEST(ColumnWrapper, StringArena) {
+  auto arena = StringValueColumnWrapper::MakeArena();
+  arena->AppendView("abc");
+  arena->Append("");
+  arena->AppendView("defgh");
+  ASSERT_TRUE(arena->is_arena());
+  EXPECT_EQ(arena->Size(), 3);
+  EXPECT_EQ(arena->Bytes(), 8);
+  EXPECT_EQ(arena->View(2), "defgh");
+
+  // Reordering keeps the arena.
+  std::shared_ptr<ColumnWrapper> col = arena->MoveIndexes({2, 0});
+  auto* reordered = static_cast<StringValueColumnWrapper*>(col.get());
+  ASSERT_TRUE(reordered->is_arena());
+  EXPECT_EQ(reordered->View(0), "defgh");
+  EXPECT_EQ(reordered->View(1), "abc");
+
+  auto other = StringValueColumnWrapper::MakeArena();
+  other->AppendView("ij");
+  col->MoveAppend(other.get());
+  EXPECT_TRUE(other->Empty());
+  ASSERT_EQ(col->Size(), 3);
+  EXPECT_EQ(reordered->View(2), "ij");
+
+  arrow::StringBuilder builder;
+  PL_CHECK_OK(builder.Append("defgh"));
+  PL_CHECK_OK(builder.Append("abc"));
+  PL_CHECK_OK(builder.Append("ij"));
+  std::shared_ptr<arrow::Array> expected;
+  PL_CHECK_OK(builder.Finish(&expected));
+
+  // The arena is shared with arrow rather than copied, and kept alive by the array.
+  const char* raw_data = reordered->arena()->bytes.data();
+  auto shared = ShareAsArrow(col, arrow::default_memory_pool());
+  EXPECT_EQ(reinterpret_cast<const uint8_t*>(raw_data),
+            static_cast<arrow::StringArray*>(shared.get())->value_data()->data());
+  EXPECT_TRUE(shared->Equals(expected));
+  EXPECT_TRUE(col->ConvertToArrow(arrow::default_memory_pool())->Equals(expected));
+  col.reset();
+  EXPECT_TRUE(shared->Equals(expected));
+}
+
+TEST(ColumnWrapper, StringArenaConvertsOnMutableAccess) {
+  auto col = StringValueColumnWrapper::MakeArena();
+  col->AppendView("abc");
+  col->AppendView("def");
+
+  // Const accesses only read the arena.
+  const auto* const_col = col.get();
+  EXPECT_EQ(const_col->operator[](1), "def");
+  EXPECT_EQ(const_col->Get<StringValue>(0), "abc");
+  EXPECT_TRUE(col->is_arena());
+
+  col->Get<StringValue>(0) += "x";
+  EXPECT_FALSE(col->is_arena());
+  EXPECT_EQ(col->Get<StringValue>(0), "abcx");
+  EXPECT_EQ(col->Get<StringValue>(1), "def");
+  col->AppendView("g");
+  EXPECT_EQ(col->Size(), 3);
+  EXPECT_EQ(col->Get<StringValue>(2), "g");
+}
+
+TEST(ColumnWrapper, SharedStringArenaOutlivesColumnChanges) {
+  auto col = StringValueColumnWrapper::MakeArena();
+  col->AppendView("abc");
+  col->AppendView("def");
+  auto shared = ShareAsArrow(col, arrow::default_memory_pool());
+
+  arrow::StringBuilder builder;
+  PL_CHECK_OK(builder.Append("abc"));
+  PL_CHECK_OK(builder.Append("def"));
+  std::shared_ptr<arrow::Array> expected;
+  PL_CHECK_OK(builder.Finish(&expected));
+
+  // Appending to the column copies the arena instead of changing the shared one.
+  col->AppendView("g");
+  EXPECT_TRUE(col->is_arena());
+  EXPECT_TRUE(shared->Equals(expected));
+
+  // Converting the arena drops the column's reference to it, but not the array's.
+  col->Unpack();
+  EXPECT_FALSE(col->is_arena());
+  col->Get<StringValue>(0) = "xyz";
+  col->Clear();
+  EXPECT_TRUE(shared->Equals(expected));
+
+  auto cleared = StringValueColumnWrapper::MakeArena();
+  cleared->AppendView("abc");
+  auto cleared_shared = ShareAsArrow(cleared, arrow::default_memory_pool());
+  cleared->Clear();
+  cleared->AppendView("def");
+  EXPECT_EQ(cleared_shared->length(), 1);
+  EXPECT_EQ(static_cast<arrow::StringArray*>(cleared_shared.get())->GetString(0), "abc");
+}
+
+TEST(ColumnWrapperDeathTest, ConstRawDataOfStringArena) {
+  auto col = StringValueColumnWrapper::MakeArena();
+  col->AppendView("abc");
+  const StringValueColumnWrapper* const_col = col.get();
+  EXPECT_DEBUG_DEATH(const_col->UnsafeRawData(), "Unpack\\(\\) the arena column");
+  col->Unpack();
+  EXPECT_EQ(const_col->UnsafeRawData()[0], "abc");
+}
+
 TEST(ColumnWrapperDeathTest, AppendTypeMismatches) {
   auto wrapper = ColumnWrapper::Make(DataType::BOOLEAN, 1);
   ASSERT_EQ(1, wrapper->Size());
@@ -283,5 +419,24 @@ TEST(ColumnWrapperTest, MoveIndexes) {
   }
 }
 
+TEST(ColumnWrapperTest, Truncate) {
+  auto col = ColumnWrapper::Make(DataType::INT64, 0);
+  col->AppendFromVector(std::vector<Int64Value>{1, 2, 3, 4});
+  col->Truncate(2);
+  ASSERT_EQ(col->Size(), 2);
+  EXPECT_EQ(col->Get<Int64Value>(1), 2);
+
+  auto arena = StringValueColumnWrapper::MakeArena();
+  arena->AppendView("abc");
+  arena->AppendView("de");
+  arena->AppendView("fgh");
+  arena->Truncate(1);
+  ASSERT_TRUE(arena->is_arena());
+  ASSERT_EQ(arena->Size(), 1);
+  EXPECT_EQ(arena->Bytes(), 3);
+  arena->AppendView("ij");
+  EXPECT_EQ(arena->View(1), "ij");
+}
+
 }  // namespace types
 }  // namespace px
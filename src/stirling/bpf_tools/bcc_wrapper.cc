@@ -18,6 +18,7 @@
 
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 
+#include <bcc/libbpf.h>
 #include <linux/perf_event.h>
 #include <sys/mount.h>
 
@@ -340,6 +341,40 @@ Status BCCWrapper::OpenPerfBuffer(const PerfBufferSpec& perf_buffer, void* cb_co
   return Status::OK();
 }
 
+int BCCWrapper::HandleRingBufferSample(void* ctx, void* data, size_t size) {
+  auto* callback = static_cast<RingBufferCallback*>(ctx);
+  callback->probe_output_fn(callback->cb_cookie, data, static_cast<int>(size));
+  return 0;
+}
+
+Status BCCWrapper::OpenRingBuffer(const PerfBufferSpec& ring_buffer, void* cb_cookie) {
+  LOG(INFO) << absl::Substitute("Opening ring buffer: $0 (shared by all cpus)", ring_buffer.name);
+
+  const int map_fd = bpf_.get_table(std::string(ring_buffer.name)).get_fd();
+  if (map_fd < 0) {
+    return error::Internal("Could not find ring buffer $0.", ring_buffer.name);
+  }
+
+  RingBufferCallback* callback = &ring_buffer_callbacks_.emplace_back(
+      RingBufferCallback{ring_buffer.probe_output_fn, cb_cookie});
+  if (ring_buffer_manager_ == nullptr) {
+    ring_buffer_manager_ = static_cast<struct ring_buffer*>(
+        bpf_new_ringbuf(map_fd, &BCCWrapper::HandleRingBufferSample, callback));
+    if (ring_buffer_manager_ == nullptr) {
+      ring_buffer_callbacks_.pop_back();
+      return error::Internal("Could not open ring buffer $0.", ring_buffer.name);
+    }
+  } else if (bpf_add_ringbuf(ring_buffer_manager_, map_fd, &BCCWrapper::HandleRingBufferSample,
+                             callback) < 0) {
+    ring_buffer_callbacks_.pop_back();
+    return error::Internal("Could not open ring buffer $0.", ring_buffer.name);
+  }
+
+  ring_buffers_.push_back(ring_buffer);
+  ++num_open_perf_buffers_;
+  return Status::OK();
+}
+
 Status BCCWrapper::OpenPerfBuffers(const ArrayView<PerfBufferSpec>& perf_buffers, void* cb_cookie) {
   for (const PerfBufferSpec& p : perf_buffers) {
     PL_RETURN_IF_ERROR(OpenPerfBuffer(p, cb_cookie));
@@ -362,6 +397,17 @@ void BCCWrapper::ClosePerfBuffers() {
   perf_buffers_.clear();
 }
 
+void BCCWrapper::CloseRingBuffers() {
+  if (ring_buffer_manager_ != nullptr) {
+    VLOG(1) << "Closing ring buffers";
+    bpf_free_ringbuf(ring_buffer_manager_);
+    ring_buffer_manager_ = nullptr;
+  }
+  num_open_perf_buffers_ -= ring_buffers_.size();
+  ring_buffers_.clear();
+  ring_buffer_callbacks_.clear();
+}
+
 Status BCCWrapper::AttachPerfEvent(const PerfEventSpec& perf_event) {
   VLOG(1) << absl::Substitute("Attaching perf event:\n   type=$0\n   probe_fn=$1",
                               magic_enum::enum_name(perf_event.type), perf_event.probe_fn);
@@ -415,11 +461,17 @@ void BCCWrapper::PollPerfBuffers(int timeout_ms) {
   for (const auto& spec : perf_buffers_) {
     PollPerfBuffer(spec.name, timeout_ms);
   }
+  if (ring_buffer_manager_ != nullptr) {
+    // Consumes the available events of all the ring buffers.
+    int res = bpf_poll_ringbuf(ring_buffer_manager_, timeout_ms);
+    LOG_IF(ERROR, res < 0) << "Failed to poll ring buffers: " << res;
+  }
 }
 
 void BCCWrapper::Close() {
   DetachPerfEvents();
   ClosePerfBuffers();
+  CloseRingBuffers();
   DetachKProbes();
   DetachUProbes();
   DetachTracepoints();
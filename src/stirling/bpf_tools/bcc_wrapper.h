@@ -35,6 +35,7 @@
 #include <gtest/gtest_prod.h>
 
 #include <filesystem>
+#include <list>
 #include <map>
 #include <memory>
 #include <set>
@@ -45,6 +46,9 @@
 #include "src/common/base/base.h"
 #include "src/stirling/obj_tools/elf_reader.h"
 
+// Opaque libbpf ring buffer manager, created through bcc's bpf_new_ringbuf().
+struct ring_buffer;
+
 namespace px {
 /*
  * Status adapter for ebpf::StatusTuple.
@@ -267,6 +271,18 @@ class BCCWrapper {
    */
   Status OpenPerfBuffer(const PerfBufferSpec& perf_buffer, void* cb_cookie = nullptr);
 
+  /**
+   * Open a BPF ring buffer (declared with BPF_RINGBUF_OUTPUT) for reading events.
+   * Unlike a perf buffer, a ring buffer is a single buffer shared by all CPUs, and it is sized
+   * in the probe code, so the size_bytes and probe_loss_fn of the spec are not used.
+   * Requires Linux 5.8+.
+   * @param ring_buffer Specifications of the ring buffer (name, callback function, etc.).
+   * @param cb_cookie Raw pointer returned to callback function when events are drained by
+   * PollPerfBuffers().
+   * @return Error if the ring buffer cannot be opened (e.g. ring buffer does not exist).
+   */
+  Status OpenRingBuffer(const PerfBufferSpec& ring_buffer, void* cb_cookie = nullptr);
+
   /**
    * Attach a perf event, which runs a probe every time a perf counter reaches a threshold
    * condition.
@@ -333,8 +349,8 @@ class BCCWrapper {
   }
 
   /**
-   * Drains all of the opened perf buffers, calling the handle function that was
-   * specified in the PerfBufferSpec when OpenPerfBuffer was called.
+   * Drains all of the opened perf buffers and ring buffers, calling the handle function that was
+   * specified in the PerfBufferSpec when OpenPerfBuffer or OpenRingBuffer was called.
    *
    * @param timeout_ms If there's no event in the perf buffer, then timeout_ms specifies the
    *                   amount of time to wait for an event to arrive before returning.
@@ -378,6 +394,7 @@ class BCCWrapper {
 
   // These are static counters of attached/open probes across all instances.
   // It is meant for verification that we have cleaned-up all resources in tests.
+  // Ring buffers are counted as perf buffers.
   static size_t num_attached_probes() { return num_attached_kprobes_ + num_attached_uprobes_; }
   static size_t num_open_perf_buffers() { return num_open_perf_buffers_; }
   static size_t num_attached_perf_events() { return num_attached_perf_events_; }
@@ -385,6 +402,15 @@ class BCCWrapper {
  private:
   FRIEND_TEST(BCCWrapperTest, DetachUProbe);
 
+  // The callback of a ring buffer, in the form expected by the perf buffer callbacks.
+  struct RingBufferCallback {
+    perf_reader_raw_cb probe_output_fn;
+    void* cb_cookie;
+  };
+
+  // Adapts a ring buffer sample to the RingBufferCallback passed as ctx.
+  static int HandleRingBufferSample(void* ctx, void* data, size_t size);
+
   Status DetachKProbe(const KProbeSpec& probe);
   Status DetachUProbe(const UProbeSpec& probe);
   Status DetachTracepoint(const TracepointSpec& probe);
@@ -398,6 +424,7 @@ class BCCWrapper {
   void DetachUProbes();
   void DetachTracepoints();
   void ClosePerfBuffers();
+  void CloseRingBuffers();
   void DetachPerfEvents();
 
   // Returns the name that identifies the target to attach this k-probe.
@@ -409,6 +436,12 @@ class BCCWrapper {
   std::vector<PerfBufferSpec> perf_buffers_;
   std::vector<PerfEventSpec> perf_events_;
 
+  // All ring buffers share a single manager, so one epoll drains them all.
+  // The callbacks are in a list, because their addresses are handed to the manager.
+  std::vector<PerfBufferSpec> ring_buffers_;
+  std::list<RingBufferCallback> ring_buffer_callbacks_;
+  struct ring_buffer* ring_buffer_manager_ = nullptr;
+
   std::string system_headers_include_dir_;
 
   // Initialize this with one of the below bitmask flags to turn on different debug output.
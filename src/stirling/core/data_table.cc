@@ -17,6 +17,8 @@
  */
 
 #include <algorithm>
+#include <limits>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -42,6 +44,15 @@ void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
   for (const auto& element : table_schema_.elements()) {
     px::types::DataType type = element.type();
 
+    // Strings are appended to an arena, rather than allocated one by one, and the arena is
+    // handed to the table store without a copy.
+    if (type == types::DataType::STRING) {
+      auto col = types::StringValueColumnWrapper::MakeArena();
+      col->Reserve(kTargetCapacity);
+      record_batch_ptr->push_back(col);
+      continue;
+    }
+
 #define TYPE_CASE(_dt_)                           \
   auto col = types::ColumnWrapper::Make(_dt_, 0); \
   col->Reserve(kTargetCapacity);                  \
@@ -59,68 +70,119 @@ Tablet* DataTable::GetTablet(types::TabletIDView tablet_id) {
   return &tablet;
 }
 
+void DataTable::MoveRecordsFrom(DataTable* other) {
+  DCHECK_EQ(&table_schema_, &other->table_schema_);
+  for (auto& [tablet_id, other_tablet] : other->tablets_) {
+    if (other_tablet.times.empty()) {
+      continue;
+    }
+    Tablet* tablet = GetTablet(tablet_id);
+    if (tablet->sorted_prefix_size == tablet->times.size() &&
+        (tablet->times.empty() || other_tablet.times.front() >= tablet->times.back())) {
+      tablet->sorted_prefix_size += other_tablet.sorted_prefix_size;
+    }
+    tablet->times.insert(tablet->times.end(), other_tablet.times.begin(),
+                         other_tablet.times.end());
+    for (size_t i = 0; i < tablet->records.size(); ++i) {
+      tablet->records[i]->MoveAppend(other_tablet.records[i].get());
+    }
+  }
+  other->tablets_.clear();
+}
+
+namespace {
+
+// Reorders the records of the tablet by time. Only the records after the sorted prefix are sorted,
+// and then merged with the prefix.
+void SortTablet(Tablet* tablet) {
+  std::vector<size_t> sort_indexes =
+      utils::SortedIndexes(tablet->times, tablet->sorted_prefix_size);
+
+  std::vector<uint64_t> times(sort_indexes.size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    times[i] = tablet->times[sort_indexes[i]];
+  }
+  for (auto& col : tablet->records) {
+    col = col->MoveIndexes(sort_indexes);
+  }
+  tablet->times = std::move(times);
+  tablet->sorted_prefix_size = tablet->times.size();
+}
+
+}  // namespace
+
 std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   std::vector<TaggedRecordBatch> tablets_out;
   absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
   uint64_t next_start_time = start_time_;
 
   for (auto& [tablet_id, tablet] : tablets_) {
-    // Sort based on times.
-    std::vector<size_t> sort_indexes = utils::SortedIndexes(tablet.times);
+    if (tablet.times.empty()) {
+      continue;
+    }
+
+    // Sort based on times, unless the records were already appended in order.
+    if (tablet.sorted_prefix_size < tablet.times.size()) {
+      SortTablet(&tablet);
+    }
+    const std::vector<uint64_t>& times = tablet.times;
 
-    // End time is cutoff time + 1, so call to SplitSortedVector() produces the following
-    // classification: which classified according to:
+    // End time is cutoff time + 1, so the records are classified according to:
     //   expired < start_time
     //   pushable <= end_time
     uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
                                                  : std::numeric_limits<uint64_t>::max();
 
-    // Split the indexes into three groups:
-    // 1) Expired indexes: these are too old to return.
-    // 2) Pushable indexes: these are the ones that we return.
-    // 3) Carryover indexes: these are too new to return, so hold on to them until the next round.
-    auto positions =
-        utils::SplitSortedVector<2>(tablet.times, sort_indexes, {start_time_, end_time});
-    int num_expired = positions[0];
-    int num_pushable = positions[1] - positions[0];
-    int num_carryover = tablet.times.size() - positions[1];
+    // Split the sorted records into three contiguous ranges:
+    // 1) Expired records [0, pushable_begin): these are too old to return.
+    // 2) Pushable records [pushable_begin, carryover_begin): these are the ones that we return.
+    // 3) Carryover records [carryover_begin, size): these are too new to return, so hold on to
+    //    them until the next round.
+    size_t pushable_begin =
+        std::lower_bound(times.begin(), times.end(), start_time_) - times.begin();
+    size_t carryover_begin =
+        std::lower_bound(times.begin() + pushable_begin, times.end(), end_time) - times.begin();
+    size_t num_expired = pushable_begin;
+    size_t num_pushable = carryover_begin - pushable_begin;
+    size_t num_carryover = times.size() - carryover_begin;
 
     // Case 1: Expired records. Just print a message.
     VLOG_IF(1, num_expired > 0) << absl::Substitute(
         "$0 records for table $1 dropped due to late arrival [cutoff time=$2, oldest event "
         "time=$3].",
-        num_expired, table_schema_.name(), end_time, tablet.times[sort_indexes[0]]);
+        num_expired, table_schema_.name(), end_time, times.front());
 
-    // Case 2: Pushable records. Copy to output.
-    if (num_pushable > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> push_indexes(sort_indexes.begin() + num_expired,
-                                       sort_indexes.end() - num_carryover);
-      types::ColumnWrapperRecordBatch pushable_records;
-      for (auto& col : tablet.records) {
-        pushable_records.push_back(col->MoveIndexes(push_indexes));
-      }
-      uint64_t last_time = tablet.times[push_indexes.back()];
-      next_start_time = std::max(next_start_time, last_time);
-      tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(pushable_records)});
-    }
-
-    // Case 3: Carryover records.
+    // Case 3: Carryover records. Move them out of the end of the tablet, so that the tablet is
+    // left with the records before them.
     if (num_carryover > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> carryover_indexes(sort_indexes.begin() + num_pushable,
-                                            sort_indexes.end());
+      std::vector<size_t> carryover_indexes(num_carryover);
+      std::iota(carryover_indexes.begin(), carryover_indexes.end(), carryover_begin);
       types::ColumnWrapperRecordBatch carryover_records;
       for (auto& col : tablet.records) {
         carryover_records.push_back(col->MoveIndexes(carryover_indexes));
+        col->Truncate(carryover_begin);
       }
 
-      std::vector<uint64_t> times(carryover_indexes.size());
-      for (size_t i = 0; i < times.size(); ++i) {
-        times[i] = tablet.times[carryover_indexes[i]];
+      std::vector<uint64_t> carryover_times(times.begin() + carryover_begin, times.end());
+      carryover_tablets[tablet_id] = Tablet{tablet_id, std::move(carryover_times),
+                                            std::move(carryover_records), num_carryover};
+    }
+
+    // Case 2: Pushable records. Without expired records, these are the remaining columns of the
+    // tablet, which are moved to the output as they are.
+    if (num_pushable > 0) {
+      types::ColumnWrapperRecordBatch pushable_records;
+      if (num_expired == 0) {
+        pushable_records = std::move(tablet.records);
+      } else {
+        std::vector<size_t> push_indexes(num_pushable);
+        std::iota(push_indexes.begin(), push_indexes.end(), pushable_begin);
+        for (auto& col : tablet.records) {
+          pushable_records.push_back(col->MoveIndexes(push_indexes));
+        }
       }
-      carryover_tablets[tablet_id] =
-          Tablet{tablet_id, std::move(times), std::move(carryover_records)};
+      next_start_time = std::max(next_start_time, times[carryover_begin - 1]);
+      tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(pushable_records)});
     }
   }
   tablets_ = std::move(carryover_tablets);
@@ -43,9 +43,19 @@ struct TaggedRecordBatch {
 
 struct Tablet {
   types::TabletID tablet_id;
-  // TODO(oazizi): Convert this vector into a heap of {time, index} objects.
   std::vector<uint64_t> times;
   types::ColumnWrapperRecordBatch records;
+  // Number of leading records whose times are in non-decreasing order. Records are usually
+  // appended in time order, in which case this is the size of the tablet, and ConsumeRecords()
+  // doesn't need to sort them.
+  size_t sorted_prefix_size = 0;
+
+  void AppendTime(uint64_t time) {
+    if (sorted_prefix_size == times.size() && (times.empty() || time >= times.back())) {
+      ++sorted_prefix_size;
+    }
+    times.push_back(time);
+  }
 };
 
 class DataTable : public NotCopyable {
@@ -70,6 +80,13 @@ class DataTable : public NotCopyable {
    */
   std::vector<TaggedRecordBatch> ConsumeRecords();
 
+  /**
+   * Moves the records buffered in other, which must have the same schema, into this table.
+   * Used to merge the tables that records are staged in by concurrent producers; the order of
+   * the records doesn't matter, since ConsumeRecords() sorts them by time.
+   */
+  void MoveRecordsFrom(DataTable* other);
+
   /**
    * Sets a cutoff time for the table. Any records that appear after this time
    * will not be pushed out on a call to ConsumeRecords(). Instead, they will
@@ -163,7 +180,8 @@ class DataTable : public NotCopyable {
           val.resize(TMaxStringBytes);
           val.append(kTruncatedMsg);
         }
-        val.shrink_to_fit();
+        // No need to shrink val to fit: string columns are arenas (see InitBuffers()) that copy
+        // its bytes.
       }
 
       tablet_.records[TIndex]->Append(std::move(val));
@@ -192,7 +210,7 @@ class DataTable : public NotCopyable {
    private:
     void Init(uint64_t time) {
       DCHECK_EQ(schema->elements().size(), tablet_.records.size());
-      tablet_.times.push_back(time);
+      tablet_.AppendTime(time);
     }
 
     Tablet& tablet_;
@@ -248,7 +266,7 @@ class DataTable : public NotCopyable {
    private:
     void Init(uint64_t time) {
       DCHECK_EQ(schema_.elements().size(), tablet_.records.size());
-      tablet_.times.push_back(time);
+      tablet_.AppendTime(time);
       LOG_IF(DFATAL, schema_.elements().size() > kMaxSupportedColumns) << absl::Substitute(
           "Tables with more than $0 columns are not supported.", kMaxSupportedColumns);
     }
@@ -261,6 +279,7 @@ class DataTable : public NotCopyable {
   };
 
   uint64_t id() const { return id_; }
+  const DataTableSchema& table_schema() const { return table_schema_; }
 
  protected:
   // ColumnWrapper specific members
@@ -69,6 +69,32 @@ TEST_F(DataTableTest, ResultIsSorted) {
   }
 }
 
+TEST_F(DataTableTest, MoveRecordsFrom) {
+  DataTable staging_table(/*id*/ 0, kSchema);
+  std::vector<int> time_vals = {0, 10, 40, 20, 30, 50, 90, 70, 60, 80};
+
+  // Odd records go to the staging table, which is then merged into the main table.
+  for (size_t i = 0; i < time_vals.size(); ++i) {
+    DataTable* table = i % 2 == 0 ? data_table_.get() : &staging_table;
+    DataTable::RecordBuilder<&kSchema> r(table, time_vals[i]);
+    r.Append<r.ColIndex("time_")>(time_vals[i]);
+    r.Append<r.ColIndex("x")>(time_vals[i] / 10);
+    r.Append<r.ColIndex("s")>(std::string(1, 'a' + time_vals[i] / 10));
+  }
+  data_table_->MoveRecordsFrom(&staging_table);
+  EXPECT_TRUE(staging_table.ConsumeRecords().empty());
+
+  std::vector<TaggedRecordBatch> record_batches = data_table_->ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  types::ColumnWrapperRecordBatch& rb = record_batches[0].records;
+  ASSERT_EQ(rb[0]->Size(), time_vals.size());
+  for (size_t i = 0; i < time_vals.size(); ++i) {
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(i), 10 * static_cast<int>(i));
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(i), static_cast<int>(i));
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(i), std::string(1, 'a' + i));
+  }
+}
+
 // No time passed to RecordBuilder, so all timestamps should be zero.
 // That means there should never be any expired or carry-over records.
 // Also, nothing should be sorted in any way.
@@ -314,6 +340,72 @@ TEST_F(DataTableTest, Carryover) {
   }
 }
 
+TEST_F(DataTableTest, ExpiryAndCarryoverInSameRound) {
+  std::vector<int> time_vals = {0, 10, 20, 5, 30, 40, 50, 60};
+  std::vector<int> x_vals = {0, 1, 2, -1, 3, 4, 5, 6};
+  std::vector<std::string> s_vals = {"a", "b", "c", "z", "d", "e", "f", "g"};
+
+  auto append_records = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      DataTable::RecordBuilder<&kSchema> r(data_table_.get(), time_vals[i]);
+      r.Append<r.ColIndex("time_")>(time_vals[i]);
+      r.Append<r.ColIndex("x")>(x_vals[i]);
+      r.Append<r.ColIndex("s")>(s_vals[i]);
+    }
+  };
+
+  // Records appended in time order are all pushed.
+  {
+    append_records(0, 3);
+    data_table_->SetConsumeRecordsCutoffTime(20);
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+    ASSERT_EQ(rb[0]->Size(), 3);
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(2), 20);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(2), 2);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(2), "c");
+  }
+
+  // Time 5 is expired, times 30 and 40 are pushed and time 50 is carried over.
+  {
+    append_records(3, 7);
+    data_table_->SetConsumeRecordsCutoffTime(40);
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+    ASSERT_EQ(rb[0]->Size(), 2);
+
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(0), 30);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(0), 3);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(0), "d");
+
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(1), 40);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(1), 4);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(1), "e");
+  }
+
+  {
+    append_records(7, 8);
+    data_table_->SetConsumeRecordsCutoffTime(100);
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+    ASSERT_EQ(rb[0]->Size(), 2);
+
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(0), 50);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(0), 5);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(0), "f");
+
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(1), 60);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(1), 6);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(1), "g");
+  }
+}
+
 class DataTableStressTest : public ::testing::Test {
  private:
   std::default_random_engine rng_;
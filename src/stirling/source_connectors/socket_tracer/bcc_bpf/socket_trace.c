@@ -44,7 +44,15 @@ const int32_t kInvalidFD = -1;
 const int kConnStatsDataThreshold = 65536;
 
 // This is the perf buffer for BPF program to export data from kernel to user space.
+// On kernels 5.8+, data events can instead go through a single ring buffer shared by all CPUs,
+// which keeps the events in order and doesn't reserve memory for idle CPUs.
+// Ring buffers don't report lost events, so they are counted in socket_data_events_lost.
+#if USE_SOCKET_DATA_RINGBUF
+BPF_RINGBUF_OUTPUT(socket_data_events, SOCKET_DATA_RINGBUF_PAGES);
+BPF_PERCPU_ARRAY(socket_data_events_lost, uint64_t, 1);
+#else
 BPF_PERF_OUTPUT(socket_data_events);
+#endif
 BPF_PERF_OUTPUT(socket_control_events);
 BPF_PERF_OUTPUT(conn_stats_events);
 
@@ -367,6 +375,22 @@ static __inline void submit_close_event(struct pt_regs* ctx, struct conn_info_t*
   socket_control_events.perf_submit(ctx, &control_event, sizeof(struct socket_control_event_t));
 }
 
+// Submits a data event to the socket_data_events perf buffer or ring buffer.
+static __inline void submit_socket_data_event(struct pt_regs* ctx,
+                                              struct socket_data_event_t* event, size_t size) {
+#if USE_SOCKET_DATA_RINGBUF
+  if (socket_data_events.ringbuf_output(event, size, 0) != 0) {
+    uint32_t kZero = 0;
+    uint64_t* lost = socket_data_events_lost.lookup(&kZero);
+    if (lost != NULL) {
+      ++(*lost);
+    }
+  }
+#else
+  socket_data_events.perf_submit(ctx, event, size);
+#endif
+}
+
 // Writes the input buf to event, and submits the event to the corresponding perf buffer.
 // Returns the bytes output from the input buf. Note that is not the total bytes submitted to the
 // perf buffer, which includes additional metadata.
@@ -437,7 +461,7 @@ static __inline void perf_submit_buf(struct pt_regs* ctx, const enum traffic_dir
   // If-statement is redundant, but is required to keep the 4.14 verifier happy.
   if (amount_copied > 0) {
     event->attr.msg_buf_size = amount_copied;
-    socket_data_events.perf_submit(ctx, event, sizeof(event->attr) + amount_copied);
+    submit_socket_data_event(ctx, event, sizeof(event->attr) + amount_copied);
   }
 }
 
@@ -832,7 +856,7 @@ static __inline void process_syscall_sendfile(struct pt_regs* ctx, uint64_t id,
     event->attr.pos = conn_info->wr_bytes;
     event->attr.msg_size = bytes_count;
     event->attr.msg_buf_size = 0;
-    socket_data_events.perf_submit(ctx, event, sizeof(event->attr));
+    submit_socket_data_event(ctx, event, sizeof(event->attr));
   }
 
   update_conn_stats(ctx, conn_info, kEgress, bytes_count);
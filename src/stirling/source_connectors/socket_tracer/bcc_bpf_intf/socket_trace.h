@@ -28,6 +28,8 @@
 
 const char kControlMapName[] = "control_map";
 const char kControlValuesArrayName[] = "control_values";
+const char kSocketDataEventsName[] = "socket_data_events";
+const char kSocketDataEventsLostName[] = "socket_data_events_lost";
 
 const int64_t kTraceAllTGIDs = -1;
 
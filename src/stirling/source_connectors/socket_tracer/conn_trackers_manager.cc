@@ -18,6 +18,8 @@
 
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
 
+#include <absl/hash/hash.h>
+
 DEFINE_double(
     stirling_conn_tracker_cleanup_threshold, 0.2,
     "Percentage of trackers that are ready for destruction that will trigger a memory cleanup");
@@ -133,6 +135,20 @@ ConnTracker& ConnTrackersManager::GetOrCreateConnTracker(struct conn_id_t conn_i
   return *conn_tracker_ptr;
 }
 
+std::vector<std::vector<ConnTracker*>> ConnTrackersManager::ShardActiveTrackers(
+    int num_shards) const {
+  DCHECK_GT(num_shards, 0);
+  std::vector<std::vector<ConnTracker*>> shards(num_shards);
+  for (auto& shard : shards) {
+    shard.reserve(active_trackers_.size() / num_shards + 1);
+  }
+  for (ConnTracker* tracker : active_trackers_) {
+    const uint64_t conn_map_key = GetConnMapKey(tracker->conn_id().upid.pid, tracker->conn_id().fd);
+    shards[absl::Hash<uint64_t>()(conn_map_key) % num_shards].push_back(tracker);
+  }
+  return shards;
+}
+
 StatusOr<const ConnTracker*> ConnTrackersManager::GetConnTracker(uint32_t pid, int32_t fd) const {
   const uint64_t conn_map_key = GetConnMapKey(pid, fd);
 
@@ -107,6 +107,13 @@ class ConnTrackersManager {
 
   const std::list<ConnTracker*>& active_trackers() const { return active_trackers_; }
 
+  /**
+   * Splits the active trackers into num_shards groups by PID+FD, so that all generations of a
+   * connection land in the same shard, and a connection stays in the same shard across
+   * iterations. The shards are used to process trackers concurrently.
+   */
+  std::vector<std::vector<ConnTracker*>> ShardActiveTrackers(int num_shards) const;
+
   /**
    * Returns the latest generation of a connection tracker for the given pid and fd.
    * If there is no tracker for {pid, fd}, returns error::NotFound.
@@ -115,6 +115,36 @@ TEST_F(ConnTrackersManagerTest, DebugInfo) {
                         "ready_for_destruction=false\n"));
 }
 
+// Tests that the shards partition the active trackers, and keep the generations of a connection
+// together.
+TEST_F(ConnTrackersManagerTest, ShardActiveTrackers) {
+  constexpr int kNumShards = 4;
+  for (uint32_t pid = 1; pid <= 50; ++pid) {
+    for (uint64_t tsid = 1; tsid <= 2; ++tsid) {
+      struct conn_id_t conn_id = {{{pid}, 0}, /*fd*/ 3, tsid};
+      trackers_mgr_.GetOrCreateConnTracker(conn_id);
+    }
+  }
+
+  std::vector<std::vector<ConnTracker*>> shards = trackers_mgr_.ShardActiveTrackers(kNumShards);
+  ASSERT_EQ(shards.size(), kNumShards);
+
+  absl::flat_hash_map<uint32_t, int> pid_shard;
+  size_t num_trackers = 0;
+  for (int i = 0; i < kNumShards; ++i) {
+    num_trackers += shards[i].size();
+    for (const ConnTracker* tracker : shards[i]) {
+      auto iter = pid_shard.try_emplace(tracker->conn_id().upid.pid, i).first;
+      EXPECT_EQ(iter->second, i);
+    }
+  }
+  EXPECT_EQ(num_trackers, trackers_mgr_.active_trackers().size());
+  EXPECT_EQ(pid_shard.size(), 50);
+
+  // The same connection goes to the same shard every time.
+  EXPECT_EQ(shards, trackers_mgr_.ShardActiveTrackers(kNumShards));
+}
+
 class ConnTrackerGenerationsTest : public ::testing::Test {
  protected:
   ConnTrackerGenerationsTest() : tracker_pool(1024) {
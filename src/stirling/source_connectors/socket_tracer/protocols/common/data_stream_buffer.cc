@@ -19,11 +19,12 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
 
 #include <algorithm>
+#include <cstring>
 #include <deque>
-#include <map>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "src/common/base/base.h"
 
@@ -33,37 +34,211 @@ namespace protocols {
 
 namespace {
 
-// Get element <= key in a map.
-template <typename TMapType>
-typename TMapType::const_iterator MapLE(const TMapType& map, size_t key) {
-  auto iter = map.upper_bound(key);
-  if (iter == map.begin()) {
-    return map.cend();
+// Get element <= key in a vector of (key, value) pairs sorted by key.
+template <typename TVectorType>
+auto VectorLE(TVectorType& vec, size_t key) -> decltype(vec.begin()) {
+  auto iter = std::upper_bound(vec.begin(), vec.end(), key,
+                               [](size_t k, const auto& elem) { return k < elem.first; });
+  if (iter == vec.begin()) {
+    return vec.end();
   }
   --iter;
 
   return iter;
 }
 
+// Get the first element >= key in a vector of (key, value) pairs sorted by key.
+template <typename TVectorType>
+auto VectorGE(TVectorType& vec, size_t key) -> decltype(vec.begin()) {
+  return std::lower_bound(vec.begin(), vec.end(), key,
+                          [](const auto& elem, size_t k) { return elem.first < k; });
+}
+
 }  // namespace
 
 void DataStreamBuffer::Reset() {
-  buffer_.clear();
+  blocks_.clear();
   chunks_.clear();
   timestamps_.clear();
   position_ = 0;
+  size_ = 0;
   ShrinkToFit();
 }
 
+void DataStreamBuffer::ShrinkToFit() {
+  free_blocks_.clear();
+  retired_linear_.clear();
+  linear_.reset();
+  linear_capacity_ = 0;
+  linear_size_ = 0;
+}
+
+size_t DataStreamBuffer::capacity() const {
+  size_t total = free_blocks_.size() * block_size_ + linear_capacity_;
+  for (const auto& block : blocks_) {
+    total += block.size;
+  }
+  return total;
+}
+
+std::unique_ptr<char[]> DataStreamBuffer::AcquireBlock() {
+  if (free_blocks_.empty()) {
+    return std::unique_ptr<char[]>(new char[block_size_]);
+  }
+  std::unique_ptr<char[]> data = std::move(free_blocks_.back());
+  free_blocks_.pop_back();
+  return data;
+}
+
+void DataStreamBuffer::ReleaseBlock(Block* block) {
+  if (free_blocks_.size() < kMaxFreeBlocks) {
+    free_blocks_.push_back(std::move(block->data));
+  }
+  block->data.reset();
+}
+
+void DataStreamBuffer::ReserveUntil(size_t end_pos) {
+  size_t covered_pos = position_;
+  if (!blocks_.empty()) {
+    covered_pos = blocks_.back().pos + blocks_.back().size;
+  }
+  while (covered_pos < end_pos) {
+    blocks_.push_back(Block{covered_pos, block_size_, AcquireBlock()});
+    covered_pos += block_size_;
+  }
+}
+
+size_t DataStreamBuffer::BlockIndex(size_t pos) const {
+  DCHECK(!blocks_.empty());
+  DCHECK_GE(pos, blocks_.front().pos);
+  auto iter = std::upper_bound(blocks_.begin(), blocks_.end(), pos,
+                               [](size_t p, const Block& block) { return p < block.pos; });
+  DCHECK(iter != blocks_.begin());
+  return std::distance(blocks_.begin(), iter) - 1;
+}
+
+void DataStreamBuffer::Write(size_t pos, std::string_view data) {
+  if (data.empty()) {
+    return;
+  }
+  for (size_t i = BlockIndex(pos); !data.empty(); ++i) {
+    DCHECK_LT(i, blocks_.size());
+    Block& block = blocks_[i];
+    size_t offset = pos - block.pos;
+    size_t n = std::min(data.size(), block.size - offset);
+    memcpy(block.data.get() + offset, data.data(), n);
+    data.remove_prefix(n);
+    pos += n;
+  }
+}
+
+void DataStreamBuffer::CopyOut(size_t pos, size_t size, char* out) const {
+  for (size_t i = BlockIndex(pos); size > 0; ++i) {
+    DCHECK_LT(i, blocks_.size());
+    const Block& block = blocks_[i];
+    size_t offset = pos - block.pos;
+    size_t n = std::min(size, block.size - offset);
+    memcpy(out, block.data.get() + offset, n);
+    out += n;
+    pos += n;
+    size -= n;
+  }
+}
+
+std::string DataStreamBuffer::Read(size_t pos, size_t size) const {
+  std::string out(size, '\0');
+  if (size > 0) {
+    CopyOut(pos, size, out.data());
+  }
+  return out;
+}
+
+std::string_view DataStreamBuffer::Linearize(size_t pos, size_t size) const {
+  const size_t end = pos + size;
+  if (pos < linear_pos_ || pos > linear_pos_ + linear_size_) {
+    // The linear buffer doesn't hold a prefix of the requested data. Start over in a new buffer,
+    // since views into the current one may still be in use.
+    if (linear_size_ > 0) {
+      retired_linear_.push_back(std::move(linear_));
+      linear_capacity_ = 0;
+    }
+    linear_pos_ = pos;
+    linear_size_ = 0;
+  }
+
+  if (end > linear_pos_ + linear_size_) {
+    if (end - linear_pos_ > linear_capacity_) {
+      // Move the data from pos onward into a larger buffer. The bytes before pos are not carried
+      // over, and the old buffer is kept for any views that still point into it.
+      const size_t keep = linear_pos_ + linear_size_ - pos;
+      const size_t new_capacity = std::max(end - pos, std::min(2 * linear_capacity_, capacity_));
+      auto data = std::unique_ptr<char[]>(new char[new_capacity]);
+      if (keep > 0) {
+        memcpy(data.get(), linear_.get() + (pos - linear_pos_), keep);
+        linearized_bytes_ += keep;
+      }
+      if (linear_ != nullptr) {
+        retired_linear_.push_back(std::move(linear_));
+      }
+      linear_ = std::move(data);
+      linear_capacity_ = new_capacity;
+      linear_pos_ = pos;
+      linear_size_ = keep;
+    }
+    // Only copy the bytes that the linear buffer doesn't hold yet.
+    const size_t linear_end = linear_pos_ + linear_size_;
+    CopyOut(linear_end, end - linear_end, linear_.get() + linear_size_);
+    linearized_bytes_ += end - linear_end;
+    linear_size_ = end - linear_pos_;
+  }
+
+  return std::string_view(linear_.get() + (pos - linear_pos_), size);
+}
+
+void DataStreamBuffer::InvalidateLinearFrom(size_t pos) {
+  if (pos < linear_pos_ + linear_size_) {
+    linear_size_ = pos > linear_pos_ ? pos - linear_pos_ : 0;
+  }
+}
+
+void DataStreamBuffer::CompactLinear() {
+  if (linear_size_ == 0 || linear_pos_ >= position_) {
+    return;
+  }
+  const size_t linear_end = linear_pos_ + linear_size_;
+  if (position_ >= linear_end) {
+    linear_size_ = 0;
+    return;
+  }
+  const size_t consumed = position_ - linear_pos_;
+  const size_t remaining = linear_end - position_;
+  if (consumed >= remaining) {
+    memmove(linear_.get(), linear_.get() + consumed, remaining);
+    linearized_bytes_ += remaining;
+    linear_pos_ = position_;
+    linear_size_ = remaining;
+  }
+}
+
+void DataStreamBuffer::AdvancePosition(size_t n) {
+  retired_linear_.clear();
+  position_ += n;
+  size_ -= std::min(n, size_);
+
+  // Release the blocks that only hold data before position_.
+  while (!blocks_.empty() && blocks_.front().pos + blocks_.front().size <= position_) {
+    ReleaseBlock(&blocks_.front());
+    blocks_.pop_front();
+  }
+  CompactLinear();
+}
+
 // TODO(oazizi): Add checking that the new chunk doesn't overlap with any existing chunk.
 //               Return error in such cases.
 void DataStreamBuffer::AddNewChunk(size_t pos, size_t size) {
   // Look for the chunks to the left and right of this new chunk.
-  auto r_iter = chunks_.lower_bound(pos);
-  auto l_iter = r_iter;
-  if (l_iter != chunks_.begin()) {
-    --l_iter;
-  }
+  auto r_iter = VectorGE(chunks_, pos);
+  auto l_iter = (r_iter == chunks_.begin()) ? chunks_.end() : std::prev(r_iter);
 
   // Does this chunk fuse with the chunk on the left of it?
   bool left_fuse = false;
@@ -92,22 +267,27 @@ void DataStreamBuffer::AddNewChunk(size_t pos, size_t size) {
     l_iter->second += size;
   } else if (right_fuse) {
     // Merge new chunk into the one on its right.
-    // Since its key changes, this requires removing and re-inserting the node.
-    auto node = chunks_.extract(r_iter);
-    node.key() = pos;
-    node.mapped() += size;
-    chunks_.insert(std::move(node));
+    // The order of the chunks doesn't change, so it can be updated in place.
+    r_iter->first = pos;
+    r_iter->second += size;
   } else {
     // No fusing, so just add the new chunk.
-    chunks_[pos] = size;
+    chunks_.insert(r_iter, {pos, size});
   }
 }
 
 void DataStreamBuffer::AddNewTimestamp(size_t pos, uint64_t timestamp) {
-  timestamps_[pos] = timestamp;
+  auto iter = VectorGE(timestamps_, pos);
+  if (iter != timestamps_.end() && iter->first == pos) {
+    iter->second = timestamp;
+  } else {
+    timestamps_.insert(iter, {pos, timestamp});
+  }
 }
 
 void DataStreamBuffer::Add(size_t pos, std::string_view data, uint64_t timestamp) {
+  retired_linear_.clear();
+
   if (data.size() > capacity_) {
     size_t oversize_amount = data.size() - capacity_;
     data.remove_prefix(oversize_amount);
@@ -138,7 +318,7 @@ void DataStreamBuffer::Add(size_t pos, std::string_view data, uint64_t timestamp
     data.remove_prefix(prefix);
     pos += prefix;
     ppos_front = 0;
-  } else if (ppos_back > static_cast<ssize_t>(buffer_.size())) {
+  } else if (ppos_back > static_cast<ssize_t>(size_)) {
     // Case 3: Data being added extends the buffer. Resize the buffer.
 
     // Subcase: If the data is more than max_gap_size_ ahead of the last chunk in the buffer (or
@@ -147,7 +327,19 @@ void DataStreamBuffer::Add(size_t pos, std::string_view data, uint64_t timestamp
     // front of the buffer. This allows `allow_before_gap_size_` bytes of new data to come in out of
     // order after this event that caused the gap.
     if (pos > EndPosition() + max_gap_size_) {
-      position_ = pos - allow_before_gap_size_;
+      const size_t new_position = pos - allow_before_gap_size_;
+      if (new_position >= position_) {
+        AdvancePosition(new_position - position_);
+      } else {
+        // The blocks don't reach back to new_position, so start over with new ones.
+        for (auto& block : blocks_) {
+          ReleaseBlock(&block);
+        }
+        blocks_.clear();
+        linear_size_ = 0;
+        position_ = new_position;
+        size_ = 0;
+      }
       ppos_front = allow_before_gap_size_;
       ppos_back = allow_before_gap_size_ + data.size();
       CleanupMetadata();
@@ -184,27 +376,27 @@ void DataStreamBuffer::Add(size_t pos, std::string_view data, uint64_t timestamp
     DCHECK_LE(new_size, capacity_);
     DCHECK_GE(new_size, 0);
 
-    buffer_.resize(new_size);
-
-    DCHECK_GE(buffer_.size(), 0);
-    DCHECK_LE(buffer_.size(), capacity_);
+    size_ = new_size;
+    ReserveUntil(position_ + size_);
   } else {
     // Case 4: Data being added is completely within the buffer. Write it directly.
 
     // No adjustments required.
   }
 
-  // Now copy the data into the buffer.
-  memcpy(buffer_.data() + ppos_front, data.data(), data.size());
+  // Now copy the data into the blocks.
+  InvalidateLinearFrom(position_ + ppos_front);
+  Write(position_ + ppos_front, data);
 
   // Update the metadata.
   AddNewChunk(pos, data.size());
   AddNewTimestamp(pos, timestamp);
 }
 
-std::map<size_t, size_t>::const_iterator DataStreamBuffer::GetChunkForPos(size_t pos) const {
+std::vector<std::pair<size_t, size_t>>::const_iterator DataStreamBuffer::GetChunkForPos(
+    size_t pos) const {
   // Get chunk which is <= pos.
-  auto iter = MapLE(chunks_, pos);
+  auto iter = VectorLE(chunks_, pos);
   if (iter == chunks_.cend()) {
     return chunks_.cend();
   }
@@ -233,9 +425,15 @@ std::string_view DataStreamBuffer::Get(size_t pos) const {
   DCHECK_GT(bytes_available, 0);
 
   DCHECK_GE(pos, position_);
-  size_t ppos = pos - position_;
-  DCHECK_LT(ppos, buffer_.size());
-  return std::string_view(buffer_.data() + ppos, bytes_available);
+  DCHECK_LE(pos + bytes_available, position_ + size_);
+
+  // Data within a single block is returned in place. Data that spans blocks is made contiguous
+  // in the linear buffer.
+  const Block& block = blocks_[BlockIndex(pos)];
+  if (pos + bytes_available > block.pos + block.size) {
+    return Linearize(pos, bytes_available);
+  }
+  return std::string_view(block.data.get() + (pos - block.pos), bytes_available);
 }
 
 StatusOr<uint64_t> DataStreamBuffer::GetTimestamp(size_t pos) const {
@@ -245,7 +443,7 @@ StatusOr<uint64_t> DataStreamBuffer::GetTimestamp(size_t pos) const {
   }
 
   // Get chunk which is <= pos.
-  auto iter = MapLE(timestamps_, pos);
+  auto iter = VectorLE(timestamps_, pos);
   if (iter == timestamps_.cend()) {
     LOG(DFATAL) << absl::Substitute(
         "Specified position should have been found, since we verified we are not in a chunk gap "
@@ -268,8 +466,8 @@ void DataStreamBuffer::CleanupChunks() {
   // Find and remove irrelevant metadata in `chunks_`.
 
   // Get chunk which is <= position_.
-  auto iter = MapLE(chunks_, position_);
-  if (iter == chunks_.cend()) {
+  auto iter = VectorLE(chunks_, position_);
+  if (iter == chunks_.end()) {
     return;
   }
 
@@ -289,10 +487,7 @@ void DataStreamBuffer::CleanupChunks() {
 
     // Adjust the first chunk's size.
     DCHECK(!chunks_.empty());
-    auto node = chunks_.extract(chunks_.begin());
-    node.key() = position_;
-    node.mapped() = available;
-    chunks_.insert(std::move(node));
+    chunks_.front() = {position_, available};
   }
 }
 
@@ -300,8 +495,8 @@ void DataStreamBuffer::CleanupTimestamps() {
   // Find and remove irrelevant metadata in `timestamps_`.
 
   // Get timestamp which is <= position_.
-  auto iter = MapLE(timestamps_, position_);
-  if (iter == timestamps_.cend()) {
+  auto iter = VectorLE(timestamps_, position_);
+  if (iter == timestamps_.end()) {
     return;
   }
 
@@ -320,8 +515,7 @@ void DataStreamBuffer::RemovePrefix(ssize_t n) {
     return;
   }
 
-  buffer_.erase(0, n);
-  position_ += n;
+  AdvancePosition(n);
 
   CleanupMetadata();
 }
@@ -335,8 +529,7 @@ void DataStreamBuffer::Trim() {
   DCHECK_GE(chunk_pos, position_);
   size_t trim_size = chunk_pos - position_;
 
-  buffer_.erase(0, trim_size);
-  position_ += trim_size;
+  AdvancePosition(trim_size);
 }
 
 size_t DataStreamBuffer::EndPosition() {
@@ -352,16 +545,17 @@ std::string DataStreamBuffer::DebugInfo() const {
   std::string s;
 
   absl::StrAppend(&s, absl::Substitute("Position: $0\n", position_));
-  absl::StrAppend(&s, absl::Substitute("BufferSize: $0/$1\n", buffer_.size(), capacity_));
+  absl::StrAppend(&s, absl::Substitute("BufferSize: $0/$1\n", size_, capacity_));
+  absl::StrAppend(&s, absl::Substitute("Blocks: $0\n", blocks_.size()));
   absl::StrAppend(&s, "Chunks:\n");
   for (const auto& [pos, size] : chunks_) {
-    absl::StrAppend(&s, absl::Substitute("  position:$0 size:$1\n", pos, size));
+    absl::StrAppend(&s, absl::Substitute("  position:$0 size:$1 data:$2\n", pos, size,
+                                         Read(pos, size)));
   }
   absl::StrAppend(&s, "Timestamps:\n");
   for (const auto& [pos, timestamp] : timestamps_) {
     absl::StrAppend(&s, absl::Substitute("  position:$0 timestamp:$1\n", pos, timestamp));
   }
-  absl::StrAppend(&s, absl::Substitute("Buffer: $0\n", buffer_));
 
   return s;
 }
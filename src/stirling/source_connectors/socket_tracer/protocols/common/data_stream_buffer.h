@@ -18,8 +18,12 @@
 
 #pragma once
 
-#include <map>
+#include <algorithm>
+#include <deque>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "src/common/base/base.h"
 
@@ -40,15 +44,23 @@ namespace protocols {
  * DataStreamBuffer supports data arriving out-of-order such that they are slotted into the middle
  * of the buffer.
  *
- * The underlying implementation is currently a simple string buffer, but this could be changed
- * in the future, as long as the data is maintained in a contiguous buffer.
+ * The data is stored in a sequence of fixed-size blocks, so consuming data at the head releases
+ * whole blocks instead of shifting the remaining data, and released blocks are recycled for new
+ * data at the tail. Data that spans blocks is copied into a linear buffer when it is requested
+ * with Get(). The linear buffer is reused across calls, which only copy the bytes it doesn't hold
+ * yet, so each byte is linearized about once no matter how often the head is requested.
  */
 class DataStreamBuffer {
  public:
+  // The size of the blocks in which data is stored. Buffers with a smaller capacity use blocks of
+  // their capacity instead.
+  static constexpr size_t kBlockSize = 16 * 1024;
+
   DataStreamBuffer(size_t max_capacity, size_t max_gap_size, size_t allow_before_gap_size)
       : capacity_(max_capacity),
         max_gap_size_(max_gap_size),
-        allow_before_gap_size_(allow_before_gap_size) {}
+        allow_before_gap_size_(allow_before_gap_size),
+        block_size_(std::max<size_t>(1, std::min(kBlockSize, max_capacity))) {}
 
   /**
    * Adds data to the buffer at the specified logical position.
@@ -63,8 +75,9 @@ class DataStreamBuffer {
 
   /**
    * Get all the contiguous data at the specified position of the buffer.
+   * If the data spans multiple blocks, it is first copied into the linear buffer.
    * @param pos The logical position of the requested data.
-   * @return A string_view to the data.
+   * @return A string_view to the data. It stays valid until the next non-const call.
    */
   std::string_view Get(size_t pos) const;
 
@@ -98,17 +111,22 @@ class DataStreamBuffer {
   /**
    * Current size of the internal buffer. Not all bytes may be populated.
    */
-  size_t size() const { return buffer_.size(); }
+  size_t size() const { return size_; }
 
   /**
    * Current allocated space of the internal buffer.
    */
-  size_t capacity() const { return buffer_.capacity(); }
+  size_t capacity() const;
+
+  /**
+   * Total number of bytes that were copied to make data that spans blocks contiguous.
+   */
+  size_t linearized_bytes() const { return linearized_bytes_; }
 
   /**
    * Return true if the buffer is empty.
    */
-  bool empty() const { return buffer_.empty(); }
+  bool empty() const { return size_ == 0; }
 
   /**
    * Logical position of the head of the buffer.
@@ -128,10 +146,21 @@ class DataStreamBuffer {
    * Note this has to be an external API, because `RemovePrefix` is called in situations where it
    * doesn't make sense to shrink.
    */
-  void ShrinkToFit() { buffer_.shrink_to_fit(); }
+  void ShrinkToFit();
 
  private:
-  std::map<size_t, size_t>::const_iterator GetChunkForPos(size_t pos) const;
+  // A block of the buffer. The blocks are contiguous: each block starts where the previous ends.
+  struct Block {
+    // Logical position of data_[0].
+    size_t pos;
+    size_t size;
+    std::unique_ptr<char[]> data;
+  };
+
+  // At most this many released blocks are kept for reuse.
+  static constexpr size_t kMaxFreeBlocks = 2;
+
+  std::vector<std::pair<size_t, size_t>>::const_iterator GetChunkForPos(size_t pos) const;
   void AddNewChunk(size_t pos, size_t size);
   void AddNewTimestamp(size_t pos, uint64_t timestamp);
 
@@ -144,27 +173,78 @@ class DataStreamBuffer {
   // Get the end of valid data in the buffer.
   size_t EndPosition();
 
+  // Moves the head of the buffer forward by n bytes, releasing the blocks that fall off.
+  void AdvancePosition(size_t n);
+
+  // Allocates blocks until the buffer covers all positions before end_pos.
+  void ReserveUntil(size_t end_pos);
+
+  // Copies data into the blocks, starting at the logical position pos.
+  void Write(size_t pos, std::string_view data);
+
+  // Copies size bytes at the logical position pos out of the blocks into out.
+  void CopyOut(size_t pos, size_t size, char* out) const;
+  std::string Read(size_t pos, size_t size) const;
+
+  // Returns the index of the block that holds the logical position pos.
+  size_t BlockIndex(size_t pos) const;
+
+  // Returns a view of the size bytes at the logical position pos from the linear buffer, after
+  // copying the bytes it doesn't hold yet into it.
+  std::string_view Linearize(size_t pos, size_t size) const;
+
+  // Drops the linear buffer's copy of any data at or after the logical position pos.
+  void InvalidateLinearFrom(size_t pos);
+
+  // Moves the linear buffer's data before position_ out of the way, once that data is at least as
+  // large as the data after it, so the cost is amortized over the consumed bytes.
+  void CompactLinear();
+
+  std::unique_ptr<char[]> AcquireBlock();
+  void ReleaseBlock(Block* block);
+
   const size_t capacity_;
   const size_t max_gap_size_;
   const size_t allow_before_gap_size_;
+  const size_t block_size_;
 
   // Logical position of data stream buffer.
-  // In other words, the position of buffer_[0].
+  // In other words, the position of the first byte of the buffer.
   size_t position_ = 0;
 
-  // Buffer where all data is stored.
-  // TODO(oazizi): Investigate buffer that is better suited to the rolling buffer (slinky) model.
-  std::string buffer_;
+  // Size of the buffer, from position_ to the end of the last data added.
+  size_t size_ = 0;
+
+  // Blocks where all data is stored. The first block may start before position_, and the last
+  // block may end after position_ + size_.
+  std::deque<Block> blocks_;
+
+  // Released blocks, kept for reuse.
+  std::vector<std::unique_ptr<char[]>> free_blocks_;
+
+  // The linear buffer holds a contiguous copy of the data at
+  // [linear_pos_, linear_pos_ + linear_size_), for requested data that spans blocks.
+  // Get() only ever appends to it, so views into it stay valid until the next non-const call.
+  // Mutable, because Get() fills it in.
+  mutable std::unique_ptr<char[]> linear_;
+  mutable size_t linear_capacity_ = 0;
+  mutable size_t linear_pos_ = 0;
+  mutable size_t linear_size_ = 0;
+  mutable size_t linearized_bytes_ = 0;
+
+  // Linear buffers that Get() outgrew. Views returned earlier may still point into them, so they
+  // are only freed by the next non-const call.
+  mutable std::vector<std::unique_ptr<char[]>> retired_linear_;
 
-  // Map of chunk start positions to chunk sizes.
+  // Chunk start positions and chunk sizes, sorted by position.
   // A chunk is a contiguous sequence of bytes.
   // Adjacent chunks are always fused, so a chunk either ends at a gap or the end of the buffer.
-  std::map<size_t, size_t> chunks_;
+  std::vector<std::pair<size_t, size_t>> chunks_;
 
-  // Map of positions to timestamps.
+  // Positions and timestamps, sorted by position.
   // Unlike chunks_, which will fuse when adjacent, timestamps never fuse.
   // Also, we don't track gaps in the buffer with timestamps; must use chunks_ for that.
-  std::map<size_t, uint64_t> timestamps_;
+  std::vector<std::pair<size_t, uint64_t>> timestamps_;
 };
 
 }  // namespace protocols
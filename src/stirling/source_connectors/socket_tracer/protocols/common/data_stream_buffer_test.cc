@@ -325,6 +325,78 @@ TEST(DataStreamTest, LargeGap) {
   EXPECT_EQ(stream_buffer.Get(100 - kAllowBeforeGapSize), "allow");
 }
 
+TEST(DataStreamTest, DataSpanningBlocks) {
+  const size_t kBlockSize = DataStreamBuffer::kBlockSize;
+  DataStreamBuffer stream_buffer(4 * kBlockSize, 4 * kBlockSize, 4 * kBlockSize);
+
+  // The second event crosses into the second block.
+  const std::string a(kBlockSize - 2, 'a');
+  const std::string b(4, 'b');
+  stream_buffer.Add(0, a, 0);
+  stream_buffer.Add(a.size(), b, 1);
+  EXPECT_EQ(stream_buffer.Head(), a + b);
+  EXPECT_EQ(stream_buffer.Get(a.size() - 1), "a" + b);
+
+  // Keep adding and consuming data, so that the head rolls through many blocks.
+  std::string expected = a + b;
+  size_t pos = expected.size();
+  for (int i = 0; i < 64; ++i) {
+    const std::string data((1000 + i * 797) % 7000 + 1, 'c' + i % 20);
+    stream_buffer.Add(pos, data, pos);
+    pos += data.size();
+    expected += data;
+    ASSERT_EQ(stream_buffer.Head(), expected);
+    ASSERT_OK_AND_EQ(stream_buffer.GetTimestamp(pos - 1), pos - data.size());
+
+    stream_buffer.RemovePrefix(expected.size() / 2);
+    expected.erase(0, expected.size() / 2);
+    ASSERT_EQ(stream_buffer.Head(), expected);
+    ASSERT_EQ(stream_buffer.size(), expected.size());
+  }
+  EXPECT_EQ(stream_buffer.position(), pos - expected.size());
+
+  // Consumed blocks are released, so the buffer doesn't grow with the data that passed through.
+  // The capacity also counts the linear buffer that holds the head when it spans blocks.
+  EXPECT_LE(stream_buffer.capacity(), 6 * kBlockSize);
+
+  stream_buffer.RemovePrefix(expected.size());
+  EXPECT_TRUE(stream_buffer.empty());
+  EXPECT_EQ(stream_buffer.Head(), "");
+}
+
+TEST(DataStreamTest, HeadSpanningBlocksIsLinearizedIncrementally) {
+  const size_t kBlockSize = DataStreamBuffer::kBlockSize;
+  DataStreamBuffer stream_buffer(64 * kBlockSize, 64 * kBlockSize, 64 * kBlockSize);
+
+  // Keep about four blocks of data pending, and get the head twice per event, the way
+  // DataStream::ProcessBytesToFrames() does.
+  constexpr size_t kEventSize = 1000;
+  constexpr size_t kNumEvents = 2000;
+  std::string expected;
+  size_t pos = 0;
+  for (size_t i = 0; i < kNumEvents; ++i) {
+    const std::string data(kEventSize, static_cast<char>('a' + i % 26));
+    stream_buffer.Add(pos, data, pos);
+    pos += data.size();
+    expected += data;
+
+    std::string_view head = stream_buffer.Head();
+    ASSERT_EQ(stream_buffer.Head(), expected);
+    // The second call doesn't invalidate the view returned by the first.
+    ASSERT_EQ(head, expected);
+
+    if (expected.size() > 4 * kBlockSize) {
+      stream_buffer.RemovePrefix(kEventSize);
+      expected.erase(0, kEventSize);
+    }
+  }
+
+  // Each byte is linearized about once, plus the amortized compaction of the linear buffer,
+  // rather than once per call to Head().
+  EXPECT_LE(stream_buffer.linearized_bytes(), 3 * kNumEvents * kEventSize);
+  EXPECT_LE(stream_buffer.capacity(), 16 * kBlockSize);
+}
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
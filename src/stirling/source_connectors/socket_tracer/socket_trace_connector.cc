@@ -22,7 +22,10 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <numeric>
+#include <thread>
 #include <utility>
 
 #include <absl/container/flat_hash_map.h>
@@ -34,6 +37,7 @@
 #include "src/common/base/base.h"
 #include "src/common/base/utils.h"
 #include "src/common/json/json.h"
+#include "src/common/system/config.h"
 #include "src/common/system/socket_info.h"
 #include "src/shared/metadata/metadata.h"
 #include "src/stirling/bpf_tools/macros.h"
@@ -43,6 +47,7 @@
 #include "src/stirling/source_connectors/socket_tracer/proto/sock_event.pb.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/grpc.h"
+#include "src/stirling/utils/linux_headers.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
 // 50 X less often than the normal sampling frequency. Based on the conn_stats_table.h's
@@ -120,6 +125,11 @@ DEFINE_uint64(stirling_socket_tracer_max_total_control_bw, 512 * 1024 * 1024 / 8
 DEFINE_double(stirling_socket_tracer_max_total_bw_overprovision_factor, 1,
               "Factor to overprovision maximum total bandwidth, to account for the fact that "
               "traffic won't be exactly evenly distributed over all cpus.");
+DEFINE_bool(stirling_socket_tracer_use_ringbuf,
+            gflags::BoolFromEnv("PL_STIRLING_SOCKET_TRACER_USE_RINGBUF", false),
+            "If true, data events are sent through a single BPF ring buffer shared by all cpus, "
+            "sized by stirling_socket_tracer_max_total_data_bw, instead of per-cpu perf buffers. "
+            "Requires Linux 5.8+; perf buffers are used on older kernels.");
 
 DEFINE_uint32(messages_expiry_duration_secs, 1 * 60,
               "The duration after which a parsed message is erased.");
@@ -134,6 +144,11 @@ DEFINE_uint32(
 DEFINE_uint32(datastream_buffer_retention_size,
               gflags::Uint32FromEnv("PL_DATASTREAM_BUFFER_SIZE", 1024 * 1024),
               "The maximum size of a data stream buffer retained between cycles.");
+DEFINE_uint32(stirling_socket_tracer_transfer_threads,
+              gflags::Uint32FromEnv("PL_STIRLING_SOCKET_TRACER_TRANSFER_THREADS", 4),
+              "The maximum number of threads that parse and stitch the data of connection "
+              "trackers each iteration. Each thread processes at least 1024 trackers, so hosts "
+              "with few connections keep using a single thread.");
 
 BPF_SRC_STRVIEW(socket_trace_bcc_script, socket_trace);
 
@@ -313,6 +328,37 @@ void ResizePerfBufferSpecs(std::array<bpf_tools::PerfBufferSpec, N>* perf_buffer
 }
 }  // namespace
 
+namespace {
+
+bool KernelSupportsRingBuffers() {
+  // BPF ring buffers were introduced in Linux 5.8.
+  constexpr uint32_t kMinRingBufferKernelCode = (5 << 16) | (8 << 8);
+
+  StatusOr<utils::KernelVersion> kernel_version_or = utils::GetKernelVersion();
+  if (!kernel_version_or.ok()) {
+    LOG(WARNING) << absl::Substitute("Could not determine the kernel version. Message: $0",
+                                     kernel_version_or.msg());
+    return false;
+  }
+  utils::KernelVersion kernel_version = kernel_version_or.ConsumeValueOrDie();
+  return kernel_version.code() >= kMinRingBufferKernelCode;
+}
+
+}  // namespace
+
+int SocketTraceConnector::SocketDataRingBufferPages() {
+  // The ring buffer is shared by all cpus, so unlike the per-cpu perf buffers, it needs no
+  // overprovisioning for traffic that is unevenly distributed over the cpus.
+  const double kSecondsPerPeriod =
+      std::chrono::duration_cast<std::chrono::milliseconds>(kSamplingPeriod).count() / 1000.0;
+  const int64_t kRingBufferSize =
+      static_cast<int64_t>(FLAGS_stirling_socket_tracer_max_total_data_bw * kSecondsPerPeriod);
+  const int64_t kPageSizeBytes = system::Config::GetInstance().PageSize();
+
+  // Ring buffers must be sized to a power of 2 number of pages.
+  return static_cast<int>(IntRoundUpToPow2(IntRoundUpDivide(kRingBufferSize, kPageSizeBytes)));
+}
+
 auto SocketTraceConnector::InitPerfBufferSpecs() {
   const size_t ncpus = get_nprocs_conf();
 
@@ -372,6 +418,16 @@ Status SocketTraceConnector::InitBPF() {
       absl::StrCat("-DENABLE_MUX_TRACING=", FLAGS_stirling_enable_mux_tracing),
       absl::StrCat("-DENABLE_MONGO_TRACING=", "true"),
   };
+
+  use_socket_data_ringbuf_ =
+      FLAGS_stirling_socket_tracer_use_ringbuf && KernelSupportsRingBuffers();
+  LOG_IF(WARNING, FLAGS_stirling_socket_tracer_use_ringbuf && !use_socket_data_ringbuf_)
+      << "BPF ring buffers require Linux 5.8+, falling back to perf buffers for data events.";
+  defines.push_back(absl::StrCat("-DUSE_SOCKET_DATA_RINGBUF=", use_socket_data_ringbuf_));
+  if (use_socket_data_ringbuf_) {
+    defines.push_back(absl::StrCat("-DSOCKET_DATA_RINGBUF_PAGES=", SocketDataRingBufferPages()));
+  }
+
   PL_RETURN_IF_ERROR(InitBPFProgram(socket_trace_bcc_script, defines));
 
   PL_RETURN_IF_ERROR(AttachKProbes(kProbeSpecs));
@@ -379,7 +435,13 @@ Status SocketTraceConnector::InitBPF() {
   LOG(INFO) << "Probes successfully deployed.";
 
   const auto kPerfBufferSpecs = InitPerfBufferSpecs();
-  PL_RETURN_IF_ERROR(OpenPerfBuffers(kPerfBufferSpecs, this));
+  for (const auto& spec : kPerfBufferSpecs) {
+    if (use_socket_data_ringbuf_ && spec.name == kSocketDataEventsName) {
+      PL_RETURN_IF_ERROR(OpenRingBuffer(spec, this));
+    } else {
+      PL_RETURN_IF_ERROR(OpenPerfBuffer(spec, this));
+    }
+  }
   LOG(INFO) << absl::Substitute("Number of perf buffers opened = $0", kPerfBufferSpecs.size());
 
   // Set trace role to BPF probes.
@@ -535,6 +597,9 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   // No data is lost, but this is a side-effect of sorts that affects timing of transfers.
   // It may be worth noting during debug.
   PollPerfBuffers();
+  if (use_socket_data_ringbuf_) {
+    UpdateSocketDataRingBufferLoss();
+  }
 
   // Set-up current state for connection inference purposes.
   if (socket_info_mgr_ != nullptr) {
@@ -610,17 +675,17 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx,
     }
   }
 
+  // The pre-tick uses the proc parser and the socket info manager, which are shared by all
+  // trackers, so it runs on this thread. Parsing and stitching are independent per tracker.
   for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
-    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
-    DataTable* data_table = data_tables[transfer_spec.table_num];
-
     UpdateTrackerTraceLevel(conn_tracker);
-
     conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
                                    socket_info_mgr_.get());
-    if (transfer_spec.enabled && transfer_spec.transfer_fn && data_table != nullptr) {
-      transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
-    }
+  }
+
+  TransferStreams(ctx, data_tables);
+
+  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
     conn_tracker->IterationPostTick();
   }
 
@@ -628,6 +693,76 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx,
   pids_to_trace_disable_.clear();
 }
 
+namespace {
+
+// Below this many trackers per thread, the cost of the threads outweighs the parallelism.
+constexpr size_t kMinTrackersPerTransferThread = 1024;
+
+}  // namespace
+
+void SocketTraceConnector::TransferStreams(ConnectorContext* ctx,
+                                           const std::vector<ConnTracker*>& trackers,
+                                           const std::vector<DataTable*>& data_tables) {
+  for (ConnTracker* conn_tracker : trackers) {
+    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
+    DataTable* data_table = data_tables[transfer_spec.table_num];
+    if (transfer_spec.enabled && transfer_spec.transfer_fn && data_table != nullptr) {
+      transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
+    }
+  }
+}
+
+void SocketTraceConnector::TransferStreams(ConnectorContext* ctx,
+                                           const std::vector<DataTable*>& data_tables) {
+  const auto& active_trackers = conn_trackers_mgr_.active_trackers();
+  size_t num_threads =
+      std::min<size_t>(FLAGS_stirling_socket_tracer_transfer_threads,
+                       active_trackers.size() / kMinTrackersPerTransferThread);
+  if (num_threads <= 1) {
+    TransferStreams(ctx, {active_trackers.begin(), active_trackers.end()}, data_tables);
+    return;
+  }
+
+  // Trackers are sharded by connection, and each shard is transferred into its own staging
+  // tables, since DataTable isn't thread-safe. The staged records are merged into the output
+  // tables afterwards; ConsumeRecords() sorts them by time, so the merge order doesn't matter.
+  std::vector<std::vector<ConnTracker*>> shards =
+      conn_trackers_mgr_.ShardActiveTrackers(num_threads);
+  std::vector<std::vector<std::unique_ptr<DataTable>>> staging_tables(num_threads);
+  std::vector<std::vector<DataTable*>> staging_table_ptrs(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    for (DataTable* data_table : data_tables) {
+      if (data_table == nullptr) {
+        staging_tables[i].push_back(nullptr);
+      } else {
+        staging_tables[i].push_back(
+            std::make_unique<DataTable>(data_table->id(), data_table->table_schema()));
+      }
+      staging_table_ptrs[i].push_back(staging_tables[i].back().get());
+    }
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back([this, ctx, &shards, &staging_table_ptrs, i]() {
+      TransferStreams(ctx, shards[i], staging_table_ptrs[i]);
+    });
+  }
+  TransferStreams(ctx, shards[0], staging_table_ptrs[0]);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < num_threads; ++i) {
+    for (size_t table_num = 0; table_num < data_tables.size(); ++table_num) {
+      if (data_tables[table_num] != nullptr) {
+        data_tables[table_num]->MoveRecordsFrom(staging_tables[i][table_num].get());
+      }
+    }
+  }
+}
+
 template <typename TValueType>
 Status UpdatePerCPUArrayValue(int idx, TValueType val, ebpf::BPFPercpuArrayTable<TValueType>* arr) {
   std::vector<TValueType> values(bpf_tools::BCCWrapper::kCPUCount, val);
@@ -666,6 +801,21 @@ Status SocketTraceConnector::DisableSelfTracing() {
 // Perf Buffer Polling and Callback functions.
 //-----------------------------------------------------------------------------
 
+void SocketTraceConnector::UpdateSocketDataRingBufferLoss() {
+  // The BPF code only ever increments the per-cpu counters, so the loss is the growth of their sum.
+  auto lost_handle = GetPerCPUArrayTable<uint64_t>(kSocketDataEventsLostName);
+  std::vector<uint64_t> lost_percpu;
+  auto res = lost_handle.get_value(0, lost_percpu);
+  if (!res.ok()) {
+    LOG_FIRST_N(ERROR, 10) << absl::Substitute("Failed to read $0, error message: $1",
+                                               kSocketDataEventsLostName, res.msg());
+    return;
+  }
+  uint64_t lost = std::accumulate(lost_percpu.begin(), lost_percpu.end(), uint64_t{0});
+  HandleDataEventLoss(this, lost - socket_data_ringbuf_lost_);
+  socket_data_ringbuf_lost_ = lost;
+}
+
 void SocketTraceConnector::HandleDataEvent(void* cb_cookie, void* data, int /*data_size*/) {
   DCHECK(cb_cookie != nullptr) << "Perf buffer callback not set-up properly. Missing cb_cookie.";
   auto* connector = static_cast<SocketTraceConnector*>(cb_cookie);
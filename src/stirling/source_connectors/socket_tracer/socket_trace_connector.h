@@ -68,6 +68,7 @@ DECLARE_uint32(stirling_socket_tracer_target_control_bw_percpu);
 DECLARE_uint32(messages_expiry_duration_secs);
 DECLARE_uint32(messages_size_limit_bytes);
 DECLARE_uint32(datastream_buffer_expiry_duration_secs);
+DECLARE_uint32(stirling_socket_tracer_transfer_threads);
 DECLARE_uint32(datastream_buffer_retention_size);
 
 namespace px {
@@ -159,10 +160,15 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   Status InitBPF();
   auto InitPerfBufferSpecs();
+  // The number of pages of the ring buffer of data events, when it replaces the perf buffers.
+  static int SocketDataRingBufferPages();
   void InitProtocolTransferSpecs();
 
   ConnTracker& GetOrCreateConnTracker(struct conn_id_t conn_id);
 
+  // Ring buffers don't report lost events like perf buffers, so the BPF code counts them instead.
+  void UpdateSocketDataRingBufferLoss();
+
   // Events from BPF.
   void AcceptDataEvent(std::unique_ptr<SocketDataEvent> event);
   void AcceptControlEvent(socket_control_event_t event);
@@ -171,7 +177,11 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   void AcceptHTTP2Data(std::unique_ptr<HTTP2DataEvent> event);
 
   // Transfer of messages to the data table.
-  void TransferStreams(ConnectorContext* ctx, uint32_t table_num, DataTable* data_table);
+  // Parses and stitches the data of the active trackers into the data tables, using up to
+  // FLAGS_stirling_socket_tracer_transfer_threads threads.
+  void TransferStreams(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables);
+  void TransferStreams(ConnectorContext* ctx, const std::vector<ConnTracker*>& trackers,
+                       const std::vector<DataTable*>& data_tables);
   void TransferConnStats(ConnectorContext* ctx, DataTable* data_table);
 
   template <typename TProtocolTraits>
@@ -228,6 +238,11 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   //   Example: data_table->SetConsumeRecordsCutoffTime(perf_buffer_drain_time_);
   uint64_t perf_buffer_drain_time_ = 0;
 
+  // Whether data events are sent through a BPF ring buffer instead of perf buffers,
+  // and the total number of events that didn't fit into it so far.
+  bool use_socket_data_ringbuf_ = false;
+  uint64_t socket_data_ringbuf_lost_ = 0;
+
   // If not a nullptr, writes the events received from perf buffers to this stream.
   std::unique_ptr<std::ofstream> perf_buffer_events_output_stream_;
   enum class OutputFormat {
@@ -18,6 +18,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <numeric>
 #include <vector>
 
 namespace px {
@@ -45,6 +48,23 @@ std::vector<size_t> SortedIndexes(const std::vector<T>& v) {
   return idx;
 }
 
+// Same as SortedIndexes() above, for a vector whose first sorted_prefix_size elements are known to
+// be sorted already. Only the remaining elements are sorted, and then merged with the prefix,
+// which takes O(n + k*log(k)) for k remaining elements, rather than O(n*log(n)).
+template <typename T>
+std::vector<size_t> SortedIndexes(const std::vector<T>& v, size_t sorted_prefix_size) {
+  std::vector<size_t> idx(v.size());
+  std::iota(idx.begin(), idx.end(), 0);
+
+  auto cmp = [&v](size_t i1, size_t i2) { return v[i1] < v[i2]; };
+  auto mid = idx.begin() + std::min(sorted_prefix_size, idx.size());
+  std::stable_sort(mid, idx.end(), cmp);
+  // The merge is stable too, so the result is the same as that of SortedIndexes(v).
+  std::inplace_merge(idx.begin(), mid, idx.end(), cmp);
+
+  return idx;
+}
+
 // An iterator that walks over a vector according to provided indexes.
 // Used in conjunction with SortedIndexes to iterate through an unsorted vector in sorted order.
 template <typename T>
@@ -33,6 +33,15 @@ TEST(SortedIndexes, Basic) {
   EXPECT_EQ(sort_indexes, (std::vector<size_t>{1, 0, 2, 5, 4, 3}));
 }
 
+TEST(SortedIndexes, SortedPrefix) {
+  std::vector<int> data = {0, 2, 2, 5, 9, 4, 2, 10, 1};
+
+  EXPECT_EQ(SortedIndexes(data, 5), (std::vector<size_t>{0, 8, 1, 2, 6, 5, 3, 4, 7}));
+  EXPECT_EQ(SortedIndexes(data, 5), SortedIndexes(data));
+  EXPECT_EQ(SortedIndexes(data, 0), SortedIndexes(data));
+  EXPECT_EQ(SortedIndexes(std::vector<int>{}, 0), std::vector<size_t>{});
+}
+
 TEST(SplitSortedVector, Basic) {
   // Corresponds to {0, 2, 4, 6, 8, 10} after applying sort_indexes
   std::vector<int> data = {2, 0, 4, 10, 8, 6};
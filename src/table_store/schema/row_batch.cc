@@ -17,12 +17,15 @@
  */
 
 #include <arrow/array.h>
+#include <arrow/buffer.h>
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include <absl/strings/str_format.h>
+#include <absl/strings/str_join.h>
 #include "src/common/base/base.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
@@ -58,6 +61,9 @@ std::string RowBatch::DebugString() const {
     return "RowBatch: <empty>";
   }
   std::string debug_string = absl::StrFormat("RowBatch(eow=%d, eos=%d):\n", eow_, eos_);
+  if (has_selection_) {
+    debug_string += absl::StrFormat("  selection: [%s]\n", absl::StrJoin(selection_, ", "));
+  }
   for (const auto& col : columns_) {
     debug_string += absl::StrFormat("  %s\n", col->ToString());
   }
@@ -159,6 +165,10 @@ Status CopyFromInputPB(std::shared_ptr<arrow::Array>* output_column,
 }
 
 Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
+  if (has_selection_) {
+    PL_ASSIGN_OR_RETURN(auto dense_rb, MaterializeSelection());
+    return dense_rb->ToProto(proto);
+  }
   proto->set_num_rows(num_rows_);
   proto->set_eow(eow_);
   proto->set_eos(eos_);
@@ -223,6 +233,235 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProto(
   return output_rb;
 }
 
+namespace {
+
+// Each buffer in FlatRowBatchData starts at a multiple of this, so that the arrays that point into
+// the data are aligned.
+constexpr int64_t kFlatBufferAlignment = 8;
+
+int64_t AlignFlatBufferSize(int64_t size) {
+  return (size + kFlatBufferAlignment - 1) / kFlatBufferAlignment * kFlatBufferAlignment;
+}
+
+// The width in bytes of the values of a fixed width type, or 0 for the other types.
+// PL_CARNOT_UPDATE_FOR_NEW_TYPES
+int64_t FixedValueWidth(DataType data_type) {
+  switch (data_type) {
+    case DataType::INT64:
+      return sizeof(types::DataTypeTraits<DataType::INT64>::native_type);
+    case DataType::UINT128:
+      return sizeof(types::DataTypeTraits<DataType::UINT128>::native_type);
+    case DataType::TIME64NS:
+      return sizeof(types::DataTypeTraits<DataType::TIME64NS>::native_type);
+    case DataType::FLOAT64:
+      return sizeof(types::DataTypeTraits<DataType::FLOAT64>::native_type);
+    default:
+      return 0;
+  }
+}
+
+// The sizes of the flat buffers of a column.
+std::vector<int64_t> FlatBufferSizes(DataType data_type, const arrow::Array* arr) {
+  if (data_type == DataType::BOOLEAN) {
+    return {(arr->length() + 7) / 8};
+  }
+  if (data_type == DataType::STRING) {
+    const auto* str_arr = static_cast<const arrow::StringArray*>(arr);
+    int64_t num_chars = arr->length() == 0
+                            ? 0
+                            : str_arr->value_offset(arr->length()) - str_arr->value_offset(0);
+    return {static_cast<int64_t>((arr->length() + 1) * sizeof(int32_t)), num_chars};
+  }
+  return {arr->length() * FixedValueWidth(data_type)};
+}
+
+// Copies the buffers of a column into dst, with the given sizes and offsets.
+void CopyFlatBuffers(DataType data_type, const arrow::Array* arr,
+                     const std::vector<int64_t>& offsets, uint8_t* dst) {
+  if (data_type == DataType::BOOLEAN) {
+    // The bitmap of a sliced array may not start on a byte boundary, so copy it bit by bit.
+    const auto* bool_arr = static_cast<const arrow::BooleanArray*>(arr);
+    uint8_t* bitmap = dst + offsets[0];
+    for (int64_t i = 0; i < arr->length(); ++i) {
+      if (bool_arr->Value(i)) {
+        bitmap[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+      }
+    }
+    return;
+  }
+  if (data_type == DataType::STRING) {
+    const auto* str_arr = static_cast<const arrow::StringArray*>(arr);
+    auto* value_offsets = reinterpret_cast<int32_t*>(dst + offsets[0]);
+    if (arr->length() == 0) {
+      value_offsets[0] = 0;
+      return;
+    }
+    int32_t first = str_arr->value_offset(0);
+    for (int64_t i = 0; i <= arr->length(); ++i) {
+      value_offsets[i] = str_arr->value_offset(i) - first;
+    }
+    int32_t num_chars = str_arr->value_offset(arr->length()) - first;
+    if (num_chars > 0) {
+      std::memcpy(dst + offsets[1], str_arr->value_data()->data() + first, num_chars);
+    }
+    return;
+  }
+  int64_t width = FixedValueWidth(data_type);
+  if (arr->length() > 0) {
+    std::memcpy(dst + offsets[0], arr->data()->buffers[1]->data() + arr->offset() * width,
+                arr->length() * width);
+  }
+}
+
+// An arrow::Buffer that points into a string and keeps the string alive.
+class StringBuffer : public arrow::Buffer {
+ public:
+  explicit StringBuffer(std::shared_ptr<std::string> str)
+      : arrow::Buffer(reinterpret_cast<const uint8_t*>(str->data()),
+                      static_cast<int64_t>(str->size())),
+        str_(std::move(str)) {}
+
+ private:
+  std::shared_ptr<std::string> str_;
+};
+
+template <DataType TDataType>
+std::shared_ptr<arrow::Array> MakeFixedWidthArray(int64_t length,
+                                                  const std::shared_ptr<arrow::Buffer>& values) {
+  return std::make_shared<typename types::DataTypeTraits<TDataType>::arrow_array_type>(length,
+                                                                                       values);
+}
+
+// PL_CARNOT_UPDATE_FOR_NEW_TYPES
+StatusOr<std::shared_ptr<arrow::Array>> MakeFlatArray(
+    DataType data_type, int64_t length, const std::vector<std::shared_ptr<arrow::Buffer>>& bufs) {
+  switch (data_type) {
+    case DataType::BOOLEAN:
+      return std::shared_ptr<arrow::Array>(std::make_shared<arrow::BooleanArray>(length, bufs[0]));
+    case DataType::INT64:
+      return MakeFixedWidthArray<DataType::INT64>(length, bufs[0]);
+    case DataType::UINT128:
+      return MakeFixedWidthArray<DataType::UINT128>(length, bufs[0]);
+    case DataType::TIME64NS:
+      return MakeFixedWidthArray<DataType::TIME64NS>(length, bufs[0]);
+    case DataType::FLOAT64:
+      return MakeFixedWidthArray<DataType::FLOAT64>(length, bufs[0]);
+    case DataType::STRING: {
+      // Make sure that every string lies within the characters buffer.
+      const auto* value_offsets = reinterpret_cast<const int32_t*>(bufs[0]->data());
+      if (value_offsets[0] != 0) {
+        return error::InvalidArgument("STRING column value offsets must start at 0");
+      }
+      for (int64_t i = 0; i < length; ++i) {
+        if (value_offsets[i + 1] < value_offsets[i]) {
+          return error::InvalidArgument("STRING column value offsets must be increasing");
+        }
+      }
+      if (value_offsets[length] != bufs[1]->size()) {
+        return error::InvalidArgument("STRING column has $0 characters, expected $1",
+                                      bufs[1]->size(), value_offsets[length]);
+      }
+      return std::shared_ptr<arrow::Array>(
+          std::make_shared<arrow::StringArray>(length, bufs[0], bufs[1]));
+    }
+    default:
+      return error::InvalidArgument("Unsupported data type $0 in FlatRowBatchData",
+                                    types::ToString(data_type));
+  }
+}
+
+}  // namespace
+
+Status RowBatch::ToFlatProto(table_store::schemapb::FlatRowBatchData* proto) const {
+  if (has_selection_) {
+    PL_ASSIGN_OR_RETURN(auto dense_rb, MaterializeSelection());
+    return dense_rb->ToFlatProto(proto);
+  }
+  proto->set_num_rows(num_rows_);
+  proto->set_eow(eow_);
+  proto->set_eos(eos_);
+
+  // Lay out all of the buffers first, so that the data is allocated once.
+  std::vector<std::vector<int64_t>> col_offsets(num_columns());
+  int64_t data_size = 0;
+  for (auto col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    auto dt = desc_.type(col_idx);
+    proto->add_col_types(dt);
+    for (int64_t size : FlatBufferSizes(dt, ColumnAt(col_idx).get())) {
+      col_offsets[col_idx].push_back(data_size);
+      proto->add_buffer_offsets(data_size);
+      data_size += AlignFlatBufferSize(size);
+    }
+  }
+
+  auto data = proto->mutable_data();
+  // The padding and the BOOLEAN bitmaps rely on the data being zeroed.
+  data->assign(data_size, '\0');
+  auto dst = reinterpret_cast<uint8_t*>(data->data());
+  for (auto col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    CopyFlatBuffers(desc_.type(col_idx), ColumnAt(col_idx).get(), col_offsets[col_idx], dst);
+  }
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromFlatProto(
+    table_store::schemapb::FlatRowBatchData* proto) {
+  auto data = std::make_shared<std::string>();
+  data->swap(*proto->mutable_data());
+  auto data_buffer = std::make_shared<StringBuffer>(data);
+  int64_t num_rows = proto->num_rows();
+  if (num_rows < 0) {
+    return error::InvalidArgument("FlatRowBatchData has a negative number of rows");
+  }
+
+  std::vector<DataType> col_types;
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  int buffer_idx = 0;
+  for (auto col_idx = 0; col_idx < proto->col_types_size(); ++col_idx) {
+    auto dt = static_cast<DataType>(proto->col_types(col_idx));
+    int64_t width = FixedValueWidth(dt);
+    std::vector<int64_t> sizes;
+    if (dt == DataType::BOOLEAN) {
+      sizes = {(num_rows + 7) / 8};
+    } else if (dt == DataType::STRING) {
+      // The size of the characters buffer is only known once the offsets are read.
+      sizes = {static_cast<int64_t>((num_rows + 1) * sizeof(int32_t)), -1};
+    } else if (width > 0) {
+      sizes = {num_rows * width};
+    } else {
+      return error::InvalidArgument("Unsupported data type $0 in FlatRowBatchData",
+                                    types::ToString(dt));
+    }
+
+    std::vector<std::shared_ptr<arrow::Buffer>> bufs;
+    for (int64_t size : sizes) {
+      if (buffer_idx >= proto->buffer_offsets_size()) {
+        return error::InvalidArgument("FlatRowBatchData is missing buffers for column $0", col_idx);
+      }
+      int64_t offset = proto->buffer_offsets(buffer_idx++);
+      if (size == -1) {
+        size = reinterpret_cast<const int32_t*>(bufs[0]->data())[num_rows];
+      }
+      if (offset < 0 || size < 0 || offset + size > static_cast<int64_t>(data->size())) {
+        return error::InvalidArgument("Buffer of column $0 is out of bounds of FlatRowBatchData",
+                                      col_idx);
+      }
+      bufs.push_back(arrow::SliceBuffer(data_buffer, offset, size));
+    }
+    PL_ASSIGN_OR_RETURN(auto column, MakeFlatArray(dt, num_rows, bufs));
+    col_types.push_back(dt);
+    columns.push_back(std::move(column));
+  }
+
+  auto output_rb = std::make_unique<RowBatch>(RowDescriptor(col_types), num_rows);
+  output_rb->set_eow(proto->eow());
+  output_rb->set_eos(proto->eos());
+  for (const auto& column : columns) {
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(column));
+  }
+  return output_rb;
+}
+
 StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromColumnBuilders(
     const RowDescriptor& desc, bool eow, bool eos,
     std::vector<std::unique_ptr<arrow::ArrayBuilder>>* builders) {
@@ -265,6 +504,49 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::Slice(int64_t offset, int64_t leng
   return output_rb;
 }
 
+template <DataType T>
+Status GatherValues(const arrow::Array* input_col, const std::vector<int64_t>& selection,
+                    arrow::ArrayBuilder* output_col_builder) {
+  auto* typed_col_builder =
+      static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(output_col_builder);
+  PL_RETURN_IF_ERROR(typed_col_builder->Reserve(selection.size()));
+  if constexpr (T == DataType::STRING) {
+    // Size the data buffer up front so that the copy below never has to grow it.
+    int64_t total_size = 0;
+    for (int64_t idx : selection) {
+      total_size += static_cast<const arrow::StringArray*>(input_col)->value_length(idx);
+    }
+    PL_RETURN_IF_ERROR(typed_col_builder->ReserveData(total_size));
+  }
+  for (int64_t idx : selection) {
+    typed_col_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, idx));
+  }
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::MaterializeSelection() const {
+  auto output_rb = std::make_unique<RowBatch>(desc(), num_selected_rows());
+  output_rb->set_eow(eow());
+  output_rb->set_eos(eos());
+  for (int64_t col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    auto col = ColumnAt(col_idx);
+    if (!has_selection_) {
+      PL_RETURN_IF_ERROR(output_rb->AddColumn(col));
+      continue;
+    }
+    auto dt = desc_.type(col_idx);
+    auto builder = types::MakeArrowBuilder(dt, arrow::default_memory_pool());
+#define TYPE_CASE(_dt_) \
+  PL_RETURN_IF_ERROR(GatherValues<_dt_>(col.get(), selection_, builder.get()));
+    PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+    std::shared_ptr<arrow::Array> output_array;
+    PL_RETURN_IF_ERROR(builder->Finish(&output_array));
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
+  }
+  return output_rb;
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
@@ -36,6 +36,11 @@ namespace schema {
 /**
  * A RowBatch is a table-like structure which consists of equal-length arrays
  * that match the schema described by the RowDescriptor.
+ *
+ * A RowBatch may optionally carry a selection vector, which lists the (sorted) indices of the rows
+ * in the underlying arrays that are logically part of the batch. This lets operators such as
+ * filters narrow down a batch without copying any column data. Consumers that don't understand
+ * selection vectors should call MaterializeSelection() to get a dense copy.
  */
 class RowBatch {
  public:
@@ -53,6 +58,18 @@ class RowBatch {
   static StatusOr<std::unique_ptr<RowBatch>> FromProto(
       const table_store::schemapb::RowBatchData& row_batch_proto);
 
+  /**
+   * Serializes the row batch into the flat columnar encoding described by FlatRowBatchData, which
+   * copies each column as a whole instead of value by value.
+   */
+  Status ToFlatProto(table_store::schemapb::FlatRowBatchData* row_batch_proto) const;
+  /**
+   * Deserializes a row batch from the flat columnar encoding. The arrays of the row batch point
+   * into the proto's data instead of copying it, so the data is moved out of the proto.
+   */
+  static StatusOr<std::unique_ptr<RowBatch>> FromFlatProto(
+      table_store::schemapb::FlatRowBatchData* row_batch_proto);
+
   static StatusOr<std::unique_ptr<RowBatch>> FromColumnBuilders(
       const RowDescriptor& desc, bool eow, bool eos,
       std::vector<std::unique_ptr<arrow::ArrayBuilder>>* builders);
@@ -76,6 +93,16 @@ class RowBatch {
    */
   StatusOr<std::unique_ptr<RowBatch>> Slice(int64_t offset, int64_t length) const;
 
+  /**
+   * @brief Returns a dense copy of this RowBatch which only contains the selected rows.
+   *
+   * If the RowBatch has no selection vector, the columns are shared rather than copied. The
+   * eow and eos flags are carried over to the new RowBatch.
+   *
+   * @return StatusOr<std::unique_ptr<RowBatch>>
+   */
+  StatusOr<std::unique_ptr<RowBatch>> MaterializeSelection() const;
+
   /**
    * Adds the given column to the row batch, given that it correctly fits the schema.
    * param col ptr to the arrow array that should be added to the row batch.
@@ -99,6 +126,32 @@ class RowBatch {
    */
   int64_t num_rows() const { return num_rows_; }
 
+  /**
+   * @ return whether a selection vector is set on this row batch.
+   */
+  bool has_selection() const { return has_selection_; }
+
+  /**
+   * @ return the indices of the selected rows. Only valid if has_selection() is true.
+   */
+  const std::vector<int64_t>& selection() const { return selection_; }
+
+  /**
+   * Sets the selection vector. The indices must be sorted and less than num_rows().
+   */
+  void set_selection(std::vector<int64_t> selection) {
+    selection_ = std::move(selection);
+    has_selection_ = true;
+  }
+
+  /**
+   * @ return the number of rows that are logically in the row batch, taking the selection vector
+   * into account.
+   */
+  int64_t num_selected_rows() const {
+    return has_selection_ ? static_cast<int64_t>(selection_.size()) : num_rows_;
+  }
+
   /**
    * @ return the number of columns which the row batch should contain.
    */
@@ -125,6 +178,8 @@ class RowBatch {
   int64_t num_rows_;
   bool eow_ = false;
   bool eos_ = false;
+  bool has_selection_ = false;
+  std::vector<int64_t> selection_;
   std::vector<std::shared_ptr<arrow::Array>> columns_;
 };
 
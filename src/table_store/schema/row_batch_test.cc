@@ -179,6 +179,55 @@ TEST_F(RowBatchTest, to_from_proto) {
   EXPECT_TRUE(differ.Compare(input_proto, output_proto));
 }
 
+TEST_F(RowBatchTest, to_from_flat_proto) {
+  table_store::schemapb::RowBatchData input_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kTestRowBatchProto, &input_proto));
+  auto rb = RowBatch::FromProto(input_proto).ConsumeValueOrDie();
+
+  table_store::schemapb::FlatRowBatchData flat_proto;
+  EXPECT_OK(rb->ToFlatProto(&flat_proto));
+  EXPECT_EQ(3, flat_proto.num_rows());
+  EXPECT_EQ(3, flat_proto.col_types_size());
+  // The STRING column has two buffers.
+  EXPECT_EQ(4, flat_proto.buffer_offsets_size());
+
+  ASSERT_OK_AND_ASSIGN(auto flat_rb, RowBatch::FromFlatProto(&flat_proto));
+  EXPECT_TRUE(flat_rb->eow());
+  EXPECT_FALSE(flat_rb->eos());
+  EXPECT_EQ(rb->desc(), flat_rb->desc());
+  // The data is moved into the row batch.
+  EXPECT_TRUE(flat_proto.data().empty());
+
+  table_store::schemapb::RowBatchData output_proto;
+  EXPECT_OK(flat_rb->ToProto(&output_proto));
+  google::protobuf::util::MessageDifferencer differ;
+  EXPECT_TRUE(differ.Compare(input_proto, output_proto));
+}
+
+TEST_F(RowBatchTest, to_from_flat_proto_sliced) {
+  // The sliced BOOLEAN bitmap doesn't start on a byte boundary.
+  ASSERT_OK_AND_ASSIGN(auto sliced_rb, rb_->Slice(1, 2));
+  table_store::schemapb::FlatRowBatchData flat_proto;
+  EXPECT_OK(sliced_rb->ToFlatProto(&flat_proto));
+  ASSERT_OK_AND_ASSIGN(auto flat_rb, RowBatch::FromFlatProto(&flat_proto));
+  EXPECT_EQ(sliced_rb->DebugString(), flat_rb->DebugString());
+
+  // Only the selected rows are sent.
+  rb_->set_selection({0, 2});
+  flat_proto.Clear();
+  EXPECT_OK(rb_->ToFlatProto(&flat_proto));
+  ASSERT_OK_AND_ASSIGN(flat_rb, RowBatch::FromFlatProto(&flat_proto));
+  ASSERT_OK_AND_ASSIGN(auto dense_rb, rb_->MaterializeSelection());
+  EXPECT_EQ(dense_rb->DebugString(), flat_rb->DebugString());
+}
+
+TEST_F(RowBatchTest, from_flat_proto_out_of_bounds) {
+  table_store::schemapb::FlatRowBatchData flat_proto;
+  EXPECT_OK(rb_->ToFlatProto(&flat_proto));
+  flat_proto.set_num_rows(1000);
+  EXPECT_NOT_OK(RowBatch::FromFlatProto(&flat_proto));
+}
+
 TEST_F(RowBatchTest, with_zero_rows) {
   bool eow = true;
   bool eos = false;
@@ -231,6 +280,37 @@ TEST_F(RowBatchTest, slice) {
   ASSERT_EQ(status2.msg(), "Slice(offset=-1, length=3) on rowbatch of length 3 is invalid");
 }
 
+TEST_F(RowBatchTest, materialize_selection) {
+  EXPECT_FALSE(rb_->has_selection());
+  EXPECT_EQ(3, rb_->num_selected_rows());
+
+  rb_->set_selection({0, 2});
+  rb_->set_eow(true);
+  EXPECT_TRUE(rb_->has_selection());
+  EXPECT_EQ(3, rb_->num_rows());
+  EXPECT_EQ(2, rb_->num_selected_rows());
+
+  ASSERT_OK_AND_ASSIGN(auto dense_rb, rb_->MaterializeSelection());
+  EXPECT_FALSE(dense_rb->has_selection());
+  EXPECT_EQ(2, dense_rb->num_rows());
+  EXPECT_TRUE(dense_rb->eow());
+  EXPECT_FALSE(dense_rb->eos());
+  EXPECT_EQ(
+      "RowBatch(eow=1, eos=0):\n  [\n  true,\n  true\n]\n  [\n  3,\n  5\n]\n  [\n  3.3,\n  "
+      "5.6\n]\n",
+      dense_rb->DebugString());
+
+  // Serializing a batch with a selection only sends the selected rows.
+  table_store::schemapb::RowBatchData rb_data_pb;
+  EXPECT_OK(rb_->ToProto(&rb_data_pb));
+  EXPECT_EQ(2, rb_data_pb.num_rows());
+
+  rb_->set_selection({});
+  ASSERT_OK_AND_ASSIGN(auto empty_rb, rb_->MaterializeSelection());
+  EXPECT_EQ(0, empty_rb->num_rows());
+  EXPECT_EQ(3, empty_rb->num_columns());
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
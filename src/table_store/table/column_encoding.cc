@@ -0,0 +1,586 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/column_encoding.h"
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <string_view>
+
+#include "src/common/zlib/zlib_wrapper.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+// The sampler reads kNumSampleRuns runs of kSampleRunLength consecutive rows, spread evenly over
+// the column. It needs runs rather than single rows to estimate the delta of delta encoding.
+constexpr int64_t kNumSampleRuns = 32;
+constexpr int64_t kSampleRunLength = 32;
+// Columns shorter than this are kept as is, since the savings wouldn't be worth the decode cost.
+constexpr int64_t kMinEncodedLength = 64;
+
+template <typename TFunc>
+void ForEachSampleRun(int64_t length, TFunc func) {
+  if (length <= kNumSampleRuns * kSampleRunLength) {
+    func(0, length);
+    return;
+  }
+  int64_t stride = length / kNumSampleRuns;
+  for (int64_t run = 0; run < kNumSampleRuns; ++run) {
+    func(run * stride, run * stride + kSampleRunLength);
+  }
+}
+
+int BitWidth(uint64_t max_value) { return max_value == 0 ? 0 : 64 - __builtin_clzll(max_value); }
+
+int64_t NumPackedWords(int64_t length, int bit_width) { return (length * bit_width + 63) / 64; }
+
+void PackBits(uint64_t value, int64_t idx, int bit_width, std::vector<uint64_t>* packed) {
+  if (bit_width == 0) {
+    return;
+  }
+  int64_t bit = idx * bit_width;
+  int64_t word = bit / 64;
+  int shift = bit % 64;
+  (*packed)[word] |= value << shift;
+  if (shift + bit_width > 64) {
+    (*packed)[word + 1] |= value >> (64 - shift);
+  }
+}
+
+uint64_t UnpackBits(const std::vector<uint64_t>& packed, int64_t idx, int bit_width) {
+  if (bit_width == 0) {
+    return 0;
+  }
+  int64_t bit = idx * bit_width;
+  int64_t word = bit / 64;
+  int shift = bit % 64;
+  uint64_t value = packed[word] >> shift;
+  if (shift + bit_width > 64) {
+    value |= packed[word + 1] << (64 - shift);
+  }
+  return bit_width == 64 ? value : value & ((uint64_t{1} << bit_width) - 1);
+}
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+int VarintLength(uint64_t value) {
+  int length = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++length;
+  }
+  return length;
+}
+
+// Reads the varint at *pos and advances *pos past it. Returns false if the data is truncated.
+bool ReadVarint(std::string_view data, size_t* pos, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (*pos >= data.size()) {
+      return false;
+    }
+    uint8_t byte = static_cast<uint8_t>(data[(*pos)++]);
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The difference between consecutive deltas, computed with wrapping arithmetic so that it is
+// defined for any pair of int64 values.
+int64_t DeltaOfDelta(int64_t prev_prev, int64_t prev, int64_t value) {
+  uint64_t prev_delta = static_cast<uint64_t>(prev) - static_cast<uint64_t>(prev_prev);
+  uint64_t delta = static_cast<uint64_t>(value) - static_cast<uint64_t>(prev);
+  return static_cast<int64_t>(delta - prev_delta);
+}
+
+ColumnEncoding SelectInt64Encoding(const arrow::Int64Array* arr) {
+  int64_t num_rows = 0;
+  int64_t min = std::numeric_limits<int64_t>::max();
+  int64_t max = std::numeric_limits<int64_t>::min();
+  int64_t num_dod_rows = 0;
+  int64_t dod_bytes = 0;
+  ForEachSampleRun(arr->length(), [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      int64_t value = arr->Value(i);
+      min = std::min(min, value);
+      max = std::max(max, value);
+      ++num_rows;
+      if (i >= start + 2) {
+        dod_bytes += VarintLength(
+            ZigZagEncode(DeltaOfDelta(arr->Value(i - 2), arr->Value(i - 1), value)));
+        ++num_dod_rows;
+      }
+    }
+  });
+  if (num_rows == 0) {
+    return ColumnEncoding::kPlain;
+  }
+
+  ColumnEncoding best = ColumnEncoding::kPlain;
+  double best_bytes_per_row = sizeof(int64_t);
+  double for_bytes_per_row =
+      BitWidth(static_cast<uint64_t>(max) - static_cast<uint64_t>(min)) / 8.0;
+  if (for_bytes_per_row < best_bytes_per_row) {
+    best = ColumnEncoding::kFrameOfReference;
+    best_bytes_per_row = for_bytes_per_row;
+  }
+  if (num_dod_rows > 0) {
+    double dod_bytes_per_row = static_cast<double>(dod_bytes) / num_dod_rows;
+    if (dod_bytes_per_row < best_bytes_per_row) {
+      best = ColumnEncoding::kDeltaOfDelta;
+    }
+  }
+  return best;
+}
+
+ColumnEncoding SelectStringEncoding(const arrow::StringArray* arr) {
+  int64_t num_rows = 0;
+  absl::flat_hash_set<std::string> distinct;
+  std::string sample;
+  ForEachSampleRun(arr->length(), [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      std::string value = arr->GetString(i);
+      sample.append(value);
+      distinct.insert(std::move(value));
+      ++num_rows;
+    }
+  });
+  if (num_rows == 0 || sample.empty()) {
+    return ColumnEncoding::kPlain;
+  }
+
+  ColumnEncoding best = ColumnEncoding::kPlain;
+  double avg_length = static_cast<double>(sample.size()) / num_rows;
+  double best_bytes_per_row = avg_length;
+  // The sample underestimates the number of distinct values in the column, so the dictionary is
+  // assumed to grow in proportion to the column length.
+  double dict_bytes_per_row =
+      BitWidth(distinct.size()) / 8.0 + avg_length * distinct.size() / num_rows;
+  if (dict_bytes_per_row < best_bytes_per_row) {
+    best = ColumnEncoding::kDictionary;
+    best_bytes_per_row = dict_bytes_per_row;
+  }
+  auto compressed_or_s = zlib::Deflate(sample);
+  if (compressed_or_s.ok()) {
+    double deflate_bytes_per_row =
+        static_cast<double>(compressed_or_s.ValueOrDie().size()) / num_rows + 1;
+    if (deflate_bytes_per_row < best_bytes_per_row) {
+      best = ColumnEncoding::kDeflate;
+    }
+  }
+  return best;
+}
+
+bool IsInt64Encodable(types::DataType data_type) {
+  return data_type == types::DataType::INT64 || data_type == types::DataType::TIME64NS;
+}
+
+}  // namespace
+
+std::string ToString(ColumnEncoding encoding) {
+  switch (encoding) {
+    case ColumnEncoding::kPlain:
+      return "plain";
+    case ColumnEncoding::kDictionary:
+      return "dictionary";
+    case ColumnEncoding::kDeltaOfDelta:
+      return "delta_of_delta";
+    case ColumnEncoding::kFrameOfReference:
+      return "frame_of_reference";
+    case ColumnEncoding::kDeflate:
+      return "deflate";
+  }
+  return "unknown";
+}
+
+ColumnEncoding EncodedColumn::SelectEncoding(types::DataType data_type, const arrow::Array* arr) {
+  if (IsInt64Encodable(data_type)) {
+    return SelectInt64Encoding(static_cast<const arrow::Int64Array*>(arr));
+  }
+  if (data_type == types::DataType::STRING) {
+    return SelectStringEncoding(static_cast<const arrow::StringArray*>(arr));
+  }
+  return ColumnEncoding::kPlain;
+}
+
+StatusOr<std::shared_ptr<const EncodedColumn>> EncodedColumn::Encode(
+    types::DataType data_type, const std::shared_ptr<arrow::Array>& arr) {
+  auto encoding = arr->length() < kMinEncodedLength ? ColumnEncoding::kPlain
+                                                    : SelectEncoding(data_type, arr.get());
+  if (encoding == ColumnEncoding::kPlain) {
+    return Encode(data_type, arr, encoding);
+  }
+  PL_ASSIGN_OR_RETURN(auto encoded, Encode(data_type, arr, encoding));
+  int64_t plain_bytes = 0;
+#define TYPE_CASE(_dt_) plain_bytes = types::GetArrowArrayBytes<_dt_>(arr.get());
+  PL_SWITCH_FOREACH_DATATYPE(data_type, TYPE_CASE);
+#undef TYPE_CASE
+  // The sample can be misleading, so keep the array as is if the encoding didn't pay off.
+  if (encoded->bytes() >= plain_bytes) {
+    return Encode(data_type, arr, ColumnEncoding::kPlain);
+  }
+  return encoded;
+}
+
+StatusOr<std::shared_ptr<const EncodedColumn>> EncodedColumn::Encode(
+    types::DataType data_type, const std::shared_ptr<arrow::Array>& arr,
+    ColumnEncoding encoding) {
+  // Can't use std::make_shared because the constructor is private.
+  auto col = std::shared_ptr<EncodedColumn>(new EncodedColumn(data_type, encoding, arr->length()));
+  bool supported = true;
+  switch (encoding) {
+    case ColumnEncoding::kPlain:
+      col->plain_ = arr;
+#define TYPE_CASE(_dt_) col->bytes_ = types::GetArrowArrayBytes<_dt_>(arr.get());
+      PL_SWITCH_FOREACH_DATATYPE(data_type, TYPE_CASE);
+#undef TYPE_CASE
+      break;
+    case ColumnEncoding::kDictionary:
+      supported = data_type == types::DataType::STRING;
+      if (supported) {
+        PL_RETURN_IF_ERROR(
+            col->EncodeDictionary(static_cast<const arrow::StringArray*>(arr.get())));
+      }
+      break;
+    case ColumnEncoding::kDeflate:
+      supported = data_type == types::DataType::STRING;
+      if (supported) {
+        PL_RETURN_IF_ERROR(col->EncodeDeflate(static_cast<const arrow::StringArray*>(arr.get())));
+      }
+      break;
+    case ColumnEncoding::kDeltaOfDelta:
+      supported = IsInt64Encodable(data_type);
+      if (supported) {
+        PL_RETURN_IF_ERROR(
+            col->EncodeDeltaOfDelta(static_cast<const arrow::Int64Array*>(arr.get())));
+      }
+      break;
+    case ColumnEncoding::kFrameOfReference:
+      supported = IsInt64Encodable(data_type);
+      if (supported) {
+        PL_RETURN_IF_ERROR(
+            col->EncodeFrameOfReference(static_cast<const arrow::Int64Array*>(arr.get())));
+      }
+      break;
+  }
+  if (!supported) {
+    return error::InvalidArgument("The $0 encoding doesn't support $1 columns", ToString(encoding),
+                                  types::ToString(data_type));
+  }
+  return std::shared_ptr<const EncodedColumn>(std::move(col));
+}
+
+Status EncodedColumn::EncodeDictionary(const arrow::StringArray* arr) {
+  absl::flat_hash_map<std::string, uint64_t> codes;
+  std::vector<uint64_t> row_codes(length_);
+  for (int64_t i = 0; i < length_; ++i) {
+    std::string value = arr->GetString(i);
+    auto [it, inserted] = codes.try_emplace(value, dictionary_.size());
+    if (inserted) {
+      bytes_ += value.size();
+      dictionary_.push_back(std::move(value));
+    }
+    row_codes[i] = it->second;
+  }
+  bit_width_ = dictionary_.empty() ? 0 : BitWidth(dictionary_.size() - 1);
+  packed_.assign(NumPackedWords(length_, bit_width_), 0);
+  for (int64_t i = 0; i < length_; ++i) {
+    PackBits(row_codes[i], i, bit_width_, &packed_);
+  }
+  bytes_ += packed_.size() * sizeof(uint64_t);
+  return Status::OK();
+}
+
+Status EncodedColumn::EncodeDeltaOfDelta(const arrow::Int64Array* arr) {
+  // The first two values are encoded as deltas from zero, which keeps the decoder branch free.
+  int64_t prev_prev = 0;
+  int64_t prev = 0;
+  for (int64_t i = 0; i < length_; ++i) {
+    int64_t value = arr->Value(i);
+    AppendVarint(ZigZagEncode(DeltaOfDelta(prev_prev, prev, value)), &data_);
+    if (i % kRowsPerCheckpoint == 0) {
+      checkpoints_.push_back(DeltaOfDeltaCheckpoint{
+          data_.size(), static_cast<uint64_t>(value),
+          static_cast<uint64_t>(value) - static_cast<uint64_t>(prev)});
+    }
+    prev_prev = prev;
+    prev = value;
+  }
+  data_.shrink_to_fit();
+  bytes_ = data_.size() + checkpoints_.size() * sizeof(DeltaOfDeltaCheckpoint);
+  return Status::OK();
+}
+
+Status EncodedColumn::EncodeFrameOfReference(const arrow::Int64Array* arr) {
+  if (length_ == 0) {
+    return Status::OK();
+  }
+  const int64_t* values = arr->raw_values();
+  auto [min_it, max_it] = std::minmax_element(values, values + length_);
+  reference_ = *min_it;
+  bit_width_ = BitWidth(static_cast<uint64_t>(*max_it) - static_cast<uint64_t>(reference_));
+  packed_.assign(NumPackedWords(length_, bit_width_), 0);
+  for (int64_t i = 0; i < length_; ++i) {
+    PackBits(static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(reference_), i, bit_width_,
+             &packed_);
+  }
+  bytes_ = packed_.size() * sizeof(uint64_t) + sizeof(reference_);
+  return Status::OK();
+}
+
+Status EncodedColumn::EncodeDeflate(const arrow::StringArray* arr) {
+  // In each block, the lengths of all of the strings come first, followed by the string data.
+  std::string raw;
+  for (int64_t start = 0; start < length_; start += kRowsPerCheckpoint) {
+    int64_t end = std::min(start + kRowsPerCheckpoint, length_);
+    raw.clear();
+    for (int64_t i = start; i < end; ++i) {
+      AppendVarint(arr->value_length(i), &raw);
+    }
+    for (int64_t i = start; i < end; ++i) {
+      auto value = arr->GetView(i);
+      raw.append(value.data(), value.size());
+    }
+    PL_ASSIGN_OR_RETURN(std::string compressed, zlib::Deflate(raw));
+    blocks_.push_back(DeflateBlock{data_.size(), compressed.size(), raw.size()});
+    data_.append(compressed);
+  }
+  data_.shrink_to_fit();
+  bytes_ = data_.size() + blocks_.size() * sizeof(DeflateBlock);
+  return Status::OK();
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> EncodedColumn::DecodeSlice(
+    int64_t offset, int64_t length, arrow::MemoryPool* mem_pool) const {
+  if (offset < 0 || length < 0 || offset + length > length_) {
+    return error::InvalidArgument("Slice [$0, $1) is out of range for a column of length $2",
+                                  offset, offset + length, length_);
+  }
+  switch (encoding_) {
+    case ColumnEncoding::kPlain:
+      return plain_->Slice(offset, length);
+    case ColumnEncoding::kDictionary:
+      return DecodeDictionary(offset, length, mem_pool);
+    case ColumnEncoding::kDeltaOfDelta:
+      return DecodeDeltaOfDelta(offset, length, mem_pool);
+    case ColumnEncoding::kFrameOfReference:
+      return DecodeFrameOfReference(offset, length, mem_pool);
+    case ColumnEncoding::kDeflate:
+      return DecodeDeflate(offset, length, mem_pool);
+  }
+  return error::Internal("Unknown column encoding $0", static_cast<int>(encoding_));
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> EncodedColumn::DecodeDictionary(
+    int64_t offset, int64_t length, arrow::MemoryPool* mem_pool) const {
+  int64_t total_size = 0;
+  for (int64_t i = offset; i < offset + length; ++i) {
+    total_size += dictionary_[UnpackBits(packed_, i, bit_width_)].size();
+  }
+  arrow::StringBuilder builder(mem_pool);
+  PL_RETURN_IF_ERROR(builder.Reserve(length));
+  PL_RETURN_IF_ERROR(builder.ReserveData(total_size));
+  for (int64_t i = offset; i < offset + length; ++i) {
+    builder.UnsafeAppend(dictionary_[UnpackBits(packed_, i, bit_width_)]);
+  }
+  std::shared_ptr<arrow::Array> arr;
+  PL_RETURN_IF_ERROR(builder.Finish(&arr));
+  return arr;
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> EncodedColumn::DecodeDeltaOfDelta(
+    int64_t offset, int64_t length, arrow::MemoryPool* mem_pool) const {
+  arrow::Int64Builder builder(mem_pool);
+  PL_RETURN_IF_ERROR(builder.Reserve(length));
+  // Each value depends on all of the values before it, so decoding has to start at the checkpoint
+  // at or before the slice.
+  if (length > 0) {
+    int64_t row = offset / kRowsPerCheckpoint * kRowsPerCheckpoint;
+    const auto& checkpoint = checkpoints_[row / kRowsPerCheckpoint];
+    size_t pos = checkpoint.pos;
+    uint64_t prev = checkpoint.value;
+    uint64_t prev_delta = checkpoint.delta;
+    if (row == offset) {
+      builder.UnsafeAppend(static_cast<int64_t>(prev));
+    }
+    for (int64_t i = row + 1; i < offset + length; ++i) {
+      uint64_t zigzag;
+      if (!ReadVarint(data_, &pos, &zigzag)) {
+        return error::Internal("Delta of delta column is truncated at row $0", i);
+      }
+      prev_delta += static_cast<uint64_t>(ZigZagDecode(zigzag));
+      prev += prev_delta;
+      if (i >= offset) {
+        builder.UnsafeAppend(static_cast<int64_t>(prev));
+      }
+    }
+  }
+  std::shared_ptr<arrow::Array> arr;
+  PL_RETURN_IF_ERROR(builder.Finish(&arr));
+  return arr;
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> EncodedColumn::DecodeFrameOfReference(
+    int64_t offset, int64_t length, arrow::MemoryPool* mem_pool) const {
+  arrow::Int64Builder builder(mem_pool);
+  PL_RETURN_IF_ERROR(builder.Reserve(length));
+  for (int64_t i = offset; i < offset + length; ++i) {
+    builder.UnsafeAppend(static_cast<int64_t>(static_cast<uint64_t>(reference_) +
+                                              UnpackBits(packed_, i, bit_width_)));
+  }
+  std::shared_ptr<arrow::Array> arr;
+  PL_RETURN_IF_ERROR(builder.Finish(&arr));
+  return arr;
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> EncodedColumn::DecodeDeflate(
+    int64_t offset, int64_t length, arrow::MemoryPool* mem_pool) const {
+  arrow::StringBuilder builder(mem_pool);
+  PL_RETURN_IF_ERROR(builder.Reserve(length));
+  // Only the blocks that overlap the slice are inflated.
+  for (int64_t start = offset / kRowsPerCheckpoint * kRowsPerCheckpoint; start < offset + length;
+       start += kRowsPerCheckpoint) {
+    const auto& block = blocks_[start / kRowsPerCheckpoint];
+    PL_ASSIGN_OR_RETURN(
+        std::string raw,
+        zlib::Inflate(std::string_view(data_).substr(block.pos, block.compressed_size),
+                      block.uncompressed_size + 1));
+    int64_t end = std::min(start + kRowsPerCheckpoint, length_);
+    std::vector<uint64_t> lengths(end - start);
+    size_t pos = 0;
+    for (int64_t i = start; i < end; ++i) {
+      if (!ReadVarint(raw, &pos, &lengths[i - start])) {
+        return error::Internal("Deflate column is truncated at row $0", i);
+      }
+    }
+    int64_t slice_start = std::max(start, offset);
+    int64_t slice_end = std::min(end, offset + length);
+    for (int64_t i = start; i < slice_start; ++i) {
+      pos += lengths[i - start];
+    }
+    size_t total_size = 0;
+    for (int64_t i = slice_start; i < slice_end; ++i) {
+      total_size += lengths[i - start];
+    }
+    if (pos + total_size > raw.size()) {
+      return error::Internal("Deflate column data is truncated");
+    }
+    PL_RETURN_IF_ERROR(builder.ReserveData(total_size));
+    for (int64_t i = slice_start; i < slice_end; ++i) {
+      builder.UnsafeAppend(raw.data() + pos, static_cast<int32_t>(lengths[i - start]));
+      pos += lengths[i - start];
+    }
+  }
+  std::shared_ptr<arrow::Array> arr;
+  PL_RETURN_IF_ERROR(builder.Finish(&arr));
+  return arr;
+}
+
+int64_t EncodedColumn::CheckpointFirstValue(int64_t checkpoint) const {
+  int64_t row = checkpoint * kRowsPerCheckpoint;
+  switch (encoding_) {
+    case ColumnEncoding::kDeltaOfDelta:
+      return static_cast<int64_t>(checkpoints_[checkpoint].value);
+    case ColumnEncoding::kFrameOfReference:
+      return static_cast<int64_t>(static_cast<uint64_t>(reference_) +
+                                  UnpackBits(packed_, row, bit_width_));
+    default:
+      return static_cast<const arrow::Int64Array*>(plain_.get())->Value(row);
+  }
+}
+
+template <typename TBefore>
+int64_t EncodedColumn::LastCheckpointBefore(int64_t value, TBefore before) const {
+  int64_t lo = 0;
+  int64_t hi = (length_ + kRowsPerCheckpoint - 1) / kRowsPerCheckpoint;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (before(CheckpointFirstValue(mid), value)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo - 1;
+}
+
+StatusOr<int64_t> EncodedColumn::SearchGreaterThanOrEqual(int64_t value,
+                                                          arrow::MemoryPool* mem_pool) const {
+  if (!IsInt64Encodable(data_type_)) {
+    return error::InvalidArgument("Can't search a $0 column", types::ToString(data_type_));
+  }
+  // The first row that isn't less than value is in the last checkpoint that starts with a smaller
+  // value, or it is the first row of the next checkpoint.
+  int64_t checkpoint = LastCheckpointBefore(value, std::less<int64_t>());
+  if (checkpoint == -1) {
+    return length_ == 0 ? -1 : 0;
+  }
+  int64_t start = checkpoint * kRowsPerCheckpoint;
+  int64_t length = std::min(kRowsPerCheckpoint, length_ - start);
+  PL_ASSIGN_OR_RETURN(auto arr, DecodeSlice(start, length, mem_pool));
+  const int64_t* values = static_cast<const arrow::Int64Array*>(arr.get())->raw_values();
+  int64_t idx = std::lower_bound(values, values + length, value) - values;
+  return start + idx < length_ ? start + idx : -1;
+}
+
+StatusOr<int64_t> EncodedColumn::SearchLessThanOrEqual(int64_t value,
+                                                       arrow::MemoryPool* mem_pool) const {
+  if (!IsInt64Encodable(data_type_)) {
+    return error::InvalidArgument("Can't search a $0 column", types::ToString(data_type_));
+  }
+  // The last row that isn't greater than value is in the last checkpoint that starts with a value
+  // that isn't greater either.
+  int64_t checkpoint = LastCheckpointBefore(value, std::less_equal<int64_t>());
+  if (checkpoint == -1) {
+    return -1;
+  }
+  int64_t start = checkpoint * kRowsPerCheckpoint;
+  int64_t length = std::min(kRowsPerCheckpoint, length_ - start);
+  PL_ASSIGN_OR_RETURN(auto arr, DecodeSlice(start, length, mem_pool));
+  const int64_t* values = static_cast<const arrow::Int64Array*>(arr.get())->raw_values();
+  return start + (std::upper_bound(values, values + length, value) - values) - 1;
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace table_store {
+
+enum class ColumnEncoding {
+  // The arrow array, unchanged.
+  kPlain,
+  // Each distinct string is stored once, and each row stores a bit-packed index into them.
+  kDictionary,
+  // The values are stored as zigzag varints of the difference between consecutive deltas, which is
+  // close to zero for monotonic columns such as time_. The decoder state is checkpointed every
+  // kRowsPerCheckpoint rows, so that slices don't have to be decoded from the first row.
+  kDeltaOfDelta,
+  // Each value is stored as a bit-packed offset from the minimum value of the column.
+  kFrameOfReference,
+  // The string lengths and data are compressed with zlib, in independent blocks of
+  // kRowsPerCheckpoint rows.
+  kDeflate,
+};
+
+std::string ToString(ColumnEncoding encoding);
+
+/**
+ * EncodedColumn is an immutable, compressed copy of an arrow array, used by the Table to store
+ * cold batches. The encoding is selected when the column is encoded, by estimating the size of
+ * each encoding that applies to the column's type on a sample of its rows. Columns are decoded
+ * lazily when they are read, and the encodings that support random access only decode the rows
+ * that are read. The others restart from the closest checkpoint before the rows that are read.
+ */
+class EncodedColumn {
+ public:
+  /**
+   * Encodes the array with the encoding estimated to be the smallest for its data. The array is
+   * kept as is if no encoding makes it smaller, or if it is too short to be worth encoding.
+   */
+  static StatusOr<std::shared_ptr<const EncodedColumn>> Encode(
+      types::DataType data_type, const std::shared_ptr<arrow::Array>& arr);
+
+  /**
+   * Encodes the array with the given encoding, which must support the data type.
+   */
+  static StatusOr<std::shared_ptr<const EncodedColumn>> Encode(
+      types::DataType data_type, const std::shared_ptr<arrow::Array>& arr,
+      ColumnEncoding encoding);
+
+  /**
+   * @return the encoding that Encode would pick for the array, based on a sample of its rows.
+   */
+  static ColumnEncoding SelectEncoding(types::DataType data_type, const arrow::Array* arr);
+
+  StatusOr<std::shared_ptr<arrow::Array>> Decode(arrow::MemoryPool* mem_pool) const {
+    return DecodeSlice(0, length_, mem_pool);
+  }
+
+  /**
+   * Decodes length rows starting at offset. This doesn't copy plain columns.
+   */
+  StatusOr<std::shared_ptr<arrow::Array>> DecodeSlice(int64_t offset, int64_t length,
+                                                      arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * For a sorted INT64 or TIME64NS column, finds the first row greater than or equal to value, like
+   * types::SearchArrowArrayGreaterThanOrEqual. Only the kRowsPerCheckpoint rows around the result
+   * are decoded.
+   * @return the index of the row, or -1 if all of the rows are less than value.
+   */
+  StatusOr<int64_t> SearchGreaterThanOrEqual(int64_t value, arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * For a sorted INT64 or TIME64NS column, finds the last row less than or equal to value, like
+   * types::SearchArrowArrayLessThanOrEqual.
+   * @return the index of the row, or -1 if all of the rows are greater than value.
+   */
+  StatusOr<int64_t> SearchLessThanOrEqual(int64_t value, arrow::MemoryPool* mem_pool) const;
+
+  types::DataType data_type() const { return data_type_; }
+  ColumnEncoding encoding() const { return encoding_; }
+  int64_t length() const { return length_; }
+  // The number of bytes used by the encoded column. For plain columns this matches
+  // types::GetArrowArrayBytes.
+  int64_t bytes() const { return bytes_; }
+
+  // The encodings that can't decode a row on its own restart from a checkpoint every this many
+  // rows, which bounds the rows decoded in excess of a slice.
+  static constexpr int64_t kRowsPerCheckpoint = 1024;
+
+ private:
+  // The state of the delta of delta decoder after decoding the first row of a checkpoint.
+  struct DeltaOfDeltaCheckpoint {
+    size_t pos;
+    uint64_t value;
+    uint64_t delta;
+  };
+
+  // A deflate block, which holds the rows of a checkpoint.
+  struct DeflateBlock {
+    size_t pos;
+    size_t compressed_size;
+    size_t uncompressed_size;
+  };
+
+  EncodedColumn(types::DataType data_type, ColumnEncoding encoding, int64_t length)
+      : data_type_(data_type), encoding_(encoding), length_(length) {}
+
+  Status EncodeDictionary(const arrow::StringArray* arr);
+  Status EncodeDeltaOfDelta(const arrow::Int64Array* arr);
+  Status EncodeFrameOfReference(const arrow::Int64Array* arr);
+  Status EncodeDeflate(const arrow::StringArray* arr);
+
+  StatusOr<std::shared_ptr<arrow::Array>> DecodeDictionary(int64_t offset, int64_t length,
+                                                           arrow::MemoryPool* mem_pool) const;
+  StatusOr<std::shared_ptr<arrow::Array>> DecodeDeltaOfDelta(int64_t offset, int64_t length,
+                                                             arrow::MemoryPool* mem_pool) const;
+  StatusOr<std::shared_ptr<arrow::Array>> DecodeFrameOfReference(
+      int64_t offset, int64_t length, arrow::MemoryPool* mem_pool) const;
+  StatusOr<std::shared_ptr<arrow::Array>> DecodeDeflate(int64_t offset, int64_t length,
+                                                        arrow::MemoryPool* mem_pool) const;
+
+  // Returns the value of the first row of the checkpoint, for sorted searches.
+  int64_t CheckpointFirstValue(int64_t checkpoint) const;
+  // Returns the index of the last checkpoint that starts with a value for which
+  // before(first value, value) is true, or -1 if there is none.
+  template <typename TBefore>
+  int64_t LastCheckpointBefore(int64_t value, TBefore before) const;
+
+  types::DataType data_type_;
+  ColumnEncoding encoding_;
+  int64_t length_;
+  int64_t bytes_ = 0;
+
+  // Used by kPlain.
+  std::shared_ptr<arrow::Array> plain_;
+  // Used by kDictionary.
+  std::vector<std::string> dictionary_;
+  // Used by kFrameOfReference.
+  int64_t reference_ = 0;
+  // Used by kDictionary and kFrameOfReference, which store bit_width_ bits per row.
+  std::vector<uint64_t> packed_;
+  int bit_width_ = 0;
+  // Used by kDeltaOfDelta and kDeflate.
+  std::string data_;
+  // Used by kDeltaOfDelta.
+  std::vector<DeltaOfDeltaCheckpoint> checkpoints_;
+  // Used by kDeflate.
+  std::vector<DeflateBlock> blocks_;
+};
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <absl/strings/substitute.h>
+#include <arrow/array.h>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/column_encoding.h"
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+std::shared_ptr<arrow::Array> MakeInt64Array(const std::vector<types::Int64Value>& values) {
+  return types::ToArrow(values, arrow::default_memory_pool());
+}
+
+std::shared_ptr<arrow::Array> MakeStringArray(const std::vector<types::StringValue>& values) {
+  return types::ToArrow(values, arrow::default_memory_pool());
+}
+
+void ExpectRoundTrip(types::DataType data_type, const std::shared_ptr<arrow::Array>& arr,
+                     ColumnEncoding encoding) {
+  ASSERT_OK_AND_ASSIGN(auto encoded, EncodedColumn::Encode(data_type, arr, encoding));
+  EXPECT_EQ(encoding, encoded->encoding());
+  EXPECT_EQ(arr->length(), encoded->length());
+  ASSERT_OK_AND_ASSIGN(auto decoded, encoded->Decode(arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(arr)) << ToString(encoding);
+  ASSERT_OK_AND_ASSIGN(auto slice, encoded->DecodeSlice(1, arr->length() - 2,
+                                                        arrow::default_memory_pool()));
+  EXPECT_TRUE(slice->Equals(arr->Slice(1, arr->length() - 2))) << ToString(encoding);
+}
+
+// Reads the column through consecutive slices of slice_length rows, which is how morsels read cold
+// batches.
+void ExpectSlicesMatch(types::DataType data_type, const std::shared_ptr<arrow::Array>& arr,
+                       ColumnEncoding encoding, int64_t slice_length) {
+  ASSERT_OK_AND_ASSIGN(auto encoded, EncodedColumn::Encode(data_type, arr, encoding));
+  for (int64_t offset = 0; offset < arr->length(); offset += slice_length) {
+    int64_t length = std::min(slice_length, arr->length() - offset);
+    ASSERT_OK_AND_ASSIGN(auto slice,
+                         encoded->DecodeSlice(offset, length, arrow::default_memory_pool()));
+    EXPECT_TRUE(slice->Equals(arr->Slice(offset, length)))
+        << ToString(encoding) << " at offset " << offset;
+  }
+}
+
+}  // namespace
+
+TEST(ColumnEncodingTest, int64_round_trip) {
+  auto arr = MakeInt64Array({5, -3, 1000000, std::numeric_limits<int64_t>::min(),
+                             std::numeric_limits<int64_t>::max(), 0, 7});
+  ExpectRoundTrip(types::DataType::INT64, arr, ColumnEncoding::kPlain);
+  ExpectRoundTrip(types::DataType::INT64, arr, ColumnEncoding::kDeltaOfDelta);
+  ExpectRoundTrip(types::DataType::INT64, arr, ColumnEncoding::kFrameOfReference);
+}
+
+TEST(ColumnEncodingTest, string_round_trip) {
+  auto arr = MakeStringArray({"/healthz", "/api/v1/users", "", "/healthz", "/api/v1/users",
+                              std::string(300, 'a'), "/healthz"});
+  ExpectRoundTrip(types::DataType::STRING, arr, ColumnEncoding::kPlain);
+  ExpectRoundTrip(types::DataType::STRING, arr, ColumnEncoding::kDictionary);
+  ExpectRoundTrip(types::DataType::STRING, arr, ColumnEncoding::kDeflate);
+}
+
+TEST(ColumnEncodingTest, unsupported_encoding) {
+  EXPECT_NOT_OK(EncodedColumn::Encode(types::DataType::STRING, MakeStringArray({"a"}),
+                                      ColumnEncoding::kFrameOfReference));
+  EXPECT_NOT_OK(EncodedColumn::Encode(types::DataType::INT64, MakeInt64Array({1}),
+                                      ColumnEncoding::kDictionary));
+}
+
+TEST(ColumnEncodingTest, out_of_range_slice) {
+  ASSERT_OK_AND_ASSIGN(auto encoded,
+                       EncodedColumn::Encode(types::DataType::INT64, MakeInt64Array({1, 2, 3})));
+  EXPECT_NOT_OK(encoded->DecodeSlice(2, 2, arrow::default_memory_pool()));
+}
+
+TEST(ColumnEncodingTest, selects_delta_of_delta_for_time) {
+  std::vector<types::Int64Value> times;
+  for (int64_t i = 0; i < 10000; ++i) {
+    times.push_back(1600000000000000000 + i * 1000000 + (i % 3));
+  }
+  auto arr = MakeInt64Array(times);
+  ASSERT_OK_AND_ASSIGN(auto encoded, EncodedColumn::Encode(types::DataType::TIME64NS, arr));
+  EXPECT_EQ(ColumnEncoding::kDeltaOfDelta, encoded->encoding());
+  EXPECT_LT(encoded->bytes() * 4, 10000 * static_cast<int64_t>(sizeof(int64_t)));
+  ASSERT_OK_AND_ASSIGN(auto decoded, encoded->Decode(arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(arr));
+}
+
+TEST(ColumnEncodingTest, selects_frame_of_reference_for_small_range) {
+  std::vector<types::Int64Value> latencies;
+  for (int64_t i = 0; i < 10000; ++i) {
+    // The high bits of the product are well mixed, so that the deltas aren't regular.
+    latencies.push_back(1000 + ((static_cast<uint64_t>(i) * 0x9e3779b97f4a7c15) >> 52));
+  }
+  auto arr = MakeInt64Array(latencies);
+  ASSERT_OK_AND_ASSIGN(auto encoded, EncodedColumn::Encode(types::DataType::INT64, arr));
+  EXPECT_EQ(ColumnEncoding::kFrameOfReference, encoded->encoding());
+  ASSERT_OK_AND_ASSIGN(auto decoded, encoded->Decode(arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(arr));
+}
+
+TEST(ColumnEncodingTest, selects_dictionary_for_low_cardinality_strings) {
+  std::vector<types::StringValue> services;
+  for (int64_t i = 0; i < 10000; ++i) {
+    services.push_back(absl::Substitute("pl/service-$0", i % 8));
+  }
+  auto arr = MakeStringArray(services);
+  ASSERT_OK_AND_ASSIGN(auto encoded, EncodedColumn::Encode(types::DataType::STRING, arr));
+  EXPECT_EQ(ColumnEncoding::kDictionary, encoded->encoding());
+  ASSERT_OK_AND_ASSIGN(auto decoded, encoded->Decode(arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(arr));
+}
+
+TEST(ColumnEncodingTest, small_slices_across_checkpoints) {
+  int64_t num_rows = 3 * EncodedColumn::kRowsPerCheckpoint + 100;
+  std::vector<types::Int64Value> times;
+  std::vector<types::StringValue> paths;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    times.push_back(1600000000000000000 + i * 1000000 + (i % 3));
+    paths.push_back(absl::Substitute("/api/v1/users/$0", i % 97));
+  }
+  auto time_arr = MakeInt64Array(times);
+  auto path_arr = MakeStringArray(paths);
+  for (int64_t slice_length : {1, 7, 100}) {
+    ExpectSlicesMatch(types::DataType::TIME64NS, time_arr, ColumnEncoding::kDeltaOfDelta,
+                      slice_length);
+    ExpectSlicesMatch(types::DataType::TIME64NS, time_arr, ColumnEncoding::kFrameOfReference,
+                      slice_length);
+    ExpectSlicesMatch(types::DataType::STRING, path_arr, ColumnEncoding::kDeflate, slice_length);
+    ExpectSlicesMatch(types::DataType::STRING, path_arr, ColumnEncoding::kDictionary,
+                      slice_length);
+  }
+}
+
+TEST(ColumnEncodingTest, search_sorted_column) {
+  // Each value is repeated, including across the first checkpoint boundary.
+  int64_t num_rows = 2 * EncodedColumn::kRowsPerCheckpoint + 10;
+  std::vector<types::Int64Value> times;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    times.push_back(1000 + (i + 1) / 2 * 10);
+  }
+  auto arr = MakeInt64Array(times);
+  for (auto encoding : {ColumnEncoding::kPlain, ColumnEncoding::kDeltaOfDelta,
+                        ColumnEncoding::kFrameOfReference}) {
+    ASSERT_OK_AND_ASSIGN(auto encoded,
+                         EncodedColumn::Encode(types::DataType::TIME64NS, arr, encoding));
+    for (int64_t value : {int64_t{0}, int64_t{1000}, int64_t{1005}, times[511].val,
+                          times[512].val, times[1024].val, times[1024].val + 1,
+                          times.back().val, times.back().val + 1}) {
+      SCOPED_TRACE(absl::Substitute("$0 $1", ToString(encoding), value));
+      EXPECT_OK_AND_EQ(
+          encoded->SearchGreaterThanOrEqual(value, arrow::default_memory_pool()),
+          types::SearchArrowArrayGreaterThanOrEqual<types::DataType::INT64>(arr.get(), value));
+      EXPECT_OK_AND_EQ(
+          encoded->SearchLessThanOrEqual(value, arrow::default_memory_pool()),
+          types::SearchArrowArrayLessThanOrEqual<types::DataType::INT64>(arr.get(), value));
+    }
+  }
+  ASSERT_OK_AND_ASSIGN(auto strings,
+                       EncodedColumn::Encode(types::DataType::STRING, MakeStringArray({"a"})));
+  EXPECT_NOT_OK(strings->SearchGreaterThanOrEqual(0, arrow::default_memory_pool()));
+}
+
+TEST(ColumnEncodingTest, keeps_plain_for_short_columns) {
+  ASSERT_OK_AND_ASSIGN(auto encoded,
+                       EncodedColumn::Encode(types::DataType::INT64, MakeInt64Array({1, 2, 3})));
+  EXPECT_EQ(ColumnEncoding::kPlain, encoded->encoding());
+}
+
+TEST(ColumnEncodingTest, keeps_plain_for_floats) {
+  std::vector<types::Float64Value> values = {0.5, 1.5, 2.5};
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto encoded, EncodedColumn::Encode(types::DataType::FLOAT64, arr));
+  EXPECT_EQ(ColumnEncoding::kPlain, encoded->encoding());
+  EXPECT_EQ(3 * static_cast<int64_t>(sizeof(double)), encoded->bytes());
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -22,7 +22,6 @@
 #include <iterator>
 #include <memory>
 #include <string>
-#include <variant>
 #include <vector>
 
 #include <absl/strings/str_format.h>
@@ -37,6 +36,10 @@ DEFINE_int32(table_store_table_size_limit,
              gflags::Int32FromEnv("PL_TABLE_STORE_TABLE_SIZE_LIMIT", 1024 * 1024 * 64),
              "The maximal size a table allows. When the size grows beyond this limit, "
              "old data will be discarded.");
+DEFINE_bool(table_store_cold_compression,
+            gflags::BoolFromEnv("PL_TABLE_STORE_COLD_COMPRESSION", true),
+            "Whether to encode the columns of cold batches to reduce their size. Cold data is "
+            "decoded when it is read.");
 
 namespace px {
 namespace table_store {
@@ -132,7 +135,7 @@ StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetRowBatchSlice(
 
   auto batch_size = slice.Size();
   auto output_rb = std::make_unique<schema::RowBatch>(schema::RowDescriptor(rb_types), batch_size);
-  PL_RETURN_IF_ERROR(AddBatchSliceToRowBatch(slice, cols, output_rb.get(), mem_pool));
+  PL_RETURN_IF_ERROR(AddBatchSliceToRowBatch(slice, cols, mem_pool, output_rb.get()));
   return output_rb;
 }
 
@@ -205,18 +208,27 @@ Status Table::TransferRecordBatch(
 
   uint32_t i = 0;
   int64_t rb_bytes = 0;
+  schema::RowBatch rb(schema::RowDescriptor(rel_.col_types()), record_batch->at(0)->Size());
   for (const auto& col : *record_batch) {
     auto received_type = col->data_type();
     auto expected_type = rel_.col_types().at(i);
     DCHECK_EQ(expected_type, received_type)
         << absl::StrFormat("Type mismatch [column=%u]: expected=%s received=%s", i,
                            ToString(expected_type), ToString(received_type));
-    rb_bytes += col->Bytes();
+    // Convert to arrow before taking any locks. This shares the buffers of fixed width columns, so
+    // reads of hot data don't need to convert anything.
+    auto arr = types::ShareAsArrow(col, arrow::default_memory_pool());
+    // Count the bytes of the arrow array rather than of the column wrapper, so that they match
+    // what expiry and compaction subtract from hot_bytes_.
+#define TYPE_CASE(_dt_) rb_bytes += types::GetArrowArrayBytes<_dt_>(arr.get());
+    PL_SWITCH_FOREACH_DATATYPE(received_type, TYPE_CASE);
+#undef TYPE_CASE
+    PL_RETURN_IF_ERROR(rb.AddColumn(std::move(arr)));
     ++i;
   }
 
   PL_RETURN_IF_ERROR(ExpireRowBatches(rb_bytes));
-  PL_RETURN_IF_ERROR(WriteHot(std::move(record_batch)));
+  PL_RETURN_IF_ERROR(WriteHot(std::move(rb)));
 
   absl::base_internal::SpinLockHolder lock(&stats_lock_);
   hot_bytes_ += rb_bytes;
@@ -249,9 +261,8 @@ StatusOr<BatchSlice> Table::FindBatchSliceGreaterThanOrEqual(int64_t time,
     if (it != cold_time_.end()) {
       auto index = std::distance(cold_time_.begin(), it);
       auto ring_index = RingIndexUnlocked(index);
-      auto time_col = cold_column_buffers_[time_col_idx_][ring_index];
-      auto row_offset = types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
-          time_col.get(), time);
+      const auto& time_col = cold_column_buffers_[time_col_idx_][ring_index];
+      PL_ASSIGN_OR_RETURN(auto row_offset, time_col->SearchGreaterThanOrEqual(time, mem_pool));
       auto row_ids = cold_row_ids_[index];
       return BatchSlice::Cold(ring_index, row_offset, time_col->length() - 1, generation_,
                               row_ids.first + row_offset, row_ids.second);
@@ -265,15 +276,7 @@ StatusOr<BatchSlice> Table::FindBatchSliceGreaterThanOrEqual(int64_t time,
     return BatchSlice::Invalid();
   }
   auto index = std::distance(hot_time_.begin(), it);
-
-  ArrowArrayPtr time_col;
-  if (std::holds_alternative<RecordBatchWithCache>(hot_batches_[index])) {
-    auto record_batch_ptr = std::get_if<RecordBatchWithCache>(&hot_batches_[index]);
-    time_col = GetHotColumnUnlocked(record_batch_ptr, time_col_idx_, mem_pool);
-  } else {
-    auto row_batch = std::get<schema::RowBatch>(hot_batches_[index]);
-    time_col = row_batch.columns().at(time_col_idx_);
-  }
+  auto time_col = hot_batches_[index].ColumnAt(time_col_idx_);
 
   auto row_offset =
       types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(time_col.get(), time);
@@ -288,7 +291,7 @@ StatusOr<Table::StopPosition> Table::FindStopPositionForTime(int64_t time,
     return error::InvalidArgument(
         "Cannot call FindStopPositionForTime on table without a time column.");
   }
-  auto stop = FindStopTime(time, mem_pool);
+  PL_ASSIGN_OR_RETURN(auto stop, FindStopTime(time, mem_pool));
   if (stop == -1) {
     // If all the data is after the stop time then we return the first unique row identifier in the
     // table, which will cause no results to be returned.
@@ -297,6 +300,20 @@ StatusOr<Table::StopPosition> Table::FindStopPositionForTime(int64_t time,
   return stop + 1;
 }
 
+bool Table::MayMatch(const BatchSlice& slice,
+                     const std::vector<ZoneMapPredicate>& predicates) const {
+  if (predicates.empty()) {
+    return true;
+  }
+  absl::MutexLock gen_lock(&generation_lock_);
+  // If the slice can't be updated, let the read of the slice report the error.
+  if (!UpdateSliceUnlocked(slice).ok() || slice.unsafe_is_hot) {
+    return true;
+  }
+  absl::MutexLock cold_lock(&cold_lock_);
+  return cold_zone_maps_[RingVectorIndexUnlocked(slice.unsafe_batch_index)].MayMatch(predicates);
+}
+
 schema::Relation Table::GetRelation() const { return rel_; }
 
 TableStats Table::GetTableStats() const {
@@ -315,32 +332,6 @@ TableStats Table::GetTableStats() const {
   return info;
 }
 
-Status Table::UpdateTimeRowIndices(types::ColumnWrapperRecordBatch* record_batch) {
-  auto batch_length = record_batch->at(0)->Size();
-  DCHECK_GT(batch_length, 0);
-  if (time_col_idx_ != -1) {
-    auto first_time = record_batch->at(time_col_idx_)->Get<types::Time64NSValue>(0);
-    auto last_time = record_batch->at(time_col_idx_)->Get<types::Time64NSValue>(batch_length - 1);
-    hot_time_.emplace_back(first_time.val, last_time.val);
-  }
-  auto first_row_id = next_row_id_;
-  next_row_id_ += batch_length;
-  hot_row_ids_.emplace_back(first_row_id, next_row_id_ - 1);
-  return Status::OK();
-}
-
-Status Table::WriteHot(RecordBatchPtr record_batch) {
-  absl::MutexLock hot_lock(&hot_lock_);
-  PL_RETURN_IF_ERROR(UpdateTimeRowIndices(record_batch.get()));
-  auto rb = RecordBatchWithCache{
-      std::move(record_batch),
-      std::vector<ArrowArrayPtr>(rel_.NumColumns()),
-      std::vector<bool>(rel_.NumColumns(), false),
-  };
-  hot_batches_.emplace_back(std::move(rb));
-  return Status::OK();
-}
-
 Status Table::UpdateTimeRowIndices(const schema::RowBatch& rb) {
   auto batch_length = rb.ColumnAt(0)->length();
   DCHECK_GT(batch_length, 0);
@@ -357,10 +348,10 @@ Status Table::UpdateTimeRowIndices(const schema::RowBatch& rb) {
   return Status::OK();
 }
 
-Status Table::WriteHot(const schema::RowBatch& rb) {
+Status Table::WriteHot(schema::RowBatch rb) {
   absl::MutexLock hot_lock(&hot_lock_);
   PL_RETURN_IF_ERROR(UpdateTimeRowIndices(rb));
-  hot_batches_.emplace_back(rb);
+  hot_batches_.emplace_back(std::move(rb));
   return Status::OK();
 }
 
@@ -370,60 +361,82 @@ Status Table::CompactSingleBatch(arrow::MemoryPool* mem_pool) {
   int64_t last_time = -1;
   int64_t first_row_id = -1;
   int64_t last_row_id = -1;
-  absl::MutexLock gen_lock(&generation_lock_);
-  // We first get the necessary batches to compact from hot storage. Then we compact those batches
-  // into one batch. Then we push that batch into cold storage.
+  size_t num_hot_batches = 0;
+  // We first copy the necessary batches to compact from the front of hot storage. The hot batches
+  // are only removed once their compacted batch is ready to be pushed into cold storage, so that
+  // readers and writers aren't blocked while the batch is built and encoded, and the rows are
+  // never missing from both hot and cold storage.
   {
     absl::MutexLock hot_lock(&hot_lock_);
-    for (auto it = hot_batches_.begin(); it != hot_batches_.end();) {
+    for (const auto& [batch_idx, rb] : Enumerate(hot_batches_)) {
       if (builder.Size() >= min_cold_batch_size_) {
         break;
       }
-      std::vector<std::shared_ptr<arrow::Array>> column_arrays;
-      if (std::holds_alternative<RecordBatchWithCache>(*it)) {
-        auto record_batch_ptr = std::get_if<RecordBatchWithCache>(&(*it));
-        for (int64_t col_idx = 0; col_idx < static_cast<int64_t>(rel_.NumColumns()); ++col_idx) {
-          if (record_batch_ptr->cache_validity[col_idx]) {
-            PL_RETURN_IF_ERROR(
-                builder.AppendColumn(col_idx, record_batch_ptr->arrow_cache[col_idx]));
-          } else {
-            PL_RETURN_IF_ERROR(builder.AppendColumn(
-                col_idx, record_batch_ptr->record_batch->at(col_idx)->ConvertToArrow(mem_pool)));
-          }
-        }
-      } else {
-        auto row_batch = std::get<schema::RowBatch>(*it);
-        for (auto [col_idx, col] : Enumerate(row_batch.columns())) {
-          PL_RETURN_IF_ERROR(builder.AppendColumn(col_idx, col));
-        }
+      for (auto [col_idx, col] : Enumerate(rb.columns())) {
+        PL_RETURN_IF_ERROR(builder.AppendColumn(col_idx, col));
       }
-      auto row_ids = hot_row_ids_.front();
+      auto row_ids = hot_row_ids_[batch_idx];
       if (first_row_id == -1) {
         first_row_id = row_ids.first;
       }
       last_row_id = row_ids.second;
-
-      it = hot_batches_.erase(it);
-      hot_row_ids_.pop_front();
-
       if (time_col_idx_ != -1) {
-        auto times = hot_time_.front();
+        auto times = hot_time_[batch_idx];
         if (first_time == -1) {
           first_time = times.first;
         }
         last_time = times.second;
-        hot_time_.pop_front();
       }
+      ++num_hot_batches;
     }
   }
+  if (num_hot_batches == 0) {
+    return Status::OK();
+  }
   PL_RETURN_IF_ERROR(builder.Finish());
+  BatchZoneMap zone_map(rel_.col_types(), builder.output_columns());
+  std::vector<EncodedColumnPtr> encoded_columns;
+  int64_t encoded_bytes = 0;
+  for (const auto& [col_idx, col] : Enumerate(builder.output_columns())) {
+    auto col_type = rel_.GetColumnType(col_idx);
+    auto encoded_or_s = FLAGS_table_store_cold_compression
+                            ? EncodedColumn::Encode(col_type, col)
+                            : EncodedColumn::Encode(col_type, col, ColumnEncoding::kPlain);
+    if (!encoded_or_s.ok()) {
+      // Keep the rows rather than dropping them, the plain encoding can't fail on valid columns.
+      LOG(WARNING) << absl::Substitute("Failed to encode cold column $0, storing it plain: $1",
+                                       col_idx, encoded_or_s.msg());
+      encoded_or_s = EncodedColumn::Encode(col_type, col, ColumnEncoding::kPlain);
+    }
+    PL_ASSIGN_OR_RETURN(auto encoded, encoded_or_s);
+    encoded_bytes += encoded->bytes();
+    encoded_columns.push_back(std::move(encoded));
+  }
+
+  absl::MutexLock gen_lock(&generation_lock_);
+  {
+    absl::MutexLock hot_lock(&hot_lock_);
+    // Hot batches are only removed from the front by expiry (or a concurrent compaction). If that
+    // happened to any of the copied batches, their rows are gone and the compacted batch is stale.
+    if (hot_row_ids_.size() < num_hot_batches || hot_row_ids_.front().first != first_row_id) {
+      return Status::OK();
+    }
+    for (size_t i = 0; i < num_hot_batches; ++i) {
+      hot_batches_.pop_front();
+      hot_row_ids_.pop_front();
+      if (time_col_idx_ != -1) {
+        hot_time_.pop_front();
+      }
+    }
+  }
   {
     absl::MutexLock cold_lock(&cold_lock_);
     PL_RETURN_IF_ERROR(AdvanceRingBufferUnlocked());
-    for (const auto& [col_idx, col] : Enumerate(builder.output_columns())) {
-      cold_column_buffers_[col_idx][ring_back_idx_] = col;
+    for (const auto& [col_idx, col] : Enumerate(encoded_columns)) {
+      cold_column_buffers_[col_idx][ring_back_idx_] = std::move(col);
     }
     cold_row_ids_.emplace_back(first_row_id, last_row_id);
+    cold_zone_maps_.push_back(std::move(zone_map));
     if (time_col_idx_ != -1) {
       cold_time_.emplace_back(first_time, last_time);
     }
@@ -431,7 +444,7 @@ Status Table::CompactSingleBatch(arrow::MemoryPool* mem_pool) {
   {
     absl::base_internal::SpinLockHolder stat_lock(&stats_lock_);
     hot_bytes_ -= builder.Size();
-    cold_bytes_ += builder.Size();
+    cold_bytes_ += encoded_bytes;
     compacted_batches_++;
   }
   generation_++;
@@ -461,13 +474,11 @@ StatusOr<bool> Table::ExpireCold() {
       return false;
     }
     cold_row_ids_.pop_front();
+    cold_zone_maps_.pop_front();
     if (time_col_idx_ != -1) cold_time_.pop_front();
 
     for (size_t col_idx = 0; col_idx < rel_.NumColumns(); col_idx++) {
-#define TYPE_CASE(_dt_) \
-  rb_bytes += types::GetArrowArrayBytes<_dt_>(cold_column_buffers_[col_idx][ring_front_idx_].get());
-      PL_SWITCH_FOREACH_DATATYPE(rel_.GetColumnType(col_idx), TYPE_CASE);
-#undef TYPE_CASE
+      rb_bytes += cold_column_buffers_[col_idx][ring_front_idx_]->bytes();
       cold_column_buffers_[col_idx][ring_front_idx_].reset();
     }
     if (ring_front_idx_ == ring_back_idx_) {
@@ -485,7 +496,7 @@ StatusOr<bool> Table::ExpireCold() {
 }
 
 Status Table::ExpireHot() {
-  RecordOrRowBatch record_or_row_batch;
+  std::vector<ArrowArrayPtr> expired_columns;
   {
     absl::MutexLock gen_lock(&generation_lock_);
     absl::MutexLock hot_lock(&hot_lock_);
@@ -494,25 +505,17 @@ Status Table::ExpireHot() {
     }
     if (time_col_idx_ != -1) hot_time_.pop_front();
     hot_row_ids_.pop_front();
-    record_or_row_batch = std::move(hot_batches_.front());
+    expired_columns = hot_batches_.front().columns();
     hot_batches_.pop_front();
     // Expire the first hot batch invalidates all hot indices, so we have to increase the
     // generation.
     generation_++;
   }
   int64_t rb_bytes = 0;
-  if (std::holds_alternative<RecordBatchWithCache>(record_or_row_batch)) {
-    auto record_batch = std::move(std::get<RecordBatchWithCache>(record_or_row_batch));
-    for (const auto& col : *record_batch.record_batch) {
-      rb_bytes += col->Bytes();
-    }
-  } else {
-    auto row_batch = std::get<schema::RowBatch>(record_or_row_batch);
-    for (const auto& [col_idx, col] : Enumerate(row_batch.columns())) {
+  for (const auto& [col_idx, col] : Enumerate(expired_columns)) {
 #define TYPE_CASE(_dt_) rb_bytes += types::GetArrowArrayBytes<_dt_>(col.get());
-      PL_SWITCH_FOREACH_DATATYPE(rel_.GetColumnType(col_idx), TYPE_CASE);
+    PL_SWITCH_FOREACH_DATATYPE(rel_.GetColumnType(col_idx), TYPE_CASE);
 #undef TYPE_CASE
-    }
   }
   {
     absl::base_internal::SpinLockHolder lock(&stats_lock_);
@@ -532,47 +535,36 @@ Status Table::ExpireBatch() {
 }
 
 Status Table::AddBatchSliceToRowBatch(const BatchSlice& slice, const std::vector<int64_t>& cols,
-                                      schema::RowBatch* output_rb,
-                                      arrow::MemoryPool* mem_pool) const {
-  absl::MutexLock gen_lock(&generation_lock_);
-  PL_RETURN_IF_ERROR(UpdateSliceUnlocked(slice));
-  // After this point, as long as gen_lock is held, the unsafe properties of slice are valid.
-  if (!slice.unsafe_is_hot) {
-    absl::MutexLock cold_lock(&cold_lock_);
-    for (auto col_idx : cols) {
-      auto arr = cold_column_buffers_[col_idx][slice.unsafe_batch_index]->Slice(
-          slice.unsafe_row_start, slice.unsafe_row_end + 1 - slice.unsafe_row_start);
-      PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
-    }
-    return Status::OK();
-  }
-
-  absl::MutexLock hot_lock(&hot_lock_);
-  if (std::holds_alternative<RecordBatchWithCache>(hot_batches_[slice.unsafe_batch_index])) {
-    auto record_batch_ptr =
-        std::get_if<RecordBatchWithCache>(&hot_batches_[slice.unsafe_batch_index]);
-    for (auto col_idx : cols) {
-      if (record_batch_ptr->cache_validity[col_idx]) {
-        auto arr = record_batch_ptr->arrow_cache[col_idx]->Slice(
-            slice.unsafe_row_start, slice.unsafe_row_end + 1 - slice.unsafe_row_start);
-        PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
-        continue;
+                                      arrow::MemoryPool* mem_pool,
+                                      schema::RowBatch* output_rb) const {
+  std::vector<EncodedColumnPtr> cold_columns;
+  int64_t row_start;
+  int64_t num_rows;
+  {
+    absl::MutexLock gen_lock(&generation_lock_);
+    PL_RETURN_IF_ERROR(UpdateSliceUnlocked(slice));
+    // After this point, as long as gen_lock is held, the unsafe properties of slice are valid.
+    row_start = slice.unsafe_row_start;
+    num_rows = slice.unsafe_row_end + 1 - slice.unsafe_row_start;
+    if (slice.unsafe_is_hot) {
+      absl::MutexLock hot_lock(&hot_lock_);
+      const auto& row_batch = hot_batches_[slice.unsafe_batch_index];
+      for (auto col_idx : cols) {
+        PL_RETURN_IF_ERROR(
+            output_rb->AddColumn(row_batch.ColumnAt(col_idx)->Slice(row_start, num_rows)));
       }
-      // Arrow array wasn't in cache, Convert to arrow and then add to cache.
-      auto arr = record_batch_ptr->record_batch->at(col_idx)->ConvertToArrow(mem_pool);
-      record_batch_ptr->arrow_cache[col_idx] = arr;
-      record_batch_ptr->cache_validity[col_idx] = true;
-      PL_RETURN_IF_ERROR(output_rb->AddColumn(
-          arr->Slice(slice.unsafe_row_start, slice.unsafe_row_end + 1 - slice.unsafe_row_start)));
+      return Status::OK();
     }
-  } else {
-    const auto& row_batch = std::get<schema::RowBatch>(hot_batches_[slice.unsafe_batch_index]);
+    absl::MutexLock cold_lock(&cold_lock_);
     for (auto col_idx : cols) {
-      auto arr = row_batch.ColumnAt(col_idx)->Slice(
-          slice.unsafe_row_start, slice.unsafe_row_end + 1 - slice.unsafe_row_start);
-      PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+      cold_columns.push_back(cold_column_buffers_[col_idx][slice.unsafe_batch_index]);
     }
   }
+  // Encoded columns are immutable, so they can be decoded without holding any locks.
+  for (const auto& col : cold_columns) {
+    PL_ASSIGN_OR_RETURN(auto arr, col->DecodeSlice(row_start, num_rows, mem_pool));
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+  }
   return Status::OK();
 }
 
@@ -664,7 +656,7 @@ BatchSlice Table::NextBatchWithoutStop(const BatchSlice& slice) const {
   return BatchSlice::Hot(next_index, 0, next_length - 1, generation_, hot_row_ids_[next_index]);
 }
 
-int64_t Table::FindStopTime(int64_t time, arrow::MemoryPool* mem_pool) const {
+StatusOr<int64_t> Table::FindStopTime(int64_t time, arrow::MemoryPool* mem_pool) const {
   absl::MutexLock gen_lock(&generation_lock_);
   {
     absl::MutexLock hot_lock(&hot_lock_);
@@ -673,14 +665,7 @@ int64_t Table::FindStopTime(int64_t time, arrow::MemoryPool* mem_pool) const {
     if (it != hot_time_.begin()) {
       it--;
       auto index = std::distance(hot_time_.begin(), it);
-      ArrowArrayPtr time_col;
-      if (std::holds_alternative<RecordBatchWithCache>(hot_batches_[index])) {
-        auto record_batch_ptr = std::get_if<RecordBatchWithCache>(&hot_batches_[index]);
-        time_col = GetHotColumnUnlocked(record_batch_ptr, time_col_idx_, mem_pool);
-      } else {
-        auto row_batch = std::get<schema::RowBatch>(hot_batches_[index]);
-        time_col = row_batch.columns().at(time_col_idx_);
-      }
+      auto time_col = hot_batches_[index].ColumnAt(time_col_idx_);
       auto row_offset =
           types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(time_col.get(), time);
       return hot_row_ids_[index].first + row_offset;
@@ -695,9 +680,8 @@ int64_t Table::FindStopTime(int64_t time, arrow::MemoryPool* mem_pool) const {
   it--;
   auto index = it - cold_time_.begin();
   auto ring_index = RingIndexUnlocked(index);
-  auto time_col = cold_column_buffers_[time_col_idx_][ring_index];
-  auto row_offset =
-      types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(time_col.get(), time);
+  const auto& time_col = cold_column_buffers_[time_col_idx_][ring_index];
+  PL_ASSIGN_OR_RETURN(auto row_offset, time_col->SearchLessThanOrEqual(time, mem_pool));
   return cold_row_ids_[index].first + row_offset;
 }
 
@@ -705,25 +689,7 @@ int64_t Table::ColdBatchLengthUnlocked(int64_t index) const {
   return cold_column_buffers_[0].at(index)->length();
 }
 int64_t Table::HotBatchLengthUnlocked(int64_t index) const {
-  if (std::holds_alternative<RecordBatchWithCache>(hot_batches_[index])) {
-    auto record_batch_ptr = std::get_if<RecordBatchWithCache>(&hot_batches_[index]);
-    return record_batch_ptr->record_batch->at(0)->Size();
-  } else {
-    auto row_batch = std::get<schema::RowBatch>(hot_batches_[index]);
-    return row_batch.num_rows();
-  }
-}
-
-Table::ArrowArrayPtr Table::GetHotColumnUnlocked(const RecordBatchWithCache* record_batch_ptr,
-                                                 int64_t col_idx,
-                                                 arrow::MemoryPool* mem_pool) const {
-  if (record_batch_ptr->cache_validity[col_idx]) {
-    return record_batch_ptr->arrow_cache[col_idx];
-  }
-  auto arrow_array_sptr = record_batch_ptr->record_batch->at(col_idx)->ConvertToArrow(mem_pool);
-  record_batch_ptr->arrow_cache[col_idx] = arrow_array_sptr;
-  record_batch_ptr->cache_validity[col_idx] = true;
-  return arrow_array_sptr;
+  return hot_batches_[index].num_rows();
 }
 
 BatchSlice Table::SliceIfPastStop(const BatchSlice& slice, int64_t stop_row_id) const {
@@ -779,15 +745,28 @@ int64_t Table::RingNextAddrUnlocked(int64_t ring_index) const {
 }
 
 Status Table::AdvanceRingBufferUnlocked() {
-  auto next_ring_back_idx = (ring_back_idx_ + 1) % ring_capacity_;
-  if (ring_back_idx_ != -1 && next_ring_back_idx == ring_front_idx_) {
-    return error::Internal(
-        "Failed to add new cold batch, ring buffer alreadRingNextAddrUnlocked full");
+  if (RingSizeUnlocked() == ring_capacity_) {
+    GrowRingBufferUnlocked();
   }
-  ring_back_idx_ = next_ring_back_idx;
+  ring_back_idx_ = (ring_back_idx_ + 1) % ring_capacity_;
   return Status::OK();
 }
 
+void Table::GrowRingBufferUnlocked() {
+  auto size = RingSizeUnlocked();
+  auto new_capacity = std::max<int64_t>(1, 2 * ring_capacity_);
+  for (auto& column_buffer : cold_column_buffers_) {
+    ColumnBuffer grown(new_capacity);
+    for (int64_t i = 0; i < size; ++i) {
+      grown[i] = std::move(column_buffer[RingIndexUnlocked(i)]);
+    }
+    column_buffer = std::move(grown);
+  }
+  ring_front_idx_ = 0;
+  ring_back_idx_ = size - 1;
+  ring_capacity_ = new_capacity;
+}
+
 Status Table::UpdateSliceUnlocked(const BatchSlice& slice) const {
   if (slice.generation == generation_) {
     return Status::OK();
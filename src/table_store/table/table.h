@@ -27,7 +27,6 @@
 #include <string>
 #include <unordered_map>
 #include <utility>
-#include <variant>
 #include <vector>
 
 #include <absl/base/internal/spinlock.h>
@@ -40,9 +39,12 @@
 #include "src/table_store/schema/row_batch.h"
 #include "src/table_store/schema/row_descriptor.h"
 #include "src/table_store/schemapb/schema.pb.h"
+#include "src/table_store/table/column_encoding.h"
 #include "src/table_store/table/table_metrics.h"
+#include "src/table_store/table/zone_map.h"
 
 DECLARE_int32(table_store_table_size_limit);
+DECLARE_bool(table_store_cold_compression);
 
 namespace px {
 namespace table_store {
@@ -144,10 +146,17 @@ class ArrowArrayCompactor {
  * moved to the cold partition. Reads can hit both hot and cold data. Hot data can be written in
  * RecordBatch format (i.e. for writes from stirling) or schema::RowBatch format (i.e. for writes
  * from MemorySinkNodes, which are not currently used). Hot data is stored in a deque, while cold
- * data is stored in a ring buffer. Hot data is eventually converted to arrow arrays either during
- * compaction and transfer to cold or during a read. If the conversion happens on read then we store
- * the arrow array in a cache with the hot batch so that future reads, before this batch is
- * transferred to cold, don't also need to convert to arrow.
+ * data is stored in a ring buffer. RecordBatches are converted to arrow arrays when they are
+ * written, outside of the hot lock, and the fixed width columns share the RecordBatch's buffers
+ * rather than being copied (see types::ShareAsArrow). Reads of hot data are therefore slices of
+ * the stored arrays and never convert or copy data.
+ *
+ * Cold Encoding:
+ * When a batch is compacted into cold storage, each of its columns is stored as an EncodedColumn,
+ * with an encoding picked for that column from a sample of its rows (e.g. delta of delta for
+ * time_, a dictionary for low cardinality strings). Reads of cold data decode only the requested
+ * slice, after the locks have been released. Since encoded batches can be smaller than
+ * min_cold_batch_size_, the ring buffer grows when it is full rather than rejecting the batch.
  *
  * Synchronization Scheme:
  * The hot and cold partitions are synchronized separately with spinlocks. Additionally, the
@@ -157,6 +166,11 @@ class ArrowArrayCompactor {
  * Hot batches are compacted into batches of minimum size min_cold_batch_size_ bytes. The compaction
  * routine should be called periodically but that is not the responsibility of this class.
  *
+ * Zone Maps:
+ * Each cold batch also keeps a BatchZoneMap with the min/max and null count of its numeric columns,
+ * and a bloom filter for its low cardinality string columns. Readers use MayMatch to skip cold
+ * batches that can't contain rows matching their predicates.
+ *
  * Time and Row Indexing:
  * The first and last values of the time columns for each batch are stored as intervals in
  * (hot/cold)_time_, which internally maintains a sorted list for O(logN) time lookup. Additionally,
@@ -174,22 +188,12 @@ class ArrowArrayCompactor {
  * batch's data.
  */
 class Table : public NotCopyable {
-  using RecordBatchPtr = std::unique_ptr<px::types::ColumnWrapperRecordBatch>;
   using ArrowArrayPtr = std::shared_ptr<arrow::Array>;
-  using ColumnBuffer = std::vector<ArrowArrayPtr>;
+  using EncodedColumnPtr = std::shared_ptr<const EncodedColumn>;
+  using ColumnBuffer = std::vector<EncodedColumnPtr>;
   using TimeInterval = std::pair<int64_t, int64_t>;
   using RowIDInterval = std::pair<int64_t, int64_t>;
 
-  struct RecordBatchWithCache {
-    RecordBatchPtr record_batch;
-    // Whenever we have to convert a hot batch to an arrow array, we store the arrow array in
-    // this cache. Compaction will eventually take these arrow arrays and move them into cold.
-    mutable std::vector<ArrowArrayPtr> arrow_cache;
-    mutable std::vector<bool> cache_validity;
-  };
-
-  using RecordOrRowBatch = std::variant<RecordBatchWithCache, schema::RowBatch>;
-
   static inline constexpr int64_t kDefaultColdBatchMinSize = 64 * 1024;
 
  public:
@@ -221,7 +225,7 @@ class Table : public NotCopyable {
    * Get a RowBatch of data corresponding to the passed in BatchSlice.
    * @param slice the BatchSlice to get the data for.
    * @param cols a vector of column indices to get data for.
-   * @param mem_pool the arrow memory pool to use if the slice is in hot storage.
+   * @param mem_pool arrow MemoryPool used to decode cold data.
    * @return a unique ptr to a RowBatch with the requested data.
    */
   StatusOr<std::unique_ptr<schema::RowBatch>> GetRowBatchSlice(const BatchSlice& slice,
@@ -247,7 +251,7 @@ class Table : public NotCopyable {
 
   /**
    * @param time the timestamp to search for.
-   * @param mem_pool the arrow memory pool.
+   * @param mem_pool arrow MemoryPool used to decode cold data.
    * @return the BatchSlice of the first row with timestamp greater than or equal to the given time,
    * until the end of its corresponding row batch.
    */
@@ -256,12 +260,22 @@ class Table : public NotCopyable {
 
   /**
    * @param time the timestamp to search for.
-   * @param mem_pool the arrow memory pool.
+   * @param mem_pool arrow MemoryPool used to decode cold data.
    * @return the BatchSlice of the last row with timestamp less than or equal to the given time,
    * until the end of its corresponding row batch.
    */
   StatusOr<StopPosition> FindStopPositionForTime(int64_t time, arrow::MemoryPool* mem_pool) const;
 
+  /**
+   * Checks the statistics of the batch containing the slice against a conjunction of predicates,
+   * so that readers can skip the batch without reading it.
+   * @param slice the BatchSlice to check.
+   * @param predicates the predicates that a row must satisfy.
+   * @return false if no row of the slice can satisfy all of the predicates. Hot batches don't keep
+   * statistics, so this always returns true for them.
+   */
+  bool MayMatch(const BatchSlice& slice, const std::vector<ZoneMapPredicate>& predicates) const;
+
   /**
    * Covert the table and store in passed in proto.
    * @param table_proto The table proto to write to.
@@ -329,13 +343,14 @@ class Table : public NotCopyable {
   int64_t min_cold_batch_size_;
 
   mutable absl::Mutex hot_lock_;
-  std::deque<RecordOrRowBatch> hot_batches_ ABSL_GUARDED_BY(hot_lock_);
+  std::deque<schema::RowBatch> hot_batches_ ABSL_GUARDED_BY(hot_lock_);
 
   mutable absl::Mutex cold_lock_;
   std::vector<ColumnBuffer> cold_column_buffers_ ABSL_GUARDED_BY(cold_lock_);
 
-  // The generation lock must be held during compaction and
-  // expiration, and anytime one would like to access the unsafe_ attributes of BatchSlice.
+  // The generation lock must be held while compaction moves batches from hot to cold storage and
+  // during expiration, and anytime one would like to access the unsafe_ attributes of BatchSlice.
+  // It isn't held while compaction builds and encodes the cold batch.
   mutable absl::Mutex generation_lock_;
   // Generation of the HotColdDataStore is incremented whenever a change to the store would
   // invalidate some BatchSlice', eg. during compaction or hot expiration.
@@ -353,14 +368,12 @@ class Table : public NotCopyable {
   std::deque<TimeInterval> hot_time_ ABSL_GUARDED_BY(hot_lock_);
   std::deque<RowIDInterval> cold_row_ids_ ABSL_GUARDED_BY(cold_lock_);
   std::deque<TimeInterval> cold_time_ ABSL_GUARDED_BY(cold_lock_);
+  std::deque<BatchZoneMap> cold_zone_maps_ ABSL_GUARDED_BY(cold_lock_);
 
   int64_t time_col_idx_ = -1;
 
-  Status WriteHot(RecordBatchPtr record_batch);
-  Status WriteHot(const schema::RowBatch& rb);
+  Status WriteHot(schema::RowBatch rb);
   Status UpdateTimeRowIndices(const schema::RowBatch& rb) ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
-  Status UpdateTimeRowIndices(types::ColumnWrapperRecordBatch* record_batch)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
 
   Status ExpireBatch();
   Status ExpireHot();
@@ -368,10 +381,7 @@ class Table : public NotCopyable {
   Status CompactSingleBatch(arrow::MemoryPool* mem_pool);
 
   Status AddBatchSliceToRowBatch(const BatchSlice& slice, const std::vector<int64_t>& cols,
-                                 schema::RowBatch* output_rb, arrow::MemoryPool* mem_pool) const;
-  ArrowArrayPtr GetHotColumnUnlocked(const RecordBatchWithCache* record_batch_ptr, int64_t col_idx,
-                                     arrow::MemoryPool* mem_pool) const
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+                                 arrow::MemoryPool* mem_pool, schema::RowBatch* output_rb) const;
 
   int64_t NumBatches() const;
   int64_t ColdBatchLengthUnlocked(int64_t ring_index) const
@@ -379,7 +389,7 @@ class Table : public NotCopyable {
   int64_t HotBatchLengthUnlocked(int64_t hot_index) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
 
   // Returns the unique identifier of the last row less than or equal to the given time.
-  int64_t FindStopTime(int64_t time, arrow::MemoryPool* mem_pool) const;
+  StatusOr<int64_t> FindStopTime(int64_t time, arrow::MemoryPool* mem_pool) const;
 
   // Returns the index into cold_row_ids_ or cold_time_ given the ring buffer location.
   int64_t RingVectorIndexUnlocked(int64_t ring_index) const
@@ -389,6 +399,8 @@ class Table : public NotCopyable {
   int64_t RingSizeUnlocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
   int64_t RingNextAddrUnlocked(int64_t ring_index) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
   Status AdvanceRingBufferUnlocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
+  // Doubles the capacity of the ring buffer, moving the front of the ring to index 0.
+  void GrowRingBufferUnlocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
 
   Status UpdateSliceUnlocked(const BatchSlice& slice) const
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(generation_lock_);
@@ -215,8 +215,6 @@ static void BM_TableCompaction(benchmark::State& state) {
   int64_t batch_length = 256;
   auto table = MakeTable(table_size, compaction_size);
   // Fill table first to make sure each compaction hits kMaxBatchesPerCompaction.
-  // This should be the slowest possible compaction. Since none of the batches will have an
-  // arrow_cache.
   FillTableHot(table.get(), table_size, batch_length);
 
   for (auto _ : state) {
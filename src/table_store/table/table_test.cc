@@ -16,6 +16,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <absl/strings/substitute.h>
 #include <absl/synchronization/notification.h>
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
@@ -476,6 +477,34 @@ TEST(TableTest, hot_batches_test) {
   EXPECT_TRUE(rb2->ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
 
+TEST(TableTest, hot_batches_share_record_batch_buffers) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+
+  std::shared_ptr<Table> table_ptr = Table::Create("table_name", rel);
+  Table& table = *table_ptr;
+
+  std::vector<types::Int64Value> col1_in1 = {1, 2, 3};
+  auto col1_in1_wrapper =
+      types::ColumnWrapper::FromArrow(types::ToArrow(col1_in1, arrow::default_memory_pool()));
+  const void* raw_data = col1_in1_wrapper->UnsafeRawData();
+
+  auto rb_wrapper_1 = std::make_unique<types::ColumnWrapperRecordBatch>();
+  rb_wrapper_1->push_back(col1_in1_wrapper);
+  EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper_1)));
+  col1_in1_wrapper.reset();
+
+  auto slice = table.FirstBatch();
+  slice.unsafe_row_start = 1;
+  slice.uniq_row_start_idx = 1;
+  auto rb1 = table.GetRowBatchSlice(slice, std::vector<int64_t>({0}), arrow::default_memory_pool())
+                 .ConsumeValueOrDie();
+  // Reading the hot batch should slice the record batch's buffer rather than copy it.
+  auto col = std::static_pointer_cast<arrow::Int64Array>(rb1->ColumnAt(0));
+  EXPECT_EQ(static_cast<const int64_t*>(raw_data) + 1, col->raw_values());
+  std::vector<types::Int64Value> expected = {2, 3};
+  EXPECT_TRUE(col->Equals(types::ToArrow(expected, arrow::default_memory_pool())));
+}
+
 TEST(TableTest, hot_batches_w_compaction_test) {
   schema::Relation rel({types::DataType::BOOLEAN, types::DataType::INT64}, {"col1", "col2"});
 
@@ -524,6 +553,167 @@ TEST(TableTest, hot_batches_w_compaction_test) {
   EXPECT_TRUE(rb2->ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
 
+TEST(TableTest, transferred_string_bytes_match_compaction) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "col2"});
+  Table table("test_table", rel, 64 * 1024, 1);
+
+  auto col1 = std::make_shared<types::Int64ValueColumnWrapper>(0);
+  col1->AppendFromVector(std::vector<types::Int64Value>{1, 5, 3});
+  auto col2 = std::make_shared<types::StringValueColumnWrapper>(0);
+  col2->AppendFromVector(std::vector<types::StringValue>{"test", "abc", "de"});
+  auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+  wrapper_batch->push_back(col1);
+  wrapper_batch->push_back(col2);
+
+  int64_t rb_size = 3 * sizeof(int64_t) + 9 * sizeof(char);
+
+  EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
+  EXPECT_EQ(table.GetTableStats().bytes, rb_size);
+
+  // Compaction subtracts the bytes of the arrow arrays it moves out of hot storage, which must be
+  // what the transfer added, leaving no hot bytes behind.
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(1, stats.compacted_batches);
+  EXPECT_EQ(stats.bytes, stats.cold_bytes);
+}
+
+TEST(TableTest, cold_batches_are_encoded) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING}, {"time_", "service"});
+  schema::RowDescriptor rd(rel.col_types());
+
+  constexpr int64_t kRowsPerBatch = 1000;
+  constexpr int64_t kNumBatches = 12;
+  std::vector<types::Time64NSValue> all_times;
+  std::vector<types::StringValue> all_services;
+  // Each batch is compacted into its own cold batch. The table only has room for 3 of them
+  // uncompressed, and the ring buffer has to grow to hold all of the encoded ones.
+  Table table("test_table", rel, 64 * 1024, 16 * 1024);
+  for (int64_t batch = 0; batch < kNumBatches; ++batch) {
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::StringValue> services;
+    for (int64_t i = 0; i < kRowsPerBatch; ++i) {
+      times.push_back(1000 * (batch * kRowsPerBatch + i));
+      services.push_back(absl::Substitute("service-$0", i % 4));
+    }
+    schema::RowBatch rb(rd, kRowsPerBatch);
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(services, arrow::default_memory_pool())));
+    EXPECT_OK(table.WriteRowBatch(rb));
+    EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+    all_times.insert(all_times.end(), times.begin(), times.end());
+    all_services.insert(all_services.end(), services.begin(), services.end());
+  }
+
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(0, stats.batches_expired);
+  EXPECT_EQ(kNumBatches, stats.compacted_batches);
+  // The time column is delta of delta encoded and the service column is dictionary encoded.
+  EXPECT_LT(stats.cold_bytes * 4, kNumBatches * kRowsPerBatch * 17);
+  EXPECT_EQ(stats.bytes, stats.cold_bytes);
+
+  int64_t row = 0;
+  for (auto slice = table.FirstBatch(); slice.IsValid(); slice = table.NextBatch(slice)) {
+    ASSERT_OK_AND_ASSIGN(auto rb, table.GetRowBatchSlice(slice, {0, 1},
+                                                         arrow::default_memory_pool()));
+    std::vector<types::Time64NSValue> times(all_times.begin() + row,
+                                            all_times.begin() + row + rb->num_rows());
+    std::vector<types::StringValue> services(all_services.begin() + row,
+                                             all_services.begin() + row + rb->num_rows());
+    EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_TRUE(rb->ColumnAt(1)->Equals(types::ToArrow(services, arrow::default_memory_pool())));
+    row += rb->num_rows();
+  }
+  EXPECT_EQ(kNumBatches * kRowsPerBatch, row);
+
+  ASSERT_OK_AND_ASSIGN(auto slice, table.FindBatchSliceGreaterThanOrEqual(
+                                       1000 * 5500 + 1, arrow::default_memory_pool()));
+  EXPECT_EQ(5501, slice.uniq_row_start_idx);
+  EXPECT_OK_AND_EQ(table.FindStopPositionForTime(1000 * 5500, arrow::default_memory_pool()),
+                   5501);
+}
+
+TEST(TableTest, cold_batch_read_through_small_slices) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING}, {"time_", "req_path"});
+  schema::RowDescriptor rd(rel.col_types());
+
+  // The batch spans several of the encoded columns' checkpoints.
+  constexpr int64_t kNumRows = 5000;
+  std::vector<types::Time64NSValue> all_times;
+  std::vector<types::StringValue> all_paths;
+  for (int64_t row = 0; row < kNumRows; ++row) {
+    all_times.push_back(1000 * row + row % 3);
+    all_paths.push_back(absl::Substitute("/api/v1/users/$0", row % 997));
+  }
+  Table table("test_table", rel, 1024 * 1024, 16 * 1024);
+  schema::RowBatch input_rb(rd, kNumRows);
+  EXPECT_OK(input_rb.AddColumn(types::ToArrow(all_times, arrow::default_memory_pool())));
+  EXPECT_OK(input_rb.AddColumn(types::ToArrow(all_paths, arrow::default_memory_pool())));
+  EXPECT_OK(table.WriteRowBatch(input_rb));
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(1, table.GetTableStats().compacted_batches);
+
+  // Read the cold batch the way morsels do, a few rows at a time.
+  int64_t row = 0;
+  auto batch = table.FirstBatch();
+  while (batch.IsValid()) {
+    auto slice = table.SliceIfPastStop(batch, batch.uniq_row_start_idx + 7);
+    ASSERT_OK_AND_ASSIGN(auto rb, table.GetRowBatchSlice(slice, {0, 1},
+                                                         arrow::default_memory_pool()));
+    std::vector<types::Time64NSValue> times(all_times.begin() + row,
+                                            all_times.begin() + row + rb->num_rows());
+    std::vector<types::StringValue> paths(all_paths.begin() + row,
+                                          all_paths.begin() + row + rb->num_rows());
+    EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_TRUE(rb->ColumnAt(1)->Equals(types::ToArrow(paths, arrow::default_memory_pool())));
+    row += rb->num_rows();
+    batch = table.NextBatch(slice);
+  }
+  EXPECT_EQ(kNumRows, row);
+
+  for (int64_t time_row : {0, 1023, 1024, 4999}) {
+    int64_t time = all_times[time_row].val;
+    ASSERT_OK_AND_ASSIGN(auto slice, table.FindBatchSliceGreaterThanOrEqual(
+                                         time, arrow::default_memory_pool()));
+    EXPECT_EQ(time_row, slice.uniq_row_start_idx);
+    EXPECT_OK_AND_EQ(table.FindStopPositionForTime(time, arrow::default_memory_pool()),
+                     time_row + 1);
+  }
+}
+
+TEST(TableTest, cold_batch_zone_maps) {
+  schema::Relation rel({types::DataType::INT64}, {"resp_status"});
+  schema::RowDescriptor rd(rel.col_types());
+  Table table("test_table", rel, 128 * 1024, 1);
+
+  for (const auto& statuses : std::vector<std::vector<types::Int64Value>>{
+           {200, 201}, {500, 503}, {404, 200}}) {
+    schema::RowBatch rb(rd, statuses.size());
+    EXPECT_OK(rb.AddColumn(types::ToArrow(statuses, arrow::default_memory_pool())));
+    EXPECT_OK(table.WriteRowBatch(rb));
+  }
+  // Each batch is compacted into its own cold batch.
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(3, table.GetTableStats().compacted_batches);
+  schema::RowBatch hot_rb(rd, 1);
+  EXPECT_OK(hot_rb.AddColumn(
+      types::ToArrow(std::vector<types::Int64Value>{200}, arrow::default_memory_pool())));
+  EXPECT_OK(table.WriteRowBatch(hot_rb));
+
+  std::vector<ZoneMapPredicate> server_errors = {{0, ZoneMapOp::kGreaterThanEqual, int64_t{500}}};
+  auto slice = table.FirstBatch();
+  EXPECT_TRUE(table.MayMatch(slice, {}));
+  EXPECT_FALSE(table.MayMatch(slice, server_errors));
+  slice = table.NextBatch(slice);
+  EXPECT_TRUE(table.MayMatch(slice, server_errors));
+  slice = table.NextBatch(slice);
+  EXPECT_FALSE(table.MayMatch(slice, server_errors));
+  // Hot batches don't have zone maps.
+  slice = table.NextBatch(slice);
+  EXPECT_TRUE(slice.IsValid());
+  EXPECT_TRUE(table.MayMatch(slice, server_errors));
+}
+
 TEST(TableTest, find_batch_slice_greater_or_eq) {
   schema::Relation rel(std::vector<types::DataType>({types::DataType::TIME64NS}),
                        std::vector<std::string>({"time_"}));
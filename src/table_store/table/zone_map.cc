@@ -0,0 +1,188 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/zone_map.h"
+
+#include <absl/container/flat_hash_set.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+#include <type_traits>
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+template <typename TArray, typename TValue>
+bool ComputeMinMax(const TArray* arr, TValue* min, TValue* max) {
+  bool found = false;
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    if (arr->IsNull(i)) {
+      continue;
+    }
+    TValue value = arr->Value(i);
+    if constexpr (std::is_floating_point_v<TValue>) {
+      // NaN isn't ordered, and NaN != x is true for any x, so there is no usable range.
+      if (std::isnan(value)) {
+        return false;
+      }
+    }
+    if (!found) {
+      *min = value;
+      *max = value;
+      found = true;
+      continue;
+    }
+    *min = std::min(*min, value);
+    *max = std::max(*max, value);
+  }
+  return found;
+}
+
+std::unique_ptr<bloomfilter::XXHash64BloomFilter> MaybeCreateBloomFilter(
+    const arrow::StringArray* arr) {
+  absl::flat_hash_set<std::string_view> distinct;
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    if (arr->IsNull(i)) {
+      continue;
+    }
+    int32_t length = 0;
+    const uint8_t* data = arr->GetValue(i, &length);
+    distinct.insert(std::string_view(reinterpret_cast<const char*>(data), length));
+    if (static_cast<int64_t>(distinct.size()) > ColumnZoneMap::kMaxBloomFilterEntries) {
+      return nullptr;
+    }
+  }
+  auto bloom_filter_or_s = bloomfilter::XXHash64BloomFilter::Create(
+      std::max<int64_t>(1, distinct.size()), ColumnZoneMap::kBloomFilterErrorRate);
+  if (!bloom_filter_or_s.ok()) {
+    return nullptr;
+  }
+  auto bloom_filter = bloom_filter_or_s.ConsumeValueOrDie();
+  for (const auto& value : distinct) {
+    bloom_filter->Insert(value);
+  }
+  return bloom_filter;
+}
+
+}  // namespace
+
+ColumnZoneMap ColumnZoneMap::Create(types::DataType data_type, const arrow::Array* arr) {
+  ColumnZoneMap zone_map(data_type);
+  zone_map.length_ = arr->length();
+  zone_map.null_count_ = arr->null_count();
+  switch (data_type) {
+    case types::DataType::INT64:
+    case types::DataType::TIME64NS:
+      zone_map.has_min_max_ =
+          ComputeMinMax(static_cast<const arrow::Int64Array*>(arr), &zone_map.int64_min_,
+                        &zone_map.int64_max_);
+      break;
+    case types::DataType::BOOLEAN: {
+      bool min = false;
+      bool max = false;
+      zone_map.has_min_max_ =
+          ComputeMinMax(static_cast<const arrow::BooleanArray*>(arr), &min, &max);
+      zone_map.int64_min_ = min;
+      zone_map.int64_max_ = max;
+      break;
+    }
+    case types::DataType::FLOAT64:
+      zone_map.has_min_max_ =
+          ComputeMinMax(static_cast<const arrow::DoubleArray*>(arr), &zone_map.float64_min_,
+                        &zone_map.float64_max_);
+      break;
+    case types::DataType::STRING:
+      zone_map.bloom_filter_ =
+          MaybeCreateBloomFilter(static_cast<const arrow::StringArray*>(arr));
+      break;
+    default:
+      break;
+  }
+  return zone_map;
+}
+
+template <typename TValue>
+bool ColumnZoneMap::MayMatchRange(ZoneMapOp op, TValue min, TValue max, TValue value) const {
+  switch (op) {
+    case ZoneMapOp::kEqual:
+      return min <= value && value <= max;
+    case ZoneMapOp::kNotEqual:
+      return !(min == max && min == value);
+    case ZoneMapOp::kLessThan:
+      return min < value;
+    case ZoneMapOp::kLessThanEqual:
+      return min <= value;
+    case ZoneMapOp::kGreaterThan:
+      return max > value;
+    case ZoneMapOp::kGreaterThanEqual:
+      return max >= value;
+  }
+  return true;
+}
+
+bool ColumnZoneMap::MayMatch(ZoneMapOp op,
+                             const std::variant<int64_t, double, std::string>& value) const {
+  // Comparisons against null are false, so a column of only nulls never matches.
+  if (length_ > 0 && null_count_ == length_) {
+    return false;
+  }
+  if (has_min_max_) {
+    if (const auto* int64_value = std::get_if<int64_t>(&value);
+        int64_value != nullptr && data_type_ != types::DataType::FLOAT64) {
+      return MayMatchRange(op, int64_min_, int64_max_, *int64_value);
+    }
+    if (const auto* float64_value = std::get_if<double>(&value);
+        float64_value != nullptr && data_type_ == types::DataType::FLOAT64) {
+      return MayMatchRange(op, float64_min_, float64_max_, *float64_value);
+    }
+    return true;
+  }
+  if (bloom_filter_ != nullptr && op == ZoneMapOp::kEqual) {
+    if (const auto* string_value = std::get_if<std::string>(&value); string_value != nullptr) {
+      return bloom_filter_->Contains(*string_value);
+    }
+  }
+  return true;
+}
+
+BatchZoneMap::BatchZoneMap(const std::vector<types::DataType>& column_types,
+                           const std::vector<std::shared_ptr<arrow::Array>>& columns) {
+  DCHECK_EQ(column_types.size(), columns.size());
+  columns_.reserve(columns.size());
+  for (const auto& [col_idx, col] : Enumerate(columns)) {
+    columns_.push_back(ColumnZoneMap::Create(column_types[col_idx], col.get()));
+  }
+}
+
+bool BatchZoneMap::MayMatch(const std::vector<ZoneMapPredicate>& predicates) const {
+  for (const auto& predicate : predicates) {
+    if (predicate.col_idx < 0 || predicate.col_idx >= static_cast<int64_t>(columns_.size())) {
+      continue;
+    }
+    if (!columns_[predicate.col_idx].MayMatch(predicate.op, predicate.value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace table_store {
+
+enum class ZoneMapOp {
+  kEqual,
+  kNotEqual,
+  kLessThan,
+  kLessThanEqual,
+  kGreaterThan,
+  kGreaterThanEqual,
+};
+
+/**
+ * A comparison of a table column against a constant, eg. resp_status >= 500. The value holds an
+ * int64_t for INT64, TIME64NS and BOOLEAN columns, a double for FLOAT64 columns and a string for
+ * STRING columns.
+ */
+struct ZoneMapPredicate {
+  int64_t col_idx;
+  ZoneMapOp op;
+  std::variant<int64_t, double, std::string> value;
+};
+
+/**
+ * ColumnZoneMap holds the statistics of a single column of a batch: the null count, the min and max
+ * of numeric columns, and a bloom filter of the values of low cardinality string columns.
+ */
+class ColumnZoneMap {
+ public:
+  // String columns with more distinct values than this don't get a bloom filter.
+  static constexpr int64_t kMaxBloomFilterEntries = 1024;
+  static constexpr double kBloomFilterErrorRate = 0.01;
+
+  static ColumnZoneMap Create(types::DataType data_type, const arrow::Array* arr);
+
+  /**
+   * @return false if no row of the column can satisfy the comparison, true if some may.
+   */
+  bool MayMatch(ZoneMapOp op, const std::variant<int64_t, double, std::string>& value) const;
+
+  int64_t null_count() const { return null_count_; }
+  bool has_min_max() const { return has_min_max_; }
+  bool has_bloom_filter() const { return bloom_filter_ != nullptr; }
+
+ private:
+  explicit ColumnZoneMap(types::DataType data_type) : data_type_(data_type) {}
+
+  template <typename TValue>
+  bool MayMatchRange(ZoneMapOp op, TValue min, TValue max, TValue value) const;
+
+  types::DataType data_type_;
+  int64_t length_ = 0;
+  int64_t null_count_ = 0;
+  bool has_min_max_ = false;
+  int64_t int64_min_ = 0;
+  int64_t int64_max_ = 0;
+  double float64_min_ = 0;
+  double float64_max_ = 0;
+  std::shared_ptr<const bloomfilter::XXHash64BloomFilter> bloom_filter_;
+};
+
+/**
+ * BatchZoneMap holds a ColumnZoneMap for each column of a batch, and is used to skip batches that
+ * can't contain any row that satisfies a conjunction of predicates.
+ */
+class BatchZoneMap {
+ public:
+  BatchZoneMap(const std::vector<types::DataType>& column_types,
+               const std::vector<std::shared_ptr<arrow::Array>>& columns);
+
+  /**
+   * @return false if no row of the batch can satisfy all of the predicates, true if some may.
+   */
+  bool MayMatch(const std::vector<ZoneMapPredicate>& predicates) const;
+
+  const ColumnZoneMap& column(int64_t col_idx) const { return columns_[col_idx]; }
+
+ private:
+  std::vector<ColumnZoneMap> columns_;
+};
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <absl/strings/substitute.h>
+#include <arrow/array.h>
+#include <arrow/builder.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/zone_map.h"
+
+namespace px {
+namespace table_store {
+
+TEST(ColumnZoneMapTest, int64_range) {
+  std::vector<types::Int64Value> values = {200, 404, 201, 302};
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  auto zone_map = ColumnZoneMap::Create(types::DataType::INT64, arr.get());
+  EXPECT_TRUE(zone_map.has_min_max());
+
+  EXPECT_FALSE(zone_map.MayMatch(ZoneMapOp::kGreaterThanEqual, int64_t{500}));
+  EXPECT_TRUE(zone_map.MayMatch(ZoneMapOp::kGreaterThanEqual, int64_t{404}));
+  EXPECT_FALSE(zone_map.MayMatch(ZoneMapOp::kGreaterThan, int64_t{404}));
+  EXPECT_FALSE(zone_map.MayMatch(ZoneMapOp::kLessThan, int64_t{200}));
+  EXPECT_TRUE(zone_map.MayMatch(ZoneMapOp::kLessThanEqual, int64_t{200}));
+  EXPECT_FALSE(zone_map.MayMatch(ZoneMapOp::kEqual, int64_t{100}));
+  EXPECT_TRUE(zone_map.MayMatch(ZoneMapOp::kEqual, int64_t{250}));
+  EXPECT_TRUE(zone_map.MayMatch(ZoneMapOp::kNotEqual, int64_t{200}));
+  // The value doesn't match the type of the column, so the zone map can't rule anything out.
+  EXPECT_TRUE(zone_map.MayMatch(ZoneMapOp::kEqual, std::string("abc")));
+}
+
+TEST(ColumnZoneMapTest, not_equal_constant_column) {
+  std::vector<types::Int64Value> values = {7, 7, 7};
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  auto zone_map = ColumnZoneMap::Create(types::DataType::INT64, arr.get());
+  EXPECT_FALSE(zone_map.MayMatch(ZoneMapOp::kNotEqual, int64_t{7}));
+  EXPECT_TRUE(zone_map.MayMatch(ZoneMapOp::kNotEqual, int64_t{8}));
+}
+
+TEST(ColumnZoneMapTest, float64_with_nan_has_no_range) {
+  std::vector<types::Float64Value> values = {1.0, std::numeric_limits<double>::quiet_NaN()};
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  auto zone_map = ColumnZoneMap::Create(types::DataType::FLOAT64, arr.get());
+  EXPECT_FALSE(zone_map.has_min_max());
+  EXPECT_TRUE(zone_map.MayMatch(ZoneMapOp::kGreaterThan, 2.0));
+}
+
+TEST(ColumnZoneMapTest, nulls) {
+  arrow::Int64Builder builder;
+  ASSERT_TRUE(builder.AppendNull().ok());
+  ASSERT_TRUE(builder.AppendNull().ok());
+  std::shared_ptr<arrow::Array> arr;
+  ASSERT_TRUE(builder.Finish(&arr).ok());
+  auto zone_map = ColumnZoneMap::Create(types::DataType::INT64, arr.get());
+  EXPECT_EQ(2, zone_map.null_count());
+  EXPECT_FALSE(zone_map.MayMatch(ZoneMapOp::kNotEqual, int64_t{0}));
+}
+
+TEST(ColumnZoneMapTest, low_cardinality_string_bloom_filter) {
+  std::vector<types::StringValue> values;
+  for (int64_t i = 0; i < 1000; ++i) {
+    values.push_back(absl::Substitute("upid-$0", i % 10));
+  }
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  auto zone_map = ColumnZoneMap::Create(types::DataType::STRING, arr.get());
+  ASSERT_TRUE(zone_map.has_bloom_filter());
+  for (int64_t i = 0; i < 10; ++i) {
+    EXPECT_TRUE(zone_map.MayMatch(ZoneMapOp::kEqual, absl::Substitute("upid-$0", i)));
+  }
+  int64_t false_positives = 0;
+  for (int64_t i = 10; i < 1010; ++i) {
+    false_positives += zone_map.MayMatch(ZoneMapOp::kEqual, absl::Substitute("upid-$0", i));
+  }
+  EXPECT_LT(false_positives, 50);
+  // Bloom filters only answer equality.
+  EXPECT_TRUE(zone_map.MayMatch(ZoneMapOp::kNotEqual, std::string("upid-1")));
+}
+
+TEST(ColumnZoneMapTest, high_cardinality_string_has_no_bloom_filter) {
+  std::vector<types::StringValue> values;
+  for (int64_t i = 0; i <= ColumnZoneMap::kMaxBloomFilterEntries; ++i) {
+    values.push_back(absl::Substitute("req-$0", i));
+  }
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  auto zone_map = ColumnZoneMap::Create(types::DataType::STRING, arr.get());
+  EXPECT_FALSE(zone_map.has_bloom_filter());
+  EXPECT_TRUE(zone_map.MayMatch(ZoneMapOp::kEqual, std::string("abc")));
+}
+
+TEST(BatchZoneMapTest, conjunction) {
+  std::vector<types::Int64Value> status = {200, 200, 500};
+  std::vector<types::StringValue> service = {"a", "b", "c"};
+  BatchZoneMap zone_map({types::DataType::INT64, types::DataType::STRING},
+                        {types::ToArrow(status, arrow::default_memory_pool()),
+                         types::ToArrow(service, arrow::default_memory_pool())});
+  EXPECT_TRUE(zone_map.MayMatch({}));
+  EXPECT_TRUE(zone_map.MayMatch({{0, ZoneMapOp::kGreaterThanEqual, int64_t{500}},
+                                 {1, ZoneMapOp::kEqual, std::string("c")}}));
+  EXPECT_FALSE(zone_map.MayMatch({{0, ZoneMapOp::kGreaterThanEqual, int64_t{500}},
+                                  {1, ZoneMapOp::kEqual, std::string("d")}}));
+  EXPECT_FALSE(zone_map.MayMatch({{0, ZoneMapOp::kLessThan, int64_t{200}}}));
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -207,6 +207,8 @@ func makeKelvinCarnotInfo(agentID uuid.UUID, grpcAddress string, asid uint32) *d
 		HasDataStore:         false,
 		ProcessesData:        true,
 		AcceptsRemoteSources: true,
+		// Kelvins decode the flat columnar row batches, so the sinks sending to them use it.
+		AcceptsFlatRowBatches: true,
 		// When we support persistent storage, Kelvins will also have MetadataInfo.
 		MetadataInfo:  nil,
 		SSLTargetName: fmt.Sprintf(KelvinSSLTargetOverride, viper.GetString("pod_namespace")),
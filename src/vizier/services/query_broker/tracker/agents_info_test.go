@@ -249,15 +249,16 @@ func TestAgentsInfo_UpdateAgentsInfo(t *testing.T) {
 	}
 
 	expectedKelvinInfo := &distributedpb.CarnotInfo{
-		QueryBrokerAddress:   "21285cdd-1de9-4ab1-ae6a-0ba08c8c676c",
-		AgentID:              uuidpbs[1],
-		HasGRPCServer:        true,
-		GRPCAddress:          "127.0.1.3",
-		HasDataStore:         false,
-		ProcessesData:        true,
-		AcceptsRemoteSources: true,
-		ASID:                 456,
-		SSLTargetName:        "kelvin.pl.svc",
+		QueryBrokerAddress:    "21285cdd-1de9-4ab1-ae6a-0ba08c8c676c",
+		AgentID:               uuidpbs[1],
+		HasGRPCServer:         true,
+		GRPCAddress:           "127.0.1.3",
+		HasDataStore:          false,
+		ProcessesData:         true,
+		AcceptsRemoteSources:  true,
+		AcceptsFlatRowBatches: true,
+		ASID:                  456,
+		SSLTargetName:         "kelvin.pl.svc",
 	}
 
 	agentsMap := make(map[uuid.UUID]*distributedpb.CarnotInfo)